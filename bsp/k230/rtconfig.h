@@ -336,6 +336,7 @@
 #define RT_USING_ADT_AVL
 #define RT_USING_ADT_BITMAP
 #define RT_USING_ADT_HASHMAP
+#define RT_USING_ADT_RADIX
 #define RT_USING_ADT_REF
 /* end of Utilities */
 #define RT_USING_LWP
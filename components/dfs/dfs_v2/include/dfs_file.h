@@ -7,6 +7,8 @@
  * Date           Author       Notes
  * 2005-01-26     Bernard      The first version.
  * 2023-05-05     Bernard      Change to dfs v2.0
+ * 2026-10-17     agent        add dfs_file_splice_read
+ * 2026-10-17     agent        add dfs_file_get/dfs_file_put
  */
 
 #ifndef __DFS_FILE_H__
@@ -80,6 +82,17 @@ struct dfs_vnode
     void *data;             /* private data of this file system */
 };
 
+#ifdef RT_USING_PAGECACHE
+/* readahead state of an opened file, all in pages */
+struct dfs_file_ra
+{
+    off_t start;            /* first page of the current window */
+    size_t size;            /* pages of the current window */
+    size_t async_size;      /* pages of the window which are read asynchronously */
+    off_t prev_index;       /* page of the last read */
+};
+#endif
+
 /* file descriptor */
 #define DFS_FD_MAGIC 0xfdfd
 struct dfs_file
@@ -99,6 +112,9 @@ struct dfs_file
     struct dfs_vnode *vnode;    /* vnode of this file */
 
     void *mmap_context;         /* used by mmap routine */
+#ifdef RT_USING_PAGECACHE
+    struct dfs_file_ra ra;      /* readahead state of page cache */
+#endif
 
     void *data;
 };
@@ -144,8 +160,13 @@ struct dfs_mmap2_args
 };
 #endif
 
+/* consumes len bytes of buf, returns the bytes consumed or -errno */
+typedef ssize_t (*dfs_file_actor_t)(void *data, const void *buf, size_t len);
+
 void dfs_file_init(struct dfs_file *file);
 void dfs_file_deinit(struct dfs_file *file);
+void dfs_file_get(struct dfs_file *file);
+void dfs_file_put(struct dfs_file *file);
 
 int dfs_file_open(struct dfs_file *file, const char *path, int flags, mode_t mode);
 int dfs_file_close(struct dfs_file *file);
@@ -156,6 +177,8 @@ ssize_t dfs_file_pread(struct dfs_file *file, void *buf, size_t len, off_t offse
 ssize_t dfs_file_read(struct dfs_file *file, void *buf, size_t len);
 ssize_t dfs_file_pwrite(struct dfs_file *file, const void *buf, size_t len, off_t offset);
 ssize_t dfs_file_write(struct dfs_file *file, const void *buf, size_t len);
+ssize_t dfs_file_splice_read(struct dfs_file *file, size_t len, off_t *offset,
+                             dfs_file_actor_t actor, void *data);
 off_t generic_dfs_lseek(struct dfs_file *file, off_t offset, int whence);
 off_t dfs_file_lseek(struct dfs_file *file, off_t offset, int wherece);
 int dfs_file_stat(const char *path, struct stat *buf);
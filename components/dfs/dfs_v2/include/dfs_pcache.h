@@ -6,6 +6,8 @@
  * Change Logs:
  * Date           Author       Notes
  * 2023-05-05     RTT          Implement dentry in dfs v2.0
+ * 2026-10-17     agent        add dfs_aspace_splice_read
+ * 2026-10-17     agent        add dfs_aspace_mmap_around
  */
 
 #ifndef DFS_PAGE_CACHE_H__
@@ -16,7 +18,7 @@
 #ifdef RT_USING_PAGECACHE
 
 #include <dfs_file.h>
-#include <avl.h>
+#include <radix.h>
 
 #ifdef __cplusplus
 extern "C"
@@ -40,7 +42,6 @@ struct dfs_page
 {
     rt_list_t space_node;
     rt_list_t dirty_node;
-    struct util_avl_struct avl_node;
     rt_list_t mmap_head;
 
     rt_atomic_t ref_count;
@@ -71,8 +72,10 @@ struct dfs_aspace
     rt_list_t list_dirty;
     size_t pages_count;
 
-    struct util_avl_root avl_root;
-    struct dfs_page *avl_page;
+    /* pages indexed by page offset, lookup is lockless */
+    struct util_radix_root page_tree;
+    rt_atomic_t readers;
+    rt_list_t list_zombie;
 
     rt_bool_t is_active;
 
@@ -102,10 +105,13 @@ int dfs_aspace_destroy(struct dfs_aspace *aspace);
 
 int dfs_aspace_read(struct dfs_file *file, void *buf, size_t count, off_t *pos);
 int dfs_aspace_write(struct dfs_file *file, const void *buf, size_t count, off_t *pos);
+ssize_t dfs_aspace_splice_read(struct dfs_file *file, size_t count, off_t *pos,
+                               dfs_file_actor_t actor, void *data);
 int dfs_aspace_flush(struct dfs_aspace *aspace);
 int dfs_aspace_clean(struct dfs_aspace *aspace);
 
 void *dfs_aspace_mmap(struct dfs_file *file, struct rt_varea *varea, void *vaddr);
+int dfs_aspace_mmap_around(struct dfs_file *file, struct rt_varea *varea, void *vaddr);
 int dfs_aspace_unmap(struct dfs_file *file, struct rt_varea *varea);
 int dfs_aspace_page_unmap(struct dfs_file *file, struct rt_varea *varea, void *vaddr);
 int dfs_aspace_page_dirty(struct dfs_file *file, struct rt_varea *varea, void *vaddr);
@@ -256,6 +256,8 @@ void fdt_fd_release(struct dfs_fdtable *fdt, int fd)
 
         if (file)
         {
+            /* the page cache may drop its reference of file at the same time */
+            dfs_file_lock();
             if (file->fd_ref_count)
             {
                 rt_atomic_sub(&(file->fd_ref_count), 1);
@@ -275,6 +277,7 @@ void fdt_fd_release(struct dfs_fdtable *fdt, int fd)
             {
                 rt_atomic_sub(&(file->ref_count), 1);
             }
+            dfs_file_unlock();
         }
 
         fdt->fds[fd] = RT_NULL;
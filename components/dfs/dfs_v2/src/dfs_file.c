@@ -6,6 +6,8 @@
  * Change Logs:
  * Date           Author       Notes
  * 2023-05-05     Bernard      Implement file APIs in dfs v2.0
+ * 2026-10-17     agent        add dfs_file_splice_read
+ * 2026-10-17     agent        add dfs_file_get/dfs_file_put
  */
 
 #include "errno.h"
@@ -206,6 +208,34 @@ void dfs_file_deinit(struct dfs_file *file)
     }
 }
 
+/* hold the file for a user outliving the fd, e.g. an asynchronous request */
+void dfs_file_get(struct dfs_file *file)
+{
+    if (dfs_file_lock() == RT_EOK)
+    {
+        rt_atomic_add(&(file->ref_count), 1);
+        dfs_file_unlock();
+    }
+}
+
+/* release the hold of dfs_file_get(), the last one finishes closing the file */
+void dfs_file_put(struct dfs_file *file)
+{
+    if (dfs_file_lock() == RT_EOK)
+    {
+        if (rt_atomic_load(&(file->ref_count)) == 1)
+        {
+            /* the owner has closed it meanwhile */
+            dfs_file_close(file);
+        }
+        else
+        {
+            rt_atomic_sub(&(file->ref_count), 1);
+        }
+        dfs_file_unlock();
+    }
+}
+
 static void dfs_file_unref(struct dfs_file *file)
 {
     rt_err_t ret = RT_EOK;
@@ -948,6 +978,122 @@ ssize_t dfs_file_write(struct dfs_file *file, const void *buf, size_t len)
     return ret;
 }
 
+#define SPLICE_BOUNCE_SIZE 4096
+
+/* read through a bounce buffer for a file which is not in the page cache */
+static ssize_t _splice_read_bounce(struct dfs_file *file, size_t len, off_t *pos,
+                                   dfs_file_actor_t actor, void *data)
+{
+    ssize_t ret = 0;
+    ssize_t got, done;
+    char *buf;
+
+    buf = rt_malloc(SPLICE_BOUNCE_SIZE);
+    if (!buf)
+    {
+        return -ENOMEM;
+    }
+
+    while (len)
+    {
+        off_t start = *pos;
+
+        got = file->fops->read(file, buf, len > SPLICE_BOUNCE_SIZE ? SPLICE_BOUNCE_SIZE : len, pos);
+        if (got <= 0)
+        {
+            ret = ret ? ret : got;
+            break;
+        }
+
+        done = actor(data, buf, got);
+        if (done < 0)
+        {
+            /* not consumed, keep it in the file if it's seekable */
+            *pos = start;
+            ret = ret ? ret : done;
+            break;
+        }
+
+        *pos = start + done;
+        len -= done;
+        ret += done;
+
+        if (done < got)
+        {
+            break;
+        }
+    }
+
+    rt_free(buf);
+
+    return ret;
+}
+
+/**
+ * Read len bytes of a file into actor, the page cache hands its pages to
+ * actor in place. It reads at *offset and advances it if offset is given,
+ * or at the file position otherwise.
+ */
+ssize_t dfs_file_splice_read(struct dfs_file *file, size_t len, off_t *offset,
+                             dfs_file_actor_t actor, void *data)
+{
+    ssize_t ret = -EBADF;
+
+    if (file)
+    {
+        /* check whether read */
+        if (!(dfs_fflags(file->flags) & DFS_F_FREAD))
+        {
+            ret = -EPERM;
+        }
+        else if (!file->fops || !file->fops->read)
+        {
+            ret = -ENOSYS;
+        }
+        else if (file->vnode && file->vnode->type != FT_DIRECTORY)
+        {
+            /* fpos lock */
+            off_t pos = offset ? *offset : dfs_file_get_fpos(file);
+
+            ret = rw_verify_area(file, &pos, len);
+            if (ret > 0)
+            {
+                len = ret;
+
+                if (dfs_is_mounted(file->vnode->mnt) == 0)
+                {
+#ifdef RT_USING_PAGECACHE
+                    if (file->vnode->aspace && !(file->flags & O_DIRECT))
+                    {
+                        ret = dfs_aspace_splice_read(file, len, &pos, actor, data);
+                    }
+                    else
+#endif
+                    {
+                        ret = _splice_read_bounce(file, len, &pos, actor, data);
+                    }
+                }
+                else
+                {
+                    ret = -EINVAL;
+                }
+            }
+
+            if (offset)
+            {
+                *offset = pos;
+            }
+            else
+            {
+                /* fpos unlock */
+                dfs_file_set_fpos(file, pos);
+            }
+        }
+    }
+
+    return ret;
+}
+
 off_t generic_dfs_lseek(struct dfs_file *file, off_t offset, int whence)
 {
     off_t foffset;
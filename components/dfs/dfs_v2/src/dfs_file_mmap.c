@@ -5,6 +5,7 @@
  *
  * Change Logs:
  * Date           Author       Notes
+ * 2026-10-17     agent        map the cached pages around a read fault
  */
 
 #include "dfs_file.h"
@@ -111,6 +112,11 @@ static void on_page_fault(struct rt_varea *varea, struct rt_aspace_fault_msg *ms
             msg->response.status = MM_FAULT_STATUS_OK_MAPPED;
             msg->response.size = ARCH_PAGE_SIZE;
             msg->response.vaddr = page;
+
+            if (msg->fault_op != MM_FAULT_OP_WRITE)
+            {
+                dfs_aspace_mmap_around(file, varea, msg->fault_vaddr);
+            }
         }
         else
         {
@@ -7,6 +7,12 @@
  * Date           Author       Notes
  * 2023-05-05     RTT          Implement mnt in dfs v2.0
  * 2023-10-23     Shell        fix synchronization of data to icache
+ * 2026-10-17     agent        add adaptive readahead with async prefetch
+ * 2026-10-17     agent        index pages by radix tree with lockless lookup
+ * 2026-10-17     agent        add dfs_aspace_splice_read
+ * 2026-10-17     agent        add fault-around for file mappings
+ * 2026-10-17     agent        drop the page if it can not be indexed
+ * 2026-10-17     agent        hold the readahead file with dfs_file_get
  */
 
 #define DBG_TAG "dfs.pcache"
@@ -37,6 +43,14 @@
 #define RT_PAGECACHE_PRELOAD        4
 #endif
 
+#ifndef RT_PAGECACHE_READAHEAD_MAX
+#define RT_PAGECACHE_READAHEAD_MAX  32
+#endif
+
+#ifndef RT_PAGECACHE_FAULT_AROUND
+#define RT_PAGECACHE_FAULT_AROUND   16
+#endif
+
 #ifndef RT_PAGECACHE_GC_WORK_LEVEL
 #define RT_PAGECACHE_GC_WORK_LEVEL  90
 #endif
@@ -47,6 +61,7 @@
 
 #define PCACHE_MQ_GC    1
 #define PCACHE_MQ_WB    2
+#define PCACHE_MQ_RA    3
 
 struct dfs_aspace_mmap_obj
 {
@@ -61,6 +76,11 @@ struct dfs_pcache_mq_obj
 {
     struct rt_mailbox *ack;
     rt_uint32_t cmd;
+
+    /* readahead window of PCACHE_MQ_RA */
+    struct dfs_file *file;
+    off_t index;
+    size_t count;
 };
 
 static struct dfs_page *dfs_page_lookup(struct dfs_file *file, off_t pos);
@@ -70,7 +90,10 @@ static int dfs_page_remove(struct dfs_page *page);
 static void dfs_page_release(struct dfs_page *page);
 static int dfs_page_dirty(struct dfs_page *page);
 
+static int dfs_page_readahead(struct dfs_file *file, off_t index, size_t count);
+
 static int dfs_aspace_release(struct dfs_aspace *aspace);
+static void dfs_aspace_reap(struct dfs_aspace *aspace, rt_bool_t force);
 
 static int dfs_aspace_lock(struct dfs_aspace *aspace);
 static int dfs_aspace_unlock(struct dfs_aspace *aspace);
@@ -220,6 +243,11 @@ static void dfs_pcache_thread(void *parameter)
             {
                 dfs_pcache_limit_check();
             }
+            else if (work.cmd == PCACHE_MQ_RA)
+            {
+                dfs_page_readahead(work.file, work.index, work.count);
+                dfs_file_put(work.file);
+            }
             else if (work.cmd == PCACHE_MQ_WB)
             {
                 int count = 0;
@@ -459,8 +487,9 @@ static struct dfs_aspace *_dfs_aspace_create(struct dfs_dentry *dentry,
         rt_list_init(&aspace->list_dirty);
         rt_list_insert_after(&aspace->list_active, &aspace->list_inactive);
 
-        aspace->avl_root.root_node = 0;
-        aspace->avl_page = 0;
+        util_radix_init(&aspace->page_tree);
+        rt_atomic_store(&aspace->readers, 0);
+        rt_list_init(&aspace->list_zombie);
 
         rt_mutex_init(&aspace->lock, rt_thread_self()->parent.name, RT_IPC_FLAG_PRIO);
         rt_atomic_store(&aspace->ref_count, 1);
@@ -550,6 +579,8 @@ static int dfs_aspace_release(struct dfs_aspace *aspace)
             {
                 rt_free(aspace->pathname);
             }
+            dfs_aspace_reap(aspace, RT_TRUE);
+            util_radix_destroy(&aspace->page_tree);
             rt_mutex_detach(&aspace->lock);
             rt_free(aspace);
             ret = 0;
@@ -724,16 +755,58 @@ static void dfs_page_ref(struct dfs_page *page)
     rt_atomic_add(&(page->ref_count), 1);
 }
 
-static void dfs_page_release(struct dfs_page *page)
+/* take a reference of a page found by a lockless lookup, unless it's dying */
+static rt_bool_t dfs_page_tryref(struct dfs_page *page)
 {
-    struct dfs_aspace *aspace = page->aspace;
+    rt_atomic_t ref = rt_atomic_load(&(page->ref_count));
 
-    dfs_aspace_lock(aspace);
+    while (ref > 0)
+    {
+        if (rt_atomic_compare_exchange_strong(&(page->ref_count), &ref, ref + 1))
+        {
+            return RT_TRUE;
+        }
+    }
+
+    return RT_FALSE;
+}
+
+/*
+ * Free the dying pages once no lockless lookup is walking the aspace, a
+ * reader may still hold a pointer to a page it has not referenced yet.
+ * The aspace is locked by the caller.
+ */
+static void dfs_aspace_reap(struct dfs_aspace *aspace, rt_bool_t force)
+{
+    struct dfs_page *page;
+
+    if (!force && rt_atomic_load(&(aspace->readers)) != 0)
+    {
+        return;
+    }
+
+    while (!rt_list_isempty(&aspace->list_zombie))
+    {
+        page = rt_list_first_entry(&aspace->list_zombie, struct dfs_page, space_node);
+        rt_list_remove(&page->space_node);
+
+        rt_pages_free(page->page, 0);
+        page->page = RT_NULL;
+        rt_free(page);
+    }
+
+    util_radix_reclaim(&aspace->page_tree);
+}
 
-    rt_atomic_sub(&(page->ref_count), 1);
+static void dfs_page_release(struct dfs_page *page)
+{
+    struct dfs_aspace *aspace = page->aspace;
 
-    if (rt_atomic_load(&(page->ref_count)) == 0)
+    /* only the last one needs the aspace */
+    if (rt_atomic_sub(&(page->ref_count), 1) == 1)
     {
+        dfs_aspace_lock(aspace);
+
         dfs_page_unmap(page);
 
         if (page->is_dirty == 1 && aspace->vnode)
@@ -754,55 +827,34 @@ static void dfs_page_release(struct dfs_page *page)
         }
         RT_ASSERT(page->is_dirty == 0);
 
-        rt_pages_free(page->page, 0);
-        page->page = RT_NULL;
-        rt_free(page);
-    }
-
-    dfs_aspace_unlock(aspace);
-}
+        rt_list_insert_before(&aspace->list_zombie, &page->space_node);
+        dfs_aspace_reap(aspace, RT_FALSE);
 
-static int dfs_page_compare(off_t fpos, off_t value)
-{
-    return fpos / ARCH_PAGE_SIZE * ARCH_PAGE_SIZE - value;
+        dfs_aspace_unlock(aspace);
+    }
 }
 
 static int _dfs_page_insert(struct dfs_aspace *aspace, struct dfs_page *page)
 {
-    struct dfs_page *tmp;
-    struct util_avl_struct *current = NULL;
-    struct util_avl_struct **next = &(aspace->avl_root.root_node);
+    rt_err_t err;
 
-    /* Figure out where to put new node */
-    while (*next)
+    err = util_radix_insert(&aspace->page_tree, page->fpos / ARCH_PAGE_SIZE, page);
+    if (err != RT_EOK)
     {
-        current = *next;
-        tmp = rt_container_of(current, struct dfs_page, avl_node);
-
-        if (page->fpos < tmp->fpos)
-            next = &(current->avl_left);
-        else if (page->fpos > tmp->fpos)
-            next = &(current->avl_right);
-        else
-            return -1;
+        LOG_W("page index alloc failed!");
     }
 
-    /* Add new node and rebalance tree. */
-    util_avl_link(&page->avl_node, current, next);
-    util_avl_rebalance(current, &aspace->avl_root);
-    aspace->avl_page = page;
-
-    return 0;
+    return err;
 }
 
 static void _dfs_page_remove(struct dfs_aspace *aspace, struct dfs_page *page)
 {
-    if (aspace->avl_page && aspace->avl_page == page)
+    unsigned long index = page->fpos / ARCH_PAGE_SIZE;
+
+    if (util_radix_lookup(&aspace->page_tree, index) == page)
     {
-        aspace->avl_page = 0;
+        util_radix_delete(&aspace->page_tree, index);
     }
-
-    util_avl_remove(&page->avl_node, &aspace->avl_root);
 }
 
 static int dfs_aspace_lock(struct dfs_aspace *aspace)
@@ -823,14 +875,16 @@ static int dfs_page_insert(struct dfs_page *page)
 
     dfs_aspace_lock(aspace);
 
-    rt_list_insert_before(&aspace->list_inactive, &page->space_node);
-    aspace->pages_count ++;
-
-    if (_dfs_page_insert(aspace, page))
+    if (_dfs_page_insert(aspace, page) != RT_EOK)
     {
-        RT_ASSERT(0);
+        /* a page can't be looked up must not be cached, caller drops it */
+        dfs_aspace_unlock(aspace);
+        return -ENOMEM;
     }
 
+    rt_list_insert_before(&aspace->list_inactive, &page->space_node);
+    aspace->pages_count ++;
+
     if (aspace->pages_count > RT_PAGECACHE_ASPACE_COUNT)
     {
         rt_list_t *next = aspace->list_active.next;
@@ -939,48 +993,25 @@ static int dfs_page_dirty(struct dfs_page *page)
 
 static struct dfs_page *dfs_page_search(struct dfs_aspace *aspace, off_t fpos)
 {
-    int cmp;
     struct dfs_page *page;
-    struct util_avl_struct *avl_node;
 
-    dfs_aspace_lock(aspace);
-
-    if (aspace->avl_page && dfs_page_compare(fpos, aspace->avl_page->fpos) == 0)
+    /* the readers count keeps a found page from being freed before we ref it */
+    rt_atomic_add(&(aspace->readers), 1);
+    page = util_radix_lookup(&aspace->page_tree, fpos / ARCH_PAGE_SIZE);
+    if (page && !dfs_page_tryref(page))
     {
-        page = aspace->avl_page;
-        dfs_page_active(page);
-        dfs_page_ref(page);
-        dfs_aspace_unlock(aspace);
-        return page;
+        page = RT_NULL;
     }
+    rt_atomic_sub(&(aspace->readers), 1);
 
-    avl_node = aspace->avl_root.root_node;
-    while (avl_node)
+    /* lru is only a hint, don't wait for the aspace for it */
+    if (page && rt_mutex_take(&aspace->lock, 0) == RT_EOK)
     {
-        page = rt_container_of(avl_node, struct dfs_page, avl_node);
-        cmp = dfs_page_compare(fpos, page->fpos);
-
-        if (cmp < 0)
-        {
-            avl_node = avl_node->avl_left;
-        }
-        else if (cmp > 0)
-        {
-            avl_node = avl_node->avl_right;
-        }
-        else
-        {
-            aspace->avl_page = page;
-            dfs_page_active(page);
-            dfs_page_ref(page);
-            dfs_aspace_unlock(aspace);
-            return page;
-        }
+        dfs_page_active(page);
+        dfs_aspace_unlock(aspace);
     }
 
-    dfs_aspace_unlock(aspace);
-
-    return RT_NULL;
+    return page;
 }
 
 static struct dfs_page *dfs_aspace_load_page(struct dfs_file *file, off_t pos)
@@ -1001,13 +1032,31 @@ static struct dfs_page *dfs_aspace_load_page(struct dfs_file *file, off_t pos)
             aspace->ops->read(file, page);
             page->ref_count ++;
 
-            dfs_page_insert(page);
+            if (dfs_page_insert(page) != 0)
+            {
+                /* drop the references of both the cache and the caller */
+                dfs_page_release(page);
+                dfs_page_release(page);
+                page = RT_NULL;
+            }
         }
     }
 
     return page;
 }
 
+static void dfs_pcache_gc_check(void)
+{
+    if (rt_atomic_load(&(__pcache.pages_count)) >= RT_PAGECACHE_COUNT)
+    {
+        dfs_pcache_limit_check();
+    }
+    else if (rt_atomic_load(&(__pcache.pages_count)) >= RT_PAGECACHE_COUNT * RT_PAGECACHE_GC_WORK_LEVEL / 100)
+    {
+        dfs_pcache_mq_work(PCACHE_MQ_GC);
+    }
+}
+
 static struct dfs_page *dfs_page_lookup(struct dfs_file *file, off_t pos)
 {
     struct dfs_page *page = RT_NULL;
@@ -1054,15 +1103,7 @@ static struct dfs_page *dfs_page_lookup(struct dfs_file *file, off_t pos)
         if (page)
         {
             dfs_aspace_unlock(aspace);
-
-            if (rt_atomic_load(&(__pcache.pages_count)) >= RT_PAGECACHE_COUNT)
-            {
-                dfs_pcache_limit_check();
-            }
-            else if (rt_atomic_load(&(__pcache.pages_count)) >= RT_PAGECACHE_COUNT * RT_PAGECACHE_GC_WORK_LEVEL / 100)
-            {
-                dfs_pcache_mq_work(PCACHE_MQ_GC);
-            }
+            dfs_pcache_gc_check();
 
             return page;
         }
@@ -1072,6 +1113,166 @@ static struct dfs_page *dfs_page_lookup(struct dfs_file *file, off_t pos)
     return page;
 }
 
+/* read count pages from index into cache, the aspace is not locked during the io */
+static int dfs_page_readahead(struct dfs_file *file, off_t index, size_t count)
+{
+    int ret = 0;
+    struct dfs_page *page, *tmp;
+    struct dfs_aspace *aspace = file->vnode->aspace;
+
+    for (; count > 0; count--, index++)
+    {
+        off_t fpos = index * ARCH_PAGE_SIZE;
+
+        if (!aspace->vnode || fpos >= aspace->vnode->size)
+        {
+            break;
+        }
+
+        page = dfs_page_search(aspace, fpos);
+        if (page)
+        {
+            dfs_page_release(page);
+            continue;
+        }
+
+        page = dfs_page_create();
+        if (!page)
+        {
+            ret = -ENOMEM;
+            break;
+        }
+
+        page->aspace = aspace;
+        page->size = ARCH_PAGE_SIZE;
+        page->fpos = fpos;
+        if (aspace->ops->read(file, page) < 0)
+        {
+            dfs_page_release(page);
+            ret = -EIO;
+            break;
+        }
+
+        /* someone may have loaded or written this page while we were reading */
+        dfs_aspace_lock(aspace);
+        tmp = dfs_page_search(aspace, fpos);
+        if (tmp)
+        {
+            dfs_page_release(tmp);
+            dfs_page_release(page);
+        }
+        else if (dfs_page_insert(page) != 0)
+        {
+            dfs_page_release(page);
+            dfs_aspace_unlock(aspace);
+            ret = -ENOMEM;
+            break;
+        }
+        dfs_aspace_unlock(aspace);
+        ret ++;
+    }
+
+    if (ret > 0)
+    {
+        dfs_pcache_gc_check();
+    }
+
+    return ret;
+}
+
+static void dfs_page_readahead_async(struct dfs_file *file, off_t index, size_t count)
+{
+    struct dfs_pcache_mq_obj work = { 0 };
+
+    work.cmd = PCACHE_MQ_RA;
+    work.file = file;
+    work.index = index;
+    work.count = count;
+
+    /* the file is held until the pcache thread has done with it */
+    dfs_file_get(file);
+    if (rt_mq_send_wait(__pcache.mqueue, (const void *)&work, sizeof(struct dfs_pcache_mq_obj), 0) != RT_EOK)
+    {
+        dfs_file_put(file);
+    }
+}
+
+static size_t dfs_page_ra_next_size(size_t size)
+{
+    size = size < RT_PAGECACHE_READAHEAD_MAX / 16 ? size * 4 : size * 2;
+
+    return size > RT_PAGECACHE_READAHEAD_MAX ? RT_PAGECACHE_READAHEAD_MAX : size;
+}
+
+/*
+ * Look up a page for reading and drive the readahead window of the file.
+ *
+ * A sequential stream reads the head of a window synchronously and the tail
+ * of it by the pcache thread. When the reader hits the first page of the
+ * tail, the next window is issued asynchronously with a bigger size, so a
+ * streaming reader keeps one window ahead of it. A random access only loads
+ * the page asked for and collapses the window.
+ */
+static struct dfs_page *dfs_page_lookup_ra(struct dfs_file *file, off_t pos)
+{
+    struct dfs_page *page;
+    struct dfs_file_ra *ra = &file->ra;
+    struct dfs_aspace *aspace = file->vnode->aspace;
+    off_t index = pos / ARCH_PAGE_SIZE;
+
+    page = dfs_page_search(aspace, pos);
+    if (page)
+    {
+        if (ra->async_size && index == ra->start + (off_t)(ra->size - ra->async_size))
+        {
+            ra->start += ra->size;
+            ra->size = dfs_page_ra_next_size(ra->size);
+            ra->async_size = ra->size;
+            dfs_page_readahead_async(file, ra->start, ra->size);
+        }
+        ra->prev_index = index;
+
+        return page;
+    }
+
+    if (ra->size && index >= ra->start && index < ra->start + (off_t)ra->size)
+    {
+        /* the window is still in flight, only wait for this page */
+        dfs_page_readahead(file, index, 1);
+    }
+    else if (index == ra->prev_index || index == ra->prev_index + 1 ||
+             (ra->size && index == ra->start + (off_t)ra->size))
+    {
+        ra->start = index;
+        ra->size = ra->size ? dfs_page_ra_next_size(ra->size) : RT_PAGECACHE_PRELOAD;
+        ra->async_size = ra->size / 2;
+
+        dfs_page_readahead(file, index, ra->size - ra->async_size);
+        if (ra->async_size)
+        {
+            dfs_page_readahead_async(file, ra->start + ra->size - ra->async_size, ra->async_size);
+        }
+    }
+    else
+    {
+        ra->start = index;
+        ra->size = 0;
+        ra->async_size = 0;
+
+        dfs_page_readahead(file, index, 1);
+    }
+    ra->prev_index = index;
+
+    page = dfs_page_search(aspace, pos);
+    if (!page && aspace->vnode && pos < aspace->vnode->size)
+    {
+        /* reclaimed before we got it, read it as before */
+        page = dfs_page_lookup(file, pos);
+    }
+
+    return page;
+}
+
 int dfs_aspace_read(struct dfs_file *file, void *buf, size_t count, off_t *pos)
 {
     int ret = -EINVAL;
@@ -1090,12 +1291,12 @@ int dfs_aspace_read(struct dfs_file *file, void *buf, size_t count, off_t *pos)
 
         while (count)
         {
-            page = dfs_page_lookup(file, *pos);
+            page = dfs_page_lookup_ra(file, *pos);
             if (page)
             {
                 off_t len;
 
-                dfs_aspace_lock(aspace);
+                /* the page is referenced, copy it out without the aspace lock */
                 if (aspace->vnode->size < page->fpos + ARCH_PAGE_SIZE)
                 {
                     len = aspace->vnode->size - *pos;
@@ -1117,11 +1318,9 @@ int dfs_aspace_read(struct dfs_file *file, void *buf, size_t count, off_t *pos)
                 else
                 {
                     dfs_page_release(page);
-                    dfs_aspace_unlock(aspace);
                     break;
                 }
                 dfs_page_release(page);
-                dfs_aspace_unlock(aspace);
             }
             else
             {
@@ -1133,6 +1332,74 @@ int dfs_aspace_read(struct dfs_file *file, void *buf, size_t count, off_t *pos)
     return ret;
 }
 
+/*
+ * Hand the cached pages of [*pos, *pos + count) to actor without copying
+ * them out. The page is referenced while actor works on it, so it must not
+ * be kept after actor returns. Stops at the end of file or on the first
+ * short or failed actor, *pos is advanced by the bytes consumed.
+ */
+ssize_t dfs_aspace_splice_read(struct dfs_file *file, size_t count, off_t *pos,
+                               dfs_file_actor_t actor, void *data)
+{
+    ssize_t ret = -EINVAL;
+
+    if (file && file->vnode && file->vnode->aspace && file->vnode->aspace->ops->read)
+    {
+        struct dfs_aspace *aspace = file->vnode->aspace;
+        struct dfs_page *page;
+        ssize_t done;
+
+        ret = 0;
+
+        while (count)
+        {
+            off_t len;
+
+            page = dfs_page_lookup_ra(file, *pos);
+            if (!page)
+            {
+                break;
+            }
+
+            if (aspace->vnode->size < page->fpos + ARCH_PAGE_SIZE)
+            {
+                len = aspace->vnode->size - *pos;
+            }
+            else
+            {
+                len = page->fpos + ARCH_PAGE_SIZE - *pos;
+            }
+
+            len = count > len ? len : count;
+            if (len <= 0)
+            {
+                dfs_page_release(page);
+                break;
+            }
+
+            done = actor(data, (char *)page->page + *pos - page->fpos, len);
+            dfs_page_release(page);
+
+            if (done < 0)
+            {
+                ret = ret ? ret : done;
+                break;
+            }
+
+            *pos += done;
+            count -= done;
+            ret += done;
+
+            if (done < len)
+            {
+                break;
+            }
+        }
+    }
+
+    return ret;
+}
+
 int dfs_aspace_write(struct dfs_file *file, const void *buf, size_t count, off_t *pos)
 {
     int ret = -EINVAL;
@@ -1280,7 +1547,8 @@ void *dfs_aspace_mmap(struct dfs_file *file, struct rt_varea *varea, void *vaddr
     struct dfs_aspace *aspace = file->vnode->aspace;
     rt_aspace_t target_aspace = varea->aspace;
 
-    page = dfs_page_lookup(file, dfs_aspace_fpos(varea, vaddr));
+    /* read ahead on faults as well, so the fault-around finds the neighbours */
+    page = dfs_page_lookup_ra(file, dfs_aspace_fpos(varea, vaddr));
     if (page)
     {
         struct dfs_mmap *map = (struct dfs_mmap *)rt_calloc(1, sizeof(struct dfs_mmap));
@@ -1330,6 +1598,91 @@ void *dfs_aspace_mmap(struct dfs_file *file, struct rt_varea *varea, void *vaddr
     return ret;
 }
 
+/*
+ * Map the pages around a fault which are already in the page cache, so a scan
+ * over a file mapping takes a fault per window instead of one per page. No
+ * page is read here, the ones missing in the cache are left to later faults.
+ *
+ * A page mapped into a shared mapping is marked dirty when it's unmapped, so
+ * only private or read-only mappings are populated ahead of the access.
+ */
+int dfs_aspace_mmap_around(struct dfs_file *file, struct rt_varea *varea, void *vaddr)
+{
+    int count = 0;
+    char *start, *end, *iter;
+    off_t fpos;
+    struct dfs_page *page;
+    struct dfs_mmap *map;
+    struct dfs_aspace *aspace = file->vnode->aspace;
+    rt_size_t window = RT_PAGECACHE_FAULT_AROUND * ARCH_PAGE_SIZE;
+
+    if (!aspace || window <= ARCH_PAGE_SIZE ||
+        (!rt_varea_is_private_locked(varea) && VAREA_IS_WRITABLE(varea)))
+    {
+        return 0;
+    }
+
+    vaddr = (void *)RT_ALIGN_DOWN((rt_ubase_t)vaddr, ARCH_PAGE_SIZE);
+    start = (char *)vaddr - ((rt_ubase_t)vaddr % window);
+    end = start + window;
+    if (start < (char *)varea->start)
+    {
+        start = varea->start;
+    }
+    if (end > (char *)varea->start + varea->size)
+    {
+        end = (char *)varea->start + varea->size;
+    }
+
+    dfs_aspace_lock(aspace);
+    for (iter = start; iter < end; iter += ARCH_PAGE_SIZE)
+    {
+        fpos = dfs_aspace_fpos(varea, iter);
+        if (!aspace->vnode || fpos >= aspace->vnode->size)
+        {
+            break;
+        }
+
+        if (iter == (char *)vaddr || rt_hw_mmu_v2p(varea->aspace, iter) != ARCH_MAP_FAILED)
+        {
+            continue;
+        }
+
+        page = dfs_page_search(aspace, fpos);
+        if (!page)
+        {
+            continue;
+        }
+
+        map = (struct dfs_mmap *)rt_calloc(1, sizeof(struct dfs_mmap));
+        if (!map)
+        {
+            dfs_page_release(page);
+            break;
+        }
+
+        if (rt_varea_map_range(varea, iter, rt_kmem_v2p(page->page), ARCH_PAGE_SIZE) == RT_EOK)
+        {
+            /* same synchronization as dfs_aspace_mmap() */
+            rt_hw_cpu_dcache_ops(RT_HW_CACHE_FLUSH, iter, ARCH_PAGE_SIZE);
+            rt_hw_cpu_icache_ops(RT_HW_CACHE_INVALIDATE, iter, ARCH_PAGE_SIZE);
+
+            map->aspace = varea->aspace;
+            map->vaddr = iter;
+            rt_list_insert_after(&page->mmap_head, &map->mmap_node);
+            count++;
+        }
+        else
+        {
+            rt_free(map);
+        }
+        dfs_page_release(page);
+    }
+    dfs_aspace_unlock(aspace);
+
+    return count;
+}
+
 int dfs_aspace_unmap(struct dfs_file *file, struct rt_varea *varea)
 {
     struct dfs_vnode *vnode = file->vnode;
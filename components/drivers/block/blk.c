@@ -6,6 +6,9 @@
  * Change Logs:
  * Date           Author       Notes
  * 2023-02-25     GuEe-GUI     the first version
+ * 2026-10-17     agent        route the disks with batch submit to the request layer
+ * 2026-10-17     agent        put the sector buffer cache in front of the disk
+ * 2026-10-17     agent        refuse to unregister a disk with queued requests
  */
 
 #define DBG_TAG "rtdm.blk"
@@ -99,6 +102,29 @@ static rt_ssize_t blk_parallel_write(rt_device_t dev, rt_off_t sector,
     return -RT_ENOSYS;
 }
 
+#ifdef RT_BLK_USING_MQ
+static rt_ssize_t blk_mq_read(rt_device_t dev, rt_off_t sector,
+        void *buffer, rt_size_t sector_count)
+{
+    struct rt_blk_disk *disk = to_blk_disk(dev);
+
+    return blk_mq_rw(disk, RT_BLK_REQ_READ, sector, buffer, sector_count);
+}
+
+static rt_ssize_t blk_mq_write(rt_device_t dev, rt_off_t sector,
+        const void *buffer, rt_size_t sector_count)
+{
+    struct rt_blk_disk *disk = to_blk_disk(dev);
+
+    if (!disk->read_only)
+    {
+        return blk_mq_rw(disk, RT_BLK_REQ_WRITE, sector, (void *)buffer, sector_count);
+    }
+
+    return -RT_ENOSYS;
+}
+#endif /* RT_BLK_USING_MQ */
+
 static rt_err_t blk_control(rt_device_t dev, int cmd, void *args)
 {
     rt_err_t err;
@@ -119,6 +145,14 @@ static rt_err_t blk_control(rt_device_t dev, int cmd, void *args)
         break;
 
     case RT_DEVICE_CTRL_BLK_SYNC:
+    #ifdef RT_BLK_USING_CACHE
+        /* Barrier, the dirty sectors reach the disk before its cache flush */
+        if ((err = blk_cache_flush(disk)))
+        {
+            break;
+        }
+    #endif
+
         if (disk->ops->sync)
         {
             rt_sem_take(&disk->usr_lock, RT_WAITING_FOREVER);
@@ -152,6 +186,10 @@ static rt_err_t blk_control(rt_device_t dev, int cmd, void *args)
 
             blk_remove_all(disk);
 
+        #ifdef RT_BLK_USING_CACHE
+            blk_cache_invalidate(disk);
+        #endif
+
             err = disk->ops->erase(disk);
 
         _unlock:
@@ -223,6 +261,28 @@ const static struct rt_device_ops blk_parallel_ops =
     .write = blk_parallel_write,
     .control = blk_control,
 };
+
+#ifdef RT_BLK_USING_MQ
+const static struct rt_device_ops blk_mq_ops =
+{
+    .open = blk_open,
+    .close = blk_close,
+    .read = blk_mq_read,
+    .write = blk_mq_write,
+    .control = blk_control,
+};
+#endif /* RT_BLK_USING_MQ */
+
+#ifdef RT_BLK_USING_CACHE
+const static struct rt_device_ops blk_cache_ops =
+{
+    .open = blk_open,
+    .close = blk_close,
+    .read = blk_cache_read,
+    .write = blk_cache_write,
+    .control = blk_control,
+};
+#endif /* RT_BLK_USING_CACHE */
 #endif /* RT_USING_DEVICE_OPS */
 
 rt_err_t rt_hw_blk_disk_register(struct rt_blk_disk *disk)
@@ -281,8 +341,29 @@ rt_err_t rt_hw_blk_disk_register(struct rt_blk_disk *disk)
     rt_list_init(&disk->part_nodes);
     rt_spin_lock_init(&disk->lock);
 
+#ifdef RT_BLK_USING_MQ
+    if ((err = blk_mq_init(disk)))
+    {
+        rt_sem_detach(&disk->usr_lock);
+    #ifdef RT_USING_DM
+        rt_dm_ida_free(disk->ida, device_id);
+    #endif
+
+        LOG_E("%s: Init request queue error = %s", disk_name, rt_strerror(err));
+
+        return err;
+    }
+#endif
+
     disk->parent.type = RT_Device_Class_Block;
 #ifdef RT_USING_DEVICE_OPS
+#ifdef RT_BLK_USING_MQ
+    if (disk->ops->submit)
+    {
+        disk->parent.ops = &blk_mq_ops;
+    }
+    else
+#endif
     if (disk->parallel_io)
     {
         disk->parent.ops = &blk_parallel_ops;
@@ -295,6 +376,14 @@ rt_err_t rt_hw_blk_disk_register(struct rt_blk_disk *disk)
     disk->parent.open = blk_open;
     disk->parent.close = blk_close;
 
+#ifdef RT_BLK_USING_MQ
+    if (disk->ops->submit)
+    {
+        disk->parent.read = blk_mq_read;
+        disk->parent.write = blk_mq_write;
+    }
+    else
+#endif
     if (disk->parallel_io)
     {
         disk->parent.read = blk_parallel_read;
@@ -318,6 +407,22 @@ rt_err_t rt_hw_blk_disk_register(struct rt_blk_disk *disk)
         flags |= RT_DEVICE_FLAG_WRONLY;
     }
 
+#ifdef RT_BLK_USING_CACHE
+    /* The cache misses go to the read and write chosen above */
+#ifdef RT_USING_DEVICE_OPS
+    if (!blk_cache_init(disk, disk->parent.ops->read, disk->parent.ops->write))
+    {
+        disk->parent.ops = &blk_cache_ops;
+    }
+#else
+    if (!blk_cache_init(disk, disk->parent.read, disk->parent.write))
+    {
+        disk->parent.read = blk_cache_read;
+        disk->parent.write = blk_cache_write;
+    }
+#endif
+#endif /* RT_BLK_USING_CACHE */
+
 #ifdef RT_USING_DM
     disk->parent.master_id = disk->ida->master_id;
     disk->parent.device_id = device_id;
@@ -328,6 +433,12 @@ rt_err_t rt_hw_blk_disk_register(struct rt_blk_disk *disk)
 
     if (err)
     {
+    #ifdef RT_BLK_USING_CACHE
+        blk_cache_fini(disk);
+    #endif
+    #ifdef RT_BLK_USING_MQ
+        blk_mq_fini(disk);
+    #endif
         rt_sem_detach(&disk->usr_lock);
     }
 
@@ -346,6 +457,16 @@ rt_err_t rt_hw_blk_disk_unregister(struct rt_blk_disk *disk)
         return -RT_EINVAL;
     }
 
+#ifdef RT_BLK_USING_CACHE
+    /* Write back may sleep, do it before the lock */
+    if ((err = blk_cache_flush(disk)))
+    {
+        LOG_E("%s: Write back error = %s", to_disk_name(disk), rt_strerror(err));
+
+        return err;
+    }
+#endif
+
     spin_lock(&disk->lock);
 
     if (disk->parent.ref_count > 0)
@@ -367,6 +488,16 @@ rt_err_t rt_hw_blk_disk_unregister(struct rt_blk_disk *disk)
         }
     }
 
+#ifdef RT_BLK_USING_MQ
+    /* Nothing is torn down yet if requests are still queued */
+    if ((err = blk_mq_fini(disk)))
+    {
+        LOG_E("%s: Requests are still queued", to_disk_name(disk));
+
+        goto _unlock;
+    }
+#endif
+
     rt_sem_detach(&disk->usr_lock);
 
     blk_remove_all(disk);
@@ -380,6 +511,13 @@ rt_err_t rt_hw_blk_disk_unregister(struct rt_blk_disk *disk)
 _unlock:
     spin_unlock(&disk->lock);
 
+#ifdef RT_BLK_USING_CACHE
+    if (!err)
+    {
+        blk_cache_fini(disk);
+    }
+#endif
+
     return err;
 }
 
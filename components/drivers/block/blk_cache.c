@@ -0,0 +1,777 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ * 2026-10-17     agent        hold the lock over the bypass read, add direct I/O
+ */
+
+#define DBG_TAG "rtdm.blk.cache"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+#include "blk_dev.h"
+
+/*
+ * A write-back cache of single sectors sits in front of the read and write
+ * of the disk device, so that every filesystem and partition on it shares
+ * the cached metadata (FAT, directory and inode sectors). The requests
+ * larger than RT_BLK_CACHE_BYPASS_SECTORS are bulk data, they go straight to
+ * the disk and only stay coherent with the cached sectors, so do all the
+ * O_DIRECT requests.
+ *
+ * Dirty sectors are kept sorted, and written back in runs of the adjacent
+ * sectors when the flush work expires, on RT_DEVICE_CTRL_BLK_SYNC and when
+ * there is no clean sector left to evict.
+ */
+
+/* Max sectors of a coalesced write back */
+#define BLK_CACHE_RUN_MAX   16
+#define BLK_CACHE_WB_STACK_SIZE 4096
+
+struct blk_cache_line
+{
+    rt_list_t hash_node;
+    /* Node in the LRU list, or in the free list */
+    rt_list_t lru_node;
+    rt_list_t dirty_node;
+
+    rt_off_t sector;
+    rt_bool_t dirty;
+    rt_uint8_t *data;
+};
+
+struct rt_blk_cache
+{
+    struct rt_blk_disk *disk;
+
+    rt_ssize_t (*read)(rt_device_t dev, rt_off_t sector,
+            void *buffer, rt_size_t sector_count);
+    rt_ssize_t (*write)(rt_device_t dev, rt_off_t sector,
+            const void *buffer, rt_size_t sector_count);
+
+    struct rt_mutex lock;
+
+    rt_size_t sector_size;
+    rt_uint32_t nr_lines;
+    rt_uint32_t nr_valid;
+    rt_uint32_t nr_dirty;
+
+    rt_uint32_t hash_mask;
+    rt_list_t *hash;
+    /* The most recently used is at the head */
+    rt_list_t lru;
+    rt_list_t free;
+    /* Sorted by sector */
+    rt_list_t dirty;
+
+    rt_bool_t flush_armed;
+    struct rt_work flush_work;
+
+    struct blk_cache_line *lines;
+    rt_uint8_t *data;
+    rt_uint8_t *bounce;
+
+    rt_uint64_t hits;
+    rt_uint64_t misses;
+    rt_uint64_t bypass;
+    rt_uint64_t writebacks;
+    rt_uint64_t writeback_sectors;
+};
+
+/*
+ * Not the system workqueue, the request layer may need it to make progress
+ * while the write back is waiting for the disk.
+ */
+static struct rt_workqueue *blk_cache_wq;
+static RT_DEFINE_SPINLOCK(blk_cache_wq_lock);
+
+rt_inline rt_list_t *blk_cache_bucket(struct rt_blk_cache *cache, rt_off_t sector)
+{
+    return &cache->hash[(sector ^ (sector >> 8)) & cache->hash_mask];
+}
+
+static struct blk_cache_line *blk_cache_lookup(struct rt_blk_cache *cache,
+        rt_off_t sector)
+{
+    struct blk_cache_line *line;
+    rt_list_t *bucket = blk_cache_bucket(cache, sector);
+
+    rt_list_for_each_entry(line, bucket, hash_node)
+    {
+        if (line->sector == sector)
+        {
+            return line;
+        }
+    }
+
+    return RT_NULL;
+}
+
+static void blk_cache_touch(struct rt_blk_cache *cache, struct blk_cache_line *line)
+{
+    rt_list_remove(&line->lru_node);
+    rt_list_insert_after(&cache->lru, &line->lru_node);
+}
+
+static void blk_cache_drop(struct rt_blk_cache *cache, struct blk_cache_line *line)
+{
+    if (line->dirty)
+    {
+        rt_list_remove(&line->dirty_node);
+        line->dirty = RT_FALSE;
+        --cache->nr_dirty;
+    }
+
+    rt_list_remove(&line->hash_node);
+    rt_list_remove(&line->lru_node);
+    rt_list_insert_after(&cache->free, &line->lru_node);
+    --cache->nr_valid;
+}
+
+static void blk_cache_mark_dirty(struct rt_blk_cache *cache, struct blk_cache_line *line)
+{
+    rt_list_t *pos;
+
+    if (line->dirty)
+    {
+        return;
+    }
+
+    /* Writes are mostly ascending, search the position from the tail */
+    for (pos = cache->dirty.prev; pos != &cache->dirty; pos = pos->prev)
+    {
+        if (rt_list_entry(pos, struct blk_cache_line, dirty_node)->sector < line->sector)
+        {
+            break;
+        }
+    }
+
+    rt_list_insert_after(pos, &line->dirty_node);
+    line->dirty = RT_TRUE;
+
+    if (!cache->nr_dirty++ && !cache->flush_armed)
+    {
+        cache->flush_armed = RT_TRUE;
+        rt_workqueue_submit_work(blk_cache_wq, &cache->flush_work,
+                rt_tick_from_millisecond(RT_BLK_CACHE_FLUSH_MS));
+    }
+}
+
+/* Write back all dirty sectors, the cache lock MUST be held */
+static rt_err_t blk_cache_writeback(struct rt_blk_cache *cache)
+{
+    rt_ssize_t res;
+    rt_size_t count;
+    const void *buffer;
+    struct blk_cache_line *first, *last, *next;
+    rt_list_t *node = cache->dirty.next;
+
+    while (node != &cache->dirty)
+    {
+        first = last = rt_list_entry(node, struct blk_cache_line, dirty_node);
+        count = 1;
+
+        while (last->dirty_node.next != &cache->dirty && count < BLK_CACHE_RUN_MAX)
+        {
+            next = rt_list_entry(last->dirty_node.next, struct blk_cache_line, dirty_node);
+
+            if (next->sector != last->sector + 1)
+            {
+                break;
+            }
+
+            rt_memcpy(cache->bounce + count * cache->sector_size,
+                    next->data, cache->sector_size);
+            last = next;
+            ++count;
+        }
+
+        if (count > 1)
+        {
+            rt_memcpy(cache->bounce, first->data, cache->sector_size);
+            buffer = cache->bounce;
+        }
+        else
+        {
+            buffer = first->data;
+        }
+
+        res = cache->write(&cache->disk->parent, first->sector, buffer, count);
+
+        if (res != count)
+        {
+            LOG_E("%s: Write back %u sectors at %u error = %s",
+                    to_disk_name(cache->disk), count, (rt_uint32_t)first->sector,
+                    rt_strerror(res < 0 ? res : -RT_EIO));
+
+            return res < 0 ? res : -RT_EIO;
+        }
+
+        node = last->dirty_node.next;
+
+        for (rt_size_t i = 0; i < count; ++i, first = next)
+        {
+            next = rt_list_entry(first->dirty_node.next, struct blk_cache_line, dirty_node);
+
+            rt_list_remove(&first->dirty_node);
+            first->dirty = RT_FALSE;
+        }
+
+        cache->nr_dirty -= count;
+        ++cache->writebacks;
+        cache->writeback_sectors += count;
+    }
+
+    return RT_EOK;
+}
+
+/* Take a line for `sector`, evict the least recently used clean one if full */
+static struct blk_cache_line *blk_cache_alloc(struct rt_blk_cache *cache,
+        rt_off_t sector)
+{
+    rt_list_t *node;
+    struct blk_cache_line *line = RT_NULL;
+
+    if (!rt_list_isempty(&cache->free))
+    {
+        line = rt_list_first_entry(&cache->free, struct blk_cache_line, lru_node);
+    }
+    else
+    {
+        for (node = cache->lru.prev; node != &cache->lru; node = node->prev)
+        {
+            if (!rt_list_entry(node, struct blk_cache_line, lru_node)->dirty)
+            {
+                line = rt_list_entry(node, struct blk_cache_line, lru_node);
+                break;
+            }
+        }
+
+        if (!line)
+        {
+            if (blk_cache_writeback(cache))
+            {
+                return RT_NULL;
+            }
+
+            line = rt_list_entry(cache->lru.prev, struct blk_cache_line, lru_node);
+        }
+
+        blk_cache_drop(cache, line);
+    }
+
+    rt_list_remove(&line->lru_node);
+
+    line->sector = sector;
+    rt_list_insert_after(blk_cache_bucket(cache, sector), &line->hash_node);
+    rt_list_insert_after(&cache->lru, &line->lru_node);
+    ++cache->nr_valid;
+
+    return line;
+}
+
+static void blk_cache_flush_work(struct rt_work *work, void *work_data)
+{
+    struct rt_blk_cache *cache = work_data;
+
+    rt_mutex_take(&cache->lock, RT_WAITING_FOREVER);
+
+    blk_cache_writeback(cache);
+
+    /* Retry later if write back fail */
+    if (cache->nr_dirty)
+    {
+        rt_workqueue_submit_work(blk_cache_wq, &cache->flush_work,
+                rt_tick_from_millisecond(RT_BLK_CACHE_FLUSH_MS));
+    }
+    else
+    {
+        cache->flush_armed = RT_FALSE;
+    }
+
+    rt_mutex_release(&cache->lock);
+}
+
+static rt_ssize_t blk_cache_read_bypass(struct rt_blk_cache *cache, rt_off_t sector,
+        void *buffer, rt_size_t sector_count)
+{
+    rt_ssize_t res;
+    struct blk_cache_line *line;
+
+    /*
+     * A write back in the middle of the read may clean the sectors that are
+     * newer than the ones read, the lock keeps the dirty list stable.
+     */
+    rt_mutex_take(&cache->lock, RT_WAITING_FOREVER);
+
+    ++cache->bypass;
+
+    res = cache->read(&cache->disk->parent, sector, buffer, sector_count);
+
+    if (res <= 0)
+    {
+        rt_mutex_release(&cache->lock);
+
+        return res;
+    }
+
+    /* The dirty sectors are newer than the disk */
+    rt_list_for_each_entry(line, &cache->dirty, dirty_node)
+    {
+        if (line->sector >= sector + res)
+        {
+            break;
+        }
+
+        if (line->sector >= sector)
+        {
+            rt_memcpy((rt_uint8_t *)buffer + (line->sector - sector) * cache->sector_size,
+                    line->data, cache->sector_size);
+        }
+    }
+
+    rt_mutex_release(&cache->lock);
+
+    return res;
+}
+
+static rt_ssize_t blk_cache_write_bypass(struct rt_blk_cache *cache, rt_off_t sector,
+        const void *buffer, rt_size_t sector_count)
+{
+    rt_ssize_t res;
+    struct blk_cache_line *line;
+
+    rt_mutex_take(&cache->lock, RT_WAITING_FOREVER);
+
+    ++cache->bypass;
+
+    /* Drop the old sectors, the lock keeps the misses from refilling them */
+    for (rt_size_t i = 0; i < sector_count && cache->nr_valid; ++i)
+    {
+        if ((line = blk_cache_lookup(cache, sector + i)))
+        {
+            blk_cache_drop(cache, line);
+        }
+    }
+
+    res = cache->write(&cache->disk->parent, sector, buffer, sector_count);
+
+    rt_mutex_release(&cache->lock);
+
+    return res;
+}
+
+rt_ssize_t blk_cache_read(rt_device_t dev, rt_off_t sector,
+        void *buffer, rt_size_t sector_count)
+{
+    rt_ssize_t res = 0;
+    rt_size_t i = 0, miss;
+    rt_uint8_t *ptr = buffer;
+    struct blk_cache_line *line;
+    struct rt_blk_cache *cache = to_blk_disk(dev)->cache;
+
+    if (sector_count > RT_BLK_CACHE_BYPASS_SECTORS)
+    {
+        return blk_cache_read_bypass(cache, sector, buffer, sector_count);
+    }
+
+    rt_mutex_take(&cache->lock, RT_WAITING_FOREVER);
+
+    while (i < sector_count)
+    {
+        if ((line = blk_cache_lookup(cache, sector + i)))
+        {
+            rt_memcpy(ptr + i * cache->sector_size, line->data, cache->sector_size);
+            blk_cache_touch(cache, line);
+
+            ++cache->hits;
+            ++i;
+            continue;
+        }
+
+        /* Read the adjacent missing sectors at once */
+        for (miss = 1; i + miss < sector_count; ++miss)
+        {
+            if (blk_cache_lookup(cache, sector + i + miss))
+            {
+                break;
+            }
+        }
+
+        res = cache->read(dev, sector + i, ptr + i * cache->sector_size, miss);
+
+        if (res <= 0)
+        {
+            sector_count = i;
+            break;
+        }
+
+        cache->misses += res;
+
+        for (rt_size_t end = i + res; i < end; ++i)
+        {
+            if ((line = blk_cache_alloc(cache, sector + i)))
+            {
+                rt_memcpy(line->data, ptr + i * cache->sector_size, cache->sector_size);
+            }
+        }
+
+        if (res != miss)
+        {
+            sector_count = i;
+            break;
+        }
+    }
+
+    rt_mutex_release(&cache->lock);
+
+    return sector_count ? : res;
+}
+
+rt_ssize_t blk_cache_write(rt_device_t dev, rt_off_t sector,
+        const void *buffer, rt_size_t sector_count)
+{
+    rt_ssize_t res = 0;
+    const rt_uint8_t *ptr = buffer;
+    struct blk_cache_line *line;
+    struct rt_blk_disk *disk = to_blk_disk(dev);
+    struct rt_blk_cache *cache = disk->cache;
+
+    if (disk->read_only)
+    {
+        return -RT_ENOSYS;
+    }
+
+    if (sector_count > RT_BLK_CACHE_BYPASS_SECTORS)
+    {
+        return blk_cache_write_bypass(cache, sector, buffer, sector_count);
+    }
+
+    rt_mutex_take(&cache->lock, RT_WAITING_FOREVER);
+
+    for (rt_size_t i = 0; i < sector_count; ++i, ptr += cache->sector_size)
+    {
+        if (!(line = blk_cache_lookup(cache, sector + i)))
+        {
+            /* The whole sector is overwritten, no need to read it */
+            if (!(line = blk_cache_alloc(cache, sector + i)))
+            {
+                /* Unable to write back for a clean line, write through */
+                if ((res = cache->write(dev, sector + i, ptr, 1)) != 1)
+                {
+                    res = res < 0 ? res : -RT_EIO;
+                    sector_count = i;
+                    break;
+                }
+
+                continue;
+            }
+
+            ++cache->misses;
+        }
+        else
+        {
+            blk_cache_touch(cache, line);
+
+            ++cache->hits;
+        }
+
+        rt_memcpy(line->data, ptr, cache->sector_size);
+        blk_cache_mark_dirty(cache, line);
+    }
+
+    rt_mutex_release(&cache->lock);
+
+    return sector_count ? : res;
+}
+
+/* O_DIRECT never fills the cache, whatever the size of the request is */
+rt_ssize_t blk_cache_direct_rw(struct rt_blk_disk *disk, rt_bool_t write,
+        rt_off_t sector, void *buffer, rt_size_t sector_count)
+{
+    struct rt_blk_cache *cache = disk->cache;
+
+    if (!cache)
+    {
+        return write ? rt_device_write(&disk->parent, sector, buffer, sector_count) :
+                rt_device_read(&disk->parent, sector, buffer, sector_count);
+    }
+
+    if (write)
+    {
+        if (disk->read_only)
+        {
+            return -RT_ENOSYS;
+        }
+
+        return blk_cache_write_bypass(cache, sector, buffer, sector_count);
+    }
+
+    return blk_cache_read_bypass(cache, sector, buffer, sector_count);
+}
+
+rt_err_t blk_cache_flush(struct rt_blk_disk *disk)
+{
+    rt_err_t err;
+    struct rt_blk_cache *cache = disk->cache;
+
+    if (!cache)
+    {
+        return RT_EOK;
+    }
+
+    rt_mutex_take(&cache->lock, RT_WAITING_FOREVER);
+
+    err = blk_cache_writeback(cache);
+
+    rt_mutex_release(&cache->lock);
+
+    return err;
+}
+
+void blk_cache_invalidate(struct rt_blk_disk *disk)
+{
+    struct blk_cache_line *line, *line_next;
+    struct rt_blk_cache *cache = disk->cache;
+
+    if (!cache)
+    {
+        return;
+    }
+
+    rt_mutex_take(&cache->lock, RT_WAITING_FOREVER);
+
+    rt_list_for_each_entry_safe(line, line_next, &cache->lru, lru_node)
+    {
+        blk_cache_drop(cache, line);
+    }
+
+    rt_mutex_release(&cache->lock);
+}
+
+rt_err_t blk_cache_init(struct rt_blk_disk *disk,
+        rt_ssize_t (*read)(rt_device_t, rt_off_t, void *, rt_size_t),
+        rt_ssize_t (*write)(rt_device_t, rt_off_t, const void *, rt_size_t))
+{
+    rt_err_t err;
+    rt_uint32_t buckets;
+    struct rt_blk_cache *cache;
+    struct rt_device_blk_geometry geometry;
+
+    if (disk->cache_sectors < 0)
+    {
+        return -RT_ENOSYS;
+    }
+
+    if (!disk->cache_sectors)
+    {
+        disk->cache_sectors = RT_BLK_CACHE_SECTORS;
+    }
+
+    if ((err = disk->ops->getgeome(disk, &geometry)))
+    {
+        return err;
+    }
+
+    if (!blk_cache_wq)
+    {
+        rt_ubase_t level;
+        struct rt_workqueue *wq = rt_workqueue_create("blk_wb",
+                BLK_CACHE_WB_STACK_SIZE, RT_THREAD_PRIORITY_MAX / 2);
+
+        if (!wq)
+        {
+            return -RT_ENOMEM;
+        }
+
+        /* The disks may be registered at the same time */
+        level = rt_spin_lock_irqsave(&blk_cache_wq_lock);
+
+        if (!blk_cache_wq)
+        {
+            blk_cache_wq = wq;
+            wq = RT_NULL;
+        }
+
+        rt_spin_unlock_irqrestore(&blk_cache_wq_lock, level);
+
+        if (wq)
+        {
+            rt_workqueue_destroy(wq);
+        }
+    }
+
+    if (!(cache = rt_calloc(1, sizeof(*cache))))
+    {
+        return -RT_ENOMEM;
+    }
+
+    cache->disk = disk;
+    cache->read = read;
+    cache->write = write;
+    cache->sector_size = geometry.bytes_per_sector;
+    cache->nr_lines = disk->cache_sectors;
+
+    /* About two lines per bucket */
+    buckets = 1 << rt_ilog2(rt_max_t(rt_uint32_t, cache->nr_lines / 2, 1));
+    cache->hash_mask = buckets - 1;
+
+    cache->hash = rt_malloc(sizeof(*cache->hash) * buckets);
+    cache->lines = rt_calloc(cache->nr_lines, sizeof(*cache->lines));
+    cache->data = rt_malloc_align(cache->nr_lines * cache->sector_size, cache->sector_size);
+    cache->bounce = rt_malloc_align(BLK_CACHE_RUN_MAX * cache->sector_size, cache->sector_size);
+
+    if (!cache->hash || !cache->lines || !cache->data || !cache->bounce)
+    {
+        err = -RT_ENOMEM;
+        goto _fail;
+    }
+
+    for (int i = 0; i < buckets; ++i)
+    {
+        rt_list_init(&cache->hash[i]);
+    }
+
+    rt_list_init(&cache->lru);
+    rt_list_init(&cache->free);
+    rt_list_init(&cache->dirty);
+
+    for (int i = 0; i < cache->nr_lines; ++i)
+    {
+        struct blk_cache_line *line = &cache->lines[i];
+
+        rt_list_init(&line->hash_node);
+        rt_list_init(&line->dirty_node);
+        line->data = cache->data + i * cache->sector_size;
+        rt_list_insert_before(&cache->free, &line->lru_node);
+    }
+
+    rt_mutex_init(&cache->lock, to_disk_name(disk), RT_IPC_FLAG_PRIO);
+    rt_work_init(&cache->flush_work, blk_cache_flush_work, cache);
+
+    disk->cache = cache;
+
+    return RT_EOK;
+
+_fail:
+    if (cache->bounce)
+    {
+        rt_free_align(cache->bounce);
+    }
+    if (cache->data)
+    {
+        rt_free_align(cache->data);
+    }
+    if (cache->lines)
+    {
+        rt_free(cache->lines);
+    }
+    if (cache->hash)
+    {
+        rt_free(cache->hash);
+    }
+    rt_free(cache);
+
+    return err;
+}
+
+void blk_cache_fini(struct rt_blk_disk *disk)
+{
+    struct rt_blk_cache *cache = disk->cache;
+
+    if (cache)
+    {
+        RT_ASSERT(!cache->nr_dirty);
+
+        rt_workqueue_cancel_work_sync(blk_cache_wq, &cache->flush_work);
+        rt_mutex_detach(&cache->lock);
+
+        disk->cache = RT_NULL;
+
+        rt_free_align(cache->bounce);
+        rt_free_align(cache->data);
+        rt_free(cache->lines);
+        rt_free(cache->hash);
+        rt_free(cache);
+    }
+}
+
+rt_err_t rt_blk_disk_get_cache_stat(struct rt_blk_disk *disk,
+        struct rt_blk_cache_stat *stat)
+{
+    struct rt_blk_cache *cache;
+
+    if (!disk || !stat)
+    {
+        return -RT_EINVAL;
+    }
+
+    if (!(cache = disk->cache))
+    {
+        return -RT_ENOSYS;
+    }
+
+    rt_mutex_take(&cache->lock, RT_WAITING_FOREVER);
+
+    stat->sectors = cache->nr_lines;
+    stat->valid = cache->nr_valid;
+    stat->dirty = cache->nr_dirty;
+    stat->hits = cache->hits;
+    stat->misses = cache->misses;
+    stat->bypass = cache->bypass;
+    stat->writebacks = cache->writebacks;
+    stat->writeback_sectors = cache->writeback_sectors;
+
+    rt_mutex_release(&cache->lock);
+
+    return RT_EOK;
+}
+
+#if defined(RT_USING_CONSOLE) && defined(RT_USING_MSH)
+static int list_blk_cache(int argc, char**argv)
+{
+    rt_ubase_t level;
+    struct rt_object *obj;
+    struct rt_device *dev;
+    struct rt_blk_disk *disk;
+    struct rt_blk_cache *cache;
+    struct rt_object_information *info = rt_object_get_information(RT_Object_Class_Device);
+
+    level = rt_hw_interrupt_disable();
+
+    rt_kprintf("%-*.s SECTORS VALID DIRTY       HITS     MISSES   BYPASS WRITEBACKS(SECTORS)\n",
+            RT_NAME_MAX, "NAME");
+
+    rt_list_for_each_entry(obj, &info->object_list, list)
+    {
+        dev = rt_container_of(obj, struct rt_device, parent);
+
+        if (dev->type != RT_Device_Class_Block)
+        {
+            continue;
+        }
+
+        disk = to_blk_disk(dev);
+
+        if (disk->__magic != RT_BLK_DISK_MAGIC || !(cache = disk->cache))
+        {
+            continue;
+        }
+
+        rt_kprintf("%-*.s %7u %5u %5u %10llu %10llu %8llu %10llu(%llu)\n",
+                RT_NAME_MAX, to_disk_name(disk),
+                cache->nr_lines, cache->nr_valid, cache->nr_dirty,
+                cache->hits, cache->misses, cache->bypass,
+                cache->writebacks, cache->writeback_sectors);
+    }
+
+    rt_hw_interrupt_enable(level);
+
+    return 0;
+}
+MSH_CMD_EXPORT(list_blk_cache, dump the sector buffer cache of blks);
+#endif /* RT_USING_CONSOLE && RT_USING_MSH */
@@ -6,6 +6,7 @@
  * Change Logs:
  * Date           Author       Notes
  * 2023-02-25     GuEe-GUI     first version
+ * 2026-10-17     agent        add direct I/O around the sector buffer cache
  */
 
 #include "blk_dev.h"
@@ -173,6 +174,36 @@ rt_err_t blk_dev_initialize(struct rt_blk_device *blk)
     return RT_EOK;
 }
 
+#ifdef RT_BLK_USING_CACHE
+/* Read or write a disk or a partition around the sector buffer cache */
+rt_ssize_t blk_dev_direct_rw(rt_device_t dev, rt_bool_t write,
+        rt_off_t sector, void *buffer, rt_size_t sector_count)
+{
+    struct rt_blk_device *blk;
+    struct rt_blk_disk *disk = to_blk_disk(dev);
+
+#ifdef RT_USING_DEVICE_OPS
+    if (dev->ops == &blk_dev_ops)
+#else
+    if (dev->read == blk_dev_read)
+#endif
+    {
+        blk = to_blk(dev);
+
+        if (sector > blk->sector_start + blk->sector_count ||
+            sector_count > blk->sector_count)
+        {
+            return -RT_EINVAL;
+        }
+
+        disk = blk->disk;
+        sector += blk->sector_start;
+    }
+
+    return blk_cache_direct_rw(disk, write, sector, buffer, sector_count);
+}
+#endif /* RT_BLK_USING_CACHE */
+
 rt_err_t disk_add_blk_dev(struct rt_blk_disk *disk, struct rt_blk_device *blk)
 {
     rt_err_t err;
@@ -6,6 +6,10 @@
  * Change Logs:
  * Date           Author       Notes
  * 2023-02-25     GuEe-GUI     first version
+ * 2026-10-17     agent        add multi-queue request layer hooks
+ * 2026-10-17     agent        add sector buffer cache hooks
+ * 2026-10-17     agent        add direct I/O around the sector buffer cache
+ * 2026-10-17     agent        blk_mq_fini() reports busy queues
  */
 
 #ifndef __BLK_DEV_H__
@@ -46,4 +50,28 @@ rt_err_t disk_remove_blk_dev(struct rt_blk_device *blk, rt_bool_t lockless);
 
 rt_uint32_t blk_request_ioprio(void);
 
+#ifdef RT_BLK_USING_MQ
+rt_err_t blk_mq_init(struct rt_blk_disk *disk);
+rt_err_t blk_mq_fini(struct rt_blk_disk *disk);
+rt_ssize_t blk_mq_rw(struct rt_blk_disk *disk, rt_uint32_t op, rt_off_t sector,
+        void *buffer, rt_size_t sector_count);
+#endif
+
+#ifdef RT_BLK_USING_CACHE
+rt_err_t blk_cache_init(struct rt_blk_disk *disk,
+        rt_ssize_t (*read)(rt_device_t, rt_off_t, void *, rt_size_t),
+        rt_ssize_t (*write)(rt_device_t, rt_off_t, const void *, rt_size_t));
+void blk_cache_fini(struct rt_blk_disk *disk);
+rt_ssize_t blk_cache_read(rt_device_t dev, rt_off_t sector,
+        void *buffer, rt_size_t sector_count);
+rt_ssize_t blk_cache_write(rt_device_t dev, rt_off_t sector,
+        const void *buffer, rt_size_t sector_count);
+rt_ssize_t blk_cache_direct_rw(struct rt_blk_disk *disk, rt_bool_t write,
+        rt_off_t sector, void *buffer, rt_size_t sector_count);
+rt_ssize_t blk_dev_direct_rw(rt_device_t dev, rt_bool_t write,
+        rt_off_t sector, void *buffer, rt_size_t sector_count);
+rt_err_t blk_cache_flush(struct rt_blk_disk *disk);
+void blk_cache_invalidate(struct rt_blk_disk *disk);
+#endif
+
 #endif /* __BLK_DEV_H__ */
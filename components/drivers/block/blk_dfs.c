@@ -6,14 +6,27 @@
  * Change Logs:
  * Date           Author       Notes
  * 2023-08-08     GuEe-GUI     first version
+ * 2026-10-17     agent        transfer the aligned sectors in one call
+ * 2026-10-17     agent        O_DIRECT bypasses the sector buffer cache
+ * 2026-10-17     agent        bounce the buffers not aligned for DMA
  */
 
+#include <rthw.h>
 #include "blk_dfs.h"
+#ifdef RT_BLK_USING_CACHE
+#include "blk_dev.h"
+#endif
 
+#include <fcntl.h>
 #include <dfs_file.h>
+#include <drivers/misc.h>
 #include <drivers/classes/block.h>
 
 #if defined(RT_USING_POSIX_DEVIO) && defined(RT_USING_DFS_V2)
+/* The drivers do the cache maintenance of a DMA buffer by cache lines */
+#define BLK_FOPS_DMA_ALIGN      RT_CPU_CACHE_LINE_SZ
+#define BLK_FOPS_BOUNCE_SIZE    (32 * 1024)
+
 struct blk_fops_data
 {
     struct rt_device_blk_geometry geometry;
@@ -53,11 +66,111 @@ static int blk_fops_ioctl(struct dfs_file *file, int cmd, void *arg)
     return (int)rt_device_control(dev, cmd, arg);
 }
 
+static rt_bool_t blk_fops_dma_aligned(const void *buffer)
+{
+    return !((rt_ubase_t)buffer & (BLK_FOPS_DMA_ALIGN - 1));
+}
+
+/*
+ * O_DIRECT asks for the transfers without any bounce buffer, so the position
+ * and size must both be multiples of the sector size, and the buffer must be
+ * aligned for DMA.
+ */
+static rt_bool_t blk_fops_direct_invalid(struct dfs_file *file, const void *buf,
+        size_t count, off_t pos, rt_size_t bytes_per_sector)
+{
+#ifdef O_DIRECT
+    if (file->flags & O_DIRECT)
+    {
+        return (pos % bytes_per_sector) || (count % bytes_per_sector) ||
+                !blk_fops_dma_aligned(buf);
+    }
+#endif
+
+    return RT_FALSE;
+}
+
+static rt_ssize_t blk_fops_rw_dev(struct dfs_file *file, rt_bool_t write,
+        rt_off_t sector, void *buffer, rt_size_t sector_count)
+{
+    struct rt_device *dev = file->vnode->data;
+
+#if defined(RT_BLK_USING_CACHE) && defined(O_DIRECT)
+    if (file->flags & O_DIRECT)
+    {
+        return blk_dev_direct_rw(dev, write, sector, buffer, sector_count);
+    }
+#endif
+
+    if (write)
+    {
+        return rt_device_write(dev, sector, buffer, sector_count);
+    }
+
+    return rt_device_read(dev, sector, buffer, sector_count);
+}
+
+static rt_ssize_t blk_fops_rw_sectors(struct dfs_file *file, rt_bool_t write,
+        rt_off_t sector, void *buffer, rt_size_t sector_count, rt_size_t bytes_per_sector)
+{
+    void *bounce;
+    rt_ssize_t res = 0, done = 0;
+    rt_size_t step, count;
+
+    if (blk_fops_dma_aligned(buffer))
+    {
+        return blk_fops_rw_dev(file, write, sector, buffer, sector_count);
+    }
+
+    /* The cache lines shared with the caller's data would be corrupted */
+    step = rt_max_t(rt_size_t, BLK_FOPS_BOUNCE_SIZE / bytes_per_sector, 1);
+    step = rt_min_t(rt_size_t, step, sector_count);
+
+    if (!(bounce = rt_malloc_align(step * bytes_per_sector, BLK_FOPS_DMA_ALIGN)))
+    {
+        return -RT_ENOMEM;
+    }
+
+    while (done < sector_count)
+    {
+        count = rt_min_t(rt_size_t, step, sector_count - done);
+
+        if (write)
+        {
+            rt_memcpy(bounce, buffer + done * bytes_per_sector, count * bytes_per_sector);
+        }
+
+        res = blk_fops_rw_dev(file, write, sector + done, bounce, count);
+
+        if (res <= 0)
+        {
+            break;
+        }
+
+        if (!write)
+        {
+            rt_memcpy(buffer + done * bytes_per_sector, bounce, res * bytes_per_sector);
+        }
+
+        done += res;
+
+        if (res != count)
+        {
+            break;
+        }
+    }
+
+    rt_free_align(bounce);
+
+    return done ? done : res;
+}
+
 static ssize_t blk_fops_read(struct dfs_file *file, void *buf, size_t count, off_t *pos)
 {
-    void *rbuf;
-    rt_ssize_t res = 0;
-    int bytes_per_sector, blk_pos, first_offs, rsize = 0;
+    void *rbuf = RT_NULL;
+    rt_ssize_t res;
+    rt_off_t blk_pos;
+    rt_size_t bytes_per_sector, first_offs, sectors, rsize = 0;
     struct rt_device *dev = file->vnode->data;
     struct blk_fops_data *data = dev->user_data;
 
@@ -65,64 +178,84 @@ static ssize_t blk_fops_read(struct dfs_file *file, void *buf, size_t count, off
     blk_pos = *pos / bytes_per_sector;
     first_offs = *pos % bytes_per_sector;
 
-    if ((rbuf = rt_malloc(bytes_per_sector)))
+    if (blk_fops_direct_invalid(file, buf, count, *pos, bytes_per_sector))
+    {
+        return -EINVAL;
+    }
+
+    /*
+    ** #1: read first unalign block size.
+    */
+    if (first_offs != 0)
     {
-        /*
-        ** #1: read first unalign block size.
-        */
-        res = rt_device_read(dev, blk_pos, rbuf, 1);
+        if (!(rbuf = rt_malloc_align(bytes_per_sector, BLK_FOPS_DMA_ALIGN)))
+        {
+            return -ENOMEM;
+        }
 
-        if (res == 1)
+        if (rt_device_read(dev, blk_pos, rbuf, 1) != 1)
         {
-            if (count > bytes_per_sector - first_offs)
-            {
-                rsize = bytes_per_sector - first_offs;
-            }
-            else
-            {
-                rsize = count;
-            }
-            rt_memcpy(buf, rbuf + first_offs, rsize);
-            ++blk_pos;
+            goto _end;
+        }
 
-            /*
-            ** #2: read continuous block size.
-            */
-            while (rsize < count)
-            {
-                res = rt_device_read(dev, blk_pos++, rbuf, 1);
-
-                if (res != 1)
-                {
-                    break;
-                }
-
-                if (count - rsize >= bytes_per_sector)
-                {
-                    rt_memcpy(buf + rsize, rbuf, bytes_per_sector);
-                    rsize += bytes_per_sector;
-                }
-                else
-                {
-                    rt_memcpy(buf + rsize, rbuf, count - rsize);
-                    rsize = count;
-                }
-            }
+        rsize = rt_min_t(rt_size_t, count, bytes_per_sector - first_offs);
+        rt_memcpy(buf, rbuf + first_offs, rsize);
+        ++blk_pos;
+    }
+
+    /*
+    ** #2: read continuous block size to the buffer directly.
+    */
+    if ((sectors = (count - rsize) / bytes_per_sector))
+    {
+        res = blk_fops_rw_sectors(file, RT_FALSE, blk_pos, buf + rsize, sectors,
+                bytes_per_sector);
 
-            *pos += rsize;
+        if (res > 0)
+        {
+            rsize += res * bytes_per_sector;
+            blk_pos += res;
         }
 
-        rt_free(rbuf);
+        if (res != sectors)
+        {
+            goto _end;
+        }
     }
 
+    /*
+    ** #3: read last unalign block size.
+    */
+    if (rsize < count)
+    {
+        if (!rbuf && !(rbuf = rt_malloc_align(bytes_per_sector, BLK_FOPS_DMA_ALIGN)))
+        {
+            goto _end;
+        }
+
+        if (rt_device_read(dev, blk_pos, rbuf, 1) == 1)
+        {
+            rt_memcpy(buf + rsize, rbuf, count - rsize);
+            rsize = count;
+        }
+    }
+
+_end:
+    if (rbuf)
+    {
+        rt_free_align(rbuf);
+    }
+
+    *pos += rsize;
     return rsize;
 }
 
 static ssize_t blk_fops_write(struct dfs_file *file, const void *buf, size_t count, off_t *pos)
 {
-    void *rbuf;
-    rt_ssize_t res = 0;
-    int bytes_per_sector, blk_pos, first_offs, wsize = 0;
+    void *rbuf = RT_NULL;
+    rt_ssize_t res;
+    rt_off_t blk_pos;
+    rt_size_t bytes_per_sector, first_offs, sectors, wsize = 0;
     struct rt_device *dev = file->vnode->data;
     struct blk_fops_data *data = dev->user_data;
 
@@ -130,85 +263,85 @@ static ssize_t blk_fops_write(struct dfs_file *file, const void *buf, size_t cou
     blk_pos = *pos / bytes_per_sector;
     first_offs = *pos % bytes_per_sector;
 
+    if (blk_fops_direct_invalid(file, buf, count, *pos, bytes_per_sector))
+    {
+        return -EINVAL;
+    }
+
     /*
     ** #1: write first unalign block size.
     */
     if (first_offs != 0)
     {
-        if (count > bytes_per_sector - first_offs)
-        {
-            wsize = bytes_per_sector - first_offs;
-        }
-        else
+        if (!(rbuf = rt_malloc_align(bytes_per_sector, BLK_FOPS_DMA_ALIGN)))
         {
-            wsize = count;
+            return -ENOMEM;
         }
 
-        if ((rbuf = rt_malloc(bytes_per_sector)))
+        if (rt_device_read(dev, blk_pos, rbuf, 1) != 1)
         {
-            res = rt_device_read(dev, blk_pos, rbuf, 1);
-
-            if (res == 1)
-            {
-                rt_memcpy(rbuf + first_offs, buf, wsize);
-                res = rt_device_write(dev, blk_pos, (const void *)rbuf, 1);
+            goto _end;
+        }
 
-                if (res == 1)
-                {
-                    blk_pos += 1;
-                    rt_free(rbuf);
+        wsize = rt_min_t(rt_size_t, count, bytes_per_sector - first_offs);
+        rt_memcpy(rbuf + first_offs, buf, wsize);
 
-                    goto _goon;
-                }
-            }
-
-            rt_free(rbuf);
+        if (rt_device_write(dev, blk_pos, (const void *)rbuf, 1) != 1)
+        {
+            wsize = 0;
+            goto _end;
         }
 
-        return 0;
+        ++blk_pos;
     }
 
-_goon:
     /*
-    ** #2: write continuous block size.
+    ** #2: write continuous block size from the buffer directly.
     */
-    if ((count - wsize) / bytes_per_sector != 0)
+    if ((sectors = (count - wsize) / bytes_per_sector))
     {
-        res = rt_device_write(dev, blk_pos, buf + wsize, (count - wsize) / bytes_per_sector);
-        wsize += res * bytes_per_sector;
-        blk_pos += res;
+        res = blk_fops_rw_sectors(file, RT_TRUE, blk_pos, (void *)buf + wsize, sectors,
+                bytes_per_sector);
 
-        if (res != (count - wsize) / bytes_per_sector)
+        if (res > 0)
         {
-            *pos += wsize;
-            return wsize;
+            wsize += res * bytes_per_sector;
+            blk_pos += res;
+        }
+
+        if (res != sectors)
+        {
+            goto _end;
         }
     }
 
     /*
-    ** # 3: write last unalign block size.
+    ** #3: write last unalign block size.
     */
-    if ((count - wsize) != 0)
+    if (wsize < count)
     {
-        if ((rbuf = rt_malloc(bytes_per_sector)))
+        if (!rbuf && !(rbuf = rt_malloc_align(bytes_per_sector, BLK_FOPS_DMA_ALIGN)))
         {
-            res = rt_device_read(dev, blk_pos, rbuf, 1);
+            goto _end;
+        }
 
-            if (res == 1)
-            {
-                rt_memcpy(rbuf, buf + wsize, count - wsize);
-                res = rt_device_write(dev, blk_pos, (const void *)rbuf, 1);
+        if (rt_device_read(dev, blk_pos, rbuf, 1) == 1)
+        {
+            rt_memcpy(rbuf, buf + wsize, count - wsize);
 
-                if (res == 1)
-                {
-                    wsize += count - wsize;
-                }
+            if (rt_device_write(dev, blk_pos, (const void *)rbuf, 1) == 1)
+            {
+                wsize = count;
             }
-
-            rt_free(rbuf);
         }
     }
 
+_end:
+    if (rbuf)
+    {
+        rt_free_align(rbuf);
+    }
+
     *pos += wsize;
     return wsize;
 }
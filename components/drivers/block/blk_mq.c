@@ -0,0 +1,507 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ * 2026-10-17     agent        fail blk_mq_fini() while requests are queued
+ */
+
+#define DBG_TAG "rtdm.blk.mq"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+#include "blk_dev.h"
+
+/*
+ * Requests are queued on the software queue of the submitting CPU, merged
+ * with the adjacent sectors there and dispatched in batches to the hardware
+ * queue mapped to that CPU, up to `queue_depth` requests in flight. Disks
+ * without the `submit` op are served synchronously by `read` and `write`.
+ */
+
+struct rt_blk_mq_ctx
+{
+    struct rt_spinlock lock;
+    rt_list_t list;
+};
+
+struct rt_blk_mq
+{
+    struct rt_blk_disk *disk;
+
+    rt_atomic_t inflight;
+    rt_atomic_t pending;
+    struct rt_work run_work;
+
+    struct rt_blk_mq_ctx ctx[RT_CPUS_NR];
+};
+
+static void blk_list_splice_tail(rt_list_t *from, rt_list_t *to)
+{
+    rt_list_t *first = from->next, *last = from->prev;
+
+    if (first == from)
+    {
+        return;
+    }
+
+    first->prev = to->prev;
+    to->prev->next = first;
+    last->next = to;
+    to->prev = last;
+
+    rt_list_init(from);
+}
+
+/* Append `req` and the requests merged behind it to `head` */
+static void blk_mq_chain(struct rt_blk_request *head, struct rt_blk_request *req)
+{
+    rt_list_insert_before(&head->merge_list, &req->list);
+    blk_list_splice_tail(&req->merge_list, &head->merge_list);
+
+    head->total_count += req->total_count;
+}
+
+rt_inline rt_bool_t blk_mq_mergeable(struct rt_blk_request *front,
+        struct rt_blk_request *back)
+{
+    return front->disk == back->disk && front->op == back->op &&
+            front->sector + front->total_count == back->sector &&
+            front->total_count + back->total_count <= RT_BLK_MQ_MAX_SECTORS;
+}
+
+static void blk_mq_insert_merge(rt_list_t *list, struct rt_blk_request *req)
+{
+    rt_list_t *node;
+    struct rt_blk_request *prev;
+
+    /* The newest requests are the most likely to be adjacent */
+    for (node = list->prev; node != list; node = node->prev)
+    {
+        prev = rt_list_entry(node, struct rt_blk_request, list);
+
+        if (blk_mq_mergeable(prev, req))
+        {
+            blk_mq_chain(prev, req);
+            return;
+        }
+
+        if (blk_mq_mergeable(req, prev))
+        {
+            /* `req` takes the place of `prev` in the queue */
+            rt_list_insert_before(&prev->list, &req->list);
+            rt_list_remove(&prev->list);
+            blk_mq_chain(req, prev);
+            return;
+        }
+    }
+
+    rt_list_insert_before(list, &req->list);
+}
+
+static void blk_mq_queue(struct rt_blk_mq *mq, struct rt_blk_request *req)
+{
+    rt_ubase_t level;
+    struct rt_blk_mq_ctx *ctx = &mq->ctx[rt_hw_cpu_id() % RT_CPUS_NR];
+
+    level = rt_spin_lock_irqsave(&ctx->lock);
+
+    blk_mq_insert_merge(&ctx->list, req);
+    rt_atomic_add(&mq->pending, 1);
+
+    rt_spin_unlock_irqrestore(&ctx->lock, level);
+}
+
+static void blk_mq_dispatch_sync(struct rt_blk_disk *disk, rt_list_t *batch)
+{
+    rt_ssize_t res, seg_res;
+    struct rt_blk_request *req, *req_next, *seg;
+
+    rt_list_for_each_entry_safe(req, req_next, batch, list)
+    {
+        rt_list_remove(&req->list);
+
+        if (!disk->parallel_io)
+        {
+            rt_sem_take(&disk->usr_lock, RT_WAITING_FOREVER);
+        }
+
+        res = 0;
+        rt_blk_request_for_each_segment(seg, req)
+        {
+            if (seg->op == RT_BLK_REQ_READ)
+            {
+                seg_res = disk->ops->read(disk, seg->sector, seg->buffer, seg->sector_count);
+            }
+            else
+            {
+                seg_res = disk->ops->write(disk, seg->sector, seg->buffer, seg->sector_count);
+            }
+
+            if (seg_res < 0)
+            {
+                res = res ? : seg_res;
+                break;
+            }
+
+            res += seg_res;
+
+            if (seg_res != seg->sector_count)
+            {
+                break;
+            }
+        }
+
+        if (!disk->parallel_io)
+        {
+            rt_sem_release(&disk->usr_lock);
+        }
+
+        rt_blk_request_complete(req, res);
+    }
+}
+
+static void blk_mq_run_ctx(struct rt_blk_mq *mq, int cpu)
+{
+    rt_err_t err;
+    rt_ubase_t level;
+    rt_list_t batch;
+    rt_atomic_t budget, count = 0;
+    struct rt_blk_request *req, *req_next;
+    struct rt_blk_disk *disk = mq->disk;
+    struct rt_blk_mq_ctx *ctx = &mq->ctx[cpu];
+
+    rt_list_init(&batch);
+
+    level = rt_spin_lock_irqsave(&ctx->lock);
+
+    budget = (rt_atomic_t)disk->queue_depth - rt_atomic_load(&mq->inflight);
+
+    while (budget-- > 0 && !rt_list_isempty(&ctx->list))
+    {
+        req = rt_list_first_entry(&ctx->list, struct rt_blk_request, list);
+        rt_list_remove(&req->list);
+        rt_list_insert_before(&batch, &req->list);
+        ++count;
+    }
+
+    if (count)
+    {
+        rt_atomic_add(&mq->inflight, count);
+        rt_atomic_sub(&mq->pending, count);
+    }
+
+    rt_spin_unlock_irqrestore(&ctx->lock, level);
+
+    if (!count)
+    {
+        return;
+    }
+
+    if (!disk->ops->submit)
+    {
+        blk_mq_dispatch_sync(disk, &batch);
+
+        return;
+    }
+
+    err = disk->ops->submit(disk, cpu % disk->nr_hw_queues, &batch);
+
+    if (rt_list_isempty(&batch))
+    {
+        return;
+    }
+
+    if (err == -RT_EBUSY)
+    {
+        /* Hardware queue is full, put the rest back in order */
+        count = 0;
+        rt_list_for_each_entry(req, &batch, list)
+        {
+            ++count;
+        }
+
+        level = rt_spin_lock_irqsave(&ctx->lock);
+
+        blk_list_splice_tail(&ctx->list, &batch);
+        rt_list_insert_after(&batch, &ctx->list);
+        rt_list_remove(&batch);
+
+        rt_atomic_sub(&mq->inflight, count);
+        rt_atomic_add(&mq->pending, count);
+
+        rt_spin_unlock_irqrestore(&ctx->lock, level);
+
+        /* Nothing will complete to kick us again */
+        if (!rt_atomic_load(&mq->inflight))
+        {
+            rt_work_submit(&mq->run_work, 1);
+        }
+
+        return;
+    }
+
+    LOG_D("%s: Submit error = %s", to_disk_name(disk), rt_strerror(err));
+
+    rt_list_for_each_entry_safe(req, req_next, &batch, list)
+    {
+        rt_list_remove(&req->list);
+        rt_blk_request_complete(req, err ? : -RT_EIO);
+    }
+}
+
+static void blk_mq_run(struct rt_blk_mq *mq)
+{
+    int cpu = rt_hw_cpu_id() % RT_CPUS_NR;
+
+    do {
+        /* Local queue first, then help the others */
+        for (int i = 0; i < RT_CPUS_NR; ++i)
+        {
+            if (!rt_atomic_load(&mq->pending))
+            {
+                return;
+            }
+
+            blk_mq_run_ctx(mq, (cpu + i) % RT_CPUS_NR);
+        }
+
+        /*
+         * Synchronous disks are served by the submitters, keep on draining
+         * the requests queued by others while we were busy.
+         */
+    } while (!mq->disk->ops->submit &&
+            rt_atomic_load(&mq->inflight) < (rt_atomic_t)mq->disk->queue_depth);
+}
+
+static void blk_mq_run_work(struct rt_work *work, void *work_data)
+{
+    blk_mq_run(work_data);
+}
+
+void rt_blk_request_init(struct rt_blk_request *req, struct rt_blk_disk *disk,
+        rt_uint32_t op, rt_off_t sector, void *buffer, rt_size_t sector_count,
+        rt_blk_request_done_t done, void *priv)
+{
+    RT_ASSERT(req != RT_NULL);
+
+    rt_list_init(&req->list);
+    rt_list_init(&req->merge_list);
+    req->disk = disk;
+    req->op = op;
+    req->sector = sector;
+    req->sector_count = sector_count;
+    req->buffer = buffer;
+    req->total_count = sector_count;
+    req->done = done;
+    req->priv = priv;
+}
+
+rt_err_t rt_blk_submit(struct rt_blk_request *req, struct rt_blk_plug *plug)
+{
+    struct rt_blk_disk *disk;
+
+    if (!req || !(disk = req->disk) || !req->buffer || !req->sector_count)
+    {
+        return -RT_EINVAL;
+    }
+
+    if (req->op == RT_BLK_REQ_WRITE && disk->read_only)
+    {
+        return -RT_ENOSYS;
+    }
+
+    if (!disk->mq)
+    {
+        return -RT_ENOSYS;
+    }
+
+    if (plug)
+    {
+        blk_mq_insert_merge(&plug->list, req);
+
+        return RT_EOK;
+    }
+
+    blk_mq_queue(disk->mq, req);
+    blk_mq_run(disk->mq);
+
+    return RT_EOK;
+}
+
+/*
+ * `res` is the sectors done of the whole merged request, or an error.
+ * It can be called in interrupt context.
+ */
+void rt_blk_request_complete(struct rt_blk_request *req, rt_ssize_t res)
+{
+    rt_ssize_t head_res, seg_res;
+    rt_list_t *node, *node_next;
+    struct rt_blk_request *seg;
+    /* `req` may be gone once its callback returns */
+    struct rt_blk_disk *disk = req->disk;
+    struct rt_blk_mq *mq = disk->mq;
+    rt_bool_t async = !!disk->ops->submit;
+
+    head_res = res < 0 ? res : rt_min_t(rt_ssize_t, res, req->sector_count);
+    res = res < 0 ? res : res - head_res;
+
+    /* The head goes last, its callback may release the merge list */
+    for (node = req->merge_list.next; node != &req->merge_list; node = node_next)
+    {
+        node_next = node->next;
+        seg = rt_list_entry(node, struct rt_blk_request, list);
+
+        seg_res = res < 0 ? res : rt_min_t(rt_ssize_t, res, seg->sector_count);
+        res = res < 0 ? res : res - seg_res;
+
+        rt_list_init(&seg->list);
+        if (seg->done)
+        {
+            seg->done(seg, seg_res);
+        }
+    }
+
+    rt_list_init(&req->merge_list);
+    if (req->done)
+    {
+        req->done(req, head_res);
+    }
+
+    rt_atomic_sub(&mq->inflight, 1);
+
+    /* Synchronous disks are drained in blk_mq_run() */
+    if (async && rt_atomic_load(&mq->pending))
+    {
+        rt_work_submit(&mq->run_work, 0);
+    }
+}
+
+void rt_blk_start_plug(struct rt_blk_plug *plug)
+{
+    RT_ASSERT(plug != RT_NULL);
+
+    rt_list_init(&plug->list);
+}
+
+void rt_blk_finish_plug(struct rt_blk_plug *plug)
+{
+    struct rt_blk_request *req;
+    struct rt_blk_disk *disk = RT_NULL;
+
+    RT_ASSERT(plug != RT_NULL);
+
+    while (!rt_list_isempty(&plug->list))
+    {
+        req = rt_list_first_entry(&plug->list, struct rt_blk_request, list);
+        rt_list_remove(&req->list);
+
+        if (disk && disk != req->disk)
+        {
+            blk_mq_run(disk->mq);
+        }
+        disk = req->disk;
+
+        blk_mq_queue(disk->mq, req);
+    }
+
+    if (disk)
+    {
+        blk_mq_run(disk->mq);
+    }
+}
+
+struct blk_mq_sync
+{
+    struct rt_completion done;
+    rt_ssize_t res;
+};
+
+static void blk_mq_sync_done(struct rt_blk_request *req, rt_ssize_t res)
+{
+    struct blk_mq_sync *sync = req->priv;
+
+    sync->res = res;
+    rt_completion_done(&sync->done);
+}
+
+rt_ssize_t blk_mq_rw(struct rt_blk_disk *disk, rt_uint32_t op, rt_off_t sector,
+        void *buffer, rt_size_t sector_count)
+{
+    rt_err_t err;
+    struct blk_mq_sync sync;
+    struct rt_blk_request req;
+
+    rt_completion_init(&sync.done);
+    rt_blk_request_init(&req, disk, op, sector, buffer, sector_count,
+            blk_mq_sync_done, &sync);
+
+    if ((err = rt_blk_submit(&req, RT_NULL)))
+    {
+        return err;
+    }
+
+    rt_completion_wait(&sync.done, RT_WAITING_FOREVER);
+
+    return sync.res;
+}
+
+rt_err_t blk_mq_init(struct rt_blk_disk *disk)
+{
+    struct rt_blk_mq *mq = rt_calloc(1, sizeof(*mq));
+
+    if (!mq)
+    {
+        return -RT_ENOMEM;
+    }
+
+    if (!disk->nr_hw_queues)
+    {
+        disk->nr_hw_queues = 1;
+    }
+
+    if (!disk->queue_depth)
+    {
+        disk->queue_depth = disk->ops->submit || disk->parallel_io ?
+                RT_BLK_MQ_QUEUE_DEPTH : 1;
+    }
+
+    mq->disk = disk;
+    rt_atomic_store(&mq->inflight, 0);
+    rt_atomic_store(&mq->pending, 0);
+    rt_work_init(&mq->run_work, blk_mq_run_work, mq);
+
+    for (int i = 0; i < RT_CPUS_NR; ++i)
+    {
+        rt_spin_lock_init(&mq->ctx[i].lock);
+        rt_list_init(&mq->ctx[i].list);
+    }
+
+    disk->mq = mq;
+
+    return RT_EOK;
+}
+
+rt_err_t blk_mq_fini(struct rt_blk_disk *disk)
+{
+    struct rt_blk_mq *mq = disk->mq;
+
+    if (mq)
+    {
+        /* The requests still refer to the queues */
+        if (rt_atomic_load(&mq->inflight) || rt_atomic_load(&mq->pending))
+        {
+            return -RT_EBUSY;
+        }
+
+        rt_work_cancel(&mq->run_work);
+
+        disk->mq = RT_NULL;
+        rt_free(mq);
+    }
+
+    return RT_EOK;
+}
@@ -6,6 +6,8 @@
  * Change Logs:
  * Date           Author       Notes
  * 2023-02-25     GuEe-GUI     first version
+ * 2026-10-17     agent        add multi-queue asynchronous request layer
+ * 2026-10-17     agent        add write-back sector buffer cache
  */
 
 #ifndef __BLK_H__
@@ -16,6 +18,8 @@
 #include <drivers/classes/block.h>
 
 struct rt_dm_ida;
+struct rt_blk_mq;
+struct rt_blk_cache;
 struct rt_blk_device;
 struct rt_blk_disk_ops;
 
@@ -42,7 +46,72 @@ struct rt_blk_disk
 
     struct rt_spinlock lock;
     struct rt_semaphore usr_lock;
+
+#ifdef RT_BLK_USING_MQ
+    /* Set by driver before register, 0 to use the default */
+    rt_uint32_t nr_hw_queues;
+    rt_uint32_t queue_depth;
+
+    struct rt_blk_mq *mq;
+#endif
+
+#ifdef RT_BLK_USING_CACHE
+    /* Set by driver before register, 0 to use the default, -1 to disable */
+    rt_int32_t cache_sectors;
+
+    struct rt_blk_cache *cache;
+#endif
+};
+
+#ifdef RT_BLK_USING_CACHE
+struct rt_blk_cache_stat
+{
+    rt_uint32_t sectors;
+    rt_uint32_t valid;
+    rt_uint32_t dirty;
+
+    rt_uint64_t hits;
+    rt_uint64_t misses;
+    /* Requests too large to be cached */
+    rt_uint64_t bypass;
+    /* Coalesced writes of the dirty sectors */
+    rt_uint64_t writebacks;
+    rt_uint64_t writeback_sectors;
 };
+#endif /* RT_BLK_USING_CACHE */
+
+#ifdef RT_BLK_USING_MQ
+#define RT_BLK_REQ_READ     0
+#define RT_BLK_REQ_WRITE    1
+
+struct rt_blk_request;
+typedef void (*rt_blk_request_done_t)(struct rt_blk_request *req, rt_ssize_t res);
+
+struct rt_blk_request
+{
+    /* Node in the queue, or in the merge list of the head request */
+    rt_list_t list;
+    /* Requests of the adjacent sectors merged behind this one */
+    rt_list_t merge_list;
+    struct rt_blk_disk *disk;
+
+    rt_uint32_t op;
+    rt_off_t sector;
+    rt_size_t sector_count;
+    void *buffer;
+
+    /* Sectors of this request and all the merged ones */
+    rt_size_t total_count;
+
+    rt_blk_request_done_t done;
+    void *priv;
+};
+
+struct rt_blk_plug
+{
+    rt_list_t list;
+};
+#endif /* RT_BLK_USING_MQ */
 
 struct rt_blk_disk_ops
 {
@@ -55,6 +124,14 @@ struct rt_blk_disk_ops
     rt_err_t (*erase)(struct rt_blk_disk *disk);
     rt_err_t (*autorefresh)(struct rt_blk_disk *disk, rt_bool_t is_auto);
     rt_err_t (*control)(struct rt_blk_disk *disk, struct rt_blk_device *blk, int cmd, void *args);
+#ifdef RT_BLK_USING_MQ
+    /*
+     * Take the requests off the list and start them on hardware queue `qid`,
+     * finish each one with rt_blk_request_complete(). Return -RT_EBUSY when
+     * the queue is full, the requests left in the list are retried later.
+     */
+    rt_err_t (*submit)(struct rt_blk_disk *disk, int qid, rt_list_t *requests);
+#endif
 };
 
 #ifndef __DFS_H__
@@ -84,4 +161,33 @@ rt_err_t rt_blk_disk_probe_partition(struct rt_blk_disk *disk);
 rt_ssize_t rt_blk_disk_get_capacity(struct rt_blk_disk *disk);
 rt_ssize_t rt_blk_disk_get_logical_block_size(struct rt_blk_disk *disk);
 
+#ifdef RT_BLK_USING_CACHE
+rt_err_t rt_blk_disk_get_cache_stat(struct rt_blk_disk *disk,
+        struct rt_blk_cache_stat *stat);
+#endif
+
+#ifdef RT_BLK_USING_MQ
+void rt_blk_request_init(struct rt_blk_request *req, struct rt_blk_disk *disk,
+        rt_uint32_t op, rt_off_t sector, void *buffer, rt_size_t sector_count,
+        rt_blk_request_done_t done, void *priv);
+rt_err_t rt_blk_submit(struct rt_blk_request *req, struct rt_blk_plug *plug);
+void rt_blk_request_complete(struct rt_blk_request *req, rt_ssize_t res);
+
+void rt_blk_start_plug(struct rt_blk_plug *plug);
+void rt_blk_finish_plug(struct rt_blk_plug *plug);
+
+rt_inline struct rt_blk_request *rt_blk_request_next_segment(
+        struct rt_blk_request *req, struct rt_blk_request *seg)
+{
+    rt_list_t *next = seg == req ? req->merge_list.next : seg->list.next;
+
+    return next != &req->merge_list ?
+            rt_list_entry(next, struct rt_blk_request, list) : RT_NULL;
+}
+
+/* Walk the head request and the requests merged behind it */
+#define rt_blk_request_for_each_segment(seg, req) \
+    for ((seg) = (req); (seg); (seg) = rt_blk_request_next_segment(req, seg))
+#endif /* RT_BLK_USING_MQ */
+
 #endif /* __BLK_H__ */
@@ -6,6 +6,9 @@
  * Change Logs:
  * Date           Author       Notes
  * 2023-02-25     GuEe-GUI     the first version
+ * 2026-10-17     agent        per-queue polled I/O latency statistics
+ * 2026-10-17     agent        asynchronous block requests
+ * 2026-10-17     agent        slots of the synchronous commands
  */
 
 #ifndef __NVME_H__
@@ -14,6 +17,9 @@
 #include <rthw.h>
 #include <rtthread.h>
 #include <drivers/blk.h>
+#ifdef RT_BLK_USING_MQ
+#include <ipc/workqueue.h>
+#endif
 
 #define NVME_RSVD(offset, bytes_size)   rt_uint8_t __rsvd##offset[bytes_size]
 
@@ -795,6 +801,23 @@ enum
 struct rt_nvme_ops;
 struct rt_nvme_controller;
 
+struct rt_nvme_blk_cmd;
+
+/* Synchronous commands in flight per queue, the slot is the low bits of the id */
+#define RT_NVME_SYNC_CMD_SHIFT      4
+#define RT_NVME_SYNC_CMD_NR         (1 << RT_NVME_SYNC_CMD_SHIFT)
+
+struct rt_nvme_sync_cmd
+{
+    struct rt_nvme_command *cmd;
+    /* Command id in CPU order, zero if the slot is free */
+    rt_uint16_t cmdid;
+    rt_bool_t reaped;
+    rt_err_t err;
+
+    struct rt_completion done;
+};
+
 /*
  * An NVM Express queue. Each device has at least two (one for admin commands
  * and one for I/O commands).
@@ -816,11 +839,30 @@ struct rt_nvme_queue
     rt_uint16_t cq_head;
     rt_uint16_t cq_phase;
 
-    rt_err_t err;
-    struct rt_nvme_command *cmd;
+    /* Commands submitted and not reaped yet */
+    rt_uint16_t inflight;
 
-    struct rt_completion done;
+    struct rt_nvme_sync_cmd sync_cmds[RT_NVME_SYNC_CMD_NR];
+    /* Bitmap of the free synchronous command slots */
+    rt_uint32_t sync_free;
     struct rt_spinlock lock;
+
+#ifdef RT_BLK_USING_MQ
+    /* Block requests in flight, indexed by the command id */
+    struct rt_nvme_blk_cmd *blk_cmds;
+    rt_list_t blk_free;
+    rt_list_t blk_done;
+    struct rt_work blk_work;
+#endif
+
+#ifdef RT_NVME_IO_STATS
+    /* Completions found by the poller, and the polls fallback to the IRQ */
+    rt_atomic_t polled;
+    rt_atomic_t poll_fallback;
+    /* Latency histogram, bucket N counts the latency less than (1 << N) us */
+#define RT_NVME_LAT_HIST_NR 20
+    rt_atomic_t lat_hist[RT_NVME_LAT_HIST_NR];
+#endif
 };
 
 struct rt_nvme_controller
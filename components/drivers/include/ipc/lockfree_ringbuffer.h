@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ */
+#ifndef LOCKFREE_RINGBUFFER_H__
+#define LOCKFREE_RINGBUFFER_H__
+
+#include <rtdef.h>
+#include <rtthread.h>
+#include <rthw.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Lock-free ring buffers, the size of buffer must be a power of two.
+ *
+ * The head and tail are free running counters, which wrap naturally and
+ * are masked only when the buffer is accessed, so the full buffer can be
+ * used and there is no mirror bit. The producer side and the consumer side
+ * live in different cache lines.
+ */
+
+/**
+ * Single producer, single consumer byte stream.
+ *
+ * One context may put (e.g. an ISR) while another gets (e.g. a thread)
+ * without any lock or interrupt disabling. Several producers or several
+ * consumers still need to be serialized by the user.
+ */
+struct rt_spsc_ringbuffer
+{
+    rt_uint8_t *buffer_ptr;
+    rt_size_t buffer_mask;
+
+    /* producer */
+    rt_align(RT_CPU_CACHE_LINE_SZ) rt_atomic_t head;
+    rt_size_t cached_tail;
+
+    /* consumer */
+    rt_align(RT_CPU_CACHE_LINE_SZ) rt_atomic_t tail;
+    rt_size_t cached_head;
+};
+
+void rt_spsc_ringbuffer_init(struct rt_spsc_ringbuffer *rb, rt_uint8_t *pool, rt_size_t size);
+void rt_spsc_ringbuffer_reset(struct rt_spsc_ringbuffer *rb);
+rt_size_t rt_spsc_ringbuffer_data_len(struct rt_spsc_ringbuffer *rb);
+rt_size_t rt_spsc_ringbuffer_space_len(struct rt_spsc_ringbuffer *rb);
+
+/* producer side */
+rt_size_t rt_spsc_ringbuffer_reserve(struct rt_spsc_ringbuffer *rb, rt_uint8_t **ptr, rt_size_t length);
+void rt_spsc_ringbuffer_commit(struct rt_spsc_ringbuffer *rb, rt_size_t length);
+rt_size_t rt_spsc_ringbuffer_put(struct rt_spsc_ringbuffer *rb, const rt_uint8_t *ptr, rt_size_t length);
+
+/* consumer side */
+rt_size_t rt_spsc_ringbuffer_peek(struct rt_spsc_ringbuffer *rb, rt_uint8_t **ptr);
+void rt_spsc_ringbuffer_consume(struct rt_spsc_ringbuffer *rb, rt_size_t length);
+rt_size_t rt_spsc_ringbuffer_get(struct rt_spsc_ringbuffer *rb, rt_uint8_t *ptr, rt_size_t length);
+
+/**
+ * Multiple producers, single consumer record queue.
+ *
+ * Producers reserve a contiguous record by compare-and-swap, fill it in place
+ * and commit it, no producer ever waits for another one. The consumer takes
+ * the records in reservation order and stops at the first one which is not
+ * committed yet. Each record costs a header of sizeof(rt_atomic_t) and is
+ * aligned to it, so is the pool.
+ */
+struct rt_mpsc_ringbuffer
+{
+    rt_uint8_t *buffer_ptr;
+    rt_size_t buffer_size;
+
+    /* producers */
+    rt_align(RT_CPU_CACHE_LINE_SZ) rt_atomic_t head;
+
+    /* consumer */
+    rt_align(RT_CPU_CACHE_LINE_SZ) rt_atomic_t tail;
+};
+
+void rt_mpsc_ringbuffer_init(struct rt_mpsc_ringbuffer *rb, rt_uint8_t *pool, rt_size_t size);
+
+/* producer side */
+void *rt_mpsc_ringbuffer_reserve(struct rt_mpsc_ringbuffer *rb, rt_size_t length);
+void rt_mpsc_ringbuffer_commit(struct rt_mpsc_ringbuffer *rb, void *record);
+void rt_mpsc_ringbuffer_discard(struct rt_mpsc_ringbuffer *rb, void *record);
+rt_size_t rt_mpsc_ringbuffer_put(struct rt_mpsc_ringbuffer *rb, const void *ptr, rt_size_t length);
+
+/* consumer side */
+void *rt_mpsc_ringbuffer_peek(struct rt_mpsc_ringbuffer *rb, rt_size_t *length);
+void rt_mpsc_ringbuffer_consume(struct rt_mpsc_ringbuffer *rb);
+rt_size_t rt_mpsc_ringbuffer_get(struct rt_mpsc_ringbuffer *rb, void *ptr, rt_size_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -5,6 +5,7 @@
  *
  * Change Logs:
  * Date           Author       Notes
+ * 2026-10-17     agent        add rt_pipe_is_fops()
  */
 
 #ifndef PIPE_H__
@@ -47,5 +48,8 @@ rt_ssize_t rt_pipe_write(rt_device_t device, rt_off_t pos, const void *buffer, r
 rt_err_t rt_pipe_control(rt_device_t dev, int cmd, void *args);
 rt_err_t rt_pipe_close(rt_device_t device);
 int rt_pipe_delete(const char *name);
+#if defined(RT_USING_POSIX_DEVIO) && defined(RT_USING_POSIX_PIPE)
+rt_bool_t rt_pipe_is_fops(const void *fops);
+#endif
 
 #endif /* PIPE_H__ */
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ */
+#ifndef SOFTIRQ_H__
+#define SOFTIRQ_H__
+
+#include <rtdef.h>
+#include <rtconfig.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef RT_USING_SOFTIRQ
+
+/*
+ * Per-CPU deferred work.
+ *
+ * A raised vector is marked pending in the bitmap of the current CPU with
+ * one atomic operation, no lock is taken, so it may be raised from any ISR.
+ * The pending vectors run in the order of their number when the outermost
+ * interrupt leaves, or in the softirq thread of the CPU when raised from a
+ * thread or when the budget of the interrupt exit is exhausted. A vector
+ * never runs on two contexts of one CPU at the same time, the handlers of
+ * the interrupt exit are in the interrupt context and must never block.
+ */
+enum rt_softirq_nr
+{
+    RT_SOFTIRQ_HI = 0,                  /* high priority tasklets */
+    RT_SOFTIRQ_NET_TX,
+    RT_SOFTIRQ_NET_RX,
+    RT_SOFTIRQ_BLOCK,
+    RT_SOFTIRQ_TASKLET,                 /* normal priority tasklets */
+
+    RT_SOFTIRQ_MAX,
+};
+
+typedef void (*rt_softirq_handler_t)(void);
+
+struct rt_softirq_stat
+{
+    rt_uint32_t raised;                 /* times marked pending from clear */
+    rt_uint32_t runs;                   /* times the handler ran */
+    rt_uint64_t latency_total_us;       /* raise to run latency */
+    rt_uint32_t latency_max_us;
+};
+
+enum
+{
+    RT_TASKLET_STATE_SCHED   = 0x0001,  /* Tasklet queued on a CPU */
+    RT_TASKLET_STATE_RUN     = 0x0002,  /* Tasklet running */
+};
+
+/*
+ * Tasklets are run by the HI and TASKLET vectors on the CPU that scheduled
+ * them. A tasklet is queued once however many times it is scheduled before
+ * it runs, and never runs on two CPUs at the same time.
+ */
+struct rt_tasklet
+{
+    struct rt_tasklet *next;
+    rt_atomic_t state;
+
+    void (*func)(struct rt_tasklet *tasklet, void *data);
+    void *data;
+};
+
+rt_err_t rt_softirq_register(enum rt_softirq_nr nr, rt_softirq_handler_t handler);
+void rt_softirq_raise(enum rt_softirq_nr nr);
+rt_bool_t rt_softirq_pending(void);
+#ifdef RT_SOFTIRQ_ON_IRQ_EXIT
+void rt_softirq_irq_exit(void);
+#endif
+#ifdef RT_SOFTIRQ_STATS
+rt_err_t rt_softirq_get_stat(int cpu, enum rt_softirq_nr nr, struct rt_softirq_stat *stat);
+#endif
+
+void rt_tasklet_init(struct rt_tasklet *tasklet,
+        void (*func)(struct rt_tasklet *tasklet, void *data), void *data);
+void rt_tasklet_schedule(struct rt_tasklet *tasklet);
+void rt_tasklet_hi_schedule(struct rt_tasklet *tasklet);
+void rt_tasklet_kill(struct rt_tasklet *tasklet);
+
+#endif /* RT_USING_SOFTIRQ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SOFTIRQ_H__ */
@@ -7,6 +7,7 @@
  * Date           Author       Notes
  * 2021-08-01     Meco Man     remove rt_delayed_work_init() and rt_delayed_work structure
  * 2021-08-14     Jackistang   add comments for rt_work_init()
+ * 2026-10-17     agent        add concurrency managed worker pools
  */
 #ifndef WORKQUEUE_H__
 #define WORKQUEUE_H__
@@ -32,6 +33,17 @@ enum
     RT_WORK_TYPE_DELAYED     = 0x0001,
 };
 
+/**
+ * workqueue flag definitions
+ */
+enum
+{
+    RT_WORKQUEUE_FLAG_PERCPU  = 0x0001,     /* A worker pool per CPU */
+    RT_WORKQUEUE_FLAG_UNBOUND = 0x0002,     /* A worker pool for all CPUs */
+    RT_WORKQUEUE_FLAG_POOL    = 0x0100,     /* Internal: the worker pool */
+    RT_WORKQUEUE_FLAG_DYING   = 0x0200,     /* Internal: the worker pool is destroying */
+};
+
 /* workqueue implementation */
 struct rt_workqueue
 {
@@ -42,6 +54,24 @@ struct rt_workqueue
     struct rt_semaphore sem;
     rt_thread_t    work_thread;
     struct rt_spinlock spinlock;
+
+#ifdef RT_WORKQUEUE_USING_POOL
+    rt_uint16_t    flags;
+    rt_uint16_t    nr_pools;
+    struct rt_workqueue *pools;   /* worker pools of the concurrency managed workqueue */
+
+    /* worker pool */
+    rt_list_t      idle_workers;
+    rt_list_t      busy_workers;
+    rt_uint16_t    nr_workers;
+    rt_uint16_t    nr_idle;
+    rt_uint16_t    nr_busy;
+    rt_uint16_t    max_active;    /* limit of the busy workers */
+    rt_int16_t     cpu;           /* bound CPU, -1 if unbound */
+    rt_uint16_t    stack_size;
+    rt_uint8_t     priority;
+    char           name[RT_NAME_MAX];
+#endif /* RT_WORKQUEUE_USING_POOL */
 };
 
 struct rt_work
@@ -62,6 +92,10 @@ struct rt_work
  */
 void rt_work_init(struct rt_work *work, void (*work_func)(struct rt_work *work, void *work_data), void *work_data);
 struct rt_workqueue *rt_workqueue_create(const char *name, rt_uint16_t stack_size, rt_uint8_t priority);
+#ifdef RT_WORKQUEUE_USING_POOL
+struct rt_workqueue *rt_workqueue_create_pool(const char *name, rt_uint16_t stack_size, rt_uint8_t priority,
+                                              rt_uint16_t flags, rt_uint16_t max_active);
+#endif
 rt_err_t rt_workqueue_destroy(struct rt_workqueue *queue);
 rt_err_t rt_workqueue_dowork(struct rt_workqueue *queue, struct rt_work *work);
 rt_err_t rt_workqueue_submit_work(struct rt_workqueue *queue, struct rt_work *work, rt_tick_t ticks);
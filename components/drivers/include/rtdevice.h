@@ -24,9 +24,11 @@
 #include <drivers/classes/net.h>
 
 #include "ipc/ringbuffer.h"
+#include "ipc/lockfree_ringbuffer.h"
 #include "ipc/completion.h"
 #include "ipc/dataqueue.h"
 #include "ipc/workqueue.h"
+#include "ipc/softirq.h"
 #include "ipc/condvar.h"
 #include "ipc/waitqueue.h"
 #include "ipc/pipe.h"
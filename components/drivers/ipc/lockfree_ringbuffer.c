@@ -0,0 +1,513 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ */
+
+#include <rtdevice.h>
+#include <string.h>
+
+#define IS_POWER_OF_TWO(x)  ((x) != 0 && ((x) & ((x) - 1)) == 0)
+
+/**
+ * @brief Initialize the single producer single consumer ring buffer.
+ *
+ * @param rb        A pointer to the ring buffer object.
+ * @param pool      A pointer to the buffer.
+ * @param size      The size of the buffer in bytes, must be a power of two.
+ */
+void rt_spsc_ringbuffer_init(struct rt_spsc_ringbuffer *rb, rt_uint8_t *pool, rt_size_t size)
+{
+    RT_ASSERT(rb != RT_NULL);
+    RT_ASSERT(IS_POWER_OF_TWO(size));
+
+    rb->buffer_ptr = pool;
+    rb->buffer_mask = size - 1;
+    rt_spsc_ringbuffer_reset(rb);
+}
+RTM_EXPORT(rt_spsc_ringbuffer_init);
+
+/**
+ * @brief Reset the ring buffer, neither side may be working on it.
+ *
+ * @param rb        A pointer to the ring buffer object.
+ */
+void rt_spsc_ringbuffer_reset(struct rt_spsc_ringbuffer *rb)
+{
+    RT_ASSERT(rb != RT_NULL);
+
+    rt_atomic_store(&rb->head, 0);
+    rt_atomic_store(&rb->tail, 0);
+    rb->cached_head = 0;
+    rb->cached_tail = 0;
+}
+RTM_EXPORT(rt_spsc_ringbuffer_reset);
+
+/**
+ * @brief Get the size of data in the ring buffer.
+ *
+ * @param rb        A pointer to the ring buffer object.
+ *
+ * @return Return the size of data in bytes.
+ */
+rt_size_t rt_spsc_ringbuffer_data_len(struct rt_spsc_ringbuffer *rb)
+{
+    rt_size_t tail = rt_atomic_load(&rb->tail);
+
+    return (rt_size_t)rt_atomic_load(&rb->head) - tail;
+}
+RTM_EXPORT(rt_spsc_ringbuffer_data_len);
+
+/**
+ * @brief Get the size of free space in the ring buffer.
+ *
+ * @param rb        A pointer to the ring buffer object.
+ *
+ * @return Return the size of free space in bytes.
+ */
+rt_size_t rt_spsc_ringbuffer_space_len(struct rt_spsc_ringbuffer *rb)
+{
+    return rb->buffer_mask + 1 - rt_spsc_ringbuffer_data_len(rb);
+}
+RTM_EXPORT(rt_spsc_ringbuffer_space_len);
+
+/**
+ * @brief Reserve contiguous space to be written in place by the producer.
+ *
+ * @param rb            A pointer to the ring buffer object.
+ * @param ptr           Return the start of the space.
+ * @param length        The size wanted in bytes.
+ *
+ * @return Return the size of space reserved, which may be less than length
+ *         when the buffer is nearly full or the space wraps around.
+ */
+rt_size_t rt_spsc_ringbuffer_reserve(struct rt_spsc_ringbuffer *rb, rt_uint8_t **ptr, rt_size_t length)
+{
+    rt_size_t head, space, offset;
+
+    RT_ASSERT(rb != RT_NULL);
+
+    head = rt_atomic_load(&rb->head);
+    space = rb->buffer_mask + 1 - (head - rb->cached_tail);
+    if (space < length)
+    {
+        /* only look at the consumer when the cached one is not enough */
+        rb->cached_tail = rt_atomic_load(&rb->tail);
+        space = rb->buffer_mask + 1 - (head - rb->cached_tail);
+    }
+
+    offset = head & rb->buffer_mask;
+    if (space > rb->buffer_mask + 1 - offset)
+    {
+        space = rb->buffer_mask + 1 - offset;
+    }
+
+    *ptr = &rb->buffer_ptr[offset];
+
+    return length < space ? length : space;
+}
+RTM_EXPORT(rt_spsc_ringbuffer_reserve);
+
+/**
+ * @brief Publish the data written in the reserved space to the consumer.
+ *
+ * @param rb            A pointer to the ring buffer object.
+ * @param length        The size of data in bytes, no more than reserved.
+ */
+void rt_spsc_ringbuffer_commit(struct rt_spsc_ringbuffer *rb, rt_size_t length)
+{
+    RT_ASSERT(rb != RT_NULL);
+
+    rt_atomic_store(&rb->head, (rt_size_t)rt_atomic_load(&rb->head) + length);
+}
+RTM_EXPORT(rt_spsc_ringbuffer_commit);
+
+/**
+ * @brief Put a block of data into the ring buffer. If the capacity of ring buffer is insufficient, it will discard out-of-range data.
+ *
+ * @param rb            A pointer to the ring buffer object.
+ * @param ptr           A pointer to the data buffer.
+ * @param length        The size of data in bytes.
+ *
+ * @return Return the data size we put into the ring buffer.
+ */
+rt_size_t rt_spsc_ringbuffer_put(struct rt_spsc_ringbuffer *rb, const rt_uint8_t *ptr, rt_size_t length)
+{
+    rt_size_t head, space, offset, size;
+
+    RT_ASSERT(rb != RT_NULL);
+
+    head = rt_atomic_load(&rb->head);
+    space = rb->buffer_mask + 1 - (head - rb->cached_tail);
+    if (space < length)
+    {
+        rb->cached_tail = rt_atomic_load(&rb->tail);
+        space = rb->buffer_mask + 1 - (head - rb->cached_tail);
+    }
+
+    /* drop some data */
+    if (space < length)
+    {
+        length = space;
+    }
+    if (length == 0)
+    {
+        return 0;
+    }
+
+    offset = head & rb->buffer_mask;
+    size = rb->buffer_mask + 1 - offset;
+    if (size > length)
+    {
+        size = length;
+    }
+
+    rt_memcpy(&rb->buffer_ptr[offset], ptr, size);
+    rt_memcpy(&rb->buffer_ptr[0], ptr + size, length - size);
+
+    /* the data must be there before the consumer sees the new head */
+    rt_atomic_store(&rb->head, head + length);
+
+    return length;
+}
+RTM_EXPORT(rt_spsc_ringbuffer_put);
+
+/**
+ * @brief Get the contiguous data to be read in place by the consumer.
+ *
+ * @param rb            A pointer to the ring buffer object.
+ * @param ptr           Return the start of the data.
+ *
+ * @return Return the size of contiguous data, which may be less than the
+ *         data length when the data wraps around.
+ */
+rt_size_t rt_spsc_ringbuffer_peek(struct rt_spsc_ringbuffer *rb, rt_uint8_t **ptr)
+{
+    rt_size_t tail, size, offset;
+
+    RT_ASSERT(rb != RT_NULL);
+
+    tail = rt_atomic_load(&rb->tail);
+    if (rb->cached_head == tail)
+    {
+        rb->cached_head = rt_atomic_load(&rb->head);
+    }
+
+    size = rb->cached_head - tail;
+    offset = tail & rb->buffer_mask;
+    if (size > rb->buffer_mask + 1 - offset)
+    {
+        size = rb->buffer_mask + 1 - offset;
+    }
+
+    *ptr = &rb->buffer_ptr[offset];
+
+    return size;
+}
+RTM_EXPORT(rt_spsc_ringbuffer_peek);
+
+/**
+ * @brief Give the space of the data read in place back to the producer.
+ *
+ * @param rb            A pointer to the ring buffer object.
+ * @param length        The size of data in bytes, no more than peeked.
+ */
+void rt_spsc_ringbuffer_consume(struct rt_spsc_ringbuffer *rb, rt_size_t length)
+{
+    RT_ASSERT(rb != RT_NULL);
+
+    rt_atomic_store(&rb->tail, (rt_size_t)rt_atomic_load(&rb->tail) + length);
+}
+RTM_EXPORT(rt_spsc_ringbuffer_consume);
+
+/**
+ * @brief Get data from the ring buffer.
+ *
+ * @param rb            A pointer to the ring buffer.
+ * @param ptr           A pointer to the data buffer.
+ * @param length        The size of the data we want to read from the ring buffer.
+ *
+ * @return Return the data size we read from the ring buffer.
+ */
+rt_size_t rt_spsc_ringbuffer_get(struct rt_spsc_ringbuffer *rb, rt_uint8_t *ptr, rt_size_t length)
+{
+    rt_size_t tail, data, offset, size;
+
+    RT_ASSERT(rb != RT_NULL);
+
+    tail = rt_atomic_load(&rb->tail);
+    data = rb->cached_head - tail;
+    if (data < length)
+    {
+        rb->cached_head = rt_atomic_load(&rb->head);
+        data = rb->cached_head - tail;
+    }
+
+    if (data < length)
+    {
+        length = data;
+    }
+    if (length == 0)
+    {
+        return 0;
+    }
+
+    offset = tail & rb->buffer_mask;
+    size = rb->buffer_mask + 1 - offset;
+    if (size > length)
+    {
+        size = length;
+    }
+
+    rt_memcpy(ptr, &rb->buffer_ptr[offset], size);
+    rt_memcpy(ptr + size, &rb->buffer_ptr[0], length - size);
+
+    /* the data must be copied out before the producer sees the new tail */
+    rt_atomic_store(&rb->tail, tail + length);
+
+    return length;
+}
+RTM_EXPORT(rt_spsc_ringbuffer_get);
+
+/*
+ * A record is a header followed by the data, the header is 0 until the
+ * space is reserved, then holds the length and becomes ready when it is
+ * committed. The consumer zeroes a record when it's consumed, as any word
+ * of it may be the header of a later record.
+ */
+#define MPSC_HDR_SIZE       sizeof(rt_atomic_t)
+#define MPSC_HDR_READY      0x1
+#define MPSC_HDR_DISCARD    0x2
+#define MPSC_HDR_SHIFT      2
+#define MPSC_REC_SIZE(len)  (MPSC_HDR_SIZE + RT_ALIGN((len), MPSC_HDR_SIZE))
+
+rt_inline rt_atomic_t *_mpsc_header(struct rt_mpsc_ringbuffer *rb, rt_size_t pos)
+{
+    return (rt_atomic_t *)&rb->buffer_ptr[pos & (rb->buffer_size - 1)];
+}
+
+/**
+ * @brief Initialize the multiple producers single consumer ring buffer.
+ *
+ * @param rb        A pointer to the ring buffer object.
+ * @param pool      A pointer to the buffer, aligned to sizeof(rt_atomic_t).
+ * @param size      The size of the buffer in bytes, must be a power of two.
+ */
+void rt_mpsc_ringbuffer_init(struct rt_mpsc_ringbuffer *rb, rt_uint8_t *pool, rt_size_t size)
+{
+    RT_ASSERT(rb != RT_NULL);
+    RT_ASSERT(IS_POWER_OF_TWO(size) && size >= 2 * MPSC_HDR_SIZE);
+    RT_ASSERT(((rt_ubase_t)pool & (MPSC_HDR_SIZE - 1)) == 0);
+
+    rt_memset(pool, 0, size);
+    rb->buffer_ptr = pool;
+    rb->buffer_size = size;
+    rt_atomic_store(&rb->head, 0);
+    rt_atomic_store(&rb->tail, 0);
+}
+RTM_EXPORT(rt_mpsc_ringbuffer_init);
+
+/**
+ * @brief Reserve a record to be written in place, it's safe to be called
+ *        by several threads and ISRs at the same time.
+ *
+ * @param rb            A pointer to the ring buffer object.
+ * @param length        The size of the record in bytes.
+ *
+ * @return Return the record, or RT_NULL if there is no enough space.
+ */
+void *rt_mpsc_ringbuffer_reserve(struct rt_mpsc_ringbuffer *rb, rt_size_t length)
+{
+    rt_atomic_t head;
+    rt_size_t tail, offset, pad, total;
+
+    RT_ASSERT(rb != RT_NULL);
+
+    total = MPSC_REC_SIZE(length);
+    if (length == 0 || total > rb->buffer_size)
+    {
+        return RT_NULL;
+    }
+
+    head = rt_atomic_load(&rb->head);
+    do
+    {
+        tail = rt_atomic_load(&rb->tail);
+
+        /* a record never wraps, skip the end of buffer with a padding */
+        offset = (rt_size_t)head & (rb->buffer_size - 1);
+        pad = rb->buffer_size - offset < total ? rb->buffer_size - offset : 0;
+
+        if ((rt_size_t)head + pad + total - tail > rb->buffer_size)
+        {
+            return RT_NULL;
+        }
+    } while (!rt_atomic_compare_exchange_strong(&rb->head, &head, head + pad + total));
+
+    if (pad)
+    {
+        rt_atomic_store(_mpsc_header(rb, head),
+                        ((pad - MPSC_HDR_SIZE) << MPSC_HDR_SHIFT) | MPSC_HDR_DISCARD | MPSC_HDR_READY);
+        head += pad;
+    }
+    rt_atomic_store(_mpsc_header(rb, head), length << MPSC_HDR_SHIFT);
+
+    return (rt_uint8_t *)_mpsc_header(rb, head) + MPSC_HDR_SIZE;
+}
+RTM_EXPORT(rt_mpsc_ringbuffer_reserve);
+
+/**
+ * @brief Publish a reserved record to the consumer.
+ *
+ * @param rb            A pointer to the ring buffer object.
+ * @param record        The record returned by rt_mpsc_ringbuffer_reserve.
+ */
+void rt_mpsc_ringbuffer_commit(struct rt_mpsc_ringbuffer *rb, void *record)
+{
+    RT_ASSERT(rb != RT_NULL && record != RT_NULL);
+
+    rt_atomic_or((rt_atomic_t *)((rt_uint8_t *)record - MPSC_HDR_SIZE), MPSC_HDR_READY);
+}
+RTM_EXPORT(rt_mpsc_ringbuffer_commit);
+
+/**
+ * @brief Give up a reserved record, the consumer will skip it.
+ *
+ * @param rb            A pointer to the ring buffer object.
+ * @param record        The record returned by rt_mpsc_ringbuffer_reserve.
+ */
+void rt_mpsc_ringbuffer_discard(struct rt_mpsc_ringbuffer *rb, void *record)
+{
+    RT_ASSERT(rb != RT_NULL && record != RT_NULL);
+
+    rt_atomic_or((rt_atomic_t *)((rt_uint8_t *)record - MPSC_HDR_SIZE), MPSC_HDR_DISCARD | MPSC_HDR_READY);
+}
+RTM_EXPORT(rt_mpsc_ringbuffer_discard);
+
+/**
+ * @brief Put a block of data into the ring buffer as one record.
+ *
+ * @param rb            A pointer to the ring buffer object.
+ * @param ptr           A pointer to the data buffer.
+ * @param length        The size of data in bytes.
+ *
+ * @return Return length, or 0 if there is no enough space.
+ */
+rt_size_t rt_mpsc_ringbuffer_put(struct rt_mpsc_ringbuffer *rb, const void *ptr, rt_size_t length)
+{
+    void *record;
+
+    record = rt_mpsc_ringbuffer_reserve(rb, length);
+    if (record == RT_NULL)
+    {
+        return 0;
+    }
+
+    rt_memcpy(record, ptr, length);
+    rt_mpsc_ringbuffer_commit(rb, record);
+
+    return length;
+}
+RTM_EXPORT(rt_mpsc_ringbuffer_put);
+
+/**
+ * @brief Get the oldest record to be read in place by the consumer.
+ *
+ * @param rb            A pointer to the ring buffer object.
+ * @param length        Return the size of the record in bytes.
+ *
+ * @return Return the record, or RT_NULL if it's empty or the oldest record
+ *         is not committed yet.
+ */
+void *rt_mpsc_ringbuffer_peek(struct rt_mpsc_ringbuffer *rb, rt_size_t *length)
+{
+    rt_atomic_t *header, value;
+    rt_size_t tail, size;
+
+    RT_ASSERT(rb != RT_NULL);
+
+    tail = rt_atomic_load(&rb->tail);
+    while (tail != (rt_size_t)rt_atomic_load(&rb->head))
+    {
+        header = _mpsc_header(rb, tail);
+        value = rt_atomic_load(header);
+        if (!(value & MPSC_HDR_READY))
+        {
+            break;
+        }
+
+        size = (rt_size_t)value >> MPSC_HDR_SHIFT;
+        if (!(value & MPSC_HDR_DISCARD))
+        {
+            if (length)
+            {
+                *length = size;
+            }
+            return (rt_uint8_t *)header + MPSC_HDR_SIZE;
+        }
+
+        /* skip the padding and the discarded ones */
+        rt_memset(header, 0, MPSC_REC_SIZE(size));
+        tail += MPSC_REC_SIZE(size);
+        rt_atomic_store(&rb->tail, tail);
+    }
+
+    return RT_NULL;
+}
+RTM_EXPORT(rt_mpsc_ringbuffer_peek);
+
+/**
+ * @brief Release the record returned by rt_mpsc_ringbuffer_peek.
+ *
+ * @param rb            A pointer to the ring buffer object.
+ */
+void rt_mpsc_ringbuffer_consume(struct rt_mpsc_ringbuffer *rb)
+{
+    rt_atomic_t *header;
+    rt_size_t tail, total;
+
+    RT_ASSERT(rb != RT_NULL);
+
+    tail = rt_atomic_load(&rb->tail);
+    header = _mpsc_header(rb, tail);
+    total = MPSC_REC_SIZE((rt_size_t)rt_atomic_load(header) >> MPSC_HDR_SHIFT);
+
+    rt_memset(header, 0, total);
+    rt_atomic_store(&rb->tail, tail + total);
+}
+RTM_EXPORT(rt_mpsc_ringbuffer_consume);
+
+/**
+ * @brief Get the oldest record from the ring buffer.
+ *
+ * @param rb            A pointer to the ring buffer object.
+ * @param ptr           A pointer to the data buffer.
+ * @param length        The size of the data buffer, a longer record is truncated.
+ *
+ * @return Return the data size we read from the ring buffer.
+ */
+rt_size_t rt_mpsc_ringbuffer_get(struct rt_mpsc_ringbuffer *rb, void *ptr, rt_size_t length)
+{
+    void *record;
+    rt_size_t size;
+
+    record = rt_mpsc_ringbuffer_peek(rb, &size);
+    if (record == RT_NULL)
+    {
+        return 0;
+    }
+
+    if (size < length)
+    {
+        length = size;
+    }
+    rt_memcpy(ptr, record, length);
+    rt_mpsc_ringbuffer_consume(rb);
+
+    return length;
+}
+RTM_EXPORT(rt_mpsc_ringbuffer_get);
@@ -10,6 +10,7 @@
  * 2023-06-28     shell        return POLLHUP when writer closed its channel on poll()
  *                             fix flag test on pipe_fops_open()
  * 2023-12-02     shell        Make read pipe operation interruptable.
+ * 2026-10-17     agent        add rt_pipe_is_fops()
  */
 #include <rthw.h>
 #include <rtdevice.h>
@@ -409,6 +410,19 @@ static const struct dfs_file_ops pipe_fops =
     .write = pipe_fops_write,
     .poll  = pipe_fops_poll,
 };
+
+/**
+ * @brief    This function will check whether the file operations belong to a pipe.
+ *           The pipe copies the data with CPU, so its callers may pass the user buffer directly.
+ *
+ * @param    fops is the file operations of the file.
+ *
+ * @return   Return RT_TRUE if fops is the file operations of pipe, otherwise RT_FALSE.
+ */
+rt_bool_t rt_pipe_is_fops(const void *fops)
+{
+    return fops == (const void *)&pipe_fops;
+}
 #endif /* defined(RT_USING_POSIX_DEVIO) && defined(RT_USING_POSIX_PIPE) */
 
 /**
@@ -0,0 +1,502 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ * 2026-10-17     agent        run the vectors left on interrupt exit in the thread
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+#include <rtdevice.h>
+
+#define DBG_TAG "ipc.softirq"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+#ifdef RT_USING_SOFTIRQ
+
+#define TASKLET_HI      0
+#define TASKLET_NORMAL  1
+
+struct rt_softirq_cpu
+{
+    rt_align(RT_CPU_CACHE_LINE_SZ) rt_atomic_t pending;
+
+    /* only touched by the contexts of its own CPU */
+    rt_bool_t running;
+    rt_thread_t thread;
+    struct rt_tasklet *tasklets[2];
+
+#ifdef RT_SOFTIRQ_STATS
+    rt_uint64_t raise_stamp[RT_SOFTIRQ_MAX];
+    struct rt_softirq_stat stat[RT_SOFTIRQ_MAX];
+#endif
+};
+
+static struct rt_softirq_cpu _softirq_cpus[RT_CPUS_NR];
+static rt_softirq_handler_t _softirq_handlers[RT_SOFTIRQ_MAX];
+
+rt_inline struct rt_softirq_cpu *_softirq_cpu_self(void)
+{
+    return &_softirq_cpus[rt_cpu_get_id()];
+}
+
+static void _softirq_wakeup(struct rt_softirq_cpu *sc)
+{
+    if (sc->thread)
+    {
+        rt_thread_resume(sc->thread);
+    }
+}
+
+/* The local interrupt must be disabled */
+static void _softirq_raise_locked(struct rt_softirq_cpu *sc, enum rt_softirq_nr nr)
+{
+    rt_ubase_t bit = 1UL << nr;
+
+    if (rt_atomic_or(&sc->pending, bit) & bit)
+    {
+        return;
+    }
+
+#ifdef RT_SOFTIRQ_STATS
+    sc->raise_stamp[nr] = clock_cpu_gettime();
+    ++sc->stat[nr].raised;
+#endif
+
+#ifdef RT_SOFTIRQ_ON_IRQ_EXIT
+    /* The interrupt exit will wake the thread up once for all */
+    if (rt_interrupt_get_nest())
+    {
+        return;
+    }
+#endif
+
+    if (!sc->running)
+    {
+        _softirq_wakeup(sc);
+    }
+}
+
+/**
+ * @brief Register the handler of a softirq vector.
+ *
+ * @param nr is the vector number.
+ * @param handler is the handler, it runs on the CPU that raised the vector.
+ *
+ * @return Return the operation status. When the return value is RT_EOK, the
+ *         operation is successful. If the vector is used, -RT_EBUSY is returned.
+ */
+rt_err_t rt_softirq_register(enum rt_softirq_nr nr, rt_softirq_handler_t handler)
+{
+    RT_ASSERT(nr < RT_SOFTIRQ_MAX);
+    RT_ASSERT(handler != RT_NULL);
+
+    if (_softirq_handlers[nr] && _softirq_handlers[nr] != handler)
+    {
+        return -RT_EBUSY;
+    }
+
+    _softirq_handlers[nr] = handler;
+
+    return RT_EOK;
+}
+
+/**
+ * @brief Mark a softirq vector pending on the current CPU.
+ *
+ * @note It takes no lock and may be called from any ISR.
+ *
+ * @param nr is the vector number.
+ */
+void rt_softirq_raise(enum rt_softirq_nr nr)
+{
+    rt_base_t level;
+
+    RT_ASSERT(nr < RT_SOFTIRQ_MAX);
+
+    level = rt_hw_local_irq_disable();
+    _softirq_raise_locked(_softirq_cpu_self(), nr);
+    rt_hw_local_irq_enable(level);
+}
+
+/**
+ * @brief Check whether any softirq vector is pending on the current CPU.
+ *
+ * @return Return RT_TRUE if pending.
+ */
+rt_bool_t rt_softirq_pending(void)
+{
+    return rt_atomic_load(&_softirq_cpu_self()->pending) != 0;
+}
+
+#ifdef RT_SOFTIRQ_STATS
+static void _softirq_account(struct rt_softirq_cpu *sc, rt_ubase_t pending)
+{
+    rt_uint32_t us;
+    rt_uint64_t now = clock_cpu_gettime();
+
+    for (int nr = 0; pending; ++nr, pending >>= 1)
+    {
+        if (!(pending & 1))
+        {
+            continue;
+        }
+
+        us = (rt_uint32_t)clock_cpu_microsecond(now - sc->raise_stamp[nr]);
+
+        ++sc->stat[nr].runs;
+        sc->stat[nr].latency_total_us += us;
+
+        if (us > sc->stat[nr].latency_max_us)
+        {
+            sc->stat[nr].latency_max_us = us;
+        }
+    }
+}
+#endif /* RT_SOFTIRQ_STATS */
+
+/*
+ * Run the pending vectors of the current CPU for at most
+ * RT_SOFTIRQ_RESTART_MAX passes, return RT_TRUE if some are left.
+ */
+static rt_bool_t _softirq_run(struct rt_softirq_cpu *sc)
+{
+    rt_base_t level;
+    rt_ubase_t pending;
+    int restart = RT_SOFTIRQ_RESTART_MAX;
+
+    sc->running = RT_TRUE;
+
+    while (restart-- > 0)
+    {
+        level = rt_hw_local_irq_disable();
+        pending = rt_atomic_exchange(&sc->pending, 0);
+    #ifdef RT_SOFTIRQ_STATS
+        _softirq_account(sc, pending);
+    #endif
+        rt_hw_local_irq_enable(level);
+
+        if (!pending)
+        {
+            break;
+        }
+
+        for (int nr = 0; pending; ++nr, pending >>= 1)
+        {
+            if ((pending & 1) && _softirq_handlers[nr])
+            {
+                _softirq_handlers[nr]();
+            }
+        }
+    }
+
+    sc->running = RT_FALSE;
+
+    return rt_atomic_load(&sc->pending) != 0;
+}
+
+#ifdef RT_SOFTIRQ_ON_IRQ_EXIT
+/**
+ * @brief Hand the vectors raised by the interrupts to the softirq thread
+ *        when the outermost interrupt leaves.
+ *
+ * @note It is called by rt_interrupt_leave() with the local interrupt
+ *       disabled. The vectors are not run here, since there is no portable
+ *       way to unmask the local interrupt on the interrupt stack. The thread
+ *       is switched to on the interrupt return if it preempts the one
+ *       interrupted, and runs the vectors with the interrupt enabled.
+ */
+void rt_softirq_irq_exit(void)
+{
+    struct rt_softirq_cpu *sc = _softirq_cpu_self();
+
+    /* The thread of this CPU is interrupted in the vectors */
+    if (!rt_atomic_load(&sc->pending) || sc->running)
+    {
+        return;
+    }
+
+    _softirq_wakeup(sc);
+}
+#endif /* RT_SOFTIRQ_ON_IRQ_EXIT */
+
+static void _softirq_thread_entry(void *parameter)
+{
+    rt_base_t level;
+    struct rt_softirq_cpu *sc = parameter;
+
+    while (1)
+    {
+        level = rt_hw_local_irq_disable();
+
+        if (!rt_atomic_load(&sc->pending))
+        {
+            rt_thread_suspend_with_flag(rt_thread_self(), RT_UNINTERRUPTIBLE);
+
+            /* Enable after suspend so we will not lost any raise */
+            rt_hw_local_irq_enable(level);
+
+            rt_schedule();
+            continue;
+        }
+
+        rt_hw_local_irq_enable(level);
+
+        if (_softirq_run(sc))
+        {
+            /* Budget exhausted, give the same priority threads a chance */
+            rt_thread_yield();
+        }
+    }
+}
+
+/* The local interrupt must be disabled */
+static void _tasklet_queue_locked(struct rt_softirq_cpu *sc, int idx,
+        struct rt_tasklet *tasklet)
+{
+    tasklet->next = sc->tasklets[idx];
+    sc->tasklets[idx] = tasklet;
+
+    _softirq_raise_locked(sc, idx == TASKLET_HI ? RT_SOFTIRQ_HI : RT_SOFTIRQ_TASKLET);
+}
+
+static void _tasklet_action(int idx)
+{
+    rt_base_t level;
+    int budget = RT_SOFTIRQ_TASKLET_BUDGET;
+    struct rt_tasklet *list, *tasklet, *prev = RT_NULL;
+    struct rt_softirq_cpu *sc = _softirq_cpu_self();
+
+    level = rt_hw_local_irq_disable();
+    list = sc->tasklets[idx];
+    sc->tasklets[idx] = RT_NULL;
+    rt_hw_local_irq_enable(level);
+
+    /* Queued in LIFO, run in FIFO */
+    while (list)
+    {
+        tasklet = list;
+        list = list->next;
+        tasklet->next = prev;
+        prev = tasklet;
+    }
+    list = prev;
+
+    while (list)
+    {
+        tasklet = list;
+        list = list->next;
+
+        /* Out of budget, or running on the other CPU */
+        if (budget <= 0 ||
+            (rt_atomic_or(&tasklet->state, RT_TASKLET_STATE_RUN) & RT_TASKLET_STATE_RUN))
+        {
+            level = rt_hw_local_irq_disable();
+            _tasklet_queue_locked(sc, idx, tasklet);
+            rt_hw_local_irq_enable(level);
+            continue;
+        }
+
+        --budget;
+
+        /* It may be scheduled again by itself */
+        rt_atomic_and(&tasklet->state, ~RT_TASKLET_STATE_SCHED);
+        tasklet->func(tasklet, tasklet->data);
+        rt_atomic_and(&tasklet->state, ~RT_TASKLET_STATE_RUN);
+    }
+}
+
+static void _tasklet_hi_action(void)
+{
+    _tasklet_action(TASKLET_HI);
+}
+
+static void _tasklet_normal_action(void)
+{
+    _tasklet_action(TASKLET_NORMAL);
+}
+
+/**
+ * @brief Initialize a tasklet.
+ *
+ * @param tasklet is the tasklet.
+ * @param func is the callback function, it must never block.
+ * @param data is the parameter of the callback function.
+ */
+void rt_tasklet_init(struct rt_tasklet *tasklet,
+        void (*func)(struct rt_tasklet *tasklet, void *data), void *data)
+{
+    RT_ASSERT(tasklet != RT_NULL);
+    RT_ASSERT(func != RT_NULL);
+
+    tasklet->next = RT_NULL;
+    rt_atomic_store(&tasklet->state, 0);
+    tasklet->func = func;
+    tasklet->data = data;
+}
+
+static void _tasklet_schedule(struct rt_tasklet *tasklet, int idx)
+{
+    rt_base_t level;
+
+    RT_ASSERT(tasklet != RT_NULL);
+
+    /* Queued already */
+    if (rt_atomic_or(&tasklet->state, RT_TASKLET_STATE_SCHED) & RT_TASKLET_STATE_SCHED)
+    {
+        return;
+    }
+
+    level = rt_hw_local_irq_disable();
+    _tasklet_queue_locked(_softirq_cpu_self(), idx, tasklet);
+    rt_hw_local_irq_enable(level);
+}
+
+/**
+ * @brief Schedule a tasklet on the current CPU.
+ *
+ * @note It takes no lock and may be called from any ISR.
+ *
+ * @param tasklet is the tasklet.
+ */
+void rt_tasklet_schedule(struct rt_tasklet *tasklet)
+{
+    _tasklet_schedule(tasklet, TASKLET_NORMAL);
+}
+
+/**
+ * @brief Schedule a tasklet on the current CPU before the other vectors.
+ *
+ * @note It takes no lock and may be called from any ISR.
+ *
+ * @param tasklet is the tasklet.
+ */
+void rt_tasklet_hi_schedule(struct rt_tasklet *tasklet)
+{
+    _tasklet_schedule(tasklet, TASKLET_HI);
+}
+
+/**
+ * @brief Wait until a tasklet is neither queued nor running.
+ *
+ * @note It must be called in the thread context, the tasklet must not be
+ *       scheduled again by the others meanwhile.
+ *
+ * @param tasklet is the tasklet.
+ */
+void rt_tasklet_kill(struct rt_tasklet *tasklet)
+{
+    RT_ASSERT(tasklet != RT_NULL);
+    RT_DEBUG_SCHEDULER_AVAILABLE(RT_TRUE);
+
+    while (rt_atomic_or(&tasklet->state, RT_TASKLET_STATE_SCHED) & RT_TASKLET_STATE_SCHED)
+    {
+        do {
+            rt_thread_delay(1);
+        } while (rt_atomic_load(&tasklet->state) & RT_TASKLET_STATE_SCHED);
+    }
+
+    while (rt_atomic_load(&tasklet->state) & RT_TASKLET_STATE_RUN)
+    {
+        rt_thread_delay(1);
+    }
+
+    rt_atomic_and(&tasklet->state, ~RT_TASKLET_STATE_SCHED);
+}
+
+#ifdef RT_SOFTIRQ_STATS
+/**
+ * @brief Get the statistics of a softirq vector on a CPU.
+ *
+ * @param cpu is the CPU id.
+ * @param nr is the vector number.
+ * @param stat is the statistics to fill.
+ *
+ * @return Return the operation status. When the return value is RT_EOK, the
+ *         operation is successful.
+ */
+rt_err_t rt_softirq_get_stat(int cpu, enum rt_softirq_nr nr, struct rt_softirq_stat *stat)
+{
+    if (cpu < 0 || cpu >= RT_CPUS_NR || nr >= RT_SOFTIRQ_MAX || !stat)
+    {
+        return -RT_EINVAL;
+    }
+
+    rt_memcpy(stat, &_softirq_cpus[cpu].stat[nr], sizeof(*stat));
+
+    return RT_EOK;
+}
+
+#if defined(RT_USING_CONSOLE) && defined(RT_USING_MSH)
+static int softirq_stat(int argc, char **argv)
+{
+    struct rt_softirq_stat stat;
+    static const char * const names[RT_SOFTIRQ_MAX] =
+    {
+        [RT_SOFTIRQ_HI] = "HI",
+        [RT_SOFTIRQ_NET_TX] = "NET_TX",
+        [RT_SOFTIRQ_NET_RX] = "NET_RX",
+        [RT_SOFTIRQ_BLOCK] = "BLOCK",
+        [RT_SOFTIRQ_TASKLET] = "TASKLET",
+    };
+
+    for (int cpu = 0; cpu < RT_CPUS_NR; ++cpu)
+    {
+        rt_kprintf("cpu%d:\n", cpu);
+
+        for (int nr = 0; nr < RT_SOFTIRQ_MAX; ++nr)
+        {
+            rt_softirq_get_stat(cpu, nr, &stat);
+
+            rt_kprintf("  %-8s raised %u, runs %u, latency avg %u us, max %u us\n",
+                    names[nr], stat.raised, stat.runs,
+                    stat.runs ? (rt_uint32_t)(stat.latency_total_us / stat.runs) : 0,
+                    stat.latency_max_us);
+        }
+    }
+
+    return 0;
+}
+MSH_CMD_EXPORT(softirq_stat, dump softirq raise and latency statistics);
+#endif /* RT_USING_CONSOLE && RT_USING_MSH */
+#endif /* RT_SOFTIRQ_STATS */
+
+static int rt_softirq_init(void)
+{
+    char name[RT_NAME_MAX];
+    struct rt_softirq_cpu *sc;
+
+    rt_softirq_register(RT_SOFTIRQ_HI, _tasklet_hi_action);
+    rt_softirq_register(RT_SOFTIRQ_TASKLET, _tasklet_normal_action);
+
+    for (int cpu = 0; cpu < RT_CPUS_NR; ++cpu)
+    {
+        sc = &_softirq_cpus[cpu];
+
+        rt_snprintf(name, sizeof(name), "sirq%d", cpu);
+
+        sc->thread = rt_thread_create(name, _softirq_thread_entry, sc,
+                RT_SOFTIRQ_THREAD_STACKSIZE, RT_SOFTIRQ_THREAD_PRIORITY, 10);
+
+        if (!sc->thread)
+        {
+            LOG_E("Create %s thread fail", name);
+            return -RT_ENOMEM;
+        }
+
+    #ifdef RT_USING_SMP
+        rt_thread_control(sc->thread, RT_THREAD_CTRL_BIND_CPU, (void *)(rt_ubase_t)cpu);
+    #endif
+
+        rt_thread_startup(sc->thread);
+    }
+
+    return RT_EOK;
+}
+INIT_PREV_EXPORT(rt_softirq_init);
+#endif /* RT_USING_SOFTIRQ */
@@ -10,6 +10,8 @@
  * 2021-08-14     Jackistang   add comments for function interface
  * 2022-01-16     Meco Man     add rt_work_urgent()
  * 2023-09-15     xqyjlj       perf rt_hw_interrupt_disable/enable
+ * 2026-10-17     agent        add concurrency managed worker pools
+ * 2026-10-17     agent        serialize the pool selecting of a work
  */
 
 #include <rthw.h>
@@ -90,6 +92,355 @@ static void _workqueue_thread_entry(void *parameter)
     }
 }
 
+#ifdef RT_WORKQUEUE_USING_POOL
+#define WORKER_IDLE_MAX 2
+
+struct rt_workqueue_worker
+{
+    rt_list_t list;                 /* in the idle or busy list of the pool */
+    rt_thread_t thread;
+    struct rt_workqueue *pool;
+    struct rt_work *work_current;
+    rt_bool_t busy;
+};
+
+static rt_err_t _pool_create_worker(struct rt_workqueue *pool);
+
+/* Whether a busy worker other than self is runnable, i.e. not blocked */
+static rt_bool_t _pool_has_runnable(struct rt_workqueue *pool, struct rt_workqueue_worker *self)
+{
+    struct rt_workqueue_worker *worker;
+
+    rt_list_for_each_entry(worker, &pool->busy_workers, list)
+    {
+        if (worker != self && !(RT_SCHED_CTX(worker->thread).stat & RT_THREAD_SUSPEND_MASK))
+        {
+            return RT_TRUE;
+        }
+    }
+
+    return RT_FALSE;
+}
+
+/* The first pending work not running on the other workers */
+static struct rt_work *_pool_first_work(struct rt_workqueue *pool, struct rt_workqueue_worker *self)
+{
+    struct rt_work *work;
+    struct rt_workqueue_worker *worker;
+
+    rt_list_for_each_entry(work, &(pool->work_list), list)
+    {
+        rt_bool_t running = RT_FALSE;
+
+        rt_list_for_each_entry(worker, &(pool->busy_workers), list)
+        {
+            if (worker != self && worker->work_current == work)
+            {
+                running = RT_TRUE;
+                break;
+            }
+        }
+
+        if (!running)
+        {
+            return work;
+        }
+    }
+
+    return RT_NULL;
+}
+
+static rt_bool_t _pool_may_start(struct rt_workqueue *pool, struct rt_workqueue_worker *self)
+{
+    if ((pool->flags & RT_WORKQUEUE_FLAG_DYING) || !_pool_first_work(pool, self))
+    {
+        return RT_FALSE;
+    }
+
+    /* keeps its active slot */
+    if (self && self->busy)
+    {
+        return RT_TRUE;
+    }
+
+    if (pool->nr_busy >= pool->max_active)
+    {
+        return RT_FALSE;
+    }
+
+    /* the bound pool runs one worker at a time, unless the others block */
+    return pool->cpu < 0 || !_pool_has_runnable(pool, self);
+}
+
+/* The pool lock must be held */
+static void _pool_kick(struct rt_workqueue *pool)
+{
+    struct rt_workqueue_worker *worker;
+
+    if (pool->nr_idle && _pool_may_start(pool, RT_NULL))
+    {
+        worker = rt_list_first_entry(&(pool->idle_workers), struct rt_workqueue_worker, list);
+        rt_thread_resume(worker->thread);
+    }
+}
+
+static void _pool_worker_entry(void *parameter)
+{
+    rt_base_t level;
+    rt_bool_t spawn;
+    rt_int32_t watchdog;
+    struct rt_work *work;
+    struct rt_workqueue_worker *worker = parameter;
+    struct rt_workqueue *pool = worker->pool;
+
+    while (1)
+    {
+        level = rt_spin_lock_irqsave(&(pool->spinlock));
+
+        if (!_pool_may_start(pool, worker))
+        {
+            if (worker->busy)
+            {
+                /* release the active slot and look again as an idle one */
+                worker->busy = RT_FALSE;
+                rt_list_remove(&(worker->list));
+                rt_list_insert_after(&(pool->idle_workers), &(worker->list));
+                --pool->nr_busy;
+                ++pool->nr_idle;
+                rt_spin_unlock_irqrestore(&(pool->spinlock), level);
+                continue;
+            }
+
+            if ((pool->flags & RT_WORKQUEUE_FLAG_DYING) ||
+                (pool->nr_idle > WORKER_IDLE_MAX && rt_list_isempty(&(pool->work_list))))
+            {
+                rt_list_remove(&(worker->list));
+                --pool->nr_idle;
+                --pool->nr_workers;
+                rt_spin_unlock_irqrestore(&(pool->spinlock), level);
+
+                RT_KERNEL_FREE(worker);
+                return;
+            }
+
+            rt_thread_suspend_with_flag(worker->thread, RT_UNINTERRUPTIBLE);
+
+            if (!rt_list_isempty(&(pool->work_list)))
+            {
+                /* the busy workers may block later, look again then */
+                watchdog = rt_tick_from_millisecond(RT_WORKQUEUE_POOL_WATCHDOG_MS);
+                rt_timer_control(&(worker->thread->thread_timer), RT_TIMER_CTRL_SET_TIME, &watchdog);
+                rt_timer_start(&(worker->thread->thread_timer));
+            }
+
+            /* release lock after suspend so we will not lost any wakeups */
+            rt_spin_unlock_irqrestore(&(pool->spinlock), level);
+
+            rt_schedule();
+            continue;
+        }
+
+        if (!worker->busy)
+        {
+            worker->busy = RT_TRUE;
+            rt_list_remove(&(worker->list));
+            rt_list_insert_after(&(pool->busy_workers), &(worker->list));
+            --pool->nr_idle;
+            ++pool->nr_busy;
+        }
+
+        work = _pool_first_work(pool, worker);
+        rt_list_remove(&(work->list));
+        work->flags &= ~RT_WORK_STATE_PENDING;
+        work->workqueue = RT_NULL;
+        worker->work_current = work;
+
+        /* keep an idle worker in reserve in case this work blocks */
+        spawn = pool->nr_idle == 0 && pool->nr_workers <= pool->max_active;
+        if (spawn)
+        {
+            ++pool->nr_workers;
+        }
+
+        rt_spin_unlock_irqrestore(&(pool->spinlock), level);
+
+        if (spawn && _pool_create_worker(pool) != RT_EOK)
+        {
+            level = rt_spin_lock_irqsave(&(pool->spinlock));
+            --pool->nr_workers;
+            rt_spin_unlock_irqrestore(&(pool->spinlock), level);
+        }
+
+        /* do work */
+        work->work_func(work, work->work_data);
+
+        level = rt_spin_lock_irqsave(&(pool->spinlock));
+        worker->work_current = RT_NULL;
+        rt_spin_unlock_irqrestore(&(pool->spinlock), level);
+    }
+}
+
+/* The caller has counted the worker in nr_workers */
+static rt_err_t _pool_create_worker(struct rt_workqueue *pool)
+{
+    rt_base_t level;
+    struct rt_workqueue_worker *worker;
+
+    worker = (struct rt_workqueue_worker *)RT_KERNEL_MALLOC(sizeof(*worker));
+    if (worker == RT_NULL)
+    {
+        return -RT_ENOMEM;
+    }
+
+    worker->pool = pool;
+    worker->work_current = RT_NULL;
+    worker->busy = RT_FALSE;
+    worker->thread = rt_thread_create(pool->name, _pool_worker_entry, worker,
+                                      pool->stack_size, pool->priority, 10);
+    if (worker->thread == RT_NULL)
+    {
+        RT_KERNEL_FREE(worker);
+        return -RT_ENOMEM;
+    }
+
+#ifdef RT_USING_SMP
+    if (pool->cpu >= 0)
+    {
+        rt_thread_control(worker->thread, RT_THREAD_CTRL_BIND_CPU, (void *)(rt_ubase_t)pool->cpu);
+    }
+#endif
+
+    level = rt_spin_lock_irqsave(&(pool->spinlock));
+    rt_list_insert_after(&(pool->idle_workers), &(worker->list));
+    ++pool->nr_idle;
+    rt_spin_unlock_irqrestore(&(pool->spinlock), level);
+
+    rt_thread_startup(worker->thread);
+
+    return RT_EOK;
+}
+
+/* The pool lock must be held */
+static rt_bool_t _pool_is_running(struct rt_workqueue *pool, struct rt_work *work)
+{
+    struct rt_workqueue_worker *worker;
+
+    rt_list_for_each_entry(worker, &(pool->busy_workers), list)
+    {
+        if (worker->work_current == work)
+        {
+            return RT_TRUE;
+        }
+    }
+
+    return RT_FALSE;
+}
+#endif /* RT_WORKQUEUE_USING_POOL */
+
+/* The queue lock must be held */
+rt_inline rt_bool_t _workqueue_is_running(struct rt_workqueue *queue, struct rt_work *work)
+{
+#ifdef RT_WORKQUEUE_USING_POOL
+    if (queue->flags & RT_WORKQUEUE_FLAG_POOL)
+    {
+        return _pool_is_running(queue, work);
+    }
+#endif
+
+    return queue->work_current == work;
+}
+
+/* The queue lock must be held */
+rt_inline void _workqueue_kick(struct rt_workqueue *queue)
+{
+#ifdef RT_WORKQUEUE_USING_POOL
+    if (queue->flags & RT_WORKQUEUE_FLAG_POOL)
+    {
+        _pool_kick(queue);
+        return;
+    }
+#endif
+
+    /* whether the workqueue is doing work */
+    if (queue->work_current == RT_NULL)
+    {
+        /* resume work thread, and do a re-schedule if succeed */
+        rt_thread_resume(queue->work_thread);
+    }
+}
+
+/*
+ * Serialize the selecting of pools on a pool based queue. Otherwise two
+ * CPUs submitting the same idle work will both select their own pool and
+ * queue it on two lists at the same time. The lock is held until the work
+ * is queued on, or cancelled from, the pool selected.
+ */
+rt_inline rt_base_t _workqueue_select_lock(struct rt_workqueue *queue)
+{
+#ifdef RT_WORKQUEUE_USING_POOL
+    if (queue->pools != RT_NULL)
+    {
+        return rt_spin_lock_irqsave(&(queue->spinlock));
+    }
+#endif
+    return 0;
+}
+
+rt_inline void _workqueue_select_unlock(struct rt_workqueue *queue, rt_base_t level)
+{
+#ifdef RT_WORKQUEUE_USING_POOL
+    if (queue->pools != RT_NULL)
+    {
+        rt_spin_unlock_irqrestore(&(queue->spinlock), level);
+    }
+#endif
+    RT_UNUSED(level);
+}
+
+/*
+ * Select the queue to do the work. The work pending stays where it is,
+ * the work running goes to its pool so it never runs on two workers at
+ * the same time, the others go to the pool of the current CPU.
+ *
+ * The select lock of `queue` must be held.
+ */
+static struct rt_workqueue *_workqueue_select(struct rt_workqueue *queue, struct rt_work *work)
+{
+#ifdef RT_WORKQUEUE_USING_POOL
+    rt_base_t level;
+    rt_bool_t running;
+    struct rt_workqueue *pool;
+
+    if (queue->pools == RT_NULL)
+    {
+        return queue;
+    }
+
+    if ((pool = work->workqueue) != RT_NULL)
+    {
+        return pool;
+    }
+
+    for (int i = 0; i < queue->nr_pools; ++i)
+    {
+        pool = &queue->pools[i];
+
+        level = rt_spin_lock_irqsave(&(pool->spinlock));
+        running = _pool_is_running(pool, work);
+        rt_spin_unlock_irqrestore(&(pool->spinlock), level);
+
+        if (running)
+        {
+            return pool;
+        }
+    }
+
+    return &queue->pools[queue->nr_pools > 1 ? rt_cpu_get_id() : 0];
+#else
+    return queue;
+#endif /* RT_WORKQUEUE_USING_POOL */
+}
+
 static rt_err_t _workqueue_submit_work(struct rt_workqueue *queue,
                                        struct rt_work *work, rt_tick_t ticks)
 {
@@ -108,12 +459,7 @@ static rt_err_t _workqueue_submit_work(struct rt_workqueue *queue,
         work->flags |= RT_WORK_STATE_PENDING;
         work->workqueue = queue;
 
-        /* whether the workqueue is doing work */
-        if (queue->work_current == RT_NULL)
-        {
-            /* resume work thread, and do a re-schedule if succeed */
-            rt_thread_resume(queue->work_thread);
-        }
+        _workqueue_kick(queue);
     }
     else if (ticks < RT_TICK_MAX / 2)
     {
@@ -161,7 +507,7 @@ static rt_err_t _workqueue_cancel_work(struct rt_workqueue *queue, struct rt_wor
         rt_timer_detach(&(work->timer));
         work->flags &= ~RT_WORK_STATE_SUBMITTING;
     }
-    err = queue->work_current != work ? RT_EOK : -RT_EBUSY;
+    err = _workqueue_is_running(queue, work) ? -RT_EBUSY : RT_EOK;
     work->workqueue = RT_NULL;
 exit:
     rt_spin_unlock_irqrestore(&(queue->spinlock), level);
@@ -186,17 +532,12 @@ static void _delayed_work_timeout_handler(void *parameter)
     /* remove delay list */
     rt_list_remove(&(work->list));
     /* insert work queue */
-    if (queue->work_current != work)
+    if (!_workqueue_is_running(queue, work))
     {
         rt_list_insert_after(queue->work_list.prev, &(work->list));
         work->flags |= RT_WORK_STATE_PENDING;
     }
-    /* whether the workqueue is doing work */
-    if (queue->work_current == RT_NULL)
-    {
-        /* resume work thread, and do a re-schedule if succeed */
-        rt_thread_resume(queue->work_thread);
-    }
+    _workqueue_kick(queue);
 
     rt_spin_unlock_irqrestore(&(queue->spinlock), level);
 }
@@ -248,6 +589,11 @@ struct rt_workqueue *rt_workqueue_create(const char *name, rt_uint16_t stack_siz
         rt_list_init(&(queue->delayed_list));
         queue->work_current = RT_NULL;
         rt_sem_init(&(queue->sem), "wqueue", 0, RT_IPC_FLAG_FIFO);
+#ifdef RT_WORKQUEUE_USING_POOL
+        queue->flags = 0;
+        queue->pools = RT_NULL;
+        queue->nr_pools = 0;
+#endif
 
         /* create the work thread */
         queue->work_thread = rt_thread_create(name, _workqueue_thread_entry, queue, stack_size, priority, 10);
@@ -265,6 +611,122 @@ struct rt_workqueue *rt_workqueue_create(const char *name, rt_uint16_t stack_siz
     return queue;
 }
 
+#ifdef RT_WORKQUEUE_USING_POOL
+static void _pool_destroy(struct rt_workqueue *pool)
+{
+    rt_base_t level;
+    rt_uint16_t nr_workers;
+    struct rt_workqueue_worker *worker;
+
+    level = rt_spin_lock_irqsave(&(pool->spinlock));
+    pool->flags |= RT_WORKQUEUE_FLAG_DYING;
+    rt_list_for_each_entry(worker, &(pool->idle_workers), list)
+    {
+        rt_thread_resume(worker->thread);
+    }
+    rt_spin_unlock_irqrestore(&(pool->spinlock), level);
+
+    /* the busy workers leave after their work */
+    do {
+        rt_thread_mdelay(1);
+
+        level = rt_spin_lock_irqsave(&(pool->spinlock));
+        nr_workers = pool->nr_workers;
+        rt_spin_unlock_irqrestore(&(pool->spinlock), level);
+    } while (nr_workers);
+
+    rt_sem_detach(&(pool->sem));
+}
+
+/**
+ * @brief Create a concurrency managed work queue with worker pools inside.
+ *
+ * The workers of a pool are spawned when all the busy ones block, so one
+ * blocking work item does not stall the others, and retired when idle.
+ *
+ * @param name is a name of the worker threads.
+ *
+ * @param stack_size is stack size of the worker threads.
+ *
+ * @param priority is a priority of the worker threads.
+ *
+ * @param flags is RT_WORKQUEUE_FLAG_PERCPU for a pool per CPU, whose workers are
+ *        bound to the CPU and run one at a time unless blocked, the work runs on
+ *        the CPU that submits it. Or RT_WORKQUEUE_FLAG_UNBOUND for a single pool,
+ *        whose workers run on any CPU at the same time.
+ *
+ * @param max_active is the limit of the work items running at the same time per pool.
+ *
+ * @return Return a pointer to the workqueue object. It will return RT_NULL if failed.
+ */
+struct rt_workqueue *rt_workqueue_create_pool(const char *name, rt_uint16_t stack_size,
+                                              rt_uint8_t priority, rt_uint16_t flags,
+                                              rt_uint16_t max_active)
+{
+    int nr_pools;
+    struct rt_workqueue *queue, *pool;
+
+    RT_ASSERT(name != RT_NULL);
+    RT_ASSERT(max_active > 0);
+    RT_ASSERT(!(flags & RT_WORKQUEUE_FLAG_PERCPU) != !(flags & RT_WORKQUEUE_FLAG_UNBOUND));
+
+    nr_pools = (flags & RT_WORKQUEUE_FLAG_PERCPU) ? RT_CPUS_NR : 1;
+
+    queue = (struct rt_workqueue *)RT_KERNEL_MALLOC(sizeof(struct rt_workqueue));
+    if (queue == RT_NULL)
+    {
+        return RT_NULL;
+    }
+
+    queue->pools = (struct rt_workqueue *)RT_KERNEL_MALLOC(sizeof(struct rt_workqueue) * nr_pools);
+    if (queue->pools == RT_NULL)
+    {
+        RT_KERNEL_FREE(queue);
+        return RT_NULL;
+    }
+
+    rt_memset(queue->pools, 0, sizeof(struct rt_workqueue) * nr_pools);
+    rt_list_init(&(queue->work_list));
+    rt_list_init(&(queue->delayed_list));
+    queue->work_current = RT_NULL;
+    queue->work_thread = RT_NULL;
+    queue->flags = flags;
+    queue->nr_pools = 0;
+    rt_spin_lock_init(&(queue->spinlock));
+
+    for (int i = 0; i < nr_pools; ++i)
+    {
+        pool = &queue->pools[i];
+
+        rt_list_init(&(pool->work_list));
+        rt_list_init(&(pool->delayed_list));
+        rt_list_init(&(pool->idle_workers));
+        rt_list_init(&(pool->busy_workers));
+        rt_sem_init(&(pool->sem), "wqueue", 0, RT_IPC_FLAG_FIFO);
+        rt_spin_lock_init(&(pool->spinlock));
+        rt_strncpy(pool->name, name, RT_NAME_MAX - 1);
+        pool->flags = flags | RT_WORKQUEUE_FLAG_POOL;
+        pool->cpu = (flags & RT_WORKQUEUE_FLAG_PERCPU) ? i : -1;
+        pool->max_active = max_active;
+        pool->stack_size = stack_size;
+        pool->priority = priority;
+        pool->nr_workers = 1;
+
+        if (_pool_create_worker(pool) != RT_EOK)
+        {
+            pool->nr_workers = 0;
+            _pool_destroy(pool);
+            rt_workqueue_destroy(queue);
+            return RT_NULL;
+        }
+
+        ++queue->nr_pools;
+    }
+
+    return queue;
+}
+#endif /* RT_WORKQUEUE_USING_POOL */
+
 /**
  * @brief Destroy a work queue.
  *
@@ -277,6 +739,19 @@ rt_err_t rt_workqueue_destroy(struct rt_workqueue *queue)
     RT_ASSERT(queue != RT_NULL);
 
     rt_workqueue_cancel_all_work(queue);
+#ifdef RT_WORKQUEUE_USING_POOL
+    if (queue->pools)
+    {
+        for (int i = 0; i < queue->nr_pools; ++i)
+        {
+            _pool_destroy(&queue->pools[i]);
+        }
+        RT_KERNEL_FREE(queue->pools);
+        RT_KERNEL_FREE(queue);
+
+        return RT_EOK;
+    }
+#endif
     rt_thread_delete(queue->work_thread);
     rt_sem_detach(&(queue->sem));
     RT_KERNEL_FREE(queue);
@@ -296,10 +771,7 @@ rt_err_t rt_workqueue_destroy(struct rt_workqueue *queue)
  */
 rt_err_t rt_workqueue_dowork(struct rt_workqueue *queue, struct rt_work *work)
 {
-    RT_ASSERT(queue != RT_NULL);
-    RT_ASSERT(work != RT_NULL);
-
-    return _workqueue_submit_work(queue, work, 0);
+    return rt_workqueue_submit_work(queue, work, 0);
 }
 
 /**
@@ -319,11 +791,18 @@ rt_err_t rt_workqueue_dowork(struct rt_workqueue *queue, struct rt_work *work)
  */
 rt_err_t rt_workqueue_submit_work(struct rt_workqueue *queue, struct rt_work *work, rt_tick_t ticks)
 {
+    rt_base_t level;
+    rt_err_t err;
+
     RT_ASSERT(queue != RT_NULL);
     RT_ASSERT(work != RT_NULL);
     RT_ASSERT(ticks < RT_TICK_MAX / 2);
 
-    return _workqueue_submit_work(queue, work, ticks);
+    level = _workqueue_select_lock(queue);
+    err = _workqueue_submit_work(_workqueue_select(queue, work), work, ticks);
+    _workqueue_select_unlock(queue, level);
+
+    return err;
 }
 
 /**
@@ -337,23 +816,23 @@ rt_err_t rt_workqueue_submit_work(struct rt_workqueue *queue, struct rt_work *wo
  */
 rt_err_t rt_workqueue_urgent_work(struct rt_workqueue *queue, struct rt_work *work)
 {
-    rt_base_t level;
+    rt_base_t level, select_level;
+    struct rt_workqueue *target;
 
     RT_ASSERT(queue != RT_NULL);
     RT_ASSERT(work != RT_NULL);
 
-    level = rt_spin_lock_irqsave(&(queue->spinlock));
+    select_level = _workqueue_select_lock(queue);
+    target = _workqueue_select(queue, work);
+
+    level = rt_spin_lock_irqsave(&(target->spinlock));
     /* NOTE: the work MUST be initialized firstly */
     rt_list_remove(&(work->list));
-    rt_list_insert_after(&queue->work_list, &(work->list));
-    /* whether the workqueue is doing work */
-    if (queue->work_current == RT_NULL)
-    {
-        /* resume work thread, and do a re-schedule if succeed */
-        rt_thread_resume(queue->work_thread);
-    }
+    rt_list_insert_after(&target->work_list, &(work->list));
+    _workqueue_kick(target);
 
-    rt_spin_unlock_irqrestore(&(queue->spinlock), level);
+    rt_spin_unlock_irqrestore(&(target->spinlock), level);
+    _workqueue_select_unlock(queue, select_level);
     return RT_EOK;
 }
 
@@ -369,10 +848,17 @@ rt_err_t rt_workqueue_urgent_work(struct rt_workqueue *queue, struct rt_work *wo
  */
 rt_err_t rt_workqueue_cancel_work(struct rt_workqueue *queue, struct rt_work *work)
 {
+    rt_base_t level;
+    rt_err_t err;
+
     RT_ASSERT(work != RT_NULL);
     RT_ASSERT(queue != RT_NULL);
 
-    return _workqueue_cancel_work(queue, work);
+    level = _workqueue_select_lock(queue);
+    err = _workqueue_cancel_work(_workqueue_select(queue, work), work);
+    _workqueue_select_unlock(queue, level);
+
+    return err;
 }
 
 /**
@@ -389,6 +875,34 @@ rt_err_t rt_workqueue_cancel_work_sync(struct rt_workqueue *queue, struct rt_wor
     RT_ASSERT(queue != RT_NULL);
     RT_ASSERT(work != RT_NULL);
 
+#ifdef RT_WORKQUEUE_USING_POOL
+    if (queue->pools != RT_NULL)
+    {
+        rt_base_t level;
+        rt_bool_t running;
+        struct rt_workqueue *pool;
+
+        level = _workqueue_select_lock(queue);
+        pool = _workqueue_select(queue, work);
+        _workqueue_cancel_work(pool, work);
+        _workqueue_select_unlock(queue, level);
+
+        /* wait for work completion */
+        do {
+            level = rt_spin_lock_irqsave(&(pool->spinlock));
+            running = _pool_is_running(pool, work);
+            rt_spin_unlock_irqrestore(&(pool->spinlock), level);
+
+            if (running)
+            {
+                rt_thread_mdelay(1);
+            }
+        } while (running);
+
+        return RT_EOK;
+    }
+#endif /* RT_WORKQUEUE_USING_POOL */
+
     if (queue->work_current == work) /* it's current work in the queue */
     {
         /* wait for work completion */
@@ -416,6 +930,18 @@ rt_err_t rt_workqueue_cancel_all_work(struct rt_workqueue *queue)
 
     RT_ASSERT(queue != RT_NULL);
 
+#ifdef RT_WORKQUEUE_USING_POOL
+    if (queue->pools)
+    {
+        for (int i = 0; i < queue->nr_pools; ++i)
+        {
+            rt_workqueue_cancel_all_work(&queue->pools[i]);
+        }
+
+        return RT_EOK;
+    }
+#endif
+
     /* cancel work */
     rt_enter_critical();
     while (rt_list_isempty(&queue->work_list) == RT_FALSE)
@@ -486,8 +1012,14 @@ static int rt_work_sys_workqueue_init(void)
     if (sys_workq != RT_NULL)
         return RT_EOK;
 
+#ifdef RT_WORKQUEUE_USING_POOL
+    sys_workq = rt_workqueue_create_pool("sys workq", RT_SYSTEM_WORKQUEUE_STACKSIZE,
+                                         RT_SYSTEM_WORKQUEUE_PRIORITY, RT_WORKQUEUE_FLAG_PERCPU,
+                                         RT_SYSTEM_WORKQUEUE_MAX_ACTIVE);
+#else
     sys_workq = rt_workqueue_create("sys workq", RT_SYSTEM_WORKQUEUE_STACKSIZE,
                                     RT_SYSTEM_WORKQUEUE_PRIORITY);
+#endif
     RT_ASSERT(sys_workq != RT_NULL);
 
     return RT_EOK;
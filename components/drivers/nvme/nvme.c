@@ -6,6 +6,10 @@
  * Change Logs:
  * Date           Author       Notes
  * 2023-02-25     GuEe-GUI     the first version
+ * 2026-10-17     agent        hybrid polled I/O and latency histogram
+ * 2026-10-17     agent        asynchronous block requests
+ * 2026-10-17     agent        match the synchronous completion by command id
+ * 2026-10-17     agent        slots of the synchronous commands
  */
 
 #include <rthw.h>
@@ -95,26 +99,221 @@ static rt_err_t nvme_shutdown_ctrl(struct rt_nvme_controller *nvme)
     return nvme_poll_csts(nvme, RT_NVME_CSTS_SHST_MASK, RT_NVME_CSTS_SHST_CMPLT);
 }
 
-rt_inline rt_le16_t nvme_next_cmdid(struct rt_nvme_controller *nvme)
+#ifdef RT_BLK_USING_MQ
+/* Command id of a block request is its slot with the top bit set */
+#define NVME_BLK_CMDID      0x8000
+
+struct rt_nvme_blk_cmd
+{
+    rt_list_t list;
+
+    struct rt_blk_request *req;
+    struct rt_nvme_command cmd;
+    rt_err_t err;
+
+    /* DMA buffer of the merged or unaligned request */
+    void *bounce;
+    rt_uint32_t bounce_bits;
+    void *prp_list;
+};
+
+/* The queue lock MUST be held, it may be in interrupt context. */
+static void nvme_blk_cmd_reaped(struct rt_nvme_queue *queue,
+        rt_uint16_t slot, rt_err_t err)
+{
+    struct rt_nvme_blk_cmd *bcmd;
+    struct rt_nvme_controller *nvme = queue->nvme;
+
+    if (!queue->blk_cmds)
+    {
+        LOG_W("%s: Unknown command id = %x", nvme->name, slot | NVME_BLK_CMDID);
+        return;
+    }
+
+    bcmd = &queue->blk_cmds[slot];
+    bcmd->err = err;
+
+    if (!err && nvme->ops->complete_cmd)
+    {
+        nvme->ops->complete_cmd(queue, &bcmd->cmd);
+    }
+
+    /* Copy back and free the DMA buffers in thread context */
+    rt_list_insert_before(&queue->blk_done, &bcmd->list);
+    rt_work_submit(&queue->blk_work, 0);
+}
+#endif /* RT_BLK_USING_MQ */
+
+/* The slot is the low bits, the sequence in the rest tells a late completion */
+rt_inline rt_uint16_t nvme_next_cmdid(struct rt_nvme_controller *nvme, int slot)
+{
+    rt_uint16_t cmdid;
+
+    do {
+        cmdid = (rt_uint16_t)rt_atomic_add(&nvme->cmdid, 1) << RT_NVME_SYNC_CMD_SHIFT;
+        cmdid |= slot;
+
+    #ifdef RT_BLK_USING_MQ
+        cmdid &= ~NVME_BLK_CMDID;
+    #endif
+    } while (!cmdid);
+
+    return cmdid;
+}
+
+/* The queue lock MUST be held, it may be in interrupt context. */
+static void nvme_sync_cmd_reaped(struct rt_nvme_queue *queue,
+        rt_uint16_t cmdid, rt_err_t err)
+{
+    struct rt_nvme_controller *nvme = queue->nvme;
+    struct rt_nvme_sync_cmd *scmd = &queue->sync_cmds[cmdid & (RT_NVME_SYNC_CMD_NR - 1)];
+
+    if (scmd->cmdid != cmdid)
+    {
+        /* The waiter has timed out and released the slot */
+        LOG_W("%s: Queue%d drop stale completion of command %u",
+                nvme->name, queue->qid, cmdid);
+        return;
+    }
+
+    scmd->err = err;
+
+    if (!err && nvme->ops->complete_cmd)
+    {
+        nvme->ops->complete_cmd(queue, scmd->cmd);
+    }
+
+    scmd->reaped = RT_TRUE;
+    rt_completion_done(&scmd->done);
+}
+
+/*
+ * Reap all the completions in the CQ and wake their waiters up, the queue
+ * lock MUST be held. Return the number of the completions.
+ */
+static int nvme_queue_reap(struct rt_nvme_queue *queue)
+{
+    int reaped = 0;
+    rt_err_t err;
+    rt_uint16_t head, phase, status, cmdid;
+    struct rt_nvme_controller *nvme = queue->nvme;
+
+    head = queue->cq_head;
+    phase = queue->cq_phase;
+
+    for (;;)
+    {
+        status = HWREG16(&queue->cq_entry[head].status);
+        status = rt_le16_to_cpu(status);
+
+        if ((status & 0x01) != phase)
+        {
+            break;
+        }
+
+        err = (status >> 1) ? -RT_EIO : RT_EOK;
+        cmdid = rt_le16_to_cpu(HWREG16(&queue->cq_entry[head].cmdid));
+
+    #ifdef RT_BLK_USING_MQ
+        if (cmdid & NVME_BLK_CMDID)
+        {
+            nvme_blk_cmd_reaped(queue, cmdid & ~NVME_BLK_CMDID, err);
+        }
+        else
+    #endif /* RT_BLK_USING_MQ */
+        {
+            nvme_sync_cmd_reaped(queue, cmdid, err);
+        }
+
+        if (++head == queue->depth)
+        {
+            head = 0;
+            phase = !phase;
+        }
+
+        --queue->inflight;
+        ++reaped;
+    }
+
+    if (reaped)
+    {
+        HWREG32(queue->doorbell + nvme->doorbell_stride) = head;
+        queue->cq_head = head;
+        queue->cq_phase = phase;
+    }
+
+    return reaped;
+}
+
+#ifdef RT_NVME_IO_POLL
+/*
+ * Spin on the CQ from the submitting CPU like the io_poll of Linux, the ISR
+ * is still armed and may win the race, the queue lock decides who reaps it.
+ * Whoever reaps the CQ wakes the other commands in it up by their slots.
+ */
+static rt_err_t nvme_poll_cmd(struct rt_nvme_queue *queue, struct rt_nvme_sync_cmd *scmd)
+{
+    rt_ubase_t level;
+    rt_bool_t reaped;
+    rt_uint64_t start = clock_cpu_gettime();
+
+    do {
+        level = rt_spin_lock_irqsave(&queue->lock);
+        nvme_queue_reap(queue);
+        reaped = scmd->reaped;
+        rt_spin_unlock_irqrestore(&queue->lock, level);
+
+        if (reaped)
+        {
+        #ifdef RT_NVME_IO_STATS
+            rt_atomic_add(&queue->polled, 1);
+        #endif
+            return RT_EOK;
+        }
+
+        rt_hw_cpu_relax();
+    } while (clock_cpu_microsecond(clock_cpu_gettime() - start) < RT_NVME_IO_POLL_BUDGET_US);
+
+#ifdef RT_NVME_IO_STATS
+    rt_atomic_add(&queue->poll_fallback, 1);
+#endif
+
+    return -RT_ETIMEOUT;
+}
+#endif /* RT_NVME_IO_POLL */
+
+#ifdef RT_NVME_IO_STATS
+static void nvme_queue_account(struct rt_nvme_queue *queue, rt_uint64_t start)
 {
-    return rt_cpu_to_le16((rt_uint16_t)rt_atomic_add(&nvme->cmdid, 1));
+    int bucket;
+    rt_uint64_t us = clock_cpu_microsecond(clock_cpu_gettime() - start);
+
+    /* Bucket N counts the latency less than (1 << N) us */
+    bucket = rt_min_t(int, rt_ilog2(us + 1), RT_NVME_LAT_HIST_NR - 1);
+
+    rt_atomic_add(&queue->lat_hist[bucket], 1);
 }
+#endif /* RT_NVME_IO_STATS */
 
 static rt_err_t nvme_submit_cmd(struct rt_nvme_queue *queue,
-        struct rt_nvme_command *cmd)
+        struct rt_nvme_command *cmd, rt_bool_t poll)
 {
+    int slot;
     rt_ubase_t level;
     rt_err_t err = RT_EOK;
-    rt_uint16_t tail, head;
+    rt_uint16_t tail;
+    struct rt_nvme_sync_cmd *scmd;
     struct rt_nvme_controller *nvme = queue->nvme;
+#ifdef RT_NVME_IO_STATS
+    rt_uint64_t start;
+#endif
 
 _retry:
     level = rt_spin_lock_irqsave(&queue->lock);
 
     tail = queue->sq_tail;
-    head = queue->cq_head;
 
-    if (tail + 1 == head)
+    if (queue->inflight + 1 >= queue->depth || !queue->sync_free)
     {
         /* IO queue is full, waiting for the last IO command to complete. */
         rt_spin_unlock_irqrestore(&queue->lock, level);
@@ -124,33 +323,75 @@ _retry:
         goto _retry;
     }
 
-    cmd->common.cmdid = nvme_next_cmdid(nvme);
+    slot = __rt_ffs(queue->sync_free) - 1;
+    scmd = &queue->sync_cmds[slot];
+
+    cmd->common.cmdid = rt_cpu_to_le16(nvme_next_cmdid(nvme, slot));
     rt_memcpy(&queue->sq_cmds[tail], cmd, sizeof(*cmd));
 
     if (nvme->ops->submit_cmd)
     {
         if ((err = nvme->ops->submit_cmd(queue, cmd)))
         {
+            rt_spin_unlock_irqrestore(&queue->lock, level);
+
             return err;
         }
     }
 
+    queue->sync_free &= ~RT_BIT(slot);
+    scmd->cmd = cmd;
+    scmd->cmdid = rt_le16_to_cpu(cmd->common.cmdid);
+    scmd->reaped = RT_FALSE;
+    scmd->err = RT_EOK;
+    rt_completion_init(&scmd->done);
+
+#ifdef RT_NVME_IO_STATS
+    start = clock_cpu_gettime();
+#endif
+
     if (++tail == queue->depth)
     {
         tail = 0;
     }
     HWREG32(queue->doorbell) = tail;
     queue->sq_tail = tail;
+    ++queue->inflight;
 
-    queue->cmd = cmd;
-    queue->err = RT_EOK;
+    rt_spin_unlock_irqrestore(&queue->lock, level);
+
+#ifdef RT_NVME_IO_POLL
+    /* Fallback to the interrupt when the polling budget is exhausted */
+    if (!poll || nvme_poll_cmd(queue, scmd))
+#else
+    RT_UNUSED(poll);
+#endif
+    {
+        err = rt_completion_wait(&scmd->done,
+                rt_tick_from_millisecond(queue->qid != 0 ? RT_WAITING_FOREVER : 60));
+    }
+
+    level = rt_spin_lock_irqsave(&queue->lock);
+
+    /* The completion may come between the timeout and here */
+    if (scmd->reaped)
+    {
+        err = scmd->err;
+    }
+    scmd->cmd = RT_NULL;
+    scmd->cmdid = 0;
+    queue->sync_free |= RT_BIT(slot);
 
     rt_spin_unlock_irqrestore(&queue->lock, level);
 
-    err = rt_completion_wait(&queue->done,
-            rt_tick_from_millisecond(queue->qid != 0 ? RT_WAITING_FOREVER : 60));
+#ifdef RT_NVME_IO_STATS
+    if (queue->qid != 0)
+    {
+        nvme_queue_account(queue, start);
+    }
+#endif
 
-    return err ? : queue->err;
+    return err;
 }
 
 static rt_err_t nvme_set_features_simple(struct rt_nvme_controller *nvme,
@@ -163,18 +404,29 @@ static rt_err_t nvme_set_features_simple(struct rt_nvme_controller *nvme,
     cmd.features.fid = rt_cpu_to_le32(fid);
     cmd.features.dword11 = rt_cpu_to_le32(dword11);
 
-    return nvme_submit_cmd(&nvme->admin_queue, &cmd);
+    return nvme_submit_cmd(&nvme->admin_queue, &cmd, RT_FALSE);
 }
 
+#define NVME_IO_NO_POLL     ((rt_size_t)~0UL)
+
 static rt_err_t nvme_submit_io_cmd(struct rt_nvme_controller *nvme,
-        struct rt_nvme_command *cmd)
+        struct rt_nvme_command *cmd, rt_size_t data_length)
 {
     rt_uint16_t qid;
+    rt_bool_t poll = RT_FALSE;
 
+    /* Queues of the CPU are "cpuid + n * RT_CPUS_NR" */
     qid = rt_atomic_add(&nvme->ioqid[rt_hw_cpu_id()], RT_CPUS_NR);
     qid %= nvme->io_queue_max;
 
-    return nvme_submit_cmd(&nvme->io_queues[qid], cmd);
+#ifdef RT_NVME_IO_POLL
+    /* Only the short requests are worth to spin for */
+    poll = data_length <= RT_NVME_IO_POLL_MAX_SIZE;
+#else
+    RT_UNUSED(data_length);
+#endif
+
+    return nvme_submit_cmd(&nvme->io_queues[qid], cmd, poll);
 }
 
 /*
@@ -306,7 +558,7 @@ static rt_ssize_t nvme_blk_rw(struct rt_nvme_device *ndev, rt_off_t slba,
             cmd.rw.slba = rt_cpu_to_le16(slba);
             cmd.rw.length = rt_cpu_to_le16(max_lbas - 1);
 
-            if ((err = nvme_submit_io_cmd(nvme, &cmd)))
+            if ((err = nvme_submit_io_cmd(nvme, &cmd, data_length)))
             {
                 tlbas -= lbas;
                 break;
@@ -425,7 +677,7 @@ static rt_ssize_t nvme_blk_rw(struct rt_nvme_device *ndev, rt_off_t slba,
             cmd.rw.slba = rt_cpu_to_le16(slba);
             cmd.rw.length = rt_cpu_to_le16(max_lbas - 1);
 
-            if ((err = nvme_submit_io_cmd(nvme, &cmd)))
+            if ((err = nvme_submit_io_cmd(nvme, &cmd, data_length)))
             {
                 tlbas -= lbas;
                 break;
@@ -552,6 +804,342 @@ static rt_ssize_t nvme_blk_write(struct rt_blk_disk *disk, rt_off_t sector,
     return res;
 }
 
+#ifdef RT_BLK_USING_MQ
+static rt_ssize_t nvme_blk_rw_sync(struct rt_blk_disk *disk, struct rt_blk_request *req)
+{
+    rt_ssize_t res = 0, seg_res;
+    struct rt_blk_request *seg;
+
+    rt_blk_request_for_each_segment(seg, req)
+    {
+        if (seg->op == RT_BLK_REQ_READ)
+        {
+            seg_res = nvme_blk_read(disk, seg->sector, seg->buffer, seg->sector_count);
+        }
+        else
+        {
+            seg_res = nvme_blk_write(disk, seg->sector, seg->buffer, seg->sector_count);
+        }
+
+        if (seg_res < 0)
+        {
+            res = res ? : seg_res;
+            break;
+        }
+
+        res += seg_res;
+
+        if (seg_res != seg->sector_count)
+        {
+            break;
+        }
+    }
+
+    return res;
+}
+
+static rt_err_t nvme_blk_cmd_map(struct rt_nvme_controller *nvme,
+        struct rt_nvme_blk_cmd *bcmd, rt_ubase_t buffer_dma, rt_size_t data_length)
+{
+    rt_size_t prps, page_size = nvme->page_size;
+    rt_uint64_t *prp_list;
+    struct rt_nvme_command *cmd = &bcmd->cmd;
+
+    if (nvme->sgl_mode)
+    {
+        cmd->rw.sgl.adddress = rt_cpu_to_le64(buffer_dma);
+        cmd->rw.sgl.length = rt_cpu_to_le32(data_length);
+        cmd->rw.sgl.sgl_identify = SGL_DESC_TYPE_DATA_BLOCK;
+
+        return RT_EOK;
+    }
+
+    /* The buffer is page aligned, the PRP list is one page at most */
+    cmd->rw.prp1 = rt_cpu_to_le64(buffer_dma);
+    cmd->rw.prp2 = 0;
+
+    if (data_length <= page_size)
+    {
+        return RT_EOK;
+    }
+
+    if (data_length <= page_size * 2)
+    {
+        cmd->rw.prp2 = rt_cpu_to_le64(buffer_dma + page_size);
+
+        return RT_EOK;
+    }
+
+    prps = RT_DIV_ROUND_UP(data_length, page_size) - 1;
+
+    if (prps > page_size / sizeof(rt_uint64_t))
+    {
+        return -RT_EINVAL;
+    }
+
+    if (!(prp_list = rt_malloc_align(page_size, page_size)))
+    {
+        return -RT_ENOMEM;
+    }
+
+    for (rt_size_t i = 0; i < prps; ++i)
+    {
+        prp_list[i] = rt_cpu_to_le64(buffer_dma + (i + 1) * page_size);
+    }
+
+    rt_hw_cpu_dcache_ops(RT_HW_CACHE_FLUSH, prp_list, prps * sizeof(*prp_list));
+
+    bcmd->prp_list = prp_list;
+    cmd->rw.prp2 = rt_cpu_to_le64((rt_uint64_t)rt_kmem_v2p(prp_list));
+
+    return RT_EOK;
+}
+
+static void nvme_blk_cmd_free(struct rt_nvme_blk_cmd *bcmd)
+{
+    if (bcmd->bounce)
+    {
+        rt_pages_free(bcmd->bounce, bcmd->bounce_bits);
+        bcmd->bounce = RT_NULL;
+    }
+
+    if (bcmd->prp_list)
+    {
+        rt_free_align(bcmd->prp_list);
+        bcmd->prp_list = RT_NULL;
+    }
+}
+
+static rt_err_t nvme_blk_cmd_prepare(struct rt_nvme_device *ndev,
+        struct rt_nvme_blk_cmd *bcmd, struct rt_blk_request *req)
+{
+    rt_err_t err;
+    rt_size_t data_length;
+    rt_ubase_t buffer_dma;
+    struct rt_nvme_controller *nvme = ndev->ctrl;
+
+    data_length = req->total_count << ndev->lba_shift;
+
+    if (data_length > (1UL << nvme->max_transfer_shift))
+    {
+        return -RT_EINVAL;
+    }
+
+    buffer_dma = (rt_ubase_t)rt_kmem_v2p(req->buffer);
+
+    if (!rt_list_isempty(&req->merge_list) ||
+        (nvme->sgl_mode && (buffer_dma & RT_GENMASK(1, 0))) ||
+        (!nvme->sgl_mode && (buffer_dma & ARCH_PAGE_MASK)))
+    {
+        struct rt_blk_request *seg;
+        rt_uint8_t *ptr;
+
+        /* Gather the merged segments in one DMA buffer */
+        bcmd->bounce_bits = rt_page_bits(data_length);
+        bcmd->bounce = rt_pages_alloc(bcmd->bounce_bits);
+
+        if (!bcmd->bounce)
+        {
+            return -RT_ENOMEM;
+        }
+
+        if (req->op == RT_BLK_REQ_WRITE)
+        {
+            ptr = bcmd->bounce;
+
+            rt_blk_request_for_each_segment(seg, req)
+            {
+                rt_memcpy(ptr, seg->buffer, seg->sector_count << ndev->lba_shift);
+                ptr += seg->sector_count << ndev->lba_shift;
+            }
+        }
+
+        /* No dirty line of the old owner may be written back over the data */
+        rt_hw_cpu_dcache_ops(RT_HW_CACHE_FLUSH, bcmd->bounce, data_length);
+        buffer_dma = (rt_ubase_t)rt_kmem_v2p(bcmd->bounce);
+    }
+    else
+    {
+        rt_hw_cpu_dcache_ops(RT_HW_CACHE_FLUSH, req->buffer, data_length);
+    }
+
+    rt_memset(&bcmd->cmd, 0, sizeof(bcmd->cmd));
+    bcmd->cmd.rw.opcode = req->op == RT_BLK_REQ_READ ? RT_NVME_CMD_READ : RT_NVME_CMD_WRITE;
+    bcmd->cmd.rw.flags = nvme->sgl_mode << RT_NVME_CMD_FLAGS_PSDT_SHIFT;
+    bcmd->cmd.rw.nsid = rt_cpu_to_le32(ndev->nsid);
+    bcmd->cmd.rw.slba = rt_cpu_to_le64(req->sector);
+    bcmd->cmd.rw.length = rt_cpu_to_le16(req->total_count - 1);
+
+    if ((err = nvme_blk_cmd_map(nvme, bcmd, buffer_dma, data_length)))
+    {
+        nvme_blk_cmd_free(bcmd);
+
+        return err;
+    }
+
+    bcmd->req = req;
+
+    return RT_EOK;
+}
+
+static rt_ssize_t nvme_blk_cmd_finish(struct rt_nvme_blk_cmd *bcmd)
+{
+    rt_size_t data_length;
+    struct rt_blk_request *seg, *req = bcmd->req;
+    struct rt_nvme_device *ndev = rt_disk_to_nvme_device(req->disk);
+
+    data_length = req->total_count << ndev->lba_shift;
+
+    if (!bcmd->err && req->op == RT_BLK_REQ_READ)
+    {
+        if (bcmd->bounce)
+        {
+            rt_uint8_t *ptr = bcmd->bounce;
+
+            rt_hw_cpu_dcache_ops(RT_HW_CACHE_INVALIDATE, bcmd->bounce, data_length);
+
+            rt_blk_request_for_each_segment(seg, req)
+            {
+                rt_memcpy(seg->buffer, ptr, seg->sector_count << ndev->lba_shift);
+                ptr += seg->sector_count << ndev->lba_shift;
+            }
+        }
+        else
+        {
+            rt_hw_cpu_dcache_ops(RT_HW_CACHE_INVALIDATE, req->buffer, data_length);
+        }
+    }
+
+    nvme_blk_cmd_free(bcmd);
+
+    return bcmd->err ? : (rt_ssize_t)req->total_count;
+}
+
+static void nvme_blk_cmd_put(struct rt_nvme_queue *queue,
+        struct rt_nvme_blk_cmd *bcmd, rt_bool_t reaped)
+{
+    rt_ubase_t level = rt_spin_lock_irqsave(&queue->lock);
+
+    if (!reaped)
+    {
+        --queue->inflight;
+    }
+    rt_list_insert_before(&queue->blk_free, &bcmd->list);
+
+    rt_spin_unlock_irqrestore(&queue->lock, level);
+}
+
+static void nvme_blk_work(struct rt_work *work, void *work_data)
+{
+    rt_ubase_t level;
+    rt_list_t done;
+    rt_ssize_t res;
+    struct rt_blk_request *req;
+    struct rt_nvme_blk_cmd *bcmd, *bcmd_next;
+    struct rt_nvme_queue *queue = work_data;
+
+    rt_list_init(&done);
+
+    level = rt_spin_lock_irqsave(&queue->lock);
+
+    rt_list_insert_after(&queue->blk_done, &done);
+    rt_list_remove(&queue->blk_done);
+
+    rt_spin_unlock_irqrestore(&queue->lock, level);
+
+    rt_list_for_each_entry_safe(bcmd, bcmd_next, &done, list)
+    {
+        rt_list_remove(&bcmd->list);
+
+        req = bcmd->req;
+        res = nvme_blk_cmd_finish(bcmd);
+
+        nvme_blk_cmd_put(queue, bcmd, RT_TRUE);
+
+        rt_blk_request_complete(req, res);
+    }
+}
+
+/*
+ * Start each request as one command without waiting, the ISR reaps it and
+ * nvme_blk_work() completes it. A request that doesn't fit in one command
+ * is served synchronously.
+ */
+static rt_err_t nvme_blk_submit(struct rt_blk_disk *disk, int qid, rt_list_t *requests)
+{
+    rt_err_t err;
+    rt_ubase_t level;
+    rt_uint16_t tail;
+    struct rt_blk_request *req, *req_next;
+    struct rt_nvme_blk_cmd *bcmd;
+    struct rt_nvme_device *ndev = rt_disk_to_nvme_device(disk);
+    struct rt_nvme_controller *nvme = ndev->ctrl;
+    struct rt_nvme_queue *queue = &nvme->io_queues[qid % nvme->io_queue_max];
+
+    rt_list_for_each_entry_safe(req, req_next, requests, list)
+    {
+        level = rt_spin_lock_irqsave(&queue->lock);
+
+        /* The room in the SQ is taken with the slot */
+        if (rt_list_isempty(&queue->blk_free) || queue->inflight + 1 >= queue->depth)
+        {
+            rt_spin_unlock_irqrestore(&queue->lock, level);
+
+            return -RT_EBUSY;
+        }
+
+        bcmd = rt_list_first_entry(&queue->blk_free, struct rt_nvme_blk_cmd, list);
+        rt_list_remove(&bcmd->list);
+        ++queue->inflight;
+
+        rt_spin_unlock_irqrestore(&queue->lock, level);
+
+        rt_list_remove(&req->list);
+
+        if ((err = nvme_blk_cmd_prepare(ndev, bcmd, req)))
+        {
+            nvme_blk_cmd_put(queue, bcmd, RT_FALSE);
+
+            /* Too large for one command, or out of DMA memory */
+            rt_blk_request_complete(req, nvme_blk_rw_sync(disk, req));
+
+            continue;
+        }
+
+        bcmd->cmd.common.cmdid = rt_cpu_to_le16(NVME_BLK_CMDID | (bcmd - queue->blk_cmds));
+
+        level = rt_spin_lock_irqsave(&queue->lock);
+
+        tail = queue->sq_tail;
+        rt_memcpy(&queue->sq_cmds[tail], &bcmd->cmd, sizeof(bcmd->cmd));
+
+        if (nvme->ops->submit_cmd && (err = nvme->ops->submit_cmd(queue, &bcmd->cmd)))
+        {
+            rt_spin_unlock_irqrestore(&queue->lock, level);
+
+            bcmd->err = err;
+            nvme_blk_cmd_finish(bcmd);
+            nvme_blk_cmd_put(queue, bcmd, RT_FALSE);
+
+            rt_blk_request_complete(req, err);
+
+            continue;
+        }
+
+        if (++tail == queue->depth)
+        {
+            tail = 0;
+        }
+        HWREG32(queue->doorbell) = tail;
+        queue->sq_tail = tail;
+
+        rt_spin_unlock_irqrestore(&queue->lock, level);
+    }
+
+    return RT_EOK;
+}
+#endif /* RT_BLK_USING_MQ */
+
 static rt_err_t nvme_blk_getgeome(struct rt_blk_disk *disk,
         struct rt_device_blk_geometry *geometry)
 {
@@ -573,7 +1161,8 @@ static rt_err_t nvme_blk_sync(struct rt_blk_disk *disk)
     cmd.common.opcode = RT_NVME_CMD_FLUSH;
     cmd.common.nsid = rt_cpu_to_le32(ndev->nsid);
 
-    return nvme_submit_io_cmd(ndev->ctrl, &cmd);
+    /* Flushing the volatile cache is never short */
+    return nvme_submit_io_cmd(ndev->ctrl, &cmd, NVME_IO_NO_POLL);
 }
 
 static rt_err_t nvme_blk_erase(struct rt_blk_disk *disk)
@@ -607,7 +1196,7 @@ static rt_err_t nvme_blk_erase(struct rt_blk_disk *disk)
         cmd.write_zeroes.slba = rt_cpu_to_le16(slba);
         cmd.write_zeroes.length = rt_cpu_to_le16(max_lbas - 1);
 
-        if ((err = nvme_submit_io_cmd(nvme, &cmd)))
+        if ((err = nvme_submit_io_cmd(nvme, &cmd, NVME_IO_NO_POLL)))
         {
             break;
         }
@@ -644,48 +1233,19 @@ static const struct rt_blk_disk_ops nvme_blk_ops =
     .sync = nvme_blk_sync,
     .erase = nvme_blk_erase,
     .autorefresh = nvme_blk_autorefresh,
+#ifdef RT_BLK_USING_MQ
+    .submit = nvme_blk_submit,
+#endif
 };
 
 static void nvme_queue_isr(int irqno, void *param)
 {
     rt_ubase_t level;
-    rt_uint16_t head, phase, status;
     struct rt_nvme_queue *queue = param;
-    struct rt_nvme_controller *nvme = queue->nvme;
 
     level = rt_spin_lock_irqsave(&queue->lock);
 
-    head = queue->cq_head;
-    phase = queue->cq_phase;
-    status = HWREG16(&queue->cq_entry[head].status);
-    status = rt_le16_to_cpu(status);
-
-    if ((status & 0x01) == phase)
-    {
-        if ((status >> 1))
-        {
-            queue->err = -RT_EIO;
-            goto _end_cmd;
-        }
-
-        if (nvme->ops->complete_cmd)
-        {
-            nvme->ops->complete_cmd(queue, queue->cmd);
-        }
-
-    _end_cmd:
-        if (++head == queue->depth)
-        {
-            head = 0;
-            phase = !phase;
-        }
-
-        HWREG32(queue->doorbell + nvme->doorbell_stride) = head;
-        queue->cq_head = head;
-        queue->cq_phase = phase;
-
-        rt_completion_done(&queue->done);
-    }
+    nvme_queue_reap(queue);
 
     rt_spin_unlock_irqrestore(&queue->lock, level);
 }
@@ -717,7 +1277,7 @@ static rt_err_t nvme_identify(struct rt_nvme_controller *nvme,
 
     rt_hw_cpu_dcache_ops(RT_HW_CACHE_FLUSH, data, sizeof(struct rt_nvme_id_ctrl));
 
-    if (!(err = nvme_submit_cmd(&nvme->admin_queue, &cmd)))
+    if (!(err = nvme_submit_cmd(&nvme->admin_queue, &cmd, RT_FALSE)))
     {
         rt_hw_cpu_dcache_ops(RT_HW_CACHE_INVALIDATE, data, sizeof(struct rt_nvme_id_ctrl));
     }
@@ -757,7 +1317,7 @@ static rt_err_t nvme_attach_queue(struct rt_nvme_queue *queue, rt_uint8_t opcode
         RT_ASSERT(0);
     }
 
-    return nvme_submit_cmd(&nvme->admin_queue, &cmd);
+    return nvme_submit_cmd(&nvme->admin_queue, &cmd, RT_FALSE);
 }
 
 rt_inline rt_err_t nvme_attach_queue_sq(struct rt_nvme_queue *queue)
@@ -780,7 +1340,7 @@ static rt_err_t nvme_detach_queue(struct rt_nvme_queue *queue,
     cmd.delete_queue.opcode = opcode;
     cmd.delete_queue.qid = rt_cpu_to_le16(queue->qid);
 
-    return nvme_submit_cmd(&nvme->admin_queue, &cmd);
+    return nvme_submit_cmd(&nvme->admin_queue, &cmd, RT_FALSE);
 }
 
 rt_inline rt_ubase_t nvme_queue_dma_flags(void)
@@ -816,6 +1376,15 @@ static void nvme_free_queue(struct rt_nvme_queue *queue)
         rt_dma_free(nvme->dev, sizeof(*queue->cq_entry) * queue->depth,
                 queue->cq_entry, queue->cq_entry_phy, dma_flags);
     }
+
+#ifdef RT_BLK_USING_MQ
+    if (queue->blk_cmds)
+    {
+        rt_work_cancel(&queue->blk_work);
+        rt_free(queue->blk_cmds);
+        queue->blk_cmds = RT_NULL;
+    }
+#endif
 }
 
 static struct rt_nvme_queue *nvme_alloc_queue(struct rt_nvme_controller *nvme,
@@ -833,9 +1402,34 @@ static struct rt_nvme_queue *nvme_alloc_queue(struct rt_nvme_controller *nvme,
     queue->depth = depth;
     queue->cq_head = 0;
     queue->cq_phase = 1;
-    rt_completion_init(&queue->done);
+    queue->sync_free = RT_GENMASK(RT_NVME_SYNC_CMD_NR - 1, 0);
     rt_spin_lock_init(&queue->lock);
 
+#ifdef RT_BLK_USING_MQ
+    rt_list_init(&queue->blk_free);
+    rt_list_init(&queue->blk_done);
+    rt_work_init(&queue->blk_work, nvme_blk_work, queue);
+
+    if (qid != 0)
+    {
+        /* Slot is the low bits of the command id */
+        int slots = rt_min_t(int, depth - 1, NVME_BLK_CMDID);
+
+        queue->blk_cmds = rt_calloc(slots, sizeof(*queue->blk_cmds));
+
+        if (!queue->blk_cmds)
+        {
+            err = -RT_ENOMEM;
+            goto _fail;
+        }
+
+        for (int i = 0; i < slots; ++i)
+        {
+            rt_list_insert_before(&queue->blk_free, &queue->blk_cmds[i].list);
+        }
+    }
+#endif /* RT_BLK_USING_MQ */
+
     dma_flags = nvme_queue_dma_flags();
 
     /* struct rt_nvme_command */
@@ -959,6 +1553,12 @@ static rt_err_t nvme_setup_io_queues(struct rt_nvme_controller *nvme)
     struct rt_nvme_queue *queue;
 
     nvme->io_queue_max = nvme->irqs_nr > 1 ? nvme->irqs_nr - 1 : 1;
+
+    /* Start every CPU from its own queue which the IRQ is routed to */
+    for (int i = 0; i < RT_CPUS_NR; ++i)
+    {
+        rt_atomic_store(&nvme->ioqid[i], i);
+    }
     value = (nvme->io_queue_max - 1) | ((nvme->io_queue_max - 1) << 16);
 
     if ((err = nvme_set_features_simple(nvme, RT_NVME_FEAT_NUM_QUEUES, value)))
@@ -1094,6 +1694,9 @@ static rt_err_t nvme_scan_device(struct rt_nvme_controller *nvme,
 
         ndev->parent.ida = &nvme_ida;
         ndev->parent.parallel_io = RT_TRUE;
+    #ifdef RT_BLK_USING_MQ
+        ndev->parent.nr_hw_queues = nvme->io_queue_max;
+    #endif
         ndev->parent.ops = &nvme_blk_ops;
         ndev->parent.max_partitions = RT_BLK_PARTITION_MAX;
         rt_dm_dev_set_name(&ndev->parent.parent, "%sn%u", nvme->name, nsid);
@@ -1300,3 +1903,90 @@ static int nvme_queue_affinify_fixup(void)
     return 0;
 }
 INIT_SECONDARY_CPU_EXPORT(nvme_queue_affinify_fixup);
+
+#if defined(RT_NVME_IO_STATS) && defined(RT_USING_CONSOLE) && defined(RT_USING_MSH)
+struct nvme_queue_stat
+{
+    const char *name;
+    int index;
+    rt_uint32_t polled;
+    rt_uint32_t poll_fallback;
+    rt_uint32_t lat_hist[RT_NVME_LAT_HIST_NR];
+};
+
+static int nvme_stat(int argc, char **argv)
+{
+    rt_ubase_t level;
+    int nr = 0, count = 0;
+    struct nvme_queue_stat *stats, *stat;
+    struct rt_nvme_queue *queue;
+    struct rt_nvme_controller *nvme;
+
+    level = rt_spin_lock_irqsave(&nvme_lock);
+    rt_list_for_each_entry(nvme, &nvme_nodes, list)
+    {
+        nr += nvme->io_queue_max;
+    }
+    rt_spin_unlock_irqrestore(&nvme_lock, level);
+
+    if (!nr || !(stats = rt_malloc(sizeof(*stats) * nr)))
+    {
+        return nr ? -RT_ENOMEM : 0;
+    }
+
+    /* Snapshot under the lock, print without it */
+    level = rt_spin_lock_irqsave(&nvme_lock);
+    rt_list_for_each_entry(nvme, &nvme_nodes, list)
+    {
+        for (int i = 0; i < nvme->io_queue_max && count < nr; ++i, ++count)
+        {
+            queue = &nvme->io_queues[i];
+            stat = &stats[count];
+
+            stat->name = nvme->name;
+            stat->index = i;
+            stat->polled = (rt_uint32_t)rt_atomic_load(&queue->polled);
+            stat->poll_fallback = (rt_uint32_t)rt_atomic_load(&queue->poll_fallback);
+
+            for (int bucket = 0; bucket < RT_NVME_LAT_HIST_NR; ++bucket)
+            {
+                stat->lat_hist[bucket] = (rt_uint32_t)rt_atomic_load(&queue->lat_hist[bucket]);
+            }
+        }
+    }
+    rt_spin_unlock_irqrestore(&nvme_lock, level);
+
+    for (stat = stats; stat < &stats[count]; ++stat)
+    {
+        rt_uint32_t total = 0;
+
+        rt_kprintf("%s-io-queue%d: polled %u, fallback %u\n", stat->name, stat->index,
+                stat->polled, stat->poll_fallback);
+
+        for (int bucket = 0; bucket < RT_NVME_LAT_HIST_NR; ++bucket)
+        {
+            if (!stat->lat_hist[bucket])
+            {
+                continue;
+            }
+            total += stat->lat_hist[bucket];
+
+            if (bucket < RT_NVME_LAT_HIST_NR - 1)
+            {
+                rt_kprintf("  < %8u us: %u\n", 1U << bucket, stat->lat_hist[bucket]);
+            }
+            else
+            {
+                rt_kprintf("  >=%8u us: %u\n", 1U << (bucket - 1), stat->lat_hist[bucket]);
+            }
+        }
+
+        rt_kprintf("  total: %u\n", total);
+    }
+
+    rt_free(stats);
+
+    return 0;
+}
+MSH_CMD_EXPORT(nvme_stat, dump NVMe I/O queues polling and latency histogram);
+#endif /* RT_NVME_IO_STATS && RT_USING_CONSOLE && RT_USING_MSH */
@@ -7,6 +7,7 @@
  * Date           Author       Notes
  * 2021-9-16      GuEe-GUI     the first version
  * 2021-11-11     GuEe-GUI     using virtio common interface
+ * 2026-10-17     agent        multi-outstanding requests, indirect descriptors and multi-queue
  */
 
 #include <rthw.h>
@@ -17,84 +18,247 @@
 #ifdef RT_USING_VIRTIO_BLK
 
 #include <virtio_blk.h>
+#include <drivers/misc.h>
 
-static void virtio_blk_rw(struct virtio_blk_device *virtio_blk_dev, rt_off_t pos, void *buffer, rt_size_t count,
-    int flags)
+struct virtio_blk_seg
 {
-    rt_uint16_t idx[3];
-    rt_size_t size = count * virtio_blk_dev->config->blk_size;
-    struct virtio_device *virtio_dev = &virtio_blk_dev->virtio_dev;
+    rt_ubase_t addr;
+    rt_uint32_t len;
+};
 
+rt_inline void virtio_blk_fill_desc(struct virtq_desc *desc,
+        rt_uint64_t addr, rt_uint32_t len, rt_uint16_t flags, rt_uint16_t next)
+{
+    desc->addr = addr;
+    desc->len = len;
+    desc->flags = flags;
+    desc->next = next;
+}
+
+static int virtio_blk_queue_select(struct virtio_blk_device *virtio_blk_dev)
+{
 #ifdef RT_USING_SMP
-    rt_base_t level = rt_spin_lock_irqsave(&virtio_dev->spinlock);
+    return rt_hw_cpu_id() % virtio_blk_dev->virtio_dev.queues_num;
+#else
+    return 0;
 #endif
+}
+
+static void virtio_blk_kick(struct virtio_blk_device *virtio_blk_dev, int qid)
+{
+    struct virtio_device *virtio_dev = &virtio_blk_dev->virtio_dev;
+
+    rt_hw_dsb();
 
-    /* Allocate 3 descriptors */
-    while (virtio_alloc_desc_chain(virtio_dev, 0, 3, idx))
+    /* The device is still consuming the avail ring, it will see our entries */
+    if (!(virtio_dev->queues[qid].used->flags & VIRTQ_USED_F_NO_NOTIFY))
     {
-#ifdef RT_USING_SMP
-        rt_spin_unlock_irqrestore(&virtio_dev->spinlock, level);
-#endif
-        rt_thread_yield();
+        virtio_queue_notify(virtio_dev, qid);
+    }
+}
 
-#ifdef RT_USING_SMP
-        level = rt_spin_lock_irqsave(&virtio_dev->spinlock);
-#endif
+/*
+ * Map the head of the buffer to at most seg_max physically contiguous
+ * segments, returns the bytes mapped which is always a multiple of sectors.
+ */
+static rt_size_t virtio_blk_map_segs(struct virtio_blk_device *virtio_blk_dev,
+        rt_uint8_t *buffer, rt_size_t size, struct virtio_blk_seg *segs, rt_size_t *nsegs)
+{
+    rt_size_t n = 0, mapped = 0, trim, len;
+    rt_ubase_t va, pa;
+
+    while (mapped < size)
+    {
+        va = (rt_ubase_t)buffer + mapped;
+        pa = VIRTIO_VA2PA((void *)va);
+
+        len = VIRTIO_PAGE_SIZE - (va & (VIRTIO_PAGE_SIZE - 1));
+        len = rt_min_t(rt_size_t, len, size - mapped);
+        len = rt_min_t(rt_size_t, len, virtio_blk_dev->size_max);
+
+        if (n > 0 && segs[n - 1].addr + segs[n - 1].len == pa &&
+            segs[n - 1].len + len <= virtio_blk_dev->size_max)
+        {
+            segs[n - 1].len += len;
+        }
+        else
+        {
+            if (n == virtio_blk_dev->seg_max)
+            {
+                break;
+            }
+
+            segs[n].addr = pa;
+            segs[n].len = len;
+            ++n;
+        }
+
+        mapped += len;
     }
 
-    virtio_blk_dev->info[idx[0]].status = 0xff;
-    virtio_blk_dev->info[idx[0]].valid = RT_TRUE;
-    virtio_blk_dev->info[idx[0]].req.type = flags;
-    virtio_blk_dev->info[idx[0]].req.ioprio = 0;
-    virtio_blk_dev->info[idx[0]].req.sector = pos * (virtio_blk_dev->config->blk_size / 512);
+    /* The rest goes to the next request, which must start at a sector */
+    trim = mapped % VIRTIO_BLK_BYTES_PER_SECTOR;
+    mapped -= trim;
 
-    flags = flags == VIRTIO_BLK_T_OUT ? 0 : VIRTQ_DESC_F_WRITE;
+    while (trim > 0)
+    {
+        if (segs[n - 1].len <= trim)
+        {
+            trim -= segs[n - 1].len;
+            --n;
+        }
+        else
+        {
+            segs[n - 1].len -= trim;
+            trim = 0;
+        }
+    }
 
-    virtio_fill_desc(virtio_dev, VIRTIO_BLK_QUEUE, idx[0],
-            VIRTIO_VA2PA(&virtio_blk_dev->info[idx[0]].req), sizeof(struct virtio_blk_req), VIRTQ_DESC_F_NEXT, idx[1]);
+    *nsegs = n;
 
-    virtio_fill_desc(virtio_dev, VIRTIO_BLK_QUEUE, idx[1],
-            VIRTIO_VA2PA(buffer), size, flags | VIRTQ_DESC_F_NEXT, idx[2]);
+    return mapped;
+}
 
-    virtio_fill_desc(virtio_dev, VIRTIO_BLK_QUEUE, idx[2],
-            VIRTIO_VA2PA(&virtio_blk_dev->info[idx[0]].status), sizeof(rt_uint8_t), VIRTQ_DESC_F_WRITE, 0);
+static void virtio_blk_queue_rq(struct virtio_blk_device *virtio_blk_dev, int qid,
+        struct virtio_blk_batch *batch, int type, rt_uint64_t sector,
+        struct virtio_blk_seg *segs, rt_size_t nsegs, rt_bool_t *kick)
+{
+    rt_err_t err;
+    rt_base_t level;
+    rt_size_t ndesc = nsegs + 2;
+    rt_uint16_t head, flags, idx[VIRTIO_BLK_DESC_MAX];
+    struct virtq_desc *desc;
+    struct virtio_blk_request *req;
+    struct virtio_device *virtio_dev = &virtio_blk_dev->virtio_dev;
+    struct virtio_blk_queue *queue = &virtio_blk_dev->queues[qid];
 
-    virtio_submit_chain(virtio_dev, VIRTIO_BLK_QUEUE, idx[0]);
+    if (rt_sem_trytake(&queue->free_sem) != RT_EOK)
+    {
+        /* The ring is full, let the device see what we queued before sleeping */
+        if (*kick)
+        {
+            virtio_blk_kick(virtio_blk_dev, qid);
+            *kick = RT_FALSE;
+        }
 
-    virtio_queue_notify(virtio_dev, VIRTIO_BLK_QUEUE);
+        rt_sem_take(&queue->free_sem, RT_WAITING_FOREVER);
+    }
 
-    /* Wait for virtio_blk_isr() to done */
-    while (virtio_blk_dev->info[idx[0]].valid)
+    rt_atomic_add(&batch->pending, 1);
+
+    level = rt_spin_lock_irqsave(&queue->lock);
+
+    /* The semaphore makes sure that the descriptors are enough */
+    if (virtio_blk_dev->indirect)
     {
-#ifdef RT_USING_SMP
-        rt_spin_unlock_irqrestore(&virtio_dev->spinlock, level);
-#endif
-        rt_thread_yield();
+        head = virtio_alloc_desc(virtio_dev, qid);
+        RT_ASSERT(head != VIRTQ_INVALID_DESC_ID);
 
-#ifdef RT_USING_SMP
-        level = rt_spin_lock_irqsave(&virtio_dev->spinlock);
-#endif
+        desc = &queue->indirect[head * VIRTIO_BLK_DESC_MAX];
+
+        for (int i = 0; i < ndesc; ++i)
+        {
+            idx[i] = i;
+        }
     }
+    else
+    {
+        err = virtio_alloc_desc_chain(virtio_dev, qid, ndesc, idx);
+        RT_ASSERT(err == RT_EOK);
+        RT_UNUSED(err);
 
-    virtio_free_desc_chain(virtio_dev, VIRTIO_BLK_QUEUE, idx[0]);
+        head = idx[0];
+        desc = virtio_dev->queues[qid].desc;
+    }
 
-#ifdef RT_USING_SMP
-    rt_spin_unlock_irqrestore(&virtio_dev->spinlock, level);
-#endif
+    req = &queue->reqs[head];
+    req->req.type = type;
+    req->req.ioprio = 0;
+    req->req.sector = sector;
+    req->status = 0xff;
+    req->batch = batch;
+
+    flags = type == VIRTIO_BLK_T_OUT ? 0 : VIRTQ_DESC_F_WRITE;
+
+    virtio_blk_fill_desc(&desc[idx[0]],
+            VIRTIO_VA2PA(&req->req), sizeof(struct virtio_blk_req), VIRTQ_DESC_F_NEXT, idx[1]);
+
+    for (int i = 0; i < nsegs; ++i)
+    {
+        virtio_blk_fill_desc(&desc[idx[i + 1]],
+                segs[i].addr, segs[i].len, flags | VIRTQ_DESC_F_NEXT, idx[i + 2]);
+    }
+
+    virtio_blk_fill_desc(&desc[idx[ndesc - 1]],
+            VIRTIO_VA2PA(&req->status), sizeof(rt_uint8_t), VIRTQ_DESC_F_WRITE, 0);
+
+    if (virtio_blk_dev->indirect)
+    {
+        virtio_fill_desc(virtio_dev, qid, head,
+                VIRTIO_VA2PA(desc), ndesc * sizeof(struct virtq_desc), VIRTQ_DESC_F_INDIRECT, 0);
+    }
+
+    virtio_submit_chain(virtio_dev, qid, head);
+
+    rt_spin_unlock_irqrestore(&queue->lock, level);
+
+    *kick = RT_TRUE;
 }
 
-static rt_ssize_t virtio_blk_read(rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t count)
+static rt_ssize_t virtio_blk_rw(struct virtio_blk_device *virtio_blk_dev, rt_off_t pos, void *buffer, rt_size_t count,
+    int type)
 {
-    virtio_blk_rw((struct virtio_blk_device *)dev, pos, buffer, count, VIRTIO_BLK_T_IN);
+    int qid;
+    rt_bool_t kick = RT_FALSE;
+    rt_size_t size, mapped, nsegs;
+    rt_uint64_t sector;
+    rt_uint8_t *data = buffer;
+    struct virtio_blk_batch batch;
+    struct virtio_blk_seg segs[RT_VIRTIO_BLK_SEG_MAX];
+
+    size = count * virtio_blk_dev->config->blk_size;
+    sector = pos * (virtio_blk_dev->config->blk_size / VIRTIO_BLK_BYTES_PER_SECTOR);
+    qid = virtio_blk_queue_select(virtio_blk_dev);
+
+    /* Biased by one so that the completion can not be done while queuing */
+    rt_atomic_store(&batch.pending, 1);
+    rt_atomic_store(&batch.error, 0);
+    rt_completion_init(&batch.done);
+
+    while (size > 0)
+    {
+        mapped = virtio_blk_map_segs(virtio_blk_dev, data, size, segs, &nsegs);
+        RT_ASSERT(mapped > 0);
+
+        virtio_blk_queue_rq(virtio_blk_dev, qid, &batch, type, sector, segs, nsegs, &kick);
+
+        data += mapped;
+        size -= mapped;
+        sector += mapped / VIRTIO_BLK_BYTES_PER_SECTOR;
+    }
+
+    if (kick)
+    {
+        virtio_blk_kick(virtio_blk_dev, qid);
+    }
+
+    /* Wait for virtio_blk_isr() to done */
+    if (rt_atomic_sub(&batch.pending, 1) != 1)
+    {
+        rt_completion_wait(&batch.done, RT_WAITING_FOREVER);
+    }
 
-    return count;
+    return rt_atomic_load(&batch.error) ? -RT_EIO : count;
 }
 
-static rt_ssize_t virtio_blk_write(rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t count)
+static rt_ssize_t virtio_blk_read(rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t count)
 {
-    virtio_blk_rw((struct virtio_blk_device *)dev, pos, (void *)buffer, count, VIRTIO_BLK_T_OUT);
+    return virtio_blk_rw((struct virtio_blk_device *)dev, pos, buffer, count, VIRTIO_BLK_T_IN);
+}
 
-    return count;
+static rt_ssize_t virtio_blk_write(rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t count)
+{
+    return virtio_blk_rw((struct virtio_blk_device *)dev, pos, (void *)buffer, count, VIRTIO_BLK_T_OUT);
 }
 
 static rt_err_t virtio_blk_control(rt_device_t dev, int cmd, void *args)
@@ -139,47 +303,190 @@ const static struct rt_device_ops virtio_blk_ops =
 };
 #endif
 
-static void virtio_blk_isr(int irqno, void *param)
+static void virtio_blk_complete(struct virtio_blk_device *virtio_blk_dev, int qid)
 {
     rt_uint32_t id;
-    struct virtio_blk_device *virtio_blk_dev = (struct virtio_blk_device *)param;
+    rt_uint8_t status;
+    rt_base_t level;
+    struct virtio_blk_batch *batch;
     struct virtio_device *virtio_dev = &virtio_blk_dev->virtio_dev;
-    struct virtq *queue = &virtio_dev->queues[VIRTIO_BLK_QUEUE];
+    struct virtio_blk_queue *queue = &virtio_blk_dev->queues[qid];
+    struct virtq *vq = &virtio_dev->queues[qid];
 
-#ifdef RT_USING_SMP
-    rt_base_t level = rt_spin_lock_irqsave(&virtio_dev->spinlock);
-#endif
+    level = rt_spin_lock_irqsave(&queue->lock);
+
+    /* The device increments disk.used->idx when it adds an entry to the used ring */
+    while (vq->used_idx != vq->used->idx)
+    {
+        rt_hw_dsb();
+        id = vq->used->ring[vq->used_idx % vq->num].id;
+
+        /* The slot may be reused as soon as the chain is free */
+        status = queue->reqs[id].status;
+        batch = queue->reqs[id].batch;
+
+        virtio_free_desc_chain(virtio_dev, qid, id);
+        vq->used_idx++;
+
+        rt_spin_unlock_irqrestore(&queue->lock, level);
+
+        if (status != VIRTIO_BLK_S_OK)
+        {
+            rt_atomic_store(&batch->error, 1);
+        }
+
+        if (rt_atomic_sub(&batch->pending, 1) == 1)
+        {
+            rt_completion_done(&batch->done);
+        }
+
+        rt_sem_release(&queue->free_sem);
+
+        level = rt_spin_lock_irqsave(&queue->lock);
+    }
+
+    rt_spin_unlock_irqrestore(&queue->lock, level);
+}
+
+static void virtio_blk_isr(int irqno, void *param)
+{
+    struct virtio_blk_device *virtio_blk_dev = (struct virtio_blk_device *)param;
+    struct virtio_device *virtio_dev = &virtio_blk_dev->virtio_dev;
 
     virtio_interrupt_ack(virtio_dev);
     rt_hw_dsb();
 
-    /* The device increments disk.used->idx when it adds an entry to the used ring */
-    while (queue->used_idx != queue->used->idx)
+    for (int qid = 0; qid < virtio_dev->queues_num; ++qid)
     {
-        rt_hw_dsb();
-        id = queue->used->ring[queue->used_idx % queue->num].id;
+        virtio_blk_complete(virtio_blk_dev, qid);
+    }
+}
 
-        RT_ASSERT(virtio_blk_dev->info[id].status == 0);
+static void virtio_blk_queues_free(struct virtio_blk_device *virtio_blk_dev)
+{
+    struct virtio_blk_queue *queue;
+    struct virtio_device *virtio_dev = &virtio_blk_dev->virtio_dev;
+
+    if (virtio_blk_dev->queues == RT_NULL)
+    {
+        return;
+    }
+
+    for (int qid = 0; qid < virtio_dev->queues_num; ++qid)
+    {
+        queue = &virtio_blk_dev->queues[qid];
 
-        /* Done with buffer */
-        virtio_blk_dev->info[id].valid = RT_FALSE;
+        if (queue->reqs != RT_NULL)
+        {
+            rt_sem_detach(&queue->free_sem);
+            rt_free(queue->reqs);
+        }
+
+        if (queue->indirect != RT_NULL)
+        {
+            rt_free_align(queue->indirect);
+        }
 
-        queue->used_idx++;
+        if (virtio_dev->queues[qid].num > 0)
+        {
+            virtio_queue_destroy(virtio_dev, qid);
+        }
     }
 
-#ifdef RT_USING_SMP
-    rt_spin_unlock_irqrestore(&virtio_dev->spinlock, level);
-#endif
+    rt_free(virtio_blk_dev->queues);
+    virtio_blk_dev->queues = RT_NULL;
+
+    virtio_queues_free(virtio_dev);
+}
+
+static rt_err_t virtio_blk_queues_init(struct virtio_blk_device *virtio_blk_dev, rt_size_t queues_num)
+{
+    rt_size_t ring_size, slots;
+    struct virtio_blk_queue *queue;
+    struct virtio_device *virtio_dev = &virtio_blk_dev->virtio_dev;
+
+    if (virtio_queues_alloc(virtio_dev, queues_num) != RT_EOK)
+    {
+        return -RT_ENOMEM;
+    }
+
+    rt_memset(virtio_dev->queues, 0, sizeof(struct virtq) * queues_num);
+
+    virtio_blk_dev->queues = rt_calloc(queues_num, sizeof(struct virtio_blk_queue));
+
+    if (virtio_blk_dev->queues == RT_NULL)
+    {
+        virtio_queues_free(virtio_dev);
+        return -RT_ENOMEM;
+    }
+
+    for (int qid = 0; qid < queues_num; ++qid)
+    {
+        queue = &virtio_blk_dev->queues[qid];
+
+        virtio_dev->mmio_config->queue_sel = qid;
+        ring_size = VIRTIO_BLK_QUEUE_RING_SIZE;
+
+        while (ring_size > virtio_dev->mmio_config->queue_num_max)
+        {
+            ring_size >>= 1;
+        }
+
+        RT_ASSERT(ring_size >= 4);
+
+        if (virtio_queue_init(virtio_dev, qid, ring_size) != RT_EOK)
+        {
+            goto _fail;
+        }
+
+        if (virtio_blk_dev->indirect)
+        {
+            /* Every request takes one descriptor in the ring */
+            slots = ring_size;
+
+            queue->indirect = rt_malloc_align(
+                    ring_size * VIRTIO_BLK_DESC_MAX * sizeof(struct virtq_desc), sizeof(struct virtq_desc));
+
+            if (queue->indirect == RT_NULL)
+            {
+                goto _fail;
+            }
+        }
+        else
+        {
+            virtio_blk_dev->seg_max = rt_min_t(rt_uint32_t, virtio_blk_dev->seg_max, ring_size - 2);
+            slots = ring_size / (virtio_blk_dev->seg_max + 2);
+        }
+
+        queue->reqs = rt_calloc(ring_size, sizeof(struct virtio_blk_request));
+
+        if (queue->reqs == RT_NULL)
+        {
+            goto _fail;
+        }
+
+        rt_spin_lock_init(&queue->lock);
+        rt_sem_init(&queue->free_sem, "virtio-blk", slots, RT_IPC_FLAG_FIFO);
+    }
+
+    return RT_EOK;
+
+_fail:
+    virtio_blk_queues_free(virtio_blk_dev);
+
+    return -RT_ENOMEM;
 }
 
 rt_err_t rt_virtio_blk_init(rt_ubase_t *mmio_base, rt_uint32_t irq)
 {
     static int dev_no = 0;
     char dev_name[RT_NAME_MAX];
+    rt_uint32_t features;
+    rt_size_t queues_num = 1;
     struct virtio_device *virtio_dev;
     struct virtio_blk_device *virtio_blk_dev;
 
-    virtio_blk_dev = rt_malloc(sizeof(struct virtio_blk_device));
+    virtio_blk_dev = rt_calloc(1, sizeof(struct virtio_blk_device));
 
     if (virtio_blk_dev == RT_NULL)
     {
@@ -200,25 +507,38 @@ rt_err_t rt_virtio_blk_init(rt_ubase_t *mmio_base, rt_uint32_t irq)
     virtio_status_acknowledge_driver(virtio_dev);
 
     /* Negotiate features */
-    virtio_dev->mmio_config->driver_features = virtio_dev->mmio_config->device_features & ~(
+    features = virtio_dev->mmio_config->device_features & ~(
             (1 << VIRTIO_BLK_F_RO) |
-            (1 << VIRTIO_BLK_F_MQ) |
             (1 << VIRTIO_BLK_F_SCSI) |
             (1 << VIRTIO_BLK_F_CONFIG_WCE) |
             (1 << VIRTIO_F_ANY_LAYOUT) |
-            (1 << VIRTIO_F_RING_EVENT_IDX) |
-            (1 << VIRTIO_F_RING_INDIRECT_DESC));
+            (1 << VIRTIO_F_RING_EVENT_IDX));
+    virtio_dev->mmio_config->driver_features = features;
 
-    /* Tell device that feature negotiation is complete and we're completely ready */
-    virtio_status_driver_ok(virtio_dev);
+    virtio_blk_dev->indirect = !!(features & (1 << VIRTIO_F_RING_INDIRECT_DESC));
+    virtio_blk_dev->seg_max = RT_VIRTIO_BLK_SEG_MAX;
+    virtio_blk_dev->size_max = RT_UINT32_MAX;
 
-    if (virtio_queues_alloc(virtio_dev, 1) != RT_EOK)
+    if ((features & (1 << VIRTIO_BLK_F_SEG_MAX)) && virtio_blk_dev->config->seg_max > 0)
     {
-        goto _alloc_fail;
+        virtio_blk_dev->seg_max = rt_min_t(rt_uint32_t, virtio_blk_dev->seg_max, virtio_blk_dev->config->seg_max);
+    }
+
+    if ((features & (1 << VIRTIO_BLK_F_SIZE_MAX)) && virtio_blk_dev->config->size_max > 0)
+    {
+        virtio_blk_dev->size_max = virtio_blk_dev->config->size_max;
+    }
+
+    if ((features & (1 << VIRTIO_BLK_F_MQ)) && virtio_blk_dev->config->num_queues > 0)
+    {
+        /* More queues than CPUs only cost memory */
+        queues_num = rt_min_t(rt_size_t, virtio_blk_dev->config->num_queues, RT_CPUS_NR);
     }
 
-    /* Initialize queue 0 */
-    if (virtio_queue_init(virtio_dev, 0, VIRTIO_BLK_QUEUE_RING_SIZE) != RT_EOK)
+    /* Tell device that feature negotiation is complete and we're completely ready */
+    virtio_status_driver_ok(virtio_dev);
+
+    if (virtio_blk_queues_init(virtio_blk_dev, queues_num) != RT_EOK)
     {
         goto _alloc_fail;
     }
@@ -246,7 +566,6 @@ _alloc_fail:
 
     if (virtio_blk_dev != RT_NULL)
     {
-        virtio_queues_free(virtio_dev);
         rt_free(virtio_blk_dev);
     }
     return -RT_ENOMEM;
@@ -7,19 +7,32 @@
  * Date           Author       Notes
  * 2021-9-16      GuEe-GUI     the first version
  * 2021-11-11     GuEe-GUI     using virtio common interface
+ * 2026-10-17     agent        multi-outstanding requests, indirect descriptors and multi-queue
  */
 
 #ifndef __VIRTIO_BLK_H__
 #define __VIRTIO_BLK_H__
 
 #include <rtdef.h>
+#include <ipc/completion.h>
 
 #include <virtio.h>
 
-#define VIRTIO_BLK_QUEUE            0
+#ifndef RT_VIRTIO_BLK_QUEUE_RING_SIZE
+#define RT_VIRTIO_BLK_QUEUE_RING_SIZE   128
+#endif
+
+#ifndef RT_VIRTIO_BLK_SEG_MAX
+#define RT_VIRTIO_BLK_SEG_MAX       14
+#endif
+
 #define VIRTIO_BLK_BYTES_PER_SECTOR 512
-#define VIRTIO_BLK_QUEUE_RING_SIZE  4
+#define VIRTIO_BLK_QUEUE_RING_SIZE  RT_VIRTIO_BLK_QUEUE_RING_SIZE
+/* Header + data segments + status */
+#define VIRTIO_BLK_DESC_MAX         (RT_VIRTIO_BLK_SEG_MAX + 2)
 
+#define VIRTIO_BLK_F_SIZE_MAX       1   /* Indicates maximum segment size */
+#define VIRTIO_BLK_F_SEG_MAX        2   /* Indicates maximum # of segments */
 #define VIRTIO_BLK_F_RO             5   /* Disk is read-only */
 #define VIRTIO_BLK_F_SCSI           7   /* Supports scsi command passthru */
 #define VIRTIO_BLK_F_CONFIG_WCE     11  /* Writeback mode available in config */
@@ -32,6 +45,10 @@
 #define VIRTIO_BLK_T_FLUSH          4
 #define VIRTIO_BLK_T_FLUSH_OUT      5
 
+#define VIRTIO_BLK_S_OK             0
+#define VIRTIO_BLK_S_IOERR          1
+#define VIRTIO_BLK_S_UNSUPP         2
+
 struct virtio_blk_req
 {
     rt_uint32_t type;
@@ -82,6 +99,34 @@ struct virtio_blk_config
     rt_uint32_t secure_erase_sector_alignment;
 } __attribute__((packed));
 
+struct virtio_blk_batch
+{
+    rt_atomic_t pending;
+    rt_atomic_t error;
+
+    struct rt_completion done;
+};
+
+struct virtio_blk_request
+{
+    struct virtio_blk_req req;
+    rt_uint8_t status;
+
+    struct virtio_blk_batch *batch;
+};
+
+struct virtio_blk_queue
+{
+    struct rt_spinlock lock;
+    /* Counts the requests that may still be outstanding */
+    struct rt_semaphore free_sem;
+
+    /* Indexed by the head descriptor of the chain */
+    struct virtio_blk_request *reqs;
+    /* VIRTIO_BLK_DESC_MAX entries for each request */
+    struct virtq_desc *indirect;
+};
+
 struct virtio_blk_device
 {
     struct rt_device parent;
@@ -90,14 +135,11 @@ struct virtio_blk_device
 
     struct virtio_blk_config *config;
 
-    struct
-    {
-        rt_bool_t valid;
-        rt_uint8_t status;
-
-        struct virtio_blk_req req;
+    rt_bool_t indirect;
+    rt_uint32_t seg_max;
+    rt_uint32_t size_max;
 
-    } info[VIRTIO_BLK_QUEUE_RING_SIZE];
+    struct virtio_blk_queue *queues;
 };
 
 rt_err_t rt_virtio_blk_init(rt_ubase_t *mmio_base, rt_uint32_t irq);
@@ -6,6 +6,8 @@
  * Change Logs:
  * Date           Author       Notes
  * 2021-11-11     GuEe-GUI     the first version
+ * 2026-10-17     agent        zero-copy pbuf rings, event index and multi-queue
+ * 2026-10-17     agent        copy the volatile pbufs before TX
  */
 
 #include <rthw.h>
@@ -16,122 +18,661 @@
 #ifdef RT_USING_VIRTIO_NET
 
 #include <virtio_net.h>
+#include <drivers/misc.h>
+
+#ifdef RT_LWIP_USING_HW_CHECKSUM
+#include <lwip/inet_chksum.h>
+#endif
+
+struct virtio_net_seg
+{
+    rt_ubase_t addr;
+    rt_uint32_t len;
+};
+
+rt_inline void virtio_net_fill_desc(struct virtq_desc *desc,
+        rt_uint64_t addr, rt_uint32_t len, rt_uint16_t flags, rt_uint16_t next)
+{
+    desc->addr = addr;
+    desc->len = len;
+    desc->flags = flags;
+    desc->next = next;
+}
+
+rt_inline rt_bool_t virtio_net_has_feature(struct virtio_net_device *virtio_net_dev, rt_uint32_t feature_bit)
+{
+    return !!(virtio_net_dev->features & (1UL << feature_bit));
+}
+
+static void virtio_net_kick(struct virtio_net_device *virtio_net_dev, rt_uint32_t qid, rt_uint16_t *kicked_idx)
+{
+    rt_bool_t notify;
+    rt_uint16_t old_idx = *kicked_idx;
+    struct virtio_device *virtio_dev = &virtio_net_dev->virtio_dev;
+    struct virtq *queue = &virtio_dev->queues[qid];
+
+    *kicked_idx = queue->avail->idx;
+    rt_hw_dsb();
+
+    if (virtio_net_has_feature(virtio_net_dev, VIRTIO_F_RING_EVENT_IDX))
+    {
+        notify = virtq_need_event(VIRTQ_AVAIL_EVENT(queue), *kicked_idx, old_idx);
+    }
+    else
+    {
+        notify = !(queue->used->flags & VIRTQ_USED_F_NO_NOTIFY);
+    }
+
+    if (notify)
+    {
+        virtio_queue_notify(virtio_dev, qid);
+    }
+}
+
+static void virtio_net_irq_enable(struct virtio_net_device *virtio_net_dev, struct virtq *queue)
+{
+    if (virtio_net_has_feature(virtio_net_dev, VIRTIO_F_RING_EVENT_IDX))
+    {
+        /* Interrupt when the next entry is used */
+        VIRTQ_USED_EVENT(queue) = queue->used_idx;
+    }
+    else
+    {
+        queue->avail->flags &= ~VIRTQ_AVAIL_F_NO_INTERRUPT;
+    }
+    rt_hw_dsb();
+}
+
+static void virtio_net_irq_disable(struct virtio_net_device *virtio_net_dev, struct virtq *queue)
+{
+    /* An used event behind the used index never fires, leave it alone */
+    if (!virtio_net_has_feature(virtio_net_dev, VIRTIO_F_RING_EVENT_IDX))
+    {
+        queue->avail->flags |= VIRTQ_AVAIL_F_NO_INTERRUPT;
+    }
+}
+
+static int virtio_net_queue_select(struct virtio_net_device *virtio_net_dev)
+{
+#ifdef RT_USING_SMP
+    return rt_hw_cpu_id() % virtio_net_dev->pairs;
+#else
+    return 0;
+#endif
+}
+
+/* The payload of a referenced pbuf may go away once the output returns */
+rt_inline rt_bool_t virtio_net_pbuf_volatile(struct pbuf *q)
+{
+#ifdef PBUF_NEEDS_COPY
+    return PBUF_NEEDS_COPY(q);
+#else
+    return q->type == PBUF_REF;
+#endif
+}
+
+/*
+ * Returns the number of segments, or -1 if the chain needs more than
+ * VIRTIO_NET_TX_SEG_MAX or has a volatile payload to be copied.
+ */
+static int virtio_net_map_pbuf(struct pbuf *p, struct virtio_net_seg *segs)
+{
+    int n = 0;
+    rt_size_t offset, len;
+    rt_ubase_t va, pa;
+
+    for (struct pbuf *q = p; q != RT_NULL; q = q->next)
+    {
+        if (virtio_net_pbuf_volatile(q))
+        {
+            return -1;
+        }
+
+        for (offset = 0; offset < q->len; offset += len)
+        {
+            va = (rt_ubase_t)q->payload + offset;
+            pa = VIRTIO_VA2PA((void *)va);
+
+            len = VIRTIO_PAGE_SIZE - (va & (VIRTIO_PAGE_SIZE - 1));
+            len = rt_min_t(rt_size_t, len, q->len - offset);
+
+            if (n > 0 && segs[n - 1].addr + segs[n - 1].len == pa)
+            {
+                segs[n - 1].len += len;
+            }
+            else
+            {
+                if (n == VIRTIO_NET_TX_SEG_MAX)
+                {
+                    return -1;
+                }
+
+                segs[n].addr = pa;
+                segs[n].len = len;
+                ++n;
+            }
+        }
+
+        if (q->len == q->tot_len)
+        {
+            break;
+        }
+    }
+
+    return n;
+}
+
+#ifdef RT_LWIP_USING_HW_CHECKSUM
+/*
+ * lwIP leaves all of the checksums to the netif. The IPv4 header checksum is
+ * done here, the one of the transport is left to the device if it has
+ * VIRTIO_NET_F_CSUM, otherwise it is done here too. The headers are always
+ * in the first pbuf of the frame built by lwIP.
+ */
+static void virtio_net_tx_csum(struct virtio_net_device *virtio_net_dev,
+        struct virtio_net_hdr *hdr, struct pbuf *p)
+{
+    rt_uint8_t proto, *l3, *frame = p->payload;
+    rt_uint8_t pseudo[40];
+    rt_uint16_t type, sum, csum_offset;
+    rt_size_t l3_off = 14, l4_off, l4_len, pseudo_len = 0;
+
+    if (p->len < l3_off + 4)
+    {
+        return;
+    }
+
+    type = (frame[12] << 8) | frame[13];
+
+    if (type == 0x8100)
+    {
+        /* 802.1Q tag */
+        type = (frame[16] << 8) | frame[17];
+        l3_off += 4;
+    }
+
+    l3 = frame + l3_off;
+
+    if (type == 0x0800)
+    {
+        rt_size_t ihl;
+
+        if (p->len < l3_off + 20 || p->len < l3_off + (ihl = (l3[0] & 0xf) * 4))
+        {
+            return;
+        }
+
+        l3[10] = l3[11] = 0;
+        sum = inet_chksum(l3, ihl);
+        rt_memcpy(&l3[10], &sum, sizeof(sum));
+
+        /* Transport checksum of fragments covers the whole datagram */
+        if (((l3[6] << 8) | l3[7]) & 0x3fff)
+        {
+            return;
+        }
+
+        proto = l3[9];
+        l4_off = l3_off + ihl;
+        l4_len = ((l3[2] << 8) | l3[3]) - ihl;
+
+        if (proto != 1)
+        {
+            rt_memcpy(&pseudo[0], &l3[12], 8);
+            pseudo[8] = 0;
+            pseudo[9] = proto;
+            pseudo[10] = l4_len >> 8;
+            pseudo[11] = l4_len & 0xff;
+            pseudo_len = 12;
+        }
+    }
+    else if (type == 0x86dd)
+    {
+        if (p->len < l3_off + 40)
+        {
+            return;
+        }
+
+        proto = l3[6];
+        l4_off = l3_off + 40;
+
+        /* The MLD messages are behind a hop-by-hop options header */
+        if (proto == 0)
+        {
+            if (p->len < l4_off + 8)
+            {
+                return;
+            }
+
+            proto = frame[l4_off];
+            l4_off += (frame[l4_off + 1] + 1) * 8;
+        }
+
+        l4_len = ((l3[4] << 8) | l3[5]) - (l4_off - l3_off - 40);
+
+        rt_memcpy(&pseudo[0], &l3[8], 32);
+        pseudo[32] = pseudo[33] = 0;
+        pseudo[34] = l4_len >> 8;
+        pseudo[35] = l4_len & 0xff;
+        pseudo[36] = pseudo[37] = pseudo[38] = 0;
+        pseudo[39] = proto;
+        pseudo_len = 40;
+    }
+    else
+    {
+        return;
+    }
+
+    switch (proto)
+    {
+    case 6:     /* TCP */
+        csum_offset = 16;
+        break;
+    case 17:    /* UDP */
+        csum_offset = 6;
+        break;
+    case 1:     /* ICMP */
+    case 58:    /* ICMPv6 */
+        csum_offset = 2;
+        break;
+    default:
+        return;
+    }
+
+    if (p->len < l4_off + csum_offset + sizeof(sum))
+    {
+        return;
+    }
+
+    /* Seed with the pseudo header, the sum is not inverted */
+    sum = pseudo_len ? (rt_uint16_t)~inet_chksum(pseudo, pseudo_len) : 0;
+    rt_memcpy(&frame[l4_off + csum_offset], &sum, sizeof(sum));
+
+    if (virtio_net_has_feature(virtio_net_dev, VIRTIO_NET_F_CSUM))
+    {
+        hdr->flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+        hdr->csum_start = l4_off;
+        hdr->csum_offset = csum_offset;
+
+        return;
+    }
+
+    pbuf_header(p, -(s16_t)l4_off);
+    sum = inet_chksum_pbuf(p);
+    pbuf_header(p, (s16_t)l4_off);
+
+    if (proto == 17 && sum == 0)
+    {
+        sum = 0xffff;
+    }
+
+    rt_memcpy(&frame[l4_off + csum_offset], &sum, sizeof(sum));
+}
+#endif /* RT_LWIP_USING_HW_CHECKSUM */
+
+/* Called with the txq lock held */
+static void virtio_net_tx_reclaim(struct virtio_net_device *virtio_net_dev, struct virtio_net_txq *txq)
+{
+    rt_uint32_t id;
+    struct virtio_device *virtio_dev = &virtio_net_dev->virtio_dev;
+    struct virtq *queue = &virtio_dev->queues[txq->qid];
+
+    while (queue->used_idx != queue->used->idx)
+    {
+        rt_hw_dsb();
+        id = queue->used->ring[queue->used_idx % queue->num].id;
+
+        pbuf_free(txq->pbufs[id]);
+        txq->pbufs[id] = RT_NULL;
+
+        virtio_free_desc_chain(virtio_dev, txq->qid, id);
+
+        queue->used_idx++;
+    }
+}
 
 static rt_err_t virtio_net_tx(rt_device_t dev, struct pbuf *p)
 {
-    rt_uint16_t id;
+    int nsegs;
+    rt_err_t err;
+    rt_size_t ndesc;
+    rt_uint16_t head, idx[VIRTIO_NET_TX_DESC_MAX];
+    struct virtq_desc *desc;
+    struct virtio_net_hdr *hdr;
+    struct virtio_net_seg segs[VIRTIO_NET_TX_SEG_MAX];
     struct virtio_net_device *virtio_net_dev = (struct virtio_net_device *)dev;
     struct virtio_device *virtio_dev = &virtio_net_dev->virtio_dev;
-    struct virtq *queue_tx = &virtio_dev->queues[VIRTIO_NET_QUEUE_TX];
+    struct virtio_net_txq *txq = &virtio_net_dev->txqs[virtio_net_queue_select(virtio_net_dev)];
+    struct virtq *queue = &virtio_dev->queues[txq->qid];
 
-    id = (queue_tx->avail->idx * 2) % queue_tx->num;
+    if ((nsegs = virtio_net_map_pbuf(p, segs)) < 0)
+    {
+        /* Too scattered or volatile, the copy only happens on this rare path */
+        struct pbuf *q = pbuf_alloc(PBUF_RAW, p->tot_len, PBUF_RAM);
 
-    virtio_net_dev->info[id].hdr.flags = 0;
-    virtio_net_dev->info[id].hdr.gso_type = 0;
-    virtio_net_dev->info[id].hdr.hdr_len = 0;
-    virtio_net_dev->info[id].hdr.gso_size = 0;
-    virtio_net_dev->info[id].hdr.csum_start = 0;
-    virtio_net_dev->info[id].hdr.csum_offset = 0;
-    virtio_net_dev->info[id].hdr.num_buffers = 0;
+        if (q == RT_NULL)
+        {
+            return -RT_ENOMEM;
+        }
 
-    pbuf_copy_partial(p, virtio_net_dev->info[id].rx_buffer, p->tot_len, 0);
+        pbuf_copy(q, p);
+        p = q;
+        nsegs = virtio_net_map_pbuf(p, segs);
+    }
+    else
+    {
+        /* Hold the frame until the device consumed it */
+        pbuf_ref(p);
+    }
 
-    virtio_free_desc(virtio_dev, VIRTIO_NET_QUEUE_TX, id);
-    virtio_free_desc(virtio_dev, VIRTIO_NET_QUEUE_TX, id + 1);
+    ndesc = txq->indirect != RT_NULL ? 1 : nsegs + 1;
 
-    virtio_fill_desc(virtio_dev, VIRTIO_NET_QUEUE_TX, id,
-            VIRTIO_VA2PA(&virtio_net_dev->info[id].hdr), VIRTIO_NET_HDR_SIZE, VIRTQ_DESC_F_NEXT, id + 1);
+    rt_mutex_take(&txq->lock, RT_WAITING_FOREVER);
 
-    virtio_fill_desc(virtio_dev, VIRTIO_NET_QUEUE_TX, id + 1,
-            VIRTIO_VA2PA(virtio_net_dev->info[id].rx_buffer), p->tot_len, 0, 0);
+    virtio_net_tx_reclaim(virtio_net_dev, txq);
 
-    virtio_submit_chain(virtio_dev, VIRTIO_NET_QUEUE_TX, id);
+    while (queue->free_count < ndesc)
+    {
+        /* Make the isr wake us up, then check again in case it was done */
+        txq->waiting = RT_TRUE;
+        virtio_net_irq_enable(virtio_net_dev, queue);
 
-    virtio_queue_notify(virtio_dev, VIRTIO_NET_QUEUE_TX);
+        if (queue->used_idx == queue->used->idx)
+        {
+            rt_completion_wait(&txq->done, RT_WAITING_FOREVER);
+        }
+
+        txq->waiting = RT_FALSE;
+        rt_completion_init(&txq->done);
+
+        virtio_net_tx_reclaim(virtio_net_dev, txq);
+    }
+
+    if (txq->indirect != RT_NULL)
+    {
+        head = virtio_alloc_desc(virtio_dev, txq->qid);
+        RT_ASSERT(head != VIRTQ_INVALID_DESC_ID);
 
-    virtio_alloc_desc(virtio_dev, VIRTIO_NET_QUEUE_TX);
-    virtio_alloc_desc(virtio_dev, VIRTIO_NET_QUEUE_TX);
+        desc = &txq->indirect[head * VIRTIO_NET_TX_DESC_MAX];
+
+        for (int i = 0; i <= nsegs; ++i)
+        {
+            idx[i] = i;
+        }
+    }
+    else
+    {
+        err = virtio_alloc_desc_chain(virtio_dev, txq->qid, ndesc, idx);
+        RT_ASSERT(err == RT_EOK);
+        RT_UNUSED(err);
+
+        head = idx[0];
+        desc = queue->desc;
+    }
+
+    hdr = &txq->hdrs[head];
+    rt_memset(hdr, 0, sizeof(*hdr));
+#ifdef RT_LWIP_USING_HW_CHECKSUM
+    virtio_net_tx_csum(virtio_net_dev, hdr, p);
+#endif
+    txq->pbufs[head] = p;
+
+    virtio_net_fill_desc(&desc[idx[0]],
+            VIRTIO_VA2PA(hdr), virtio_net_dev->hdr_size, VIRTQ_DESC_F_NEXT, idx[1]);
+
+    for (int i = 0; i < nsegs; ++i)
+    {
+        virtio_net_fill_desc(&desc[idx[i + 1]], segs[i].addr, segs[i].len,
+                i + 1 < nsegs ? VIRTQ_DESC_F_NEXT : 0, i + 1 < nsegs ? idx[i + 2] : 0);
+    }
+
+    if (txq->indirect != RT_NULL)
+    {
+        virtio_fill_desc(virtio_dev, txq->qid, head,
+                VIRTIO_VA2PA(desc), (nsegs + 1) * sizeof(struct virtq_desc), VIRTQ_DESC_F_INDIRECT, 0);
+    }
+
+    virtio_submit_chain(virtio_dev, txq->qid, head);
+
+    if (virtio_net_has_feature(virtio_net_dev, VIRTIO_F_RING_EVENT_IDX))
+    {
+        /* One interrupt to reclaim the frames when the device catches up */
+        VIRTQ_USED_EVENT(queue) = queue->avail->idx - 1;
+    }
+
+    virtio_net_kick(virtio_net_dev, txq->qid, &txq->kicked_idx);
+
+    rt_mutex_release(&txq->lock);
 
     return RT_EOK;
 }
 
-static struct pbuf *virtio_net_rx(rt_device_t dev)
+static void virtio_net_rx_post(struct virtio_net_device *virtio_net_dev, struct virtio_net_rxq *rxq,
+        rt_uint16_t slot, struct pbuf *p)
 {
-    rt_uint16_t id;
+    rt_uint16_t id = slot * 2;
+    rt_ubase_t addr = VIRTIO_VA2PA(p->payload);
+    struct virtio_device *virtio_dev = &virtio_net_dev->virtio_dev;
+
+    rxq->pbufs[slot] = p;
+
+    /* Descriptor for net_hdr */
+    virtio_fill_desc(virtio_dev, rxq->qid, id,
+            addr, virtio_net_dev->hdr_size, VIRTQ_DESC_F_NEXT | VIRTQ_DESC_F_WRITE, id + 1);
+
+    /* Descriptor for data */
+    virtio_fill_desc(virtio_dev, rxq->qid, id + 1,
+            addr + virtio_net_dev->hdr_size, VIRTIO_NET_PAYLOAD_MAX_SIZE - virtio_net_dev->hdr_size,
+            VIRTQ_DESC_F_WRITE, 0);
+
+    virtio_submit_chain(virtio_dev, rxq->qid, id);
+}
+
+static struct pbuf *virtio_net_rxq_pop(struct virtio_net_device *virtio_net_dev, struct virtio_net_rxq *rxq)
+{
+    rt_uint16_t slot;
     rt_uint32_t len;
-    struct pbuf *p = RT_NULL;
-    struct virtio_net_device *virtio_net_dev = (struct virtio_net_device *)dev;
+    struct pbuf *p, *new_p;
     struct virtio_device *virtio_dev = &virtio_net_dev->virtio_dev;
-    struct virtq *queue_rx = &virtio_dev->queues[VIRTIO_NET_QUEUE_RX];
+    struct virtq *queue_rx = &virtio_dev->queues[rxq->qid];
 
-    if (queue_rx->used_idx != queue_rx->used->idx)
+    for (;;)
     {
-        id = (queue_rx->used->ring[queue_rx->used_idx % queue_rx->num].id + 1) % queue_rx->num;
-        len = queue_rx->used->ring[queue_rx->used_idx % queue_rx->num].len - VIRTIO_NET_HDR_SIZE;
+        if (queue_rx->used_idx == queue_rx->used->idx)
+        {
+            /* Drained, re-arm the interrupt then look again to close the race */
+            virtio_net_irq_enable(virtio_net_dev, queue_rx);
+
+            if (queue_rx->used_idx == queue_rx->used->idx)
+            {
+                if (rxq->kicked_idx != queue_rx->avail->idx)
+                {
+                    virtio_net_kick(virtio_net_dev, rxq->qid, &rxq->kicked_idx);
+                }
+
+                return RT_NULL;
+            }
+
+            virtio_net_irq_disable(virtio_net_dev, queue_rx);
+        }
+
+        rt_hw_dsb();
+        slot = queue_rx->used->ring[queue_rx->used_idx % queue_rx->num].id / 2;
+        len = queue_rx->used->ring[queue_rx->used_idx % queue_rx->num].len;
+
+        queue_rx->used_idx++;
+
+        p = rxq->pbufs[slot];
+        new_p = pbuf_alloc(PBUF_RAW, VIRTIO_NET_PAYLOAD_MAX_SIZE, PBUF_RAM);
+
+        if (new_p == RT_NULL)
+        {
+            /* Out of memory, drop the frame and post its buffer again */
+            new_p = p;
+            p = RT_NULL;
+        }
+
+        virtio_net_rx_post(virtio_net_dev, rxq, slot, new_p);
+
+        /* Give the buffers back in batches so that the device never starves */
+        if ((rt_uint16_t)(queue_rx->avail->idx - rxq->kicked_idx) >= queue_rx->num / 4)
+        {
+            virtio_net_kick(virtio_net_dev, rxq->qid, &rxq->kicked_idx);
+        }
+
+        if (p == RT_NULL)
+        {
+            continue;
+        }
+
+        len -= virtio_net_dev->hdr_size;
 
-        if (len > VIRTIO_NET_PAYLOAD_MAX_SIZE)
+        if (len > VIRTIO_NET_PAYLOAD_MAX_SIZE - virtio_net_dev->hdr_size)
         {
             rt_kprintf("%s: Receive buffer's size = %u is too big!\n", virtio_net_dev->parent.parent.parent.name, len);
-            len = VIRTIO_NET_PAYLOAD_MAX_SIZE;
+            len = VIRTIO_NET_PAYLOAD_MAX_SIZE - virtio_net_dev->hdr_size;
         }
 
-        p = pbuf_alloc(PBUF_RAW, len, PBUF_RAM);
+        pbuf_header(p, -(s16_t)virtio_net_dev->hdr_size);
+        pbuf_realloc(p, len);
+
+        return p;
+    }
+}
+
+static struct pbuf *virtio_net_rx(rt_device_t dev)
+{
+    struct pbuf *p;
+    struct virtio_net_txq *txq;
+    struct virtio_net_device *virtio_net_dev = (struct virtio_net_device *)dev;
+
+    for (int i = 0; i < virtio_net_dev->pairs; ++i)
+    {
+        p = virtio_net_rxq_pop(virtio_net_dev, &virtio_net_dev->rxqs[virtio_net_dev->rx_next]);
 
         if (p != RT_NULL)
         {
-            rt_memcpy(p->payload, (void *)queue_rx->desc[id].addr - PV_OFFSET, len);
+            return p;
+        }
 
-            queue_rx->used_idx++;
+        virtio_net_dev->rx_next = (virtio_net_dev->rx_next + 1) % virtio_net_dev->pairs;
+    }
 
-            virtio_submit_chain(virtio_dev, VIRTIO_NET_QUEUE_RX, id - 1);
+    /* Release the sent frames, a busy sender reclaims them by itself */
+    for (int i = 0; i < virtio_net_dev->pairs; ++i)
+    {
+        txq = &virtio_net_dev->txqs[i];
 
-            virtio_queue_notify(virtio_dev, VIRTIO_NET_QUEUE_RX);
+        if (rt_mutex_take(&txq->lock, 0) == RT_EOK)
+        {
+            virtio_net_tx_reclaim(virtio_net_dev, txq);
+            rt_mutex_release(&txq->lock);
         }
     }
 
-    return p;
+    return RT_NULL;
+}
+
+static rt_err_t virtio_net_ctrl_mq(struct virtio_net_device *virtio_net_dev, rt_uint16_t pairs)
+{
+    int retry = 1000;
+    rt_uint16_t idx[3];
+    struct virtio_device *virtio_dev = &virtio_net_dev->virtio_dev;
+    struct virtq *queue_ctrl = &virtio_dev->queues[virtio_net_dev->ctrl_qid];
+
+    if (virtio_alloc_desc_chain(virtio_dev, virtio_net_dev->ctrl_qid, 3, idx))
+    {
+        return -RT_ENOMEM;
+    }
+
+    virtio_net_dev->ctrl.hdr.ctrl_class = VIRTIO_NET_CTRL_MQ;
+    virtio_net_dev->ctrl.hdr.cmd = VIRTIO_NET_CTRL_MQ_VQ_PAIRS_SET;
+    virtio_net_dev->ctrl.pairs = pairs;
+    virtio_net_dev->ctrl.ack = VIRTIO_NET_ERR;
+
+    virtio_fill_desc(virtio_dev, virtio_net_dev->ctrl_qid, idx[0],
+            VIRTIO_VA2PA(&virtio_net_dev->ctrl.hdr), sizeof(virtio_net_dev->ctrl.hdr), VIRTQ_DESC_F_NEXT, idx[1]);
+
+    virtio_fill_desc(virtio_dev, virtio_net_dev->ctrl_qid, idx[1],
+            VIRTIO_VA2PA(&virtio_net_dev->ctrl.pairs), sizeof(virtio_net_dev->ctrl.pairs), VIRTQ_DESC_F_NEXT, idx[2]);
+
+    virtio_fill_desc(virtio_dev, virtio_net_dev->ctrl_qid, idx[2],
+            VIRTIO_VA2PA(&virtio_net_dev->ctrl.ack), sizeof(virtio_net_dev->ctrl.ack), VIRTQ_DESC_F_WRITE, 0);
+
+    virtio_submit_chain(virtio_dev, virtio_net_dev->ctrl_qid, idx[0]);
+    virtio_queue_notify(virtio_dev, virtio_net_dev->ctrl_qid);
+
+    /* Only used while initializing, the device answers at once */
+    while (queue_ctrl->used_idx == queue_ctrl->used->idx && retry-- > 0)
+    {
+        rt_thread_mdelay(1);
+        rt_hw_dsb();
+    }
+
+    if (queue_ctrl->used_idx == queue_ctrl->used->idx)
+    {
+        /* The chain still belongs to the device, never reuse the queue */
+        return -RT_ETIMEOUT;
+    }
+
+    queue_ctrl->used_idx++;
+    virtio_free_desc_chain(virtio_dev, virtio_net_dev->ctrl_qid, idx[0]);
+
+    return virtio_net_dev->ctrl.ack == VIRTIO_NET_OK ? RT_EOK : -RT_ERROR;
 }
 
 static rt_err_t virtio_net_init(rt_device_t dev)
 {
-    int i;
-    rt_uint16_t idx[VIRTIO_NET_RTX_QUEUE_SIZE];
+    struct pbuf *p;
+    struct virtq *queue_rx, *queue_tx;
     struct virtio_net_device *virtio_net_dev = (struct virtio_net_device *)dev;
     struct virtio_device *virtio_dev = &virtio_net_dev->virtio_dev;
-    struct virtq *queue_rx, *queue_tx;
 
-    queue_rx = &virtio_dev->queues[VIRTIO_NET_QUEUE_RX];
-    queue_tx = &virtio_dev->queues[VIRTIO_NET_QUEUE_TX];
+    for (int pair = 0; pair < virtio_net_dev->pairs; ++pair)
+    {
+        struct virtio_net_rxq *rxq = &virtio_net_dev->rxqs[pair];
 
-    virtio_alloc_desc_chain(virtio_dev, VIRTIO_NET_QUEUE_RX, queue_rx->num, idx);
-    virtio_alloc_desc_chain(virtio_dev, VIRTIO_NET_QUEUE_TX, queue_tx->num, idx);
+        queue_rx = &virtio_dev->queues[VIRTIO_NET_QUEUE_RX(pair)];
+        queue_tx = &virtio_dev->queues[VIRTIO_NET_QUEUE_TX(pair)];
 
-    for (i = 0; i < queue_rx->num; ++i)
-    {
-        rt_uint16_t id = (i * 2) % queue_rx->num;
-        void *addr = virtio_net_dev->info[i].tx_buffer;
+        /* The rx chains never change, own all of the descriptors */
+        for (int i = 0; i < queue_rx->num; ++i)
+        {
+            virtio_alloc_desc(virtio_dev, rxq->qid);
+        }
 
-        /* Descriptor for net_hdr */
-        virtio_fill_desc(virtio_dev, VIRTIO_NET_QUEUE_RX, id,
-                VIRTIO_VA2PA(addr), VIRTIO_NET_HDR_SIZE, VIRTQ_DESC_F_NEXT | VIRTQ_DESC_F_WRITE, id + 1);
+        for (int slot = 0; slot < queue_rx->num / 2; ++slot)
+        {
+            p = pbuf_alloc(PBUF_RAW, VIRTIO_NET_PAYLOAD_MAX_SIZE, PBUF_RAM);
 
-        /* Descriptor for data */
-        virtio_fill_desc(virtio_dev, VIRTIO_NET_QUEUE_RX, id + 1,
-                VIRTIO_VA2PA(addr) + VIRTIO_NET_HDR_SIZE, VIRTIO_NET_MSS, VIRTQ_DESC_F_WRITE, 0);
+            if (p == RT_NULL)
+            {
+                break;
+            }
 
-        queue_rx->avail->ring[i] = id;
-    }
-    rt_hw_dsb();
+            virtio_net_rx_post(virtio_net_dev, rxq, slot, p);
+        }
 
-    queue_rx->avail->flags = 0;
-    queue_rx->avail->idx = queue_rx->num;
+        queue_rx->avail->flags = 0;
+        queue_rx->used_idx = queue_rx->used->idx;
+        virtio_net_irq_enable(virtio_net_dev, queue_rx);
 
-    queue_rx->used_idx = queue_rx->used->idx;
+        /* The isr only wakes up the senders that wait for the descriptors */
+        queue_tx->avail->flags = 0;
+        queue_tx->avail->idx = 0;
 
-    queue_tx->avail->flags = VIRTQ_AVAIL_F_NO_INTERRUPT;
-    queue_tx->avail->idx = 0;
+        virtio_net_kick(virtio_net_dev, rxq->qid, &rxq->kicked_idx);
+    }
+
+    if (virtio_net_dev->pairs > 1 && virtio_net_ctrl_mq(virtio_net_dev, virtio_net_dev->pairs))
+    {
+        rt_kprintf("%s: Enable %u queue pairs fail\n", virtio_net_dev->parent.parent.parent.name,
+                virtio_net_dev->pairs);
 
-    virtio_queue_notify(virtio_dev, VIRTIO_NET_QUEUE_RX);
+        /* The device keeps using the first pair */
+        virtio_net_dev->pairs = 1;
+        virtio_net_dev->rx_next = 0;
+    }
 
     return eth_device_linkchange(&virtio_net_dev->parent, RT_TRUE);
 }
@@ -174,14 +715,42 @@ const static struct rt_device_ops virtio_net_ops =
 
 static void virtio_net_isr(int irqno, void *param)
 {
+    rt_bool_t ready = RT_FALSE;
+    struct virtq *queue_rx, *queue_tx;
+    struct virtio_net_txq *txq;
     struct virtio_net_device *virtio_net_dev = (struct virtio_net_device *)param;
     struct virtio_device *virtio_dev = &virtio_net_dev->virtio_dev;
-    struct virtq *queue_rx = &virtio_dev->queues[VIRTIO_NET_QUEUE_RX];
 
     virtio_interrupt_ack(virtio_dev);
     rt_hw_dsb();
 
-    if (queue_rx->used_idx != queue_rx->used->idx)
+    for (int pair = 0; pair < virtio_net_dev->pairs; ++pair)
+    {
+        txq = &virtio_net_dev->txqs[pair];
+        queue_rx = &virtio_dev->queues[virtio_net_dev->rxqs[pair].qid];
+        queue_tx = &virtio_dev->queues[txq->qid];
+
+        if (queue_rx->used_idx != queue_rx->used->idx)
+        {
+            /* virtio_net_rx() polls until the ring is empty and re-arms it */
+            virtio_net_irq_disable(virtio_net_dev, queue_rx);
+            ready = RT_TRUE;
+        }
+
+        if (queue_tx->used_idx != queue_tx->used->idx)
+        {
+            if (txq->waiting)
+            {
+                rt_completion_done(&txq->done);
+            }
+            else
+            {
+                ready = RT_TRUE;
+            }
+        }
+    }
+
+    if (ready)
     {
         rt_hw_dsb();
 
@@ -189,14 +758,176 @@ static void virtio_net_isr(int irqno, void *param)
     }
 }
 
+static void virtio_net_queues_free(struct virtio_net_device *virtio_net_dev)
+{
+    struct virtio_device *virtio_dev = &virtio_net_dev->virtio_dev;
+
+    if (virtio_dev->queues == RT_NULL)
+    {
+        return;
+    }
+
+    for (int pair = 0; pair < virtio_net_dev->pairs; ++pair)
+    {
+        if (virtio_net_dev->rxqs != RT_NULL && virtio_net_dev->rxqs[pair].pbufs != RT_NULL)
+        {
+            rt_free(virtio_net_dev->rxqs[pair].pbufs);
+        }
+
+        if (virtio_net_dev->txqs != RT_NULL)
+        {
+            struct virtio_net_txq *txq = &virtio_net_dev->txqs[pair];
+
+            if (txq->pbufs != RT_NULL)
+            {
+                rt_mutex_detach(&txq->lock);
+                rt_free(txq->pbufs);
+            }
+
+            if (txq->hdrs != RT_NULL)
+            {
+                rt_free(txq->hdrs);
+            }
+
+            if (txq->indirect != RT_NULL)
+            {
+                rt_free_align(txq->indirect);
+            }
+        }
+    }
+
+    for (int qid = 0; qid < virtio_dev->queues_num; ++qid)
+    {
+        if (virtio_dev->queues[qid].num > 0)
+        {
+            virtio_queue_destroy(virtio_dev, qid);
+        }
+    }
+
+    if (virtio_net_dev->rxqs != RT_NULL)
+    {
+        rt_free(virtio_net_dev->rxqs);
+    }
+
+    if (virtio_net_dev->txqs != RT_NULL)
+    {
+        rt_free(virtio_net_dev->txqs);
+    }
+
+    virtio_queues_free(virtio_dev);
+    virtio_dev->queues = RT_NULL;
+}
+
+static rt_err_t virtio_net_queue_init(struct virtio_net_device *virtio_net_dev, rt_uint32_t qid)
+{
+    rt_size_t ring_size = VIRTIO_NET_RTX_QUEUE_SIZE;
+    struct virtio_device *virtio_dev = &virtio_net_dev->virtio_dev;
+
+    virtio_dev->mmio_config->queue_sel = qid;
+
+    while (ring_size > virtio_dev->mmio_config->queue_num_max)
+    {
+        ring_size >>= 1;
+    }
+
+    return virtio_queue_init(virtio_dev, qid, ring_size);
+}
+
+static rt_err_t virtio_net_queues_init(struct virtio_net_device *virtio_net_dev, rt_size_t queues_num)
+{
+    rt_size_t ring_size;
+    struct virtio_device *virtio_dev = &virtio_net_dev->virtio_dev;
+
+    if (virtio_queues_alloc(virtio_dev, queues_num) != RT_EOK)
+    {
+        return -RT_ENOMEM;
+    }
+
+    rt_memset(virtio_dev->queues, 0, sizeof(struct virtq) * queues_num);
+
+    virtio_net_dev->rxqs = rt_calloc(virtio_net_dev->pairs, sizeof(struct virtio_net_rxq));
+    virtio_net_dev->txqs = rt_calloc(virtio_net_dev->pairs, sizeof(struct virtio_net_txq));
+
+    if (virtio_net_dev->rxqs == RT_NULL || virtio_net_dev->txqs == RT_NULL)
+    {
+        goto _fail;
+    }
+
+    for (int pair = 0; pair < virtio_net_dev->pairs; ++pair)
+    {
+        struct virtio_net_rxq *rxq = &virtio_net_dev->rxqs[pair];
+        struct virtio_net_txq *txq = &virtio_net_dev->txqs[pair];
+
+        rxq->qid = VIRTIO_NET_QUEUE_RX(pair);
+        txq->qid = VIRTIO_NET_QUEUE_TX(pair);
+
+        if (virtio_net_queue_init(virtio_net_dev, rxq->qid) != RT_EOK ||
+            virtio_net_queue_init(virtio_net_dev, txq->qid) != RT_EOK)
+        {
+            goto _fail;
+        }
+
+        rxq->pbufs = rt_calloc(virtio_dev->queues[rxq->qid].num / 2, sizeof(struct pbuf *));
+
+        if (rxq->pbufs == RT_NULL)
+        {
+            goto _fail;
+        }
+
+        ring_size = virtio_dev->queues[txq->qid].num;
+
+        txq->hdrs = rt_calloc(ring_size, sizeof(struct virtio_net_hdr));
+
+        if (txq->hdrs == RT_NULL)
+        {
+            goto _fail;
+        }
+
+        if (virtio_net_has_feature(virtio_net_dev, VIRTIO_F_RING_INDIRECT_DESC))
+        {
+            txq->indirect = rt_malloc_align(
+                    ring_size * VIRTIO_NET_TX_DESC_MAX * sizeof(struct virtq_desc), sizeof(struct virtq_desc));
+
+            if (txq->indirect == RT_NULL)
+            {
+                goto _fail;
+            }
+        }
+
+        txq->pbufs = rt_calloc(ring_size, sizeof(struct pbuf *));
+
+        if (txq->pbufs == RT_NULL)
+        {
+            goto _fail;
+        }
+
+        rt_mutex_init(&txq->lock, "virtio-net", RT_IPC_FLAG_PRIO);
+        rt_completion_init(&txq->done);
+    }
+
+    if (virtio_net_dev->pairs > 1 &&
+        virtio_net_queue_init(virtio_net_dev, virtio_net_dev->ctrl_qid) != RT_EOK)
+    {
+        goto _fail;
+    }
+
+    return RT_EOK;
+
+_fail:
+    virtio_net_queues_free(virtio_net_dev);
+
+    return -RT_ENOMEM;
+}
+
 rt_err_t rt_virtio_net_init(rt_ubase_t *mmio_base, rt_uint32_t irq)
 {
     static int dev_no = 0;
     char dev_name[RT_NAME_MAX];
+    rt_size_t queues_num = 2;
     struct virtio_device *virtio_dev;
     struct virtio_net_device *virtio_net_dev;
 
-    virtio_net_dev = rt_malloc(sizeof(struct virtio_net_device));
+    virtio_net_dev = rt_calloc(1, sizeof(struct virtio_net_device));
 
     if (virtio_net_dev == RT_NULL)
     {
@@ -212,25 +943,56 @@ rt_err_t rt_virtio_net_init(rt_ubase_t *mmio_base, rt_uint32_t irq)
     virtio_reset_device(virtio_dev);
     virtio_status_acknowledge_driver(virtio_dev);
 
-    virtio_dev->mmio_config->driver_features = virtio_dev->mmio_config->device_features & ~(
-            (1 << VIRTIO_NET_F_CTRL_VQ) |
-            (1 << VIRTIO_F_RING_EVENT_IDX));
+    /*
+     * Only take what is handled here, the frames are never larger than a
+     * rx buffer without the guest TSO/UFO, so one buffer is enough even if
+     * the buffers are mergeable. lwIP never builds a TSO frame.
+     */
+    virtio_net_dev->features = virtio_dev->mmio_config->device_features & (
+            (1 << VIRTIO_NET_F_MAC) |
+            (1 << VIRTIO_NET_F_STATUS) |
+            (1 << VIRTIO_NET_F_MRG_RXBUF) |
+#ifdef RT_LWIP_USING_HW_CHECKSUM
+            (1 << VIRTIO_NET_F_CSUM) |
+            (1 << VIRTIO_NET_F_GUEST_CSUM) |
+#endif
+            (1 << VIRTIO_F_RING_EVENT_IDX) |
+            (1 << VIRTIO_F_RING_INDIRECT_DESC));
 
-    virtio_status_driver_ok(virtio_dev);
+    virtio_net_dev->pairs = 1;
 
-    if (virtio_queues_alloc(virtio_dev, 2) != RT_EOK)
+    if (virtio_has_feature(virtio_dev, VIRTIO_NET_F_MQ) && virtio_has_feature(virtio_dev, VIRTIO_NET_F_CTRL_VQ))
     {
-        goto _alloc_fail;
+        virtio_net_dev->pairs = rt_min_t(rt_size_t, virtio_net_dev->config->max_virtqueue_pairs, RT_CPUS_NR);
+
+        if (virtio_net_dev->pairs > 1)
+        {
+            virtio_net_dev->features |= (1 << VIRTIO_NET_F_MQ) | (1 << VIRTIO_NET_F_CTRL_VQ);
+
+            /* The control queue is behind all of the pairs the device has */
+            virtio_net_dev->ctrl_qid = virtio_net_dev->config->max_virtqueue_pairs * 2;
+            queues_num = virtio_net_dev->ctrl_qid + 1;
+        }
+        else
+        {
+            virtio_net_dev->pairs = 1;
+        }
     }
 
-    if (virtio_queue_init(virtio_dev, VIRTIO_NET_QUEUE_RX, VIRTIO_NET_RTX_QUEUE_SIZE) != RT_EOK)
+    virtio_net_dev->hdr_size = VIRTIO_NET_HDR_SIZE;
+
+    if (!virtio_net_has_feature(virtio_net_dev, VIRTIO_NET_F_MRG_RXBUF))
     {
-        goto _alloc_fail;
+        /* No num_buffers */
+        virtio_net_dev->hdr_size -= sizeof(rt_uint16_t);
     }
 
-    if (virtio_queue_init(virtio_dev, VIRTIO_NET_QUEUE_TX, VIRTIO_NET_RTX_QUEUE_SIZE) != RT_EOK)
+    virtio_dev->mmio_config->driver_features = virtio_net_dev->features;
+
+    virtio_status_driver_ok(virtio_dev);
+
+    if (virtio_net_queues_init(virtio_net_dev, queues_num) != RT_EOK)
     {
-        virtio_queue_destroy(virtio_dev, VIRTIO_NET_QUEUE_RX);
         goto _alloc_fail;
     }
 
@@ -259,7 +1021,6 @@ _alloc_fail:
 
     if (virtio_net_dev != RT_NULL)
     {
-        virtio_queues_free(virtio_dev);
         rt_free(virtio_net_dev);
     }
     return -RT_ENOMEM;
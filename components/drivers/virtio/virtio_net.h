@@ -6,6 +6,7 @@
  * Change Logs:
  * Date           Author       Notes
  * 2021-11-11     GuEe-GUI     the first version
+ * 2026-10-17     agent        zero-copy pbuf rings, event index and multi-queue
  */
 
 #ifndef __VIRTIO_NET_H__
@@ -14,14 +15,22 @@
 #ifdef RT_USING_VIRTIO_NET
 
 #include <rtdef.h>
+#include <ipc/completion.h>
 #include <netif/ethernetif.h>
 
 #include <virtio.h>
 
-#define VIRTIO_NET_QUEUE_RX         0
-#define VIRTIO_NET_QUEUE_TX         1
-#define VIRTIO_NET_RTX_QUEUE_SIZE   16
-#define VIRTIO_NET_RTX_BUF_SIZE     2048
+#ifndef RT_VIRTIO_NET_QUEUE_RING_SIZE
+#define RT_VIRTIO_NET_QUEUE_RING_SIZE   64
+#endif
+
+/* Queue pair n uses the rx queue 2n and the tx queue 2n + 1 */
+#define VIRTIO_NET_QUEUE_RX(pair)   ((pair) * 2)
+#define VIRTIO_NET_QUEUE_TX(pair)   ((pair) * 2 + 1)
+#define VIRTIO_NET_RTX_QUEUE_SIZE   RT_VIRTIO_NET_QUEUE_RING_SIZE
+/* Max pbufs (split at pages) of a frame, longer chains are linearized */
+#define VIRTIO_NET_TX_SEG_MAX       15
+#define VIRTIO_NET_TX_DESC_MAX      (VIRTIO_NET_TX_SEG_MAX + 1)
 
 #define VIRTIO_NET_F_CSUM                   0   /* Host handles pkts w/ partial csum */
 #define VIRTIO_NET_F_GUEST_CSUM             1   /* Guest handles pkts w/ partial csum */
@@ -76,6 +85,18 @@ struct virtio_net_hdr
     rt_uint16_t num_buffers;
 } __attribute__ ((packed));
 
+#define VIRTIO_NET_CTRL_MQ                  4
+#define VIRTIO_NET_CTRL_MQ_VQ_PAIRS_SET     0
+
+#define VIRTIO_NET_OK               0
+#define VIRTIO_NET_ERR              1
+
+struct virtio_net_ctrl_hdr
+{
+    rt_uint8_t ctrl_class;
+    rt_uint8_t cmd;
+} __attribute__ ((packed));
+
 #define VIRTIO_NET_MSS              1514
 #define VIRTIO_NET_HDR_SIZE         (sizeof(struct virtio_net_hdr))
 #define VIRTIO_NET_PAYLOAD_MAX_SIZE (VIRTIO_NET_HDR_SIZE + VIRTIO_NET_MSS)
@@ -93,6 +114,32 @@ struct virtio_net_config
     rt_uint32_t supported_hash_types;
 } __attribute__((packed));
 
+struct virtio_net_rxq
+{
+    rt_uint32_t qid;
+    rt_uint16_t kicked_idx;
+
+    /* Posted buffers, the chain of slot n is the descriptor 2n and 2n + 1 */
+    struct pbuf **pbufs;
+};
+
+struct virtio_net_txq
+{
+    rt_uint32_t qid;
+    rt_uint16_t kicked_idx;
+
+    struct rt_mutex lock;
+    /* Done by the isr when the sender waits for free descriptors */
+    struct rt_completion done;
+    volatile rt_bool_t waiting;
+
+    /* Indexed by the head descriptor of the chain */
+    struct virtio_net_hdr *hdrs;
+    struct pbuf **pbufs;
+    /* VIRTIO_NET_TX_DESC_MAX entries for each frame */
+    struct virtq_desc *indirect;
+};
+
 struct virtio_net_device
 {
     struct eth_device parent;
@@ -101,15 +148,22 @@ struct virtio_net_device
 
     struct virtio_net_config *config;
 
+    rt_uint32_t features;
+    rt_size_t hdr_size;
+
+    rt_size_t pairs;
+    rt_size_t rx_next;
+    struct virtio_net_rxq *rxqs;
+    struct virtio_net_txq *txqs;
+
+    /* Control queue, only used to enable the queue pairs */
+    rt_uint32_t ctrl_qid;
     struct
     {
-        /* Transmit hdr */
-        struct virtio_net_hdr hdr;
-        /* Transmit buffer */
-        rt_uint8_t tx_buffer[VIRTIO_NET_PAYLOAD_MAX_SIZE];
-        /* Receive buffer */
-        rt_uint8_t rx_buffer[VIRTIO_NET_PAYLOAD_MAX_SIZE];
-    } info[VIRTIO_NET_RTX_QUEUE_SIZE];
+        struct virtio_net_ctrl_hdr hdr;
+        rt_uint16_t pairs;
+        rt_uint8_t ack;
+    } __attribute__ ((packed)) ctrl;
 };
 
 rt_err_t rt_virtio_net_init(rt_ubase_t *mmio_base, rt_uint32_t irq);
@@ -6,6 +6,7 @@
  * Change Logs:
  * Date           Author       Notes
  * 2021-11-11     GuEe-GUI     the first version
+ * 2026-10-17     agent        add event index helpers
  */
 
 #ifndef __VIRTIO_QUEUE_H__
@@ -94,4 +95,17 @@ struct virtq
 
 #define VIRTQ_INVALID_DESC_ID   RT_UINT16_MAX
 
+/* Only if VIRTIO_F_RING_EVENT_IDX, they live in the reserved tail of the rings */
+#define VIRTQ_USED_EVENT(vq)    ((vq)->avail->ring[(vq)->num])
+#define VIRTQ_AVAIL_EVENT(vq)   (*(volatile rt_uint16_t *)&(vq)->used->ring[(vq)->num])
+
+/*
+ * The other side wants to be notified if event_idx is in the entries
+ * [old_idx, new_idx) that are published since the last notification.
+ */
+rt_inline rt_bool_t virtq_need_event(rt_uint16_t event_idx, rt_uint16_t new_idx, rt_uint16_t old_idx)
+{
+    return (rt_uint16_t)(new_idx - event_idx - 1) < (rt_uint16_t)(new_idx - old_idx);
+}
+
 #endif /* __VIRTIO_QUEUE_H__ */
@@ -12,6 +12,8 @@
  *                              incorrectly woken up. This is basically because the poll
  *                              mechanism wakeup algorithm does not correctly distinguish
  *                              the current wait state.
+ * 2026-10-17     agent         Harvest the ready list appended by the wakeup callbacks,
+ *                              keep the monitored fds in a hash keyed by fd.
  */
 
 #include <rtthread.h>
@@ -23,12 +25,21 @@
 #include "poll.h"
 #include <lwp_signal.h>
 
+#define DBG_TAG    "posix.epoll"
+#define DBG_LVL    DBG_WARNING
+#include <rtdbg.h>
+
+#include <rt_uthash.h>
+
 #define EPOLL_MUTEX_NAME "EVENTEPOLL"
 
 #define EFD_SHARED_EPOLL_TYPE (EPOLL_CTL_ADD | EPOLL_CTL_DEL | EPOLL_CTL_MOD)
 #define EPOLLINOUT_BITS (EPOLLIN | EPOLLOUT | EPOLLRDNORM | EPOLLWRNORM)
 #define EPOLLEXCLUSIVE_BITS (EPOLLINOUT_BITS | EPOLLERR | EPOLLHUP | \
                 EPOLLET | EPOLLEXCLUSIVE)
+#define EPOLL_PRIVATE_BITS (EPOLLET | EPOLLONESHOT | EPOLLEXCLUSIVE)
+/* woken up without a key, the events have to be polled */
+#define EPOLL_READY_NOKEY (1U << 27)
 
 struct rt_eventpoll;
 
@@ -42,15 +53,14 @@ enum rt_epoll_status {
 struct rt_fd_list
 {
     rt_uint32_t revents;        /**< Monitored events */
+    rt_uint32_t ready_events;   /**< Events reported by the wakeups since the last harvest */
     struct epoll_event epev;    /**< Epoll event structure */
     rt_pollreq_t req;           /**< Poll request structure */
     struct rt_eventpoll *ep;    /**< Pointer to the associated event poll */
     struct rt_wqueue_node wqn;  /**< Wait queue node */
-    int exclusive;              /**< Indicates if the event is exclusive */
-    rt_bool_t is_rdl_node;      /**< Indicates if the node is in the ready list */
-    int fd;                     /**< File descriptor */
-    struct rt_fd_list *next;    /**< Pointer to the next file descriptor list */
-    rt_slist_t rdl_node;        /**< Ready list node */
+    int fd;                     /**< File descriptor, the key of the monitor hash */
+    UT_hash_handle hh;          /**< Monitor hash handle */
+    rt_list_t rdl_node;         /**< Ready list node, empty when not ready */
 };
 
 struct rt_eventpoll
@@ -58,11 +68,11 @@ struct rt_eventpoll
     rt_wqueue_t epoll_read;      /**< Epoll read queue */
     rt_thread_t polling_thread;  /**< Polling thread */
     struct rt_mutex lock;        /**< Mutex lock */
-    struct rt_fd_list *fdlist;   /**< Monitor list */
+    struct rt_fd_list *fdlist;   /**< Monitor hash, keyed by fd */
     int eventpoll_num;           /**< Number of ready lists */
     rt_pollreq_t req;            /**< Poll request structure */
     struct rt_spinlock spinlock; /**< Spin lock */
-    rt_slist_t rdl_head;         /**< Ready list head */
+    rt_list_t rdl_head;          /**< Ready list head */
     enum rt_epoll_status status; /* the waited thread whether triggered */
 };
 
@@ -77,32 +87,41 @@ static const struct dfs_file_ops epoll_fops =
     .poll       = epoll_poll,
 };
 
+/**
+ * @brief   Detaches a monitored file descriptor from its wait queue.
+ *
+ * This function removes the wait queue node of the monitored file descriptor, if it is installed.
+ *
+ * @param   fdlist  Pointer to the monitored file descriptor.
+ */
+static void epoll_wqueue_detach(struct rt_fd_list *fdlist)
+{
+    if (fdlist->wqn.wqueue)
+    {
+        rt_wqueue_remove(&fdlist->wqn);
+        fdlist->wqn.wqueue = RT_NULL;
+    }
+}
+
 /**
  * @brief   Closes the file descriptor list associated with epoll.
  *
  * This function closes the file descriptor list associated with epoll and frees the allocated memory.
  *
- * @param   fdlist  Pointer to the file descriptor list.
+ * @param   ep      Pointer to the epoll control structure.
  *
  * @return  Returns 0 on success.
  */
-static int epoll_close_fdlist(struct rt_fd_list *fdlist)
+static int epoll_close_fdlist(struct rt_eventpoll *ep)
 {
-    struct rt_fd_list *fre_node, *list;
+    struct rt_fd_list *fre_node, *tmp;
 
-    if (fdlist != RT_NULL)
+    HASH_ITER(hh, ep->fdlist, fre_node, tmp)
     {
-        list = fdlist;
-        while (list->next != RT_NULL)
-        {
-            fre_node = list->next;
-            rt_wqueue_remove(&fre_node->wqn);
-
-            list->next = fre_node->next;
-            rt_free(fre_node);
-        }
+        epoll_wqueue_detach(fre_node);
 
-        rt_free(fdlist);
+        RT_UTHASH_DELETE(ep->fdlist, fre_node);
+        rt_free(fre_node);
     }
 
     return 0;
@@ -132,10 +151,7 @@ static int epoll_close(struct dfs_file *file)
             if (ep)
             {
                 rt_mutex_take(&ep->lock, RT_WAITING_FOREVER);
-                if (ep->fdlist)
-                {
-                    epoll_close_fdlist(ep->fdlist);
-                }
+                epoll_close_fdlist(ep);
 
                 rt_mutex_release(&ep->lock);
                 rt_mutex_detach(&ep->lock);
@@ -173,7 +189,7 @@ static int epoll_poll(struct dfs_file *file, struct rt_pollreq *req)
 
         level = rt_spin_lock_irqsave(&ep->spinlock);
 
-        if (!rt_slist_isempty(&ep->rdl_head))
+        if (!rt_list_isempty(&ep->rdl_head))
             events |= POLLIN | EPOLLRDNORM | POLLOUT;
 
         rt_spin_unlock_irqrestore(&ep->spinlock, level);
@@ -183,22 +199,49 @@ static int epoll_poll(struct dfs_file *file, struct rt_pollreq *req)
     return events;
 }
 
+/**
+ * @brief   Appends a monitored file descriptor to the ready list.
+ *
+ * This function appends the monitored file descriptor to the ready list if it is not there yet,
+ * the caller must hold the spin lock of the epoll instance.
+ *
+ * @param   ep      Pointer to the epoll control structure.
+ * @param   fdlist  Pointer to the monitored file descriptor.
+ *
+ * @return  Returns RT_TRUE if it was appended.
+ */
+static rt_bool_t epoll_rdlist_add(struct rt_eventpoll *ep, struct rt_fd_list *fdlist)
+{
+    if (!rt_list_isempty(&fdlist->rdl_node))
+    {
+        return RT_FALSE;
+    }
+
+    rt_list_insert_before(&ep->rdl_head, &fdlist->rdl_node);
+    ep->eventpoll_num++;
+
+    return RT_TRUE;
+}
+
 /**
  * @brief   Callback function for the wait queue.
  *
- * This function is called when the file descriptor is ready for polling.
+ * This function is called when the file descriptor is ready for polling. The node stays in
+ * the wait queue, the file descriptor is only appended to the ready list and the waiting
+ * thread is resumed, so that nothing is polled again until epoll_wait harvests it.
  *
  * @param   wait    Pointer to the wait queue node.
  * @param   key     Key associated with the wait queue node.
  *
- * @return  Returns 0 on success.
+ * @return  Returns -1, the wait queue never resumes the polling thread of the node.
  */
 static int epoll_wqueue_callback(struct rt_wqueue_node *wait, void *key)
 {
     struct rt_fd_list *fdlist;
     struct rt_eventpoll *ep;
+    rt_thread_t waiter;
+    rt_bool_t added = RT_FALSE;
     rt_base_t level;
-    int is_waiting = 0;
 
     if (key && !((rt_ubase_t)key & wait->key))
         return -1;
@@ -209,22 +252,29 @@ static int epoll_wqueue_callback(struct rt_wqueue_node *wait, void *key)
     if (ep)
     {
         level = rt_spin_lock_irqsave(&ep->spinlock);
-        if (fdlist->is_rdl_node == RT_FALSE)
+
+        /* disabled by EPOLLONESHOT until EPOLL_CTL_MOD */
+        if (fdlist->revents & ~EPOLL_PRIVATE_BITS)
         {
-            rt_slist_append(&ep->rdl_head, &fdlist->rdl_node);
-            fdlist->exclusive = 0;
-            fdlist->is_rdl_node = RT_TRUE;
-            ep->eventpoll_num++;
-            is_waiting = (ep->status == RT_EPOLL_STAT_WAITING);
+            fdlist->ready_events |= key ? (rt_uint32_t)(rt_ubase_t)key : EPOLL_READY_NOKEY;
+            added = epoll_rdlist_add(ep, fdlist);
+
+            if (ep->status == RT_EPOLL_STAT_WAITING)
+            {
+                waiter = ep->polling_thread;
+                waiter->error = RT_EOK;
+                rt_thread_resume(waiter);
+            }
             ep->status = RT_EPOLL_STAT_TRIG;
-            rt_wqueue_wakeup(&ep->epoll_read, (void *)POLLIN);
         }
+
         rt_spin_unlock_irqrestore(&ep->spinlock, level);
-    }
 
-    if (is_waiting)
-    {
-        return __wqueue_default_wake(wait, key);
+        if (added)
+        {
+            /* the epoll instance may be monitored by another one */
+            rt_wqueue_wakeup(&ep->epoll_read, (void *)POLLIN);
+        }
     }
 
     return -1;
@@ -258,7 +308,8 @@ static void epoll_wqueue_add_callback(rt_wqueue_t *wq, rt_pollreq_t *req)
 /**
  * @brief   Installs a file descriptor list into the epoll control structure.
  *
- * This function installs a file descriptor list into the epoll control structure.
+ * This function installs a file descriptor list into the epoll control structure, the
+ * wait queue node is added once here and stays until EPOLL_CTL_DEL or EPOLL_CTL_MOD.
  *
  * @param   fdlist  Pointer to the file descriptor list.
  * @param   ep      Pointer to the epoll control structure.
@@ -274,18 +325,10 @@ static void epoll_ctl_install(struct rt_fd_list *fdlist, struct rt_eventpoll *ep
 
     if (mask & fdlist->revents)
     {
-        if (ep)
-        {
-            rt_mutex_take(&ep->lock, RT_WAITING_FOREVER);
-            level = rt_spin_lock_irqsave(&ep->spinlock);
-            rt_slist_append(&ep->rdl_head, &fdlist->rdl_node);
-            fdlist->exclusive = 0;
-            fdlist->is_rdl_node = RT_TRUE;
-            ep->status = RT_EPOLL_STAT_TRIG;
-            ep->eventpoll_num ++;
-            rt_spin_unlock_irqrestore(&ep->spinlock, level);
-            rt_mutex_release(&ep->lock);
-        }
+        level = rt_spin_lock_irqsave(&ep->spinlock);
+        epoll_rdlist_add(ep, fdlist);
+        ep->status = RT_EPOLL_STAT_TRIG;
+        rt_spin_unlock_irqrestore(&ep->spinlock, level);
     }
 }
 
@@ -303,7 +346,7 @@ static void epoll_member_init(struct rt_eventpoll *ep)
     ep->polling_thread = rt_thread_self();
     ep->fdlist = RT_NULL;
     ep->req._key = 0;
-    rt_slist_init(&(ep->rdl_head));
+    rt_list_init(&(ep->rdl_head));
     rt_wqueue_init(&ep->epoll_read);
     rt_mutex_init(&ep->lock, EPOLL_MUTEX_NAME, RT_IPC_FLAG_FIFO);
     rt_spin_lock_init(&ep->spinlock);
@@ -340,28 +383,13 @@ static int epoll_epf_init(int fd)
             df->vnode = (struct dfs_vnode *)rt_malloc(sizeof(struct dfs_vnode));
             if (df->vnode)
             {
-                ep->fdlist = (struct rt_fd_list *)rt_malloc(sizeof(struct rt_fd_list));
-                if (ep->fdlist)
-                {
-                    ep->fdlist->next = RT_NULL;
-                    ep->fdlist->fd = fd;
-                    ep->fdlist->ep = ep;
-                    ep->fdlist->exclusive = 0;
-                    ep->fdlist->is_rdl_node = RT_FALSE;
-                    dfs_vnode_init(df->vnode, FT_REGULAR, &epoll_fops);
-                    df->vnode->data = ep;
-                    rt_slist_init(&ep->fdlist->rdl_node);
-                }
-                else
-                {
-                    ret = -ENOMEM;
-                    rt_free(df->vnode);
-                    rt_free(ep);
-                }
+                dfs_vnode_init(df->vnode, FT_REGULAR, &epoll_fops);
+                df->vnode->data = ep;
             }
             else
             {
                 ret = -ENOMEM;
+                rt_mutex_detach(&ep->lock);
                 rt_free(ep);
             }
         }
@@ -415,6 +443,46 @@ static int epoll_do_create(int size)
     return ret;
 }
 
+/**
+ * @brief   Finds a monitored file descriptor in the epoll instance.
+ *
+ * This function looks the file descriptor up in the monitor hash, the caller must hold
+ * the mutex lock of the epoll instance.
+ *
+ * @param   ep      Pointer to the epoll control structure.
+ * @param   fd      File descriptor to find.
+ *
+ * @return  Returns the monitored file descriptor, or RT_NULL if it is not monitored.
+ */
+static struct rt_fd_list *epoll_fdlist_find(struct rt_eventpoll *ep, int fd)
+{
+    struct rt_fd_list *fdlist = RT_NULL;
+
+    RT_UTHASH_FIND(ep->fdlist, &fd, sizeof(fd), fdlist);
+
+    return fdlist;
+}
+
+/**
+ * @brief   Inserts a monitored file descriptor into the epoll instance.
+ *
+ * This function inserts the file descriptor into the monitor hash, the caller must hold
+ * the mutex lock of the epoll instance.
+ *
+ * @param   ep      Pointer to the epoll control structure.
+ * @param   fdlist  Pointer to the monitored file descriptor.
+ *
+ * @return  Returns 0 on success, or -RT_ENOMEM if the hash can not grow.
+ */
+static rt_err_t epoll_fdlist_insert(struct rt_eventpoll *ep, struct rt_fd_list *fdlist)
+{
+    rt_err_t rc = 0;
+
+    RT_UTHASH_ADD(ep->fdlist, fd, sizeof(fdlist->fd), fdlist);
+
+    return rc;
+}
+
 /**
  * @brief   Adds a file descriptor to the epoll instance.
  *
@@ -435,44 +503,43 @@ static int epoll_ctl_add(struct dfs_file *df, int fd, struct epoll_event *event)
     if (df->vnode->data)
     {
         ep = df->vnode->data;
-        fdlist = ep->fdlist;
         ret = 0;
 
         rt_mutex_take(&ep->lock, RT_WAITING_FOREVER);
-        while (fdlist->next != RT_NULL)
+
+        if (epoll_fdlist_find(ep, fd))
         {
-            if (fdlist->next->fd == fd)
-            {
-                rt_mutex_release(&ep->lock);
-                return 0;
-            }
-            fdlist = fdlist->next;
+            rt_mutex_release(&ep->lock);
+            return 0;
         }
-        rt_mutex_release(&ep->lock);
 
-        fdlist = (struct rt_fd_list *)rt_malloc(sizeof(struct rt_fd_list));
+        fdlist = (struct rt_fd_list *)rt_calloc(1, sizeof(struct rt_fd_list));
         if (fdlist)
         {
             fdlist->fd = fd;
             memcpy(&fdlist->epev.data, &event->data, sizeof(event->data));
             fdlist->epev.events = 0;
             fdlist->ep = ep;
-            fdlist->exclusive = 0;
-            fdlist->is_rdl_node = RT_FALSE;
             fdlist->req._proc = epoll_wqueue_add_callback;
             fdlist->revents = event->events;
-            rt_mutex_take(&ep->lock, RT_WAITING_FOREVER);
-            fdlist->next = ep->fdlist->next;
-            ep->fdlist->next = fdlist;
-            rt_mutex_release(&ep->lock);
-            rt_slist_init(&fdlist->rdl_node);
+            rt_list_init(&fdlist->rdl_node);
 
-            epoll_ctl_install(fdlist, ep);
+            if (epoll_fdlist_insert(ep, fdlist) == 0)
+            {
+                epoll_ctl_install(fdlist, ep);
+            }
+            else
+            {
+                rt_free(fdlist);
+                ret = -ENOMEM;
+            }
         }
         else
         {
             ret = -ENOMEM;
         }
+
+        rt_mutex_release(&ep->lock);
     }
 
     return ret;
@@ -490,9 +557,8 @@ static int epoll_ctl_add(struct dfs_file *df, int fd, struct epoll_event *event)
  */
 static int epoll_ctl_del(struct dfs_file *df, int fd)
 {
-    struct rt_fd_list *fdlist, *fre_fd, *rdlist;
+    struct rt_fd_list *fre_fd;
     struct rt_eventpoll *ep = RT_NULL;
-    rt_slist_t *node = RT_NULL;
     rt_err_t ret = -EINVAL;
     rt_base_t level;
 
@@ -503,33 +569,22 @@ static int epoll_ctl_del(struct dfs_file *df, int fd)
         if (ep)
         {
             rt_mutex_take(&ep->lock, RT_WAITING_FOREVER);
-            level = rt_spin_lock_irqsave(&ep->spinlock);
-            rt_slist_for_each(node, &ep->rdl_head)
-            {
-                rdlist = rt_slist_entry(node, struct rt_fd_list, rdl_node);
-                if (rdlist->fd == fd)
-                    rt_slist_remove(&ep->rdl_head, node);
-            }
-            rt_spin_unlock_irqrestore(&ep->spinlock, level);
 
-            fdlist = ep->fdlist;
-            while (fdlist->next != RT_NULL)
+            fre_fd = epoll_fdlist_find(ep, fd);
+            if (fre_fd)
             {
-                if (fdlist->next->fd == fd)
-                {
-                    fre_fd = fdlist->next;
-                    fdlist->next = fdlist->next->next;
-
-                    if (fre_fd->wqn.wqueue)
-                        rt_wqueue_remove(&fre_fd->wqn);
+                epoll_wqueue_detach(fre_fd);
 
-                    rt_free(fre_fd);
-                    break;
-                }
-                else
+                level = rt_spin_lock_irqsave(&ep->spinlock);
+                if (!rt_list_isempty(&fre_fd->rdl_node))
                 {
-                    fdlist = fdlist->next;
+                    rt_list_remove(&fre_fd->rdl_node);
+                    ep->eventpoll_num--;
                 }
+                rt_spin_unlock_irqrestore(&ep->spinlock, level);
+
+                RT_UTHASH_DELETE(ep->fdlist, fre_fd);
+                rt_free(fre_fd);
             }
 
             rt_mutex_release(&ep->lock);
@@ -557,30 +612,35 @@ static int epoll_ctl_mod(struct dfs_file *df, int fd, struct epoll_event *event)
     struct rt_fd_list *fdlist;
     struct rt_eventpoll *ep = RT_NULL;
     rt_err_t ret = -EINVAL;
+    rt_base_t level;
 
     if (df->vnode->data)
     {
         ep = df->vnode->data;
 
-        fdlist = ep->fdlist;
-        while (fdlist->next != RT_NULL)
+        rt_mutex_take(&ep->lock, RT_WAITING_FOREVER);
+
+        fdlist = epoll_fdlist_find(ep, fd);
+        if (fdlist)
         {
-            if (fdlist->next->fd == fd)
-            {
-                rt_mutex_take(&ep->lock, RT_WAITING_FOREVER);
-                memcpy(&fdlist->next->epev.data, &event->data, sizeof(event->data));
-                fdlist->next->revents = event->events;
-                if (fdlist->next->wqn.wqueue)
-                    rt_wqueue_remove(&fdlist->next->wqn);
+            epoll_wqueue_detach(fdlist);
 
-                rt_mutex_release(&ep->lock);
-                epoll_ctl_install(fdlist->next, ep);
-                break;
+            level = rt_spin_lock_irqsave(&ep->spinlock);
+            memcpy(&fdlist->epev.data, &event->data, sizeof(event->data));
+            fdlist->revents = event->events;
+            fdlist->ready_events = 0;
+            if (!rt_list_isempty(&fdlist->rdl_node))
+            {
+                rt_list_remove(&fdlist->rdl_node);
+                ep->eventpoll_num--;
             }
+            rt_spin_unlock_irqrestore(&ep->spinlock, level);
 
-            fdlist = fdlist->next;
+            epoll_ctl_install(fdlist, ep);
         }
 
+        rt_mutex_release(&ep->lock);
+
         ret = 0;
     }
 
@@ -688,7 +748,7 @@ static int epoll_wait_timeout(struct rt_eventpoll *ep, int msec)
     rt_base_t level;
     int ret = 0;
 
-    thread = ep->polling_thread;
+    thread = rt_thread_self();
 
     timeout = rt_tick_from_millisecond(msec);
 
@@ -706,6 +766,8 @@ static int epoll_wait_timeout(struct rt_eventpoll *ep, int msec)
                 rt_timer_start(&(thread->thread_timer));
             }
 
+            /* the wakeup callbacks resume the waiting thread */
+            ep->polling_thread = thread;
             ep->status = RT_EPOLL_STAT_WAITING;
 
             rt_spin_unlock_irqrestore(&ep->spinlock, level);
@@ -764,7 +826,11 @@ static int epoll_get_event(struct rt_fd_list *fl, rt_pollreq_t *req)
 /**
  * @brief   Performs epoll operation to get triggered events.
  *
- * This function performs epoll operation to get triggered events.
+ * This function performs epoll operation to get triggered events. Only the ready list is
+ * visited, so the cost follows the number of ready file descriptors rather than the number
+ * of monitored ones. The edge-triggered ones reported by the wakeup key are not polled again,
+ * the level-triggered ones are polled without reinstalling the wait queue node and stay in
+ * the ready list while they are ready.
  *
  * @param   ep          Pointer to the epoll instance.
  * @param   events      Pointer to the array to store triggered events.
@@ -776,119 +842,104 @@ static int epoll_get_event(struct rt_fd_list *fl, rt_pollreq_t *req)
 static int epoll_do(struct rt_eventpoll *ep, struct epoll_event *events, int maxevents, int timeout)
 {
     struct rt_fd_list *rdlist;
-    rt_slist_t *node = RT_NULL;
+    rt_list_t txlist;
+    rt_pollreq_t query;
+    rt_uint32_t ready;
     int event_num = 0;
     int istimeout = 0;
-    int isn_add = 0;
-    int isfree = 0;
     int mask = 0;
     rt_base_t level;
 
+    /* only query the events, the wait queue node is already installed */
+    query._proc = RT_NULL;
+
     while (1)
     {
         rt_mutex_take(&ep->lock, RT_WAITING_FOREVER);
         level = rt_spin_lock_irqsave(&ep->spinlock);
-        if (ep->eventpoll_num > 0)
+
+        /*
+         * Take the whole ready list, the ones which are ready again are appended to
+         * the ready list of the epoll instance, not visited twice in this round.
+         */
+        rt_list_init(&txlist);
+        if (!rt_list_isempty(&ep->rdl_head))
         {
-            rt_slist_for_each(node,&ep->rdl_head)
+            txlist.next = ep->rdl_head.next;
+            txlist.prev = ep->rdl_head.prev;
+            txlist.next->prev = &txlist;
+            txlist.prev->next = &txlist;
+            rt_list_init(&ep->rdl_head);
+        }
+        ep->eventpoll_num = 0;
+        ep->status = RT_EPOLL_STAT_INIT;
+
+        while (event_num < maxevents && !rt_list_isempty(&txlist))
+        {
+            rdlist = rt_list_first_entry(&txlist, struct rt_fd_list, rdl_node);
+            ready = rdlist->ready_events;
+            rdlist->ready_events = 0;
+
+            rt_spin_unlock_irqrestore(&ep->spinlock, level);
+
+            if ((rdlist->revents & EPOLLET) && !(ready & EPOLL_READY_NOKEY) &&
+                (ready & rdlist->revents))
+            {
+                /* the edge is reported by the wakeup */
+                mask = ready;
+            }
+            else
             {
-                rdlist = rt_slist_entry(node, struct rt_fd_list, rdl_node);
-                ep->eventpoll_num --;
-                rt_slist_remove(&ep->rdl_head, &rdlist->rdl_node);
-                rdlist->is_rdl_node = RT_FALSE;
+                mask = epoll_get_event(rdlist, &query);
+                mask = mask < 0 ? 0 : mask;
+            }
+            mask &= rdlist->revents;
 
-                rt_spin_unlock_irqrestore(&ep->spinlock, level);
+            level = rt_spin_lock_irqsave(&ep->spinlock);
+            rt_list_remove(&rdlist->rdl_node);
 
-                isfree = 0;
-                isn_add = 0;
-                if (event_num < maxevents)
-                {
-                    if (rdlist->wqn.wqueue)
-                    {
-                        rt_wqueue_remove(&rdlist->wqn);
-                    }
-
-                    mask = epoll_get_event(rdlist, &rdlist->req);
-
-                    if (mask & rdlist->revents)
-                    {
-                        rdlist->epev.events = mask & rdlist->revents;
-                    }
-                    else
-                    {
-                        isfree = 1;
-                        isn_add = 1;
-                    }
-
-                    if (rdlist->revents & EPOLLONESHOT)
-                    {
-                        rdlist->revents = 0;
-                        isfree = 1;
-                        if (rdlist->wqn.wqueue)
-                            rt_wqueue_remove(&rdlist->wqn);
-                    }
-                    else
-                    {
-                        if (rdlist->revents & EPOLLET)
-                        {
-                            isfree = 1;
-                        }
-                        else
-                        {
-                            level = rt_spin_lock_irqsave(&ep->spinlock);
-                            if (rdlist->exclusive != 1)
-                            {
-                                rdlist->exclusive = 1;
-                            }
-                            rt_spin_unlock_irqrestore(&ep->spinlock, level);
-                        }
-                    }
-
-                    if (!isn_add)
-                    {
-                        memcpy(&events[event_num], &rdlist->epev, sizeof(rdlist->epev));
-                        event_num ++;
-                    }
-
-                    if (!isfree)
-                    {
-                        if (rdlist->is_rdl_node == RT_FALSE)
-                        {
-                            level = rt_spin_lock_irqsave(&ep->spinlock);
-                            ep->eventpoll_num ++;
-                            rt_slist_append(&ep->rdl_head, &rdlist->rdl_node);
-                            rdlist->is_rdl_node = RT_TRUE;
-                            rt_spin_unlock_irqrestore(&ep->spinlock, level);
-                        }
-                        else
-                        {
-                            level = rt_spin_lock_irqsave(&ep->spinlock);
-                            if (!rdlist->wqn.wqueue)
-                            {
-                                epoll_get_event(rdlist, &rdlist->req);
-                            }
-                            rt_spin_unlock_irqrestore(&ep->spinlock, level);
-                        }
-                    }
-                }
-                else
+            if (mask)
+            {
+                rdlist->epev.events = mask;
+                memcpy(&events[event_num], &rdlist->epev, sizeof(rdlist->epev));
+                event_num ++;
+
+                if (rdlist->revents & EPOLLONESHOT)
                 {
-                    level = rt_spin_lock_irqsave(&ep->spinlock);
-                    break;
+                    rdlist->revents = 0;
+                    rdlist->ready_events = 0;
+                    continue;
                 }
+            }
 
-                level = rt_spin_lock_irqsave(&ep->spinlock);
+            if (rdlist->ready_events)
+            {
+                /* woken up again meanwhile, the new edge must not be lost */
+                epoll_rdlist_add(ep, rdlist);
+                ep->status = RT_EPOLL_STAT_TRIG;
+            }
+            else if (mask && !(rdlist->revents & EPOLLET))
+            {
+                /* level-triggered, stays ready until the poll tells otherwise */
+                epoll_rdlist_add(ep, rdlist);
             }
         }
 
+        /* give back the ones not harvested for lack of room */
+        while (!rt_list_isempty(&txlist))
+        {
+            rdlist = rt_list_entry(txlist.prev, struct rt_fd_list, rdl_node);
+            rt_list_remove(&rdlist->rdl_node);
+            rt_list_insert_after(&ep->rdl_head, &rdlist->rdl_node);
+            ep->eventpoll_num++;
+            ep->status = RT_EPOLL_STAT_TRIG;
+        }
+
         rt_spin_unlock_irqrestore(&ep->spinlock, level);
         rt_mutex_release(&ep->lock);
 
         if (event_num || istimeout)
         {
-            level = rt_spin_lock_irqsave(&ep->spinlock);
-            ep->status = RT_EPOLL_STAT_INIT;
-            rt_spin_unlock_irqrestore(&ep->spinlock, level);
             if ((timeout >= 0) || (event_num > 0))
                 break;
         }
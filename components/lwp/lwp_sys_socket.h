@@ -160,4 +160,6 @@ struct musl_rtentry
     unsigned short int rt_irtt;
 };
 
+int netflags_muslc_2_lwip(int flags);
+
 #endif /* __LWP_SYS_SOCKET_H__ */
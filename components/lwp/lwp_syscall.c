@@ -16,6 +16,11 @@
  * 2023-11-16     xqyjlj       fix some syscalls (about sched_*, get/setpriority)
  * 2023-11-17     xqyjlj       add process group and session support
  * 2023-11-30     Shell        Fix sys_setitimer() and exit(status)
+ * 2026-10-17     agent        add sys_io_uring_setup and sys_io_uring_enter
+ * 2026-10-17     agent        direct user buffer I/O for read/write, add readv/writev
+ * 2026-10-17     agent        add sendfile, splice and copy_file_range
+ * 2026-10-17     agent        bounce user buffers for files that may DMA
+ * 2026-10-17     agent        transfer in pinned user pages only
  */
 #define __RT_IPC_SOURCE__
 #define _GNU_SOURCE
@@ -23,6 +28,7 @@
 /* RT-Thread System call */
 #include <rtthread.h>
 #include <rthw.h>
+#include <rtdevice.h>
 #include <board.h>
 
 #include <string.h>
@@ -380,44 +386,239 @@ sysret_t sys_exit(int status)
     return rc;
 }
 
-/* syscall: "read" ret: "ssize_t" args: "int" "void *" "size_t" */
-ssize_t sys_read(int fd, void *buf, size_t nbyte)
-{
 #ifdef ARCH_MM_MMU
-    void *kmem = RT_NULL;
-    ssize_t ret = -1;
+#define FILE_UITER_CHUNK_MAX    (16 * ARCH_PAGE_SIZE)
 
-    if (!nbyte)
+#ifndef IOV_MAX
+#define IOV_MAX                 1024
+#endif /* IOV_MAX */
+
+#ifdef RT_USING_DFS_V2
+ssize_t pread(int fd, void *buf, size_t len, size_t offset);
+ssize_t pwrite(int fd, const void *buf, size_t len, size_t offset);
+#endif /* RT_USING_DFS_V2 */
+
+static rt_bool_t _file_is_regular(int fd)
+{
+    struct dfs_file *file = fd_get(fd);
+
+    return file && file->vnode && file->vnode->type == FT_REGULAR;
+}
+
+/**
+ * A file may take the user buffer in place only if it's known to copy
+ * the data with CPU, i.e. the page cache or the pipe. Others, like the
+ * block devices and the sockets, may hand the buffer to a DMA engine
+ * which requires a kernel address.
+ */
+static rt_bool_t _file_is_cpu_copy(int fd)
+{
+    struct dfs_file *file = fd_get(fd);
+
+    if (!file || !file->vnode)
+    {
+        return RT_FALSE;
+    }
+
+#ifdef RT_USING_PAGECACHE
+    if (file->vnode->type == FT_REGULAR && file->vnode->aspace && !(file->flags & O_DIRECT))
+    {
+        return RT_TRUE;
+    }
+#endif /* RT_USING_PAGECACHE */
+
+#if defined(RT_USING_POSIX_DEVIO) && defined(RT_USING_POSIX_PIPE)
+    if (rt_pipe_is_fops(file->fops))
+    {
+        return RT_TRUE;
+    }
+#endif
+
+    return RT_FALSE;
+}
+
+static ssize_t _file_chunk_rw(int fd, void *buf, size_t len, off_t *offset, int dir)
+{
+#ifdef RT_USING_DFS_V2
+    if (offset)
+    {
+        if (dir == LWP_UITER_TO_USER)
+            return pread(fd, buf, len, *offset);
+        else
+            return pwrite(fd, buf, len, *offset);
+    }
+#else
+    RT_ASSERT(!offset);
+#endif /* RT_USING_DFS_V2 */
+
+    if (dir == LWP_UITER_TO_USER)
+        return read(fd, buf, len);
+    else
+        return write(fd, buf, len);
+}
+
+/**
+ * Transfer between the file and the user buffers of iter. A file copying
+ * with CPU reads or writes each pinned chunk of user buffer in place through
+ * its kernel address, others and the chunks that can't be pinned go through
+ * a kernel bounce buffer. The transfer stops on the first short or failed
+ * chunk, and a read of a file other than a regular file returns after its
+ * first transfer since it may block for more data.
+ * The file position is used if offset is RT_NULL.
+ */
+static ssize_t _file_uiter_rw(int fd, struct lwp_uiter *iter, off_t *offset)
+{
+    rt_bool_t regular = _file_is_regular(fd);
+    rt_bool_t cpu_copy = _file_is_cpu_copy(fd);
+    void *kbuf = RT_NULL;
+    off_t pos, *ppos = RT_NULL;
+    ssize_t done = 0;
+    ssize_t chunk;
+    ssize_t ret = 0;
+    void *uaddr, *kaddr;
+
+    while ((chunk = lwp_uiter_chunk(iter, FILE_UITER_CHUNK_MAX, &uaddr,
+                                    cpu_copy ? &kaddr : RT_NULL)) > 0)
+    {
+        if (offset)
+        {
+            pos = *offset + done;
+            ppos = &pos;
+        }
+
+        if (cpu_copy && kaddr)
+        {
+            ret = _file_chunk_rw(fd, kaddr, chunk, ppos, iter->dir);
+        }
+        else if (!kbuf && !(kbuf = kmem_get(iter->count < FILE_UITER_CHUNK_MAX ?
+                                            iter->count : FILE_UITER_CHUNK_MAX)))
+        {
+            ret = -ENOMEM;
+        }
+        else if (iter->dir == LWP_UITER_TO_USER)
+        {
+            ret = _file_chunk_rw(fd, kbuf, chunk, ppos, iter->dir);
+            if (ret > 0 && lwp_put_to_user(uaddr, kbuf, ret) != ret)
+            {
+                ret = -EFAULT;
+            }
+        }
+        else
+        {
+            ret = -EFAULT;
+            if (lwp_get_from_user(kbuf, uaddr, chunk) == chunk)
+            {
+                ret = _file_chunk_rw(fd, kbuf, chunk, ppos, iter->dir);
+            }
+        }
+
+        if (ret < 0)
+        {
+            if (ret != -EFAULT && ret != -ENOMEM)
+            {
+                ret = GET_ERRNO();
+            }
+            break;
+        }
+
+        lwp_uiter_advance(iter, ret);
+        done += ret;
+
+        if (ret < chunk || (!regular && iter->dir == LWP_UITER_TO_USER))
+        {
+            break;
+        }
+    }
+
+    lwp_uiter_fini(iter);
+
+    if (kbuf)
+    {
+        kmem_put(kbuf);
+    }
+
+    if (done)
+    {
+        return done;
+    }
+
+    return chunk > 0 ? ret : chunk;
+}
+
+static ssize_t _file_user_rw(int fd, void *buf, size_t nbyte, off_t *offset, int dir)
+{
+    struct lwp_uiter iter;
+    struct iovec iov;
+    int err;
+
+    iov.iov_base = buf;
+    iov.iov_len = nbyte;
+    err = lwp_uiter_init(&iter, lwp_self(), dir, &iov, 1);
+    if (err)
+    {
+        return err;
+    }
+
+    return _file_uiter_rw(fd, &iter, offset);
+}
+
+static ssize_t _file_user_rwv(int fd, const struct iovec *iov, int iovcnt, int dir)
+{
+    struct lwp_uiter iter;
+    struct iovec *kiov;
+    size_t iov_size;
+    ssize_t ret;
+
+    if (iovcnt < 0 || iovcnt > IOV_MAX)
     {
         return -EINVAL;
     }
+    if (!iovcnt)
+    {
+        return 0;
+    }
 
-    if (!lwp_user_accessable((void *)buf, nbyte))
+    iov_size = sizeof(*iov) * iovcnt;
+    if (!lwp_user_accessable((void *)iov, iov_size))
     {
         return -EFAULT;
     }
 
-    kmem = kmem_get(nbyte);
-    if (!kmem)
+    kiov = kmem_get(iov_size);
+    if (!kiov)
     {
         return -ENOMEM;
     }
 
-    ret = read(fd, kmem, nbyte);
-    if (ret > 0)
+    if (lwp_get_from_user(kiov, (void *)iov, iov_size) != iov_size)
     {
-        if (ret != lwp_put_to_user(buf, kmem, ret))
-            return -EFAULT;
+        ret = -EFAULT;
     }
-
-    if (ret < 0)
+    else
     {
-        ret = GET_ERRNO();
+        ret = lwp_uiter_init(&iter, lwp_self(), dir, kiov, iovcnt);
+        if (!ret)
+        {
+            ret = _file_uiter_rw(fd, &iter, RT_NULL);
+        }
     }
 
-    kmem_put(kmem);
+    kmem_put(kiov);
 
     return ret;
+}
+#endif /* ARCH_MM_MMU */
+
+/* syscall: "read" ret: "ssize_t" args: "int" "void *" "size_t" */
+ssize_t sys_read(int fd, void *buf, size_t nbyte)
+{
+#ifdef ARCH_MM_MMU
+    if (!nbyte)
+    {
+        return -EINVAL;
+    }
+
+    return _file_user_rw(fd, buf, nbyte, RT_NULL, LWP_UITER_TO_USER);
 #else
     if (!lwp_user_accessable((void *)buf, nbyte))
     {
@@ -432,34 +633,15 @@ ssize_t sys_read(int fd, void *buf, size_t nbyte)
 ssize_t sys_write(int fd, const void *buf, size_t nbyte)
 {
 #ifdef ARCH_MM_MMU
-    void *kmem = RT_NULL;
-    ssize_t ret = -1;
+    ssize_t ret;
 
     if (nbyte)
     {
-        if (!lwp_user_accessable((void *)buf, nbyte))
-        {
-            return -EFAULT;
-        }
-
-        kmem = kmem_get(nbyte);
-        if (!kmem)
-        {
-            return -ENOMEM;
-        }
-
-        lwp_get_from_user(kmem, (void *)buf, nbyte);
-    }
-
-    ret = write(fd, kmem, nbyte);
-    if (ret < 0)
-    {
-        ret = GET_ERRNO();
+        return _file_user_rw(fd, (void *)buf, nbyte, RT_NULL, LWP_UITER_FROM_USER);
     }
 
-    kmem_put(kmem);
-
-    return ret;
+    ret = write(fd, RT_NULL, 0);
+    return (ret < 0 ? GET_ERRNO() : ret);
 #else
     if (!lwp_user_accessable((void *)buf, nbyte))
     {
@@ -470,6 +652,26 @@ ssize_t sys_write(int fd, const void *buf, size_t nbyte)
 #endif
 }
 
+/* syscall: "readv" ret: "ssize_t" args: "int" "const struct iovec *" "int" */
+ssize_t sys_readv(int fd, const struct iovec *iov, int iovcnt)
+{
+#ifdef ARCH_MM_MMU
+    return _file_user_rwv(fd, iov, iovcnt, LWP_UITER_TO_USER);
+#else
+    return -ENOSYS;
+#endif
+}
+
+/* syscall: "writev" ret: "ssize_t" args: "int" "const struct iovec *" "int" */
+ssize_t sys_writev(int fd, const struct iovec *iov, int iovcnt)
+{
+#ifdef ARCH_MM_MMU
+    return _file_user_rwv(fd, iov, iovcnt, LWP_UITER_FROM_USER);
+#else
+    return -ENOSYS;
+#endif
+}
+
 /* syscall: "lseek" ret: "off_t" args: "int" "off_t" "int" */
 size_t sys_lseek(int fd, size_t offset, int whence)
 {
@@ -3114,7 +3316,7 @@ sysret_t sys_listen(int socket, int backlog)
 #define MUSLC_MSG_WAITALL   0x0100
 #define MUSLC_MSG_MORE      0x8000
 
-static int netflags_muslc_2_lwip(int flags)
+int netflags_muslc_2_lwip(int flags)
 {
     int flgs = 0;
 
@@ -6192,47 +6394,51 @@ sysret_t sys_reboot(int magic, int magic2, int type)
 ssize_t sys_pread64(int fd, void *buf, int size, size_t offset)
 #ifdef RT_USING_DFS_V2
 {
-    ssize_t pread(int fd, void *buf, size_t len, size_t offset);
 #ifdef ARCH_MM_MMU
-    ssize_t ret = -1;
-    void *kmem = RT_NULL;
+    off_t pos = offset;
 
-    if (!size)
+    if (size <= 0)
     {
         return -EINVAL;
     }
 
+    return _file_user_rw(fd, buf, size, &pos, LWP_UITER_TO_USER);
+#else
     if (!lwp_user_accessable((void *)buf, size))
     {
         return -EFAULT;
     }
-    kmem = kmem_get(size);
-    if (!kmem)
-    {
-        return -ENOMEM;
-    }
 
-    ret = pread(fd, kmem, size, offset);
-    if (ret > 0)
-    {
-        lwp_put_to_user(buf, kmem, ret);
-    }
+    ssize_t ret = pread(fd, buf, size, offset);
+    return (ret < 0 ? GET_ERRNO() : ret);
+#endif
+}
+#else
+{
+    ssize_t ret = -ENOSYS;
+    return (ret < 0 ? GET_ERRNO() : ret);
+}
+#endif
 
-    if (ret < 0)
+ssize_t sys_pwrite64(int fd, void *buf, int size, size_t offset)
+#ifdef RT_USING_DFS_V2
+{
+#ifdef ARCH_MM_MMU
+    off_t pos = offset;
+
+    if (size <= 0)
     {
-        ret = GET_ERRNO();
+        return -EINVAL;
     }
 
-    kmem_put(kmem);
-
-    return ret;
+    return _file_user_rw(fd, buf, size, &pos, LWP_UITER_FROM_USER);
 #else
     if (!lwp_user_accessable((void *)buf, size))
     {
         return -EFAULT;
     }
 
-    ssize_t ret = pread(fd, kmem, size, offset);
+    ssize_t ret = pwrite(fd, buf, size, offset);
     return (ret < 0 ? GET_ERRNO() : ret);
 #endif
 }
@@ -6243,56 +6449,277 @@ ssize_t sys_pread64(int fd, void *buf, int size, size_t offset)
 }
 #endif
 
-ssize_t sys_pwrite64(int fd, void *buf, int size, size_t offset)
 #ifdef RT_USING_DFS_V2
+#ifndef SPLICE_F_MOVE
+#define SPLICE_F_MOVE       1
+#define SPLICE_F_NONBLOCK   2
+#define SPLICE_F_MORE       4
+#define SPLICE_F_GIFT       8
+#endif /* SPLICE_F_MOVE */
+
+struct splice_sink
 {
-    ssize_t pwrite(int fd, const void *buf, size_t len, size_t offset);
-#ifdef ARCH_MM_MMU
-    ssize_t ret = -1;
-    void *kmem = RT_NULL;
+    int fd;
+    struct dfs_file *file;
+    off_t *offset;          /* RT_NULL to write at the file position */
+    size_t left;            /* bytes still to come after this chunk */
+    rt_bool_t more;         /* the caller has more data to send */
+};
 
-    if (!size)
+/*
+ * Consume a chunk of the source, a socket sends it straight from the page
+ * cache page by SAL, and any other file writes it through its own cache.
+ */
+static ssize_t _splice_sink_write(void *data, const void *buf, size_t len)
+{
+    struct splice_sink *sink = data;
+    ssize_t done = 0;
+    ssize_t ret;
+
+    sink->left -= len;
+
+    while ((size_t)done < len)
     {
-        return -EINVAL;
+#ifdef RT_USING_SAL
+        if (sink->file->vnode->type == FT_SOCKET)
+        {
+            struct msghdr msg = {0};
+            struct iovec iov;
+            int flags = 0;
+
+            iov.iov_base = (char *)buf + done;
+            iov.iov_len = len - done;
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            if (sink->left || sink->more)
+            {
+                flags = netflags_muslc_2_lwip(MUSLC_MSG_MORE);
+            }
+
+            ret = sendmsg(sink->fd, &msg, flags);
+            if (ret < 0)
+            {
+                ret = GET_ERRNO();
+            }
+        }
+        else
+#endif /* RT_USING_SAL */
+        if (sink->offset)
+        {
+            ret = dfs_file_pwrite(sink->file, (char *)buf + done, len - done, *sink->offset);
+            if (ret > 0)
+            {
+                *sink->offset += ret;
+            }
+        }
+        else
+        {
+            ret = dfs_file_write(sink->file, (char *)buf + done, len - done);
+        }
+
+        if (ret <= 0)
+        {
+            sink->left += len - done;
+            return done ? done : (ret ? ret : -EIO);
+        }
+        done += ret;
     }
 
-    if (!lwp_user_accessable((void *)buf, size))
+    return done;
+}
+
+/* move len bytes from in_fd to out_fd without a copy to user space */
+static ssize_t _splice_file(int in_fd, off_t *in_off, int out_fd, off_t *out_off,
+                            size_t len, rt_bool_t more)
+{
+    struct splice_sink sink;
+    struct dfs_file *in;
+
+    in = fd_get(in_fd);
+    sink.file = fd_get(out_fd);
+    if (!in || !in->vnode || !sink.file || !sink.file->vnode)
+    {
+        return -EBADF;
+    }
+    if (!(dfs_fflags(sink.file->flags) & DFS_F_FWRITE))
+    {
+        return -EBADF;
+    }
+
+    sink.fd = out_fd;
+    sink.offset = out_off;
+    sink.left = len;
+    sink.more = more;
+
+    return dfs_file_splice_read(in, len, in_off, _splice_sink_write, &sink);
+}
+
+static int _splice_off_get(int fd, off_t *uoff, off_t *koff)
+{
+    struct dfs_file *file = fd_get(fd);
+
+    if (!file || !file->vnode)
+    {
+        return -EBADF;
+    }
+    if (file->vnode->type != FT_REGULAR)
+    {
+        return -ESPIPE;
+    }
+    if (!lwp_user_accessable(uoff, sizeof(*uoff)) ||
+        lwp_get_from_user(koff, uoff, sizeof(*koff)) != sizeof(*koff))
     {
         return -EFAULT;
     }
-    kmem = kmem_get(size);
-    if (!kmem)
+    if (*koff < 0)
     {
-        return -ENOMEM;
+        return -EINVAL;
     }
 
-    lwp_get_from_user(kmem, (void *)buf, size);
+    return 0;
+}
+#endif /* RT_USING_DFS_V2 */
 
-    ret = pwrite(fd, kmem, size, offset);
-    if (ret < 0)
+/* syscall: "sendfile" ret: "ssize_t" args: "int" "int" "off_t *" "size_t" */
+ssize_t sys_sendfile(int out_fd, int in_fd, off_t *offset, size_t count)
+{
+#ifdef RT_USING_DFS_V2
+    off_t koff;
+    ssize_t ret;
+
+    if (offset)
     {
-        ret = GET_ERRNO();
+        ret = _splice_off_get(in_fd, offset, &koff);
+        if (ret)
+        {
+            return ret;
+        }
     }
 
-    kmem_put(kmem);
+    ret = _splice_file(in_fd, offset ? &koff : RT_NULL, out_fd, RT_NULL, count, RT_FALSE);
+
+    if (offset && ret >= 0)
+    {
+        lwp_put_to_user(offset, &koff, sizeof(koff));
+    }
 
     return ret;
 #else
-    if (!lwp_user_accessable((void *)buf, size))
+    return -ENOSYS;
+#endif
+}
+
+/* syscall: "splice" ret: "ssize_t" args: "int" "off_t *" "int" "off_t *" "size_t" "unsigned int" */
+ssize_t sys_splice(int fd_in, off_t *off_in, int fd_out, off_t *off_out, size_t len, unsigned int flags)
+{
+#ifdef RT_USING_DFS_V2
+    off_t kin, kout;
+    ssize_t ret;
+
+    if (flags & ~(SPLICE_F_MOVE | SPLICE_F_NONBLOCK | SPLICE_F_MORE | SPLICE_F_GIFT))
     {
-        return -EFAULT;
+        return -EINVAL;
     }
 
-    ssize_t ret = pwrite(fd, kmem, size, offset);
-    return (ret < 0 ? GET_ERRNO() : ret);
+    if (off_in && (ret = _splice_off_get(fd_in, off_in, &kin)))
+    {
+        return ret;
+    }
+    if (off_out && (ret = _splice_off_get(fd_out, off_out, &kout)))
+    {
+        return ret;
+    }
+
+    ret = _splice_file(fd_in, off_in ? &kin : RT_NULL, fd_out, off_out ? &kout : RT_NULL,
+                       len, !!(flags & SPLICE_F_MORE));
+
+    if (ret >= 0)
+    {
+        if (off_in)
+        {
+            lwp_put_to_user(off_in, &kin, sizeof(kin));
+        }
+        if (off_out)
+        {
+            lwp_put_to_user(off_out, &kout, sizeof(kout));
+        }
+    }
+
+    return ret;
+#else
+    return -ENOSYS;
 #endif
 }
-#else
+
+/* syscall: "copy_file_range" ret: "ssize_t" args: "int" "off_t *" "int" "off_t *" "size_t" "unsigned int" */
+ssize_t sys_copy_file_range(int fd_in, off_t *off_in, int fd_out, off_t *off_out, size_t len, unsigned int flags)
 {
-    ssize_t ret = -ENOSYS;
-    return (ret < 0 ? GET_ERRNO() : ret);
-}
+#ifdef RT_USING_DFS_V2
+    struct dfs_file *in, *out;
+    off_t kin, kout;
+    ssize_t ret;
+
+    if (flags)
+    {
+        return -EINVAL;
+    }
+
+    in = fd_get(fd_in);
+    out = fd_get(fd_out);
+    if (!in || !in->vnode || !out || !out->vnode)
+    {
+        return -EBADF;
+    }
+    if (in->vnode->type != FT_REGULAR || out->vnode->type != FT_REGULAR)
+    {
+        return -EINVAL;
+    }
+    if (out->flags & O_APPEND)
+    {
+        return -EBADF;
+    }
+
+    if (off_in && (ret = _splice_off_get(fd_in, off_in, &kin)))
+    {
+        return ret;
+    }
+    if (off_out && (ret = _splice_off_get(fd_out, off_out, &kout)))
+    {
+        return ret;
+    }
+
+    /* an overlapping copy inside one file would read back its own output */
+    if (in->vnode == out->vnode)
+    {
+        off_t in_pos = off_in ? kin : in->fpos;
+        off_t out_pos = off_out ? kout : out->fpos;
+
+        if (in_pos < out_pos + (off_t)len && out_pos < in_pos + (off_t)len)
+        {
+            return -EINVAL;
+        }
+    }
+
+    ret = _splice_file(fd_in, off_in ? &kin : RT_NULL, fd_out, off_out ? &kout : RT_NULL,
+                       len, RT_FALSE);
+
+    if (ret >= 0)
+    {
+        if (off_in)
+        {
+            lwp_put_to_user(off_in, &kin, sizeof(kin));
+        }
+        if (off_out)
+        {
+            lwp_put_to_user(off_out, &kout, sizeof(kout));
+        }
+    }
+
+    return ret;
+#else
+    return -ENOSYS;
 #endif
+}
 
 sysret_t sys_timerfd_create(int clockid, int flags)
 {
@@ -6748,6 +7175,18 @@ const static struct rt_syscall_def func_table[] =
     SYSCALL_SIGN(sys_getppid),
     SYSCALL_SIGN(sys_fchdir),
     SYSCALL_SIGN(sys_chown),
+#ifdef LWP_USING_URING
+    SYSCALL_SIGN(sys_io_uring_setup),                   /* 215 */
+    SYSCALL_SIGN(sys_io_uring_enter),
+#else
+    SYSCALL_SIGN(sys_notimpl),                          /* 215 */
+    SYSCALL_SIGN(sys_notimpl),
+#endif /* LWP_USING_URING */
+    SYSCALL_SIGN(sys_readv),
+    SYSCALL_SIGN(sys_writev),
+    SYSCALL_SIGN(sys_sendfile),
+    SYSCALL_SIGN(sys_splice),                           /* 220 */
+    SYSCALL_SIGN(sys_copy_file_range),
 };
 
 const void *lwp_get_sys_api(rt_uint32_t number)
@@ -6,6 +6,9 @@
  * Change Logs:
  * Date           Author       Notes
  * 2019-11-12     Jesven       the first version
+ * 2026-10-17     agent        add io_uring syscalls
+ * 2026-10-17     agent        add readv and writev syscalls
+ * 2026-10-17     agent        add sendfile, splice and copy_file_range syscalls
  */
 
 #ifndef __LWP_SYSCALL_H__
@@ -27,6 +30,7 @@
 #include <poll.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -51,6 +55,11 @@ sysret_t sys_exit(int value);
 sysret_t sys_exit_group(int status);
 ssize_t sys_read(int fd, void *buf, size_t nbyte);
 ssize_t sys_write(int fd, const void *buf, size_t nbyte);
+ssize_t sys_readv(int fd, const struct iovec *iov, int iovcnt);
+ssize_t sys_writev(int fd, const struct iovec *iov, int iovcnt);
+ssize_t sys_sendfile(int out_fd, int in_fd, off_t *offset, size_t count);
+ssize_t sys_splice(int fd_in, off_t *off_in, int fd_out, off_t *off_out, size_t len, unsigned int flags);
+ssize_t sys_copy_file_range(int fd_in, off_t *off_in, int fd_out, off_t *off_out, size_t len, unsigned int flags);
 size_t sys_lseek(int fd, size_t offset, int whence);
 sysret_t sys_open(const char *name, int mode, ...);
 sysret_t sys_close(int fd);
@@ -115,6 +124,13 @@ sysret_t sys_getsid(pid_t pid);
 sysret_t sys_setpgid(pid_t pid, pid_t pgid);
 sysret_t sys_getpgid(pid_t pid);
 
+#ifdef LWP_USING_URING
+struct lwp_uring_params;
+sysret_t sys_io_uring_setup(rt_uint32_t entries, struct lwp_uring_params *params);
+sysret_t sys_io_uring_enter(int fd, rt_uint32_t to_submit, rt_uint32_t min_complete,
+        rt_uint32_t flags);
+#endif /* LWP_USING_URING */
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,1058 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ * 2026-10-17     agent        non-blocking accept, keep the CQEs overflowing the CQ
+ */
+#include <rthw.h>
+#include <rtthread.h>
+
+#ifdef LWP_USING_URING
+#include <lwp.h>
+#include <lwp_user_mm.h>
+#include <lwp_uring.h>
+#include <mm_page.h>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <dfs.h>
+#include <dfs_file.h>
+
+#ifdef RT_USING_SAL
+#include <dfs_net.h>
+#include <sal_socket.h>
+#include <sys/socket.h>
+#endif
+
+#include "lwp_internal.h"
+#include "lwp_sys_socket.h"
+#include "syscall_generic.h"
+
+#define DBG_TAG    "lwp.uring"
+#define DBG_LVL    DBG_INFO
+#include <rtdbg.h>
+
+#define URING_POLL_NODES        2
+#define URING_IO_MAX            (64 * 1024)     /* bytes bounced per request */
+#define URING_WORKER_STACK      8192
+#define URING_WORKER_PRIORITY   (RT_THREAD_PRIORITY_MAX / 2)
+
+#define URING_READ_ONCE(x)      (*(volatile rt_uint32_t *)&(x))
+#define URING_WRITE_ONCE(x, v)  (*(volatile rt_uint32_t *)&(x) = (v))
+
+/* the poll arming state of a request */
+#define URING_REQ_IDLE          0
+#define URING_REQ_ARMING        1
+#define URING_REQ_ARMED         2
+#define URING_REQ_PENDING       3   /* woken up while arming */
+
+struct lwp_uring_req;
+
+/* a CQE waiting for room in the CQ */
+struct lwp_uring_ocqe
+{
+    rt_list_t node;
+    struct lwp_uring_cqe cqe;
+};
+
+struct lwp_uring_poll_node
+{
+    struct rt_wqueue_node wqn;
+    struct lwp_uring_req *req;
+};
+
+struct lwp_uring_req
+{
+    rt_list_t list;                 /* in the worker queue */
+    rt_list_t armed_node;           /* in the armed list of the ring */
+    struct lwp_uring *ring;
+    struct lwp_uring_sqe sqe;
+    struct dfs_file *file;
+    rt_bool_t cancelled;
+
+    rt_atomic_t state;
+    rt_pollreq_t pollreq;
+    int nr_nodes;
+    struct lwp_uring_poll_node nodes[URING_POLL_NODES];
+};
+
+struct lwp_uring
+{
+    /* the file and every request in flight hold a reference */
+    rt_atomic_t ref;
+    struct rt_lwp *lwp;
+
+    void *pages;
+    rt_uint32_t page_bits;
+    void *uaddr;
+    rt_size_t size;
+
+    struct lwp_uring_rings *rings;
+    struct lwp_uring_sqe *sqes;
+    struct lwp_uring_cqe *cqes;
+
+    /* private copies, the shared ones may be scribbled by the user */
+    rt_uint32_t sq_head;
+    rt_uint32_t sq_entries;
+    rt_uint32_t cq_tail;
+    rt_uint32_t cq_entries;
+
+    struct rt_mutex sq_lock;
+    struct rt_spinlock lock;        /* the CQ, overflow list, armed list and closing */
+    rt_list_t overflow_list;
+    rt_list_t armed_list;
+    rt_bool_t closing;
+    rt_wqueue_t cq_wait;
+};
+
+static struct
+{
+    struct rt_spinlock lock;
+    rt_list_t queue;
+    struct rt_semaphore sem;
+    struct rt_mutex accept_lock;
+} _uring_pool;
+
+static int _uring_close(struct dfs_file *file);
+static int _uring_poll(struct dfs_file *file, struct rt_pollreq *req);
+
+static const struct dfs_file_ops _uring_fops =
+{
+    .close      = _uring_close,
+    .poll       = _uring_poll,
+};
+
+static void _uring_put(struct lwp_uring *ring)
+{
+    struct lwp_uring_ocqe *ocqe, *tmp;
+
+    if (rt_atomic_add(&ring->ref, -1) != 1)
+    {
+        return;
+    }
+
+    rt_list_for_each_entry_safe(ocqe, tmp, &ring->overflow_list, node)
+    {
+        rt_free(ocqe);
+    }
+
+    /* the user may have replaced the mapping by now */
+    if (lwp_v2p(ring->lwp, ring->uaddr) == (char *)ring->pages + PV_OFFSET)
+    {
+        lwp_unmap_user_phy(ring->lwp, ring->uaddr);
+    }
+
+    rt_pages_free(ring->pages, ring->page_bits);
+    lwp_ref_dec(ring->lwp);
+    rt_mutex_detach(&ring->sq_lock);
+    rt_free(ring);
+}
+
+static rt_uint32_t _uring_cq_ready(struct lwp_uring *ring)
+{
+    return ring->cq_tail - URING_READ_ONCE(ring->rings->cq_head);
+}
+
+static void _uring_cq_fill(struct lwp_uring *ring, rt_uint64_t user_data, rt_int32_t res)
+{
+    struct lwp_uring_cqe *cqe;
+
+    cqe = &ring->cqes[ring->cq_tail & (ring->cq_entries - 1)];
+    cqe->user_data = user_data;
+    cqe->res = res;
+    cqe->flags = 0;
+
+    /* the CQE must be visible before the tail */
+    rt_hw_dmb();
+    URING_WRITE_ONCE(ring->rings->cq_tail, ++ring->cq_tail);
+}
+
+/*
+ * A CQE is never dropped if the CQ is full. It's kept on the overflow list,
+ * and moved to the CQ by _uring_cq_flush() in order once the user has reaped
+ * some. Only if there is no memory for it, it's lost and counted in
+ * cq_overflow.
+ */
+static void _uring_post(struct lwp_uring *ring, rt_uint64_t user_data, rt_int32_t res)
+{
+    rt_base_t level;
+    rt_bool_t posted = RT_FALSE;
+    struct lwp_uring_ocqe *ocqe = RT_NULL;
+
+    while (!posted)
+    {
+        level = rt_spin_lock_irqsave(&ring->lock);
+
+        if (rt_list_isempty(&ring->overflow_list) && _uring_cq_ready(ring) < ring->cq_entries)
+        {
+            _uring_cq_fill(ring, user_data, res);
+            posted = RT_TRUE;
+        }
+        else if (ocqe)
+        {
+            ocqe->cqe.user_data = user_data;
+            ocqe->cqe.res = res;
+            ocqe->cqe.flags = 0;
+            rt_list_insert_before(&ring->overflow_list, &ocqe->node);
+            ocqe = RT_NULL;
+            posted = RT_TRUE;
+        }
+
+        rt_spin_unlock_irqrestore(&ring->lock, level);
+
+        if (!posted && !(ocqe = rt_malloc(sizeof(*ocqe))))
+        {
+            level = rt_spin_lock_irqsave(&ring->lock);
+            URING_WRITE_ONCE(ring->rings->cq_overflow, ring->rings->cq_overflow + 1);
+            rt_spin_unlock_irqrestore(&ring->lock, level);
+
+            LOG_W("%s: CQE of 0x%llx lost", __func__, (unsigned long long)user_data);
+            break;
+        }
+    }
+
+    if (ocqe)
+    {
+        /* the CQ had room again */
+        rt_free(ocqe);
+    }
+
+    rt_wqueue_wakeup_all(&ring->cq_wait, (void *)POLLIN);
+}
+
+/* move the overflowed CQEs to the CQ as many as fit, return if any is left */
+static rt_bool_t _uring_cq_flush(struct lwp_uring *ring)
+{
+    rt_base_t level;
+    rt_bool_t left;
+    rt_list_t flushed;
+    struct lwp_uring_ocqe *ocqe, *tmp;
+
+    rt_list_init(&flushed);
+
+    level = rt_spin_lock_irqsave(&ring->lock);
+    while (!rt_list_isempty(&ring->overflow_list) && _uring_cq_ready(ring) < ring->cq_entries)
+    {
+        ocqe = rt_list_first_entry(&ring->overflow_list, struct lwp_uring_ocqe, node);
+        rt_list_remove(&ocqe->node);
+
+        _uring_cq_fill(ring, ocqe->cqe.user_data, ocqe->cqe.res);
+        rt_list_insert_before(&flushed, &ocqe->node);
+    }
+    left = !rt_list_isempty(&ring->overflow_list);
+    rt_spin_unlock_irqrestore(&ring->lock, level);
+
+    rt_list_for_each_entry_safe(ocqe, tmp, &flushed, node)
+    {
+        rt_free(ocqe);
+    }
+
+    return left;
+}
+
+static void _uring_queue(struct lwp_uring_req *req)
+{
+    rt_base_t level;
+
+    level = rt_spin_lock_irqsave(&_uring_pool.lock);
+    rt_list_insert_before(&_uring_pool.queue, &req->list);
+    rt_spin_unlock_irqrestore(&_uring_pool.lock, level);
+
+    rt_sem_release(&_uring_pool.sem);
+}
+
+static void _uring_req_fire(struct lwp_uring_req *req)
+{
+    rt_atomic_t next, state = rt_atomic_load(&req->state);
+
+    while (state == URING_REQ_ARMED || state == URING_REQ_ARMING)
+    {
+        /* the arming side dispatches the request by itself */
+        next = state == URING_REQ_ARMED ? URING_REQ_IDLE : URING_REQ_PENDING;
+
+        if (rt_atomic_compare_exchange_strong(&req->state, &state, next))
+        {
+            if (next == URING_REQ_IDLE)
+            {
+                _uring_queue(req);
+            }
+            break;
+        }
+    }
+}
+
+static int _uring_poll_wake(struct rt_wqueue_node *wait, void *key)
+{
+    struct lwp_uring_poll_node *node;
+
+    if (key && !((rt_ubase_t)key & wait->key))
+    {
+        return -1;
+    }
+
+    node = rt_container_of(wait, struct lwp_uring_poll_node, wqn);
+    _uring_req_fire(node->req);
+
+    /* never resume any thread, the node is removed by the worker */
+    return -1;
+}
+
+static void _uring_poll_proc(rt_wqueue_t *wq, rt_pollreq_t *pollreq)
+{
+    struct lwp_uring_poll_node *node;
+    struct lwp_uring_req *req = rt_container_of(pollreq, struct lwp_uring_req, pollreq);
+
+    if (req->nr_nodes >= URING_POLL_NODES)
+    {
+        LOG_W("%s: too many wait queues", __func__);
+        return;
+    }
+
+    node = &req->nodes[req->nr_nodes++];
+    node->req = req;
+    node->wqn.polling_thread = RT_NULL;
+    node->wqn.wakeup = _uring_poll_wake;
+    node->wqn.key = pollreq->_key;
+    rt_list_init(&node->wqn.list);
+
+    rt_wqueue_add(wq, &node->wqn);
+}
+
+static short _uring_req_pollmask(struct lwp_uring_req *req)
+{
+    struct dfs_file *file = req->file;
+
+    if (!file->fops || !file->fops->poll)
+    {
+        return 0;
+    }
+
+    switch (req->sqe.opcode)
+    {
+    case LWP_URING_OP_POLL_ADD:
+        return (short)req->sqe.op_flags;
+
+    case LWP_URING_OP_ACCEPT:
+    case LWP_URING_OP_RECV:
+        return POLLIN;
+
+    case LWP_URING_OP_SEND:
+        return POLLOUT;
+
+    case LWP_URING_OP_READ:
+    case LWP_URING_OP_WRITE:
+        /* only the stream files may block the worker */
+        if (file->vnode->type != FT_REGULAR && file->vnode->type != FT_DIRECTORY)
+        {
+            return req->sqe.opcode == LWP_URING_OP_READ ? POLLIN : POLLOUT;
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    return 0;
+}
+
+static void _uring_req_arm(struct lwp_uring_req *req, short mask)
+{
+    int events;
+    rt_base_t level;
+    rt_atomic_t state;
+    struct lwp_uring *ring = req->ring;
+
+    req->nr_nodes = 0;
+    req->pollreq._proc = _uring_poll_proc;
+    req->pollreq._key = mask | POLLERR | POLLHUP;
+
+    level = rt_spin_lock_irqsave(&ring->lock);
+    if (ring->closing)
+    {
+        rt_spin_unlock_irqrestore(&ring->lock, level);
+
+        req->cancelled = RT_TRUE;
+        _uring_queue(req);
+        return;
+    }
+    rt_atomic_store(&req->state, URING_REQ_ARMING);
+    rt_list_insert_before(&ring->armed_list, &req->armed_node);
+    rt_spin_unlock_irqrestore(&ring->lock, level);
+
+    events = req->file->fops->poll(req->file, &req->pollreq);
+
+    state = URING_REQ_ARMING;
+    if (!(events & req->pollreq._key) &&
+        rt_atomic_compare_exchange_strong(&req->state, &state, URING_REQ_ARMED))
+    {
+        return;
+    }
+
+    /* ready already, or woken up while arming */
+    rt_atomic_store(&req->state, URING_REQ_IDLE);
+    _uring_queue(req);
+}
+
+static void _uring_req_disarm(struct lwp_uring_req *req)
+{
+    rt_base_t level;
+    struct lwp_uring *ring = req->ring;
+
+    level = rt_spin_lock_irqsave(&ring->lock);
+    rt_list_remove(&req->armed_node);
+    rt_spin_unlock_irqrestore(&ring->lock, level);
+
+    for (int i = 0; i < req->nr_nodes; ++i)
+    {
+        rt_wqueue_remove(&req->nodes[i].wqn);
+    }
+    req->nr_nodes = 0;
+}
+
+static void _uring_req_complete(struct lwp_uring_req *req, rt_ssize_t res)
+{
+    struct lwp_uring *ring = req->ring;
+
+    _uring_post(ring, req->sqe.user_data, (rt_int32_t)res);
+
+    dfs_file_put(req->file);
+    rt_free(req);
+
+    _uring_put(ring);
+}
+
+static rt_ssize_t _uring_do_rw(struct lwp_uring_req *req)
+{
+    void *kbuf;
+    rt_ssize_t res;
+    struct lwp_uring_sqe *sqe = &req->sqe;
+    struct rt_lwp *lwp = req->ring->lwp;
+    void *ubuf = (void *)(rt_ubase_t)sqe->addr;
+    rt_size_t len = sqe->len > URING_IO_MAX ? URING_IO_MAX : sqe->len;
+
+    if (!len)
+    {
+        return 0;
+    }
+
+    if (!(kbuf = rt_malloc(len)))
+    {
+        return -ENOMEM;
+    }
+
+    if (sqe->opcode == LWP_URING_OP_WRITE)
+    {
+        if (lwp_data_get(lwp, kbuf, ubuf, len) != len)
+        {
+            res = -EFAULT;
+        }
+        else if (sqe->off == (rt_uint64_t)-1)
+        {
+            res = dfs_file_write(req->file, kbuf, len);
+        }
+        else
+        {
+            res = dfs_file_pwrite(req->file, kbuf, len, (off_t)sqe->off);
+        }
+    }
+    else
+    {
+        if (sqe->off == (rt_uint64_t)-1)
+        {
+            res = dfs_file_read(req->file, kbuf, len);
+        }
+        else
+        {
+            res = dfs_file_pread(req->file, kbuf, len, (off_t)sqe->off);
+        }
+
+        if (res > 0 && lwp_data_put(lwp, ubuf, kbuf, res) != res)
+        {
+            res = -EFAULT;
+        }
+    }
+
+    rt_free(kbuf);
+
+    return res;
+}
+
+#ifdef RT_USING_SAL
+static rt_ssize_t _uring_do_sendrecv(struct lwp_uring_req *req)
+{
+    int sock, flags;
+    void *kbuf;
+    rt_ssize_t res;
+    struct lwp_uring_sqe *sqe = &req->sqe;
+    struct rt_lwp *lwp = req->ring->lwp;
+    void *ubuf = (void *)(rt_ubase_t)sqe->addr;
+    rt_size_t len = sqe->len > URING_IO_MAX ? URING_IO_MAX : sqe->len;
+
+    if (req->file->vnode->type != FT_SOCKET)
+    {
+        return -ENOTSOCK;
+    }
+
+    if (!(kbuf = rt_malloc(len ? len : 1)))
+    {
+        return -ENOMEM;
+    }
+
+    sock = (int)(rt_ubase_t)req->file->vnode->data;
+    /* the worker never sleeps in the socket, it is re-armed on EAGAIN */
+    flags = netflags_muslc_2_lwip(sqe->op_flags) | MSG_DONTWAIT;
+
+    if (sqe->opcode == LWP_URING_OP_SEND)
+    {
+        if (lwp_data_get(lwp, kbuf, ubuf, len) != len)
+        {
+            res = -EFAULT;
+        }
+        else if ((res = sal_sendto(sock, kbuf, len, flags, RT_NULL, 0)) < 0)
+        {
+            res = GET_ERRNO();
+        }
+    }
+    else
+    {
+        if ((res = sal_recvfrom(sock, kbuf, len, flags, RT_NULL, RT_NULL)) < 0)
+        {
+            res = GET_ERRNO();
+        }
+        else if (res > 0 && lwp_data_put(lwp, ubuf, kbuf, res) != res)
+        {
+            res = -EFAULT;
+        }
+    }
+
+    rt_free(kbuf);
+
+    return res;
+}
+
+static rt_ssize_t _uring_do_accept(struct lwp_uring_req *req)
+{
+    int lsock, sock, fd, flags;
+    rt_ssize_t err = 0;
+    struct dfs_file *df;
+    struct dfs_fdtable *fdt = &req->ring->lwp->fdt;
+
+    if (req->file->vnode->type != FT_SOCKET)
+    {
+        return -ENOTSOCK;
+    }
+
+    lsock = (int)(rt_ubase_t)req->file->vnode->data;
+
+    /**
+     * The worker never sleeps in the socket, it is re-armed on EAGAIN. There
+     * is no accept flag of non-blocking, the listening socket is switched to
+     * non-blocking meanwhile. The workers are serialized here, so the one
+     * restoring the flags never sees the ones switched by another worker.
+     */
+    rt_mutex_take(&_uring_pool.accept_lock, RT_WAITING_FOREVER);
+
+    flags = sal_ioctlsocket(lsock, F_GETFL, RT_NULL);
+    if (flags >= 0 && !(flags & O_NONBLOCK))
+    {
+        sal_ioctlsocket(lsock, F_SETFL, (void *)(rt_ubase_t)(flags | O_NONBLOCK));
+    }
+
+    sock = sal_accept(lsock, RT_NULL, RT_NULL);
+    if (sock < 0)
+    {
+        err = GET_ERRNO();
+    }
+
+    if (flags >= 0 && !(flags & O_NONBLOCK))
+    {
+        sal_ioctlsocket(lsock, F_SETFL, (void *)(rt_ubase_t)flags);
+    }
+
+    rt_mutex_release(&_uring_pool.accept_lock);
+
+    if (sock < 0)
+    {
+        return err == -EWOULDBLOCK ? -EAGAIN : err;
+    }
+
+    /* the new fd belongs to the ring owner, not to the worker */
+    fd = fdt_fd_new(fdt);
+    if (fd < 0)
+    {
+        sal_closesocket(sock);
+        return -EMFILE;
+    }
+
+    df = fdt_get_file(fdt, fd);
+    df->fops = dfs_net_get_fops();
+    df->vnode = (struct dfs_vnode *)rt_malloc(sizeof(struct dfs_vnode));
+    if (!df->vnode)
+    {
+        fdt_fd_release(fdt, fd);
+        sal_closesocket(sock);
+        return -ENOMEM;
+    }
+
+    dfs_vnode_init(df->vnode, FT_SOCKET, dfs_net_get_fops());
+    df->flags = O_RDWR;
+    df->vnode->data = (void *)(rt_ubase_t)sock;
+
+    return fd;
+}
+#endif /* RT_USING_SAL */
+
+static rt_ssize_t _uring_req_exec(struct lwp_uring_req *req)
+{
+    if (req->cancelled)
+    {
+        return -ECANCELED;
+    }
+
+    switch (req->sqe.opcode)
+    {
+    case LWP_URING_OP_READ:
+    case LWP_URING_OP_WRITE:
+        return _uring_do_rw(req);
+
+    case LWP_URING_OP_FSYNC:
+        return dfs_file_fsync(req->file);
+
+    case LWP_URING_OP_POLL_ADD:
+    {
+        rt_pollreq_t query = { RT_NULL, 0 };
+        short mask = (short)req->sqe.op_flags | POLLERR | POLLHUP;
+
+        /* the files without poll are always ready */
+        if (!req->file->fops || !req->file->fops->poll)
+        {
+            return mask & (POLLIN | POLLOUT);
+        }
+
+        return req->file->fops->poll(req->file, &query) & mask;
+    }
+
+#ifdef RT_USING_SAL
+    case LWP_URING_OP_SEND:
+    case LWP_URING_OP_RECV:
+        return _uring_do_sendrecv(req);
+
+    case LWP_URING_OP_ACCEPT:
+        return _uring_do_accept(req);
+#endif /* RT_USING_SAL */
+
+    default:
+        break;
+    }
+
+    return -EINVAL;
+}
+
+static void _uring_req_run(struct lwp_uring_req *req)
+{
+    short mask;
+    rt_ssize_t res;
+
+    _uring_req_disarm(req);
+
+    res = _uring_req_exec(req);
+
+    /* a spurious wakeup, wait for the next one */
+    if ((res == -EAGAIN || (req->sqe.opcode == LWP_URING_OP_POLL_ADD && res == 0)) &&
+        (mask = _uring_req_pollmask(req)))
+    {
+        _uring_req_arm(req, mask);
+        return;
+    }
+
+    _uring_req_complete(req, res);
+}
+
+static void _uring_worker_entry(void *param)
+{
+    rt_base_t level;
+    struct lwp_uring_req *req;
+
+    for (;;)
+    {
+        rt_sem_take(&_uring_pool.sem, RT_WAITING_FOREVER);
+
+        level = rt_spin_lock_irqsave(&_uring_pool.lock);
+        req = rt_list_first_entry(&_uring_pool.queue, struct lwp_uring_req, list);
+        rt_list_remove(&req->list);
+        rt_spin_unlock_irqrestore(&_uring_pool.lock, level);
+
+        _uring_req_run(req);
+    }
+}
+
+static rt_bool_t _uring_op_has_buffer(rt_uint8_t opcode)
+{
+    return opcode == LWP_URING_OP_READ || opcode == LWP_URING_OP_WRITE ||
+           opcode == LWP_URING_OP_SEND || opcode == LWP_URING_OP_RECV;
+}
+
+static void _uring_submit_sqe(struct lwp_uring *ring, struct lwp_uring_sqe *sqe)
+{
+    short mask;
+    int err = 0;
+    struct dfs_file *file = RT_NULL;
+    struct lwp_uring_req *req = RT_NULL;
+
+    if (sqe->opcode == LWP_URING_OP_NOP)
+    {
+        _uring_post(ring, sqe->user_data, 0);
+        return;
+    }
+
+    /* the fd and the buffer are resolved in the submitter context */
+    if (sqe->opcode >= LWP_URING_OP_LAST)
+    {
+        err = -EINVAL;
+    }
+    else if (!(file = fd_get(sqe->fd)) || !file->vnode)
+    {
+        err = -EBADF;
+    }
+    else if (file->fops == &_uring_fops)
+    {
+        err = -EINVAL;
+    }
+    else if (_uring_op_has_buffer(sqe->opcode) && sqe->len &&
+            !lwp_user_accessible_ext(ring->lwp, (void *)(rt_ubase_t)sqe->addr, sqe->len))
+    {
+        err = -EFAULT;
+    }
+    else if (!(req = rt_calloc(1, sizeof(*req))))
+    {
+        err = -ENOMEM;
+    }
+
+    if (err)
+    {
+        _uring_post(ring, sqe->user_data, err);
+        return;
+    }
+
+    rt_list_init(&req->list);
+    rt_list_init(&req->armed_node);
+    rt_memcpy(&req->sqe, sqe, sizeof(*sqe));
+    req->ring = ring;
+    req->file = file;
+
+    dfs_file_get(file);
+    rt_atomic_add(&ring->ref, 1);
+
+    if ((mask = _uring_req_pollmask(req)))
+    {
+        _uring_req_arm(req, mask);
+    }
+    else
+    {
+        _uring_queue(req);
+    }
+}
+
+static rt_uint32_t _uring_submit(struct lwp_uring *ring, rt_uint32_t to_submit)
+{
+    rt_uint32_t nr;
+    struct lwp_uring_sqe sqe;
+
+    rt_mutex_take(&ring->sq_lock, RT_WAITING_FOREVER);
+
+    nr = URING_READ_ONCE(ring->rings->sq_tail) - ring->sq_head;
+    /* read the SQEs after the tail */
+    rt_hw_dmb();
+
+    if (nr > ring->sq_entries)
+    {
+        nr = ring->sq_entries;
+    }
+    if (nr > to_submit)
+    {
+        nr = to_submit;
+    }
+
+    for (rt_uint32_t i = 0; i < nr; ++i)
+    {
+        rt_memcpy(&sqe, &ring->sqes[ring->sq_head++ & (ring->sq_entries - 1)], sizeof(sqe));
+        _uring_submit_sqe(ring, &sqe);
+    }
+
+    URING_WRITE_ONCE(ring->rings->sq_head, ring->sq_head);
+
+    rt_mutex_release(&ring->sq_lock);
+
+    return nr;
+}
+
+static int _uring_close(struct dfs_file *file)
+{
+    rt_base_t level;
+    struct lwp_uring_req *req;
+    struct lwp_uring *ring = file->vnode->data;
+
+    if (file->vnode->ref_count != 1)
+    {
+        return 0;
+    }
+
+    /* the armed requests complete with -ECANCELED, the running ones finish */
+    level = rt_spin_lock_irqsave(&ring->lock);
+    ring->closing = RT_TRUE;
+    rt_list_for_each_entry(req, &ring->armed_list, armed_node)
+    {
+        req->cancelled = RT_TRUE;
+        _uring_req_fire(req);
+    }
+    rt_spin_unlock_irqrestore(&ring->lock, level);
+
+    _uring_put(ring);
+
+    return 0;
+}
+
+static int _uring_poll(struct dfs_file *file, struct rt_pollreq *req)
+{
+    struct lwp_uring *ring = file->vnode->data;
+
+    rt_poll_add(&ring->cq_wait, req);
+    _uring_cq_flush(ring);
+
+    return _uring_cq_ready(ring) ? POLLIN : 0;
+}
+
+static struct lwp_uring *_uring_create(struct rt_lwp *lwp, rt_uint32_t entries)
+{
+    rt_size_t sq_off, cq_off, size;
+    rt_uint32_t sq_entries = 1, cq_entries;
+    struct lwp_uring *ring;
+
+    while (sq_entries < entries)
+    {
+        sq_entries <<= 1;
+    }
+    cq_entries = sq_entries * 2;
+
+    sq_off = RT_ALIGN(sizeof(struct lwp_uring_rings), RT_CPU_CACHE_LINE_SZ);
+    cq_off = sq_off + sq_entries * sizeof(struct lwp_uring_sqe);
+    size = cq_off + cq_entries * sizeof(struct lwp_uring_cqe);
+
+    if (!(ring = rt_calloc(1, sizeof(*ring))))
+    {
+        return RT_NULL;
+    }
+
+    ring->page_bits = rt_page_bits(size);
+    ring->pages = rt_pages_alloc_ext(ring->page_bits, PAGE_ANY_AVAILABLE);
+    if (!ring->pages)
+    {
+        rt_free(ring);
+        return RT_NULL;
+    }
+    ring->size = ARCH_PAGE_SIZE << ring->page_bits;
+    rt_memset(ring->pages, 0, ring->size);
+
+    ring->uaddr = lwp_map_user_phy(lwp, RT_NULL, (char *)ring->pages + PV_OFFSET,
+            ring->size, RT_TRUE);
+    if (!ring->uaddr)
+    {
+        rt_pages_free(ring->pages, ring->page_bits);
+        rt_free(ring);
+        return RT_NULL;
+    }
+
+    ring->rings = ring->pages;
+    ring->sqes = (void *)((char *)ring->pages + sq_off);
+    ring->cqes = (void *)((char *)ring->pages + cq_off);
+    ring->sq_entries = sq_entries;
+    ring->cq_entries = cq_entries;
+
+    ring->rings->sq_mask = sq_entries - 1;
+    ring->rings->sq_entries = sq_entries;
+    ring->rings->cq_mask = cq_entries - 1;
+    ring->rings->cq_entries = cq_entries;
+
+    rt_atomic_store(&ring->ref, 1);
+    ring->lwp = lwp;
+    lwp_ref_inc(lwp);
+
+    rt_mutex_init(&ring->sq_lock, "uring", RT_IPC_FLAG_PRIO);
+    rt_spin_lock_init(&ring->lock);
+    rt_list_init(&ring->overflow_list);
+    rt_list_init(&ring->armed_list);
+    rt_wqueue_init(&ring->cq_wait);
+
+    return ring;
+}
+
+static struct lwp_uring *_uring_get(int fd)
+{
+    struct lwp_uring *ring;
+    struct dfs_file *file = fd_get(fd);
+
+    if (!file || file->fops != &_uring_fops)
+    {
+        return RT_NULL;
+    }
+
+    ring = file->vnode->data;
+    rt_atomic_add(&ring->ref, 1);
+
+    return ring;
+}
+
+int lwp_uring_setup(struct rt_lwp *lwp, rt_uint32_t entries, struct lwp_uring_params *params)
+{
+    int fd;
+    struct dfs_file *file;
+    struct lwp_uring *ring;
+
+    if (!entries || entries > LWP_URING_MAX_ENTRIES || params->flags)
+    {
+        return -EINVAL;
+    }
+
+    if (!(ring = _uring_create(lwp, entries)))
+    {
+        return -ENOMEM;
+    }
+
+    fd = fd_new();
+    if (fd < 0)
+    {
+        _uring_put(ring);
+        return fd;
+    }
+
+    file = fd_get(fd);
+    file->vnode = (struct dfs_vnode *)rt_malloc(sizeof(struct dfs_vnode));
+    if (!file->vnode)
+    {
+        fd_release(fd);
+        _uring_put(ring);
+        return -ENOMEM;
+    }
+
+    dfs_vnode_init(file->vnode, FT_NONLOCK, &_uring_fops);
+    file->vnode->data = ring;
+    file->flags = O_RDWR;
+    file->fops = &_uring_fops;
+
+    params->sq_entries = ring->sq_entries;
+    params->cq_entries = ring->cq_entries;
+    params->size = ring->size;
+    params->rings = (rt_uint64_t)(rt_ubase_t)ring->uaddr;
+    params->sq_off = (char *)ring->sqes - (char *)ring->pages;
+    params->cq_off = (char *)ring->cqes - (char *)ring->pages;
+
+    return fd;
+}
+
+sysret_t sys_io_uring_setup(rt_uint32_t entries, struct lwp_uring_params *params)
+{
+    int fd;
+    struct lwp_uring_params kparams;
+
+    if (!lwp_user_accessable(params, sizeof(*params)))
+    {
+        return -EFAULT;
+    }
+
+    lwp_get_from_user(&kparams, params, sizeof(kparams));
+
+    fd = lwp_uring_setup(lwp_self(), entries, &kparams);
+    if (fd >= 0)
+    {
+        lwp_put_to_user(params, &kparams, sizeof(kparams));
+    }
+
+    return fd;
+}
+
+sysret_t sys_io_uring_enter(int fd, rt_uint32_t to_submit, rt_uint32_t min_complete,
+        rt_uint32_t flags)
+{
+    sysret_t ret = 0;
+    struct lwp_uring *ring;
+
+    if (flags & ~LWP_URING_ENTER_GETEVENTS)
+    {
+        return -EINVAL;
+    }
+
+    if (!(ring = _uring_get(fd)))
+    {
+        return -EBADF;
+    }
+
+    if (to_submit)
+    {
+        /* no more requests until the overflowed CQEs fit in the CQ */
+        ret = _uring_cq_flush(ring) ? -EBUSY : _uring_submit(ring, to_submit);
+    }
+
+    if (flags & LWP_URING_ENTER_GETEVENTS)
+    {
+        if (min_complete > ring->cq_entries)
+        {
+            min_complete = ring->cq_entries;
+        }
+
+        for (;;)
+        {
+            /* the overflowed CQEs count once they are moved to the CQ */
+            _uring_cq_flush(ring);
+            if (_uring_cq_ready(ring) >= min_complete)
+            {
+                break;
+            }
+
+            if (rt_wqueue_wait_interruptible(&ring->cq_wait, 0, RT_WAITING_FOREVER) == -RT_EINTR)
+            {
+                ret = ret ? ret : -EINTR;
+                break;
+            }
+        }
+    }
+
+    _uring_put(ring);
+
+    return ret;
+}
+
+static int lwp_uring_init(void)
+{
+    rt_thread_t tid;
+    char name[RT_NAME_MAX];
+
+    rt_spin_lock_init(&_uring_pool.lock);
+    rt_list_init(&_uring_pool.queue);
+    rt_sem_init(&_uring_pool.sem, "uring", 0, RT_IPC_FLAG_FIFO);
+    rt_mutex_init(&_uring_pool.accept_lock, "uring", RT_IPC_FLAG_PRIO);
+
+    for (int i = 0; i < LWP_URING_WORKERS; ++i)
+    {
+        rt_snprintf(name, sizeof(name), "uring%d", i);
+
+        tid = rt_thread_create(name, _uring_worker_entry, RT_NULL,
+                URING_WORKER_STACK, URING_WORKER_PRIORITY, 20);
+
+        if (!tid)
+        {
+            LOG_E("Create %s worker fail", name);
+            return -RT_ENOMEM;
+        }
+
+        rt_thread_startup(tid);
+    }
+
+    return 0;
+}
+INIT_COMPONENT_EXPORT(lwp_uring_init);
+
+#endif /* LWP_USING_URING */
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ * 2026-10-17     agent        keep the CQEs overflowing the CQ, add lwp_uring_setup
+ */
+#ifndef __LWP_URING_H__
+#define __LWP_URING_H__
+
+#include <rtdef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Shared memory submission/completion rings.
+ *
+ * sys_io_uring_setup() maps one region into the caller, laid out as
+ * [struct lwp_uring_rings][sqe array][cqe array]. The user fills the SQEs
+ * at sq_tail & sq_mask and advances sq_tail, the kernel consumes them on
+ * sys_io_uring_enter() and advances sq_head. The kernel posts the CQEs at
+ * cq_tail & cq_mask and advances cq_tail, the user reaps them and advances
+ * cq_head without entering the kernel.
+ *
+ * A completion is never dropped because the CQ is full. It's kept by the
+ * kernel and moved to the CQ in order once the user has reaped some, on the
+ * next sys_io_uring_enter() or poll of the ring. While any of them can't be
+ * moved, sys_io_uring_enter() refuses new SQEs with -EBUSY, the user should
+ * reap the CQ and enter again. cq_overflow counts the completions lost only
+ * if the kernel is out of memory to keep them.
+ */
+
+#define LWP_URING_OP_NOP            0
+#define LWP_URING_OP_READ           1   /* off == -1 reads at the file position */
+#define LWP_URING_OP_WRITE          2   /* off == -1 writes at the file position */
+#define LWP_URING_OP_FSYNC          3
+#define LWP_URING_OP_POLL_ADD       4   /* op_flags: POLL* mask, res: ready mask */
+#define LWP_URING_OP_ACCEPT         5   /* res: the new fd */
+#define LWP_URING_OP_SEND           6   /* op_flags: MSG_* flags */
+#define LWP_URING_OP_RECV           7   /* op_flags: MSG_* flags */
+#define LWP_URING_OP_LAST           8
+
+/* sys_io_uring_enter() flags */
+#define LWP_URING_ENTER_GETEVENTS   (1U << 0)
+
+struct lwp_uring_sqe
+{
+    rt_uint8_t  opcode;
+    rt_uint8_t  flags;
+    rt_uint16_t ioprio;
+    rt_int32_t  fd;
+    rt_uint64_t off;
+    rt_uint64_t addr;
+    rt_uint32_t len;
+    rt_uint32_t op_flags;
+    rt_uint64_t user_data;
+    rt_uint64_t resv;
+};
+
+struct lwp_uring_cqe
+{
+    rt_uint64_t user_data;
+    rt_int32_t  res;                /* the result or the negative errno */
+    rt_uint32_t flags;
+};
+
+struct lwp_uring_rings
+{
+    rt_uint32_t sq_head;            /* written by the kernel */
+    rt_uint32_t sq_tail;            /* written by the user */
+    rt_uint32_t sq_mask;
+    rt_uint32_t sq_entries;
+    rt_uint32_t cq_head;            /* written by the user */
+    rt_uint32_t cq_tail;            /* written by the kernel */
+    rt_uint32_t cq_mask;
+    rt_uint32_t cq_entries;
+    rt_uint32_t cq_overflow;        /* CQEs lost, the kernel had no memory to keep them */
+};
+
+struct lwp_uring_params
+{
+    rt_uint32_t sq_entries;         /* out: rounded up to a power of 2 */
+    rt_uint32_t cq_entries;         /* out: twice sq_entries */
+    rt_uint32_t flags;              /* in: reserved, must be 0 */
+    rt_uint32_t size;               /* out: bytes of the mapping */
+    rt_uint64_t rings;              /* out: user address of the mapping */
+    rt_uint32_t sq_off;             /* out: offset of the sqe array */
+    rt_uint32_t cq_off;             /* out: offset of the cqe array */
+};
+
+struct rt_lwp;
+
+/* create a ring owned by lwp on a new fd of the caller, params is in kernel */
+int lwp_uring_setup(struct rt_lwp *lwp, rt_uint32_t entries, struct lwp_uring_params *params);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LWP_URING_H__ */
@@ -15,11 +15,16 @@
  * 2023-08-29     Shell        Add API accessible()/data_get()/data_set()/data_put()
  * 2023-09-13     Shell        Add lwp_memcpy and support run-time choice of memcpy base on memory attr
  * 2023-09-19     Shell        add lwp_user_memory_remap_to_kernel
+ * 2026-10-17     agent        add user buffer iterator lwp_uiter
+ * 2026-10-17     agent        support MAP_POPULATE in lwp_mmap2
+ * 2026-10-17     agent        pin the chunks of lwp_uiter
  */
 
 #include <rtthread.h>
 #include <rthw.h>
 #include <string.h>
+#include <errno.h>
+#include <limits.h>
 
 #ifdef ARCH_MM_MMU
 
@@ -29,6 +34,7 @@
 #include <mm_fault.h>
 #include <mm_flag.h>
 #include <mm_page.h>
+#include <mm_private.h>
 #include <mmu.h>
 #include <page.h>
 
@@ -504,6 +510,35 @@ void *lwp_user_memory_remap_to_kernel(rt_lwp_t lwp, void *uaddr, size_t length)
     return kaddr;
 }
 
+/**
+ * Fault in the pages of a new mapping for MAP_POPULATE. A private writable
+ * mapping is populated by write faults so the copy on write is done here
+ * too. Failures are ignored, the pages are left to the later faults.
+ */
+static void _populate_mmap(rt_aspace_t aspace, void *addr, size_t length, int prot, int flags)
+{
+    struct rt_aspace_fault_msg msg;
+    char *end = (char *)RT_ALIGN((rt_ubase_t)addr + length, ARCH_PAGE_SIZE);
+
+    if ((prot & PROT_WRITE) && !(flags & MAP_SHARED))
+        msg.fault_op = MM_FAULT_OP_WRITE;
+    else
+        msg.fault_op = MM_FAULT_OP_READ;
+    msg.fault_type = MM_FAULT_TYPE_PAGE_FAULT;
+
+    for (char *base = (char *)RT_ALIGN_DOWN((rt_ubase_t)addr, ARCH_PAGE_SIZE); base < end; base += ARCH_PAGE_SIZE)
+    {
+        /* skip the pages mapped by the fault-around of former faults */
+        if (rt_hw_mmu_v2p(aspace, base) != ARCH_MAP_FAILED)
+            continue;
+
+        msg.fault_vaddr = base;
+        msg.off = (long)base >> MM_PAGE_SHIFT;
+        if (!rt_aspace_fault_try_fix(aspace, &msg))
+            break;
+    }
+}
+
 void *lwp_mmap2(struct rt_lwp *lwp, void *addr, size_t length, int prot,
                 int flags, int fd, off_t pgoffset)
 {
@@ -585,6 +620,8 @@ void *lwp_mmap2(struct rt_lwp *lwp, void *addr, size_t length, int prot,
 
     if ((long)ret <= 0)
         LOG_D("%s() => %ld", __func__, ret);
+    else if (flags & MAP_POPULATE)
+        _populate_mmap(lwp->aspace, ret, length, prot, flags);
     return ret;
 }
 
@@ -938,6 +975,227 @@ size_t lwp_data_set(struct rt_lwp *lwp, void *dst, int byte, size_t size)
     return copy_len;
 }
 
+int lwp_uiter_init(struct lwp_uiter *iter, struct rt_lwp *lwp, int dir,
+                   const struct iovec *iov, int nr_segs)
+{
+    size_t count = 0;
+
+    if (!lwp || nr_segs < 0)
+    {
+        return -EINVAL;
+    }
+
+    for (int i = 0; i < nr_segs; i++)
+    {
+        char *base = iov[i].iov_base;
+        size_t len = iov[i].iov_len;
+
+        if (len > (size_t)SSIZE_MAX - count)
+        {
+            return -EINVAL;
+        }
+        count += len;
+
+        if (len && (base < (char *)USER_VADDR_START ||
+                    base + len > (char *)USER_VADDR_TOP ||
+                    base + len < base))
+        {
+            return -EFAULT;
+        }
+    }
+
+    iter->lwp = lwp;
+    iter->iov = iov;
+    iter->nr_segs = nr_segs;
+    iter->dir = dir;
+    iter->iov_offset = 0;
+    iter->count = count;
+    iter->pinned = RT_NULL;
+    iter->nr_pinned = 0;
+
+    return 0;
+}
+
+/**
+ * Make the pages of a user range present with the permission the transfer
+ * needs. Returns the bytes from addr that may be accessed, a page that is
+ * not mapped with the permission ends the range.
+ */
+static size_t _uiter_fault_in(struct rt_lwp *lwp, char *addr, size_t len, int dir)
+{
+    rt_aspace_t aspace = lwp->aspace;
+    struct rt_aspace_fault_msg msg;
+    rt_base_t perm = RT_HW_MMU_PROT_USER;
+    char *page = (char *)((rt_ubase_t)addr & ~ARCH_PAGE_MASK);
+    char *end = addr + len;
+    rt_varea_t varea;
+    rt_size_t attr;
+    rt_bool_t cow;
+
+    perm |= dir == LWP_UITER_TO_USER ? RT_HW_MMU_PROT_WRITE : RT_HW_MMU_PROT_READ;
+
+    for (; page < end; page += ARCH_PAGE_SIZE)
+    {
+        RD_LOCK(aspace);
+        varea = _aspace_bst_search(aspace, page);
+        attr = varea ? varea->attr : 0;
+        cow = varea && dir == LWP_UITER_TO_USER && rt_varea_is_private_locked(varea);
+        RD_UNLOCK(aspace);
+
+        if (!varea || !rt_hw_mmu_attr_test_perm(attr, perm))
+        {
+            break;
+        }
+
+        /**
+         * A present page that is write protected for copy-on-write is
+         * copied here too, the transfer writes it through the kernel
+         * address where no fault resolves it.
+         */
+        if (cow || lwp_v2p(lwp, page) == ARCH_MAP_FAILED)
+        {
+            msg.fault_op = dir == LWP_UITER_TO_USER ? MM_FAULT_OP_WRITE : MM_FAULT_OP_READ;
+            msg.fault_type = MM_FAULT_TYPE_GENERIC_MMU;
+            msg.fault_vaddr = page;
+            if (rt_aspace_fault_try_fix(aspace, &msg) != MM_FAULT_FIXABLE_TRUE)
+            {
+                break;
+            }
+        }
+    }
+
+    if (page <= addr)
+    {
+        return 0;
+    }
+
+    return (size_t)(page - addr) < len ? (size_t)(page - addr) : len;
+}
+
+/**
+ * Pin the frames of anonymous memory from addr, as long as they are
+ * contiguous in the kernel, so they are not freed if the range is unmapped
+ * during the transfer. A page that can't be pinned ends the range. Returns
+ * the bytes pinned from addr.
+ */
+static size_t _uiter_pin(struct lwp_uiter *iter, char *addr, size_t len)
+{
+    rt_aspace_t aspace = iter->lwp->aspace;
+    char *page = (char *)((rt_ubase_t)addr & ~ARCH_PAGE_MASK);
+    char *end = addr + len;
+    char *frame;
+    void *pa;
+    rt_varea_t varea;
+
+    RD_LOCK(aspace);
+    for (; page < end; page += ARCH_PAGE_SIZE)
+    {
+        varea = _aspace_bst_search(aspace, page);
+        if (!varea || !rt_varea_is_anon(varea) ||
+            (iter->dir == LWP_UITER_TO_USER && rt_varea_is_private_locked(varea)))
+        {
+            break;
+        }
+
+        pa = rt_hw_mmu_v2p(aspace, page);
+        if (pa == ARCH_MAP_FAILED || !(frame = rt_kmem_p2v(pa)))
+        {
+            break;
+        }
+
+        if (iter->nr_pinned && frame != iter->pinned + iter->nr_pinned * ARCH_PAGE_SIZE)
+        {
+            break;
+        }
+
+        rt_page_ref_inc(frame, 0);
+        if (!iter->nr_pinned)
+        {
+            iter->pinned = frame;
+        }
+        iter->nr_pinned++;
+    }
+    RD_UNLOCK(aspace);
+
+    if (page <= addr)
+    {
+        return 0;
+    }
+
+    return (size_t)(page - addr) < len ? (size_t)(page - addr) : len;
+}
+
+void lwp_uiter_fini(struct lwp_uiter *iter)
+{
+    for (int i = 0; i < iter->nr_pinned; i++)
+    {
+        rt_pages_free(iter->pinned + i * ARCH_PAGE_SIZE, 0);
+    }
+
+    iter->pinned = RT_NULL;
+    iter->nr_pinned = 0;
+}
+
+ssize_t lwp_uiter_chunk(struct lwp_uiter *iter, size_t max, void **uaddr, void **kaddr)
+{
+    char *base;
+    size_t len, pinned;
+
+    lwp_uiter_fini(iter);
+
+    if (kaddr)
+    {
+        *kaddr = RT_NULL;
+    }
+
+    while (iter->nr_segs && iter->iov_offset == iter->iov->iov_len)
+    {
+        iter->iov++;
+        iter->nr_segs--;
+        iter->iov_offset = 0;
+    }
+
+    if (!iter->nr_segs || !iter->count)
+    {
+        return 0;
+    }
+
+    base = (char *)iter->iov->iov_base + iter->iov_offset;
+    len = iter->iov->iov_len - iter->iov_offset;
+    if (len > max)
+    {
+        len = max;
+    }
+
+    len = _uiter_fault_in(iter->lwp, base, len, iter->dir);
+    if (!len)
+    {
+        return -EFAULT;
+    }
+
+    /* a chunk that can't be pinned from its start is copied by the caller */
+    if (kaddr && (pinned = _uiter_pin(iter, base, len)))
+    {
+        *kaddr = iter->pinned + ((rt_ubase_t)base & ARCH_PAGE_MASK);
+        len = pinned;
+    }
+
+    *uaddr = base;
+
+    return len;
+}
+
+void lwp_uiter_advance(struct lwp_uiter *iter, size_t bytes)
+{
+    RT_ASSERT(iter->nr_segs);
+    RT_ASSERT(bytes <= iter->iov->iov_len - iter->iov_offset);
+
+    lwp_uiter_fini(iter);
+
+    iter->iov_offset += bytes;
+    iter->count -= bytes;
+}
+
 size_t lwp_user_strlen_ext(struct rt_lwp *lwp, const char *s)
 {
     int len = 0;
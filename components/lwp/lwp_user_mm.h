@@ -8,6 +8,8 @@
  * 2019-10-28     Jesven       first version
  * 2021-02-12     lizhirui     add 64-bit support for lwp_brk
  * 2023-09-19     Shell        add lwp_user_memory_remap_to_kernel
+ * 2026-10-17     agent        add user buffer iterator lwp_uiter
+ * 2026-10-17     agent        pin the chunks of lwp_uiter
  */
 #ifndef  __LWP_USER_MM_H__
 #define  __LWP_USER_MM_H__
@@ -21,6 +23,7 @@
 #include <mm_aspace.h>
 #include <mm_fault.h>
 #include <mm_page.h>
+#include <sys/uio.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -145,6 +148,74 @@ size_t lwp_put_to_user(void *dst, void *src, size_t size);
  */
 size_t lwp_data_set(struct rt_lwp *lwp, void *dst, int c, size_t size);
 
+#define LWP_UITER_TO_USER       0   /* data moves into the user buffers */
+#define LWP_UITER_FROM_USER     1   /* data moves out of the user buffers */
+
+/**
+ * @brief iterator over the user buffers of an iovec array
+ *
+ * The file operations fill or drain the user buffers directly, one chunk at
+ * a time, so no kernel bounce buffer of the transfer size is needed. The
+ * pages of a chunk are checked against the permission of their mapping and
+ * faulted in before the chunk is handed out. The frames of anonymous memory
+ * are pinned and accessed through their kernel address, so the chunk stays
+ * valid even if another thread unmaps it. Other chunks must be copied with
+ * the fault tolerant helpers like lwp_data_get()/lwp_data_put().
+ */
+struct lwp_uiter
+{
+    struct rt_lwp *lwp;
+    const struct iovec *iov;    /* kernel copy of the iovec array */
+    int nr_segs;
+    int dir;                    /* LWP_UITER_* */
+    size_t iov_offset;          /* bytes consumed in the current segment */
+    size_t count;               /* bytes left in the iterator */
+    char *pinned;               /* kernel address of the pinned frames */
+    int nr_pinned;              /* frames pinned for the current chunk */
+};
+
+/**
+ * @brief setup an iterator over the user buffers described by iov
+ *
+ * @param iter the iterator
+ * @param lwp target process
+ * @param dir LWP_UITER_TO_USER or LWP_UITER_FROM_USER
+ * @param iov iovec array in kernel space, must stay valid while iterating
+ * @param nr_segs entries of iov
+ * @return int 0 on success, -EINVAL if the total size overflows, -EFAULT if
+ *         a buffer is outside of the user space
+ */
+int lwp_uiter_init(struct lwp_uiter *iter, struct rt_lwp *lwp, int dir,
+                   const struct iovec *iov, int nr_segs);
+
+/**
+ * @brief get the next chunk of user buffer, ready for access
+ *
+ * @param iter the iterator
+ * @param max the maximum bytes of the chunk
+ * @param uaddr the user address of the chunk
+ * @param kaddr if not RT_NULL, the chunk is pinned if possible and its kernel
+ *        address is returned here, otherwise RT_NULL is returned here
+ * @return ssize_t the bytes of the chunk, 0 if nothing is left, -EFAULT if
+ *         the first page of the chunk can not be accessed
+ */
+ssize_t lwp_uiter_chunk(struct lwp_uiter *iter, size_t max, void **uaddr, void **kaddr);
+
+/**
+ * @brief consume bytes of the current chunk and unpin it
+ *
+ * @param iter the iterator
+ * @param bytes the bytes transferred, no more than the current chunk
+ */
+void lwp_uiter_advance(struct lwp_uiter *iter, size_t bytes);
+
+/**
+ * @brief unpin the current chunk if the transfer stops without advancing
+ *
+ * @param iter the iterator
+ */
+void lwp_uiter_fini(struct lwp_uiter *iter);
+
 int lwp_user_space_init(struct rt_lwp *lwp, rt_bool_t is_fork);
 void lwp_unmap_user_space(struct rt_lwp *lwp);
 
@@ -6,6 +6,8 @@
  * Change Logs:
  * Date           Author       Notes
  * 2023-08-19     Shell        Support PRIVATE mapping and COW
+ * 2026-10-17     agent        Fault in huge pages for large mappings
+ * 2026-10-17     agent        Add rt_varea_is_anon
  */
 
 #define DBG_TAG "mm.anon"
@@ -115,6 +117,44 @@ void rt_varea_pgmgr_insert(rt_varea_t varea, void *page_addr)
     rt_page_ref_inc(page_addr, 0);
 }
 
+#ifdef RT_USING_HUGEPAGE
+/**
+ * Unmap an aligned 2MB block at once if it's backed by contiguous page frames,
+ * so a huge mapping is released without being split first
+ */
+static rt_bool_t _pgmgr_pop_block(rt_varea_t varea, char *block, char *end)
+{
+    char *page_pa;
+    char *page_va;
+    rt_size_t off;
+
+    if (((rt_ubase_t)block & (RT_HUGE_PAGE_SIZE - 1)) || (rt_size_t)(end - block) < RT_HUGE_PAGE_SIZE)
+        return RT_FALSE;
+
+    page_pa = rt_hw_mmu_v2p(varea->aspace, block);
+    if (page_pa == ARCH_MAP_FAILED || ((rt_ubase_t)page_pa & (RT_HUGE_PAGE_SIZE - 1)))
+        return RT_FALSE;
+
+    page_va = rt_kmem_p2v(page_pa);
+    if (!page_va)
+        return RT_FALSE;
+
+    for (off = ARCH_PAGE_SIZE; off != RT_HUGE_PAGE_SIZE; off += ARCH_PAGE_SIZE)
+    {
+        if (rt_hw_mmu_v2p(varea->aspace, block + off) != page_pa + off)
+            return RT_FALSE;
+    }
+
+    LOG_D("%s: free block %p", __func__, page_va);
+    rt_varea_unmap_range(varea, block, RT_HUGE_PAGE_SIZE);
+    for (off = 0; off != RT_HUGE_PAGE_SIZE; off += ARCH_PAGE_SIZE)
+    {
+        rt_pages_free(page_va + off, 0);
+    }
+    return RT_TRUE;
+}
+#endif /* RT_USING_HUGEPAGE */
+
 /**
  * Private unmapping of address space
  */
@@ -130,6 +170,13 @@ static void _pgmgr_pop_all(rt_varea_t varea)
 
     for (; iter != end_addr; iter += ARCH_PAGE_SIZE)
     {
+#ifdef RT_USING_HUGEPAGE
+        if (_pgmgr_pop_block(varea, iter, end_addr))
+        {
+            iter += RT_HUGE_PAGE_SIZE - ARCH_PAGE_SIZE;
+            continue;
+        }
+#endif /* RT_USING_HUGEPAGE */
         void *page_pa = rt_hw_mmu_v2p(aspace, iter);
         char *page_va = rt_kmem_p2v(page_pa);
         if (page_pa != ARCH_MAP_FAILED && page_va)
@@ -148,6 +195,13 @@ static void _pgmgr_pop_range(rt_varea_t varea, void *rm_start, void *rm_end)
     RT_ASSERT(!((rt_ubase_t)rm_end & ARCH_PAGE_MASK));
     while (rm_start != rm_end)
     {
+#ifdef RT_USING_HUGEPAGE
+        if (_pgmgr_pop_block(varea, rm_start, rm_end))
+        {
+            rm_start += RT_HUGE_PAGE_SIZE;
+            continue;
+        }
+#endif /* RT_USING_HUGEPAGE */
         page_va = rt_hw_mmu_v2p(varea->aspace, rm_start);
 
         if (page_va != ARCH_MAP_FAILED)
@@ -250,6 +304,66 @@ rt_inline void _map_page_in_varea(rt_aspace_t asapce, rt_varea_t varea,
     }
 }
 
+#ifdef RT_USING_HUGEPAGE
+/**
+ * Back the whole aligned 2MB block around the fault with a huge page, if it
+ * lies in the varea and none of its pages is populated yet. The huge page is
+ * split to single pages on allocation, so the page manager still references
+ * and releases every page on its own, and a partial unmap only splits the
+ * mapping in the page table.
+ */
+static rt_err_t _map_huge_in_varea(rt_varea_t varea, struct rt_aspace_fault_msg *msg)
+{
+    char *block = (char *)RT_ALIGN_DOWN((rt_ubase_t)msg->fault_vaddr, RT_HUGE_PAGE_SIZE);
+    char *iter;
+    void *page;
+    void *page_pa;
+
+    if (RT_HUGE_PAGE_ORDER >= RT_PAGE_MAX_ORDER ||
+        block < (char *)varea->start ||
+        block + RT_HUGE_PAGE_SIZE > (char *)varea->start + varea->size)
+    {
+        return -RT_EINVAL;
+    }
+
+    /* one look at the page table instead of a walk for every page */
+    if (!rt_hw_mmu_huge_unused(varea->aspace, block))
+    {
+        return -RT_EBUSY;
+    }
+
+    page = rt_pages_alloc_ext(RT_HUGE_PAGE_ORDER, PAGE_ANY_AVAILABLE);
+    if (!page)
+    {
+        return -RT_ENOMEM;
+    }
+
+    page_pa = rt_kmem_v2p(page);
+    if ((rt_ubase_t)page_pa & (RT_HUGE_PAGE_SIZE - 1))
+    {
+        rt_pages_free(page, RT_HUGE_PAGE_ORDER);
+        return -RT_EINVAL;
+    }
+
+    /* each page of the block holds the reference of its mapping */
+    rt_page_split(page, RT_HUGE_PAGE_ORDER);
+    if (rt_varea_map_range(varea, block, page_pa, RT_HUGE_PAGE_SIZE) != RT_EOK)
+    {
+        for (iter = page; iter != (char *)page + RT_HUGE_PAGE_SIZE; iter += ARCH_PAGE_SIZE)
+        {
+            rt_pages_free(iter, 0);
+        }
+        return -RT_ENOMEM;
+    }
+
+    LOG_D("%s: huge page %p at %p in %s", __func__, page_pa, block, VAREA_NAME(varea));
+    msg->response.status = MM_FAULT_STATUS_OK_MAPPED;
+    msg->response.vaddr = (char *)page + ((char *)msg->fault_vaddr - block);
+    msg->response.size = ARCH_PAGE_SIZE;
+    return RT_EOK;
+}
+#endif /* RT_USING_HUGEPAGE */
+
 /* page frame inquiry or allocation in backup address space */
 static void *_get_page_from_backup(rt_aspace_t backup, rt_base_t offset_in_mobj)
 {
@@ -324,14 +438,19 @@ static void _fetch_page_for_varea(struct rt_varea *varea, struct rt_aspace_fault
     {
         if (backup == curr_aspace)
         {
-            rt_mm_dummy_mapper.on_page_fault(varea, msg);
-            if (msg->response.status != MM_FAULT_STATUS_UNRECOVERABLE)
+#ifdef RT_USING_HUGEPAGE
+            if (_map_huge_in_varea(varea, msg) != RT_EOK)
+#endif /* RT_USING_HUGEPAGE */
             {
-                /* if backup == curr_aspace, a page fetch always binding with a pte filling */
-                _map_page_in_varea(backup, varea, msg, msg->fault_vaddr);
+                rt_mm_dummy_mapper.on_page_fault(varea, msg);
                 if (msg->response.status != MM_FAULT_STATUS_UNRECOVERABLE)
                 {
-                    rt_pages_free(msg->response.vaddr, 0);
+                    /* if backup == curr_aspace, a page fetch always binding with a pte filling */
+                    _map_page_in_varea(backup, varea, msg, msg->fault_vaddr);
+                    if (msg->response.status != MM_FAULT_STATUS_UNRECOVERABLE)
+                    {
+                        rt_pages_free(msg->response.vaddr, 0);
+                    }
                 }
             }
         }
@@ -365,6 +484,14 @@ static void _anon_page_fault(struct rt_varea *varea, struct rt_aspace_fault_msg
     _fetch_page_for_varea(varea, msg, RT_TRUE);
 }
 
+rt_bool_t rt_varea_is_anon(rt_varea_t varea)
+{
+    rt_mem_obj_t mem_obj = varea->mem_obj;
+
+    return mem_obj == &rt_mm_dummy_mapper ||
+           (mem_obj && mem_obj->on_page_fault == _anon_page_fault);
+}
+
 static void read_by_mte(rt_aspace_t aspace, struct rt_aspace_io_msg *iomsg)
 {
     if (rt_aspace_page_get_phy(aspace, iomsg->fault_vaddr, iomsg->buffer_vaddr) == RT_EOK)
@@ -10,6 +10,9 @@
  *                             page management algorithm
  * 2023-02-20     WangXiaoyao  Multi-list page-management
  * 2023-11-28     Shell        Bugs fix for page_install on shadow region
+ * 2026-10-17     agent        add per-CPU page frame caches
+ * 2026-10-17     agent        split of huge page frames
+ * 2026-10-17     agent        drain the page frame caches of all CPUs
  */
 #include <rtthread.h>
 
@@ -312,7 +315,7 @@ static void _pages_ref_inc(struct rt_page *p, rt_uint32_t size_bits)
 
     page_head = page_start + idx;
     page_head = (void *)((char *)page_head + early_offset);
-    page_head->ref_cnt++;
+    rt_atomic_add(&(page_head->ref_cnt), 1);
 }
 
 static int _pages_ref_get(struct rt_page *p, rt_uint32_t size_bits)
@@ -325,7 +328,7 @@ static int _pages_ref_get(struct rt_page *p, rt_uint32_t size_bits)
     idx = idx & ~((1UL << size_bits) - 1);
 
     page_head = page_start + idx;
-    return page_head->ref_cnt;
+    return rt_atomic_load(&(page_head->ref_cnt));
 }
 
 static int _pages_free(rt_page_t page_list[], struct rt_page *p, rt_uint32_t size_bits)
@@ -340,8 +343,7 @@ static int _pages_free(rt_page_t page_list[], struct rt_page *p, rt_uint32_t siz
     RT_ASSERT(p->size_bits == ARCH_ADDRESS_WIDTH_BITS);
     RT_ASSERT(size_bits < RT_PAGE_MAX_ORDER);
 
-    p->ref_cnt--;
-    if (p->ref_cnt != 0)
+    if (rt_atomic_sub(&(p->ref_cnt), 1) != 1)
     {
         return 0;
     }
@@ -521,6 +523,28 @@ void rt_page_ref_inc(void *addr, rt_uint32_t size_bits)
     rt_spin_unlock_irqrestore(&_spinlock, level);
 }
 
+#ifdef RT_USING_HUGEPAGE
+void rt_page_split(void *addr, rt_uint32_t size_bits)
+{
+    struct rt_page *p;
+    rt_base_t level;
+
+    p = rt_page_addr2page(addr);
+    level = rt_spin_lock_irqsave(&_spinlock);
+
+    RT_ASSERT(p->size_bits == ARCH_ADDRESS_WIDTH_BITS);
+    RT_ASSERT(rt_atomic_load(&(p->ref_cnt)) == 1);
+
+    /* the buddies merge again when all of the single pages are freed */
+    for (rt_size_t i = 1; i < (1UL << size_bits); i++)
+    {
+        p[i].size_bits = ARCH_ADDRESS_WIDTH_BITS;
+        rt_atomic_store(&(p[i].ref_cnt), 1);
+    }
+    rt_spin_unlock_irqrestore(&_spinlock, level);
+}
+#endif /* RT_USING_HUGEPAGE */
+
 static rt_page_t (*pages_alloc_handler)(rt_page_t page_list[], rt_uint32_t size_bits);
 
 /* if not, we skip the finding on page_list_high */
@@ -540,12 +564,232 @@ static rt_page_t *_flag_to_page_list(size_t flags)
     return page_list;
 }
 
-rt_inline void *_do_pages_alloc(rt_uint32_t size_bits, size_t flags)
+#ifdef RT_PAGE_USING_PCP
+
+#if RT_PAGE_PCP_HIGH < RT_PAGE_PCP_BATCH
+#error "RT_PAGE_PCP_HIGH must not be less than RT_PAGE_PCP_BATCH"
+#endif
+
+/**
+ * Per-CPU caches of single page frames, one list for each region. A cached
+ * frame is still allocated in view of the buddy lists so it never merges.
+ * A cache is touched by its CPU with the local interrupt disabled, and
+ * under its lock, which is only contended when another CPU drains it.
+ * Frames are freed to and allocated from the head where the hot ones are,
+ * the tail is refilled from and drained to the buddy lists in batches.
+ */
+struct _pcp_list
+{
+    struct rt_page *head;
+    struct rt_page *tail;
+    rt_size_t count;
+};
+
+struct _pcp
+{
+    struct rt_spinlock lock;
+    struct _pcp_list list[2];       /* low and high region */
+    struct rt_page_pcp_stat stat;
+};
+
+static struct _pcp _pcp_cpus[RT_CPUS_NR];
+
+#define PCP_LIST_IDX(page_list) ((page_list) == page_list_high ? 1 : 0)
+#define PCP_ACTIVE()            (pages_alloc_handler == _pages_alloc)
+
+static void _pcp_push_head(struct _pcp_list *list, struct rt_page *p)
+{
+    p->pre = RT_NULL;
+    p->next = list->head;
+    if (list->head)
+        list->head->pre = p;
+    else
+        list->tail = p;
+    list->head = p;
+    list->count++;
+}
+
+static void _pcp_push_tail(struct _pcp_list *list, struct rt_page *p)
+{
+    p->next = RT_NULL;
+    p->pre = list->tail;
+    if (list->tail)
+        list->tail->next = p;
+    else
+        list->head = p;
+    list->tail = p;
+    list->count++;
+}
+
+static struct rt_page *_pcp_pop(struct _pcp_list *list, rt_bool_t from_head)
+{
+    struct rt_page *p = from_head ? list->head : list->tail;
+
+    if (p)
+    {
+        if (p->pre)
+            p->pre->next = p->next;
+        else
+            list->head = p->next;
+        if (p->next)
+            p->next->pre = p->pre;
+        else
+            list->tail = p->pre;
+        p->next = p->pre = RT_NULL;
+        list->count--;
+    }
+    return p;
+}
+
+/* the local interrupt is disabled and the cache is locked by caller */
+static void _pcp_refill(struct _pcp *pcp, rt_page_t page_list[])
+{
+    struct _pcp_list *list = &pcp->list[PCP_LIST_IDX(page_list)];
+    struct rt_page *p;
+    int i;
+
+    rt_spin_lock(&_spinlock);
+    for (i = 0; i < RT_PAGE_PCP_BATCH; i++)
+    {
+        p = _pages_alloc(page_list, 0);
+        if (!p)
+        {
+            break;
+        }
+        rt_atomic_store(&(p->ref_cnt), 0);
+        _pcp_push_tail(list, p);
+    }
+    rt_spin_unlock(&_spinlock);
+
+    if (i)
+    {
+        pcp->stat.refill++;
+    }
+}
+
+/* the local interrupt is disabled and the cache is locked by caller */
+static void _pcp_drain(struct _pcp *pcp, int idx, rt_size_t nr)
+{
+    rt_page_t *page_list = idx ? page_list_high : page_list_low;
+    struct _pcp_list *list = &pcp->list[idx];
+    struct rt_page *p;
+
+    if (!list->count)
+    {
+        return;
+    }
+
+    rt_spin_lock(&_spinlock);
+    while (nr-- && (p = _pcp_pop(list, RT_FALSE)))
+    {
+        rt_atomic_store(&(p->ref_cnt), 1);
+        _pages_free(page_list, p, 0);
+    }
+    rt_spin_unlock(&_spinlock);
+
+    pcp->stat.drain++;
+}
+
+static struct rt_page *_pcp_alloc(rt_page_t page_list[])
+{
+    struct _pcp_list *list;
+    struct rt_page *p;
+    struct _pcp *pcp;
+    rt_base_t level;
+
+    level = rt_hw_local_irq_disable();
+    pcp = &_pcp_cpus[rt_cpu_get_id()];
+    list = &pcp->list[PCP_LIST_IDX(page_list)];
+    rt_spin_lock(&pcp->lock);
+
+    if (!list->count)
+    {
+        _pcp_refill(pcp, page_list);
+    }
+
+    p = _pcp_pop(list, RT_TRUE);
+    if (p)
+    {
+        rt_atomic_store(&(p->ref_cnt), 1);
+        pcp->stat.alloc++;
+    }
+    rt_spin_unlock(&pcp->lock);
+    rt_hw_local_irq_enable(level);
+
+    return p;
+}
+
+static void _pcp_free(rt_page_t page_list[], struct rt_page *p)
+{
+    int idx = PCP_LIST_IDX(page_list);
+    struct _pcp *pcp;
+    rt_base_t level;
+
+    level = rt_hw_local_irq_disable();
+    pcp = &_pcp_cpus[rt_cpu_get_id()];
+    rt_spin_lock(&pcp->lock);
+
+    _pcp_push_head(&pcp->list[idx], p);
+    pcp->stat.free++;
+
+    if (pcp->list[idx].count > RT_PAGE_PCP_HIGH)
+    {
+        _pcp_drain(pcp, idx, RT_PAGE_PCP_BATCH);
+    }
+    rt_spin_unlock(&pcp->lock);
+    rt_hw_local_irq_enable(level);
+}
+
+static rt_size_t _pcp_count(int idx)
+{
+    rt_size_t count = 0;
+
+    for (int cpu = 0; cpu < RT_CPUS_NR; cpu++)
+    {
+        count += _pcp_cpus[cpu].list[idx].count;
+    }
+    return count;
+}
+
+int rt_page_pcp_get_stat(int cpu, struct rt_page_pcp_stat *stat)
+{
+    struct _pcp *pcp;
+    rt_base_t level;
+
+    if (cpu < 0 || cpu >= RT_CPUS_NR || !stat)
+    {
+        return -RT_EINVAL;
+    }
+
+    pcp = &_pcp_cpus[cpu];
+    level = rt_spin_lock_irqsave(&pcp->lock);
+    *stat = pcp->stat;
+    stat->count = pcp->list[0].count + pcp->list[1].count;
+    rt_spin_unlock_irqrestore(&pcp->lock, level);
+
+    return RT_EOK;
+}
+
+void rt_page_pcp_drain(void)
+{
+    struct _pcp *pcp;
+    rt_base_t level;
+
+    for (int cpu = 0; cpu < RT_CPUS_NR; cpu++)
+    {
+        pcp = &_pcp_cpus[cpu];
+        level = rt_spin_lock_irqsave(&pcp->lock);
+        _pcp_drain(pcp, 0, RT_PAGE_PCP_HIGH + 1);
+        _pcp_drain(pcp, 1, RT_PAGE_PCP_HIGH + 1);
+        rt_spin_unlock_irqrestore(&pcp->lock, level);
+    }
+}
+#endif /* RT_PAGE_USING_PCP */
+
+static struct rt_page *_buddy_alloc(rt_page_t *page_list, rt_uint32_t size_bits)
 {
-    void *alloc_buf = RT_NULL;
     struct rt_page *p;
     rt_base_t level;
-    rt_page_t *page_list = _flag_to_page_list(flags);
 
     level = rt_spin_lock_irqsave(&_spinlock);
     p = pages_alloc_handler(page_list, size_bits);
@@ -561,11 +805,45 @@ rt_inline void *_do_pages_alloc(rt_uint32_t size_bits, size_t flags)
         rt_spin_unlock_irqrestore(&_spinlock, level);
     }
 
+    return p;
+}
+
+rt_inline void *_do_pages_alloc(rt_uint32_t size_bits, size_t flags)
+{
+    void *alloc_buf = RT_NULL;
+    struct rt_page *p;
+    rt_page_t *page_list = _flag_to_page_list(flags);
+
+#ifdef RT_PAGE_USING_PCP
+    if (size_bits == 0 && PCP_ACTIVE())
+    {
+        p = _pcp_alloc(page_list);
+        if (!p && page_list != page_list_low)
+        {
+            p = _pcp_alloc(page_list_low);
+        }
+    }
+    else
+    {
+        p = _buddy_alloc(page_list, size_bits);
+    }
+
+    if (!p && PCP_ACTIVE())
+    {
+        /* the frames may be held by the caches of any CPU */
+        rt_page_pcp_drain();
+        p = _buddy_alloc(page_list, size_bits);
+    }
+#else
+    p = _buddy_alloc(page_list, size_bits);
+#endif /* RT_PAGE_USING_PCP */
+
     if (p)
     {
         alloc_buf = page_to_addr(p);
 
         #ifdef RT_DEBUGING_PAGE_LEAK
+            rt_base_t level;
             level = rt_spin_lock_irqsave(&_spinlock);
             TRACE_ALLOC(p, size_bits);
             rt_spin_unlock_irqrestore(&_spinlock, level);
@@ -594,6 +872,20 @@ int rt_pages_free(void *addr, rt_uint32_t size_bits)
     if (p)
     {
         rt_base_t level;
+
+#ifdef RT_PAGE_USING_PCP
+        if (size_bits == 0 && PCP_ACTIVE())
+        {
+            RT_ASSERT(rt_atomic_load(&(p->ref_cnt)) > 0);
+            if (rt_atomic_sub(&(p->ref_cnt), 1) == 1)
+            {
+                _pcp_free(page_list, p);
+                real_free = 1;
+            }
+            return real_free;
+        }
+#endif /* RT_PAGE_USING_PCP */
+
         level = rt_spin_lock_irqsave(&_spinlock);
         real_free = _pages_free(page_list, p, size_bits);
         if (real_free)
@@ -640,9 +932,23 @@ void list_page(void)
     }
 
     rt_spin_unlock_irqrestore(&_spinlock, level);
+#ifdef RT_PAGE_USING_PCP
+    free += _pcp_count(0) + _pcp_count(1);
+#endif
     rt_kprintf("-------------------------------\n");
     rt_kprintf("Page Summary:\n => free/installed: 0x%lx/0x%lx (%ld/%ld KB)\n", free, installed, PGNR2SIZE(free), PGNR2SIZE(installed));
     rt_kprintf("-------------------------------\n");
+#ifdef RT_PAGE_USING_PCP
+    for (i = 0; i < RT_CPUS_NR; i++)
+    {
+        struct rt_page_pcp_stat stat;
+
+        rt_page_pcp_get_stat(i, &stat);
+        rt_kprintf("cpu%d cache: %ld pages, alloc %ld, free %ld, refill %ld, drain %ld\n",
+                   i, stat.count, stat.alloc, stat.free, stat.refill, stat.drain);
+    }
+    rt_kprintf("-------------------------------\n");
+#endif /* RT_PAGE_USING_PCP */
 }
 MSH_CMD_EXPORT(list_page, show page info);
 
@@ -674,6 +980,9 @@ void rt_page_get_info(rt_size_t *total_nr, rt_size_t *free_nr)
         }
     }
     rt_spin_unlock_irqrestore(&_spinlock, level);
+#ifdef RT_PAGE_USING_PCP
+    total_free += _pcp_count(0) + _pcp_count(1);
+#endif
     *total_nr = page_nr;
     *free_nr = total_free;
 }
@@ -696,6 +1005,9 @@ void rt_page_high_get_info(rt_size_t *total_nr, rt_size_t *free_nr)
         }
     }
     rt_spin_unlock_irqrestore(&_spinlock, level);
+#ifdef RT_PAGE_USING_PCP
+    total_free += _pcp_count(1);
+#endif
     *total_nr = _high_pages_nr;
     *free_nr = total_free;
 }
@@ -825,6 +1137,13 @@ void rt_page_init(rt_region_t reg)
     reg.start = init_mpr_cont_end;
     _install_page(mpr_cont, reg, _early_page_insert);
 
+#ifdef RT_PAGE_USING_PCP
+    for (int cpu = 0; cpu < RT_CPUS_NR; cpu++)
+    {
+        rt_spin_lock_init(&_pcp_cpus[cpu].lock);
+    }
+#endif /* RT_PAGE_USING_PCP */
+
     pages_alloc_handler = _early_pages_alloc;
     /* doing the page table bushiness */
     if (rt_aspace_load_page(&rt_kernel_space, (void *)init_mpr_align_start, init_mpr_npage))
@@ -8,6 +8,8 @@
  * 2019-11-01     Jesven       The first version
  * 2022-12-13     WangXiaoyao  Hot-pluggable, extensible
  *                             page management algorithm
+ * 2026-10-17     agent        add per-CPU page frame caches
+ * 2026-10-17     agent        split of huge page frames
  */
 #ifndef __MM_PAGE_H__
 #define __MM_PAGE_H__
@@ -52,7 +54,7 @@ DEF_PAGE_T(
     DEBUG_FIELD;
 
     rt_uint32_t size_bits;     /* if is ARCH_ADDRESS_WIDTH_BITS, means not free */
-    rt_uint32_t ref_cnt;       /* page group ref count */
+    rt_atomic_t ref_cnt;       /* page group ref count */
 );
 
 #undef GET_FLOOR
@@ -91,6 +93,48 @@ void rt_page_get_info(rt_size_t *total_nr, rt_size_t *free_nr);
 
 void rt_page_high_get_info(rt_size_t *total_nr, rt_size_t *free_nr);
 
+#ifdef RT_PAGE_USING_PCP
+struct rt_page_pcp_stat
+{
+    rt_size_t count;            /* pages in the cache now */
+    rt_size_t alloc;            /* single pages allocated from the cache */
+    rt_size_t free;             /* single pages freed to the cache */
+    rt_size_t refill;           /* batches taken from the buddy lists */
+    rt_size_t drain;            /* batches given back to the buddy lists */
+};
+
+/**
+ * @brief Get the statistics of the page frame cache of a CPU
+ *
+ * @param cpu the CPU id
+ * @param stat the statistics of both the low and the high region
+ * @return int 0 on success
+ */
+int rt_page_pcp_get_stat(int cpu, struct rt_page_pcp_stat *stat);
+
+/**
+ * @brief Give all the cached page frames of every CPU back to the buddy
+ * lists, so they can merge into bigger blocks again
+ */
+void rt_page_pcp_drain(void);
+#endif /* RT_PAGE_USING_PCP */
+
+#ifdef RT_USING_HUGEPAGE
+#define RT_HUGE_PAGE_SHIFT  21
+#define RT_HUGE_PAGE_SIZE   (1ul << RT_HUGE_PAGE_SHIFT)
+#define RT_HUGE_PAGE_ORDER  (RT_HUGE_PAGE_SHIFT - ARCH_PAGE_SHIFT)
+
+/**
+ * @brief Split an allocated block of 2^size_bits page frames into single
+ * page frames, each holding one reference, so they can be freed one by one
+ * with rt_pages_free(addr, 0). The block must hold exactly one reference.
+ *
+ * @param addr the start address of the block
+ * @param size_bits the order of the block
+ */
+void rt_page_split(void *addr, rt_uint32_t size_bits);
+#endif /* RT_USING_HUGEPAGE */
+
 void *rt_page_page2addr(struct rt_page *p);
 
 struct rt_page *rt_page_addr2page(void *addr);
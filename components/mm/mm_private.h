@@ -6,6 +6,7 @@
  * Change Logs:
  * Date           Author       Notes
  * 2022-11-14     WangXiaoyao  the first version
+ * 2026-10-17     agent        add rt_varea_is_anon
  */
 #ifndef __MM_PRIVATE_H__
 #define __MM_PRIVATE_H__
@@ -129,6 +130,13 @@ rt_inline rt_bool_t rt_varea_is_private_locked(rt_varea_t varea)
 }
 
 rt_err_t rt_aspace_anon_ref_dec(rt_mem_obj_t aobj);
+
+/**
+ * @brief Test if the frames of a varea are anonymous memory. They are single
+ * page frames from the page allocator, each of them holds its own reference.
+ */
+rt_bool_t rt_varea_is_anon(rt_varea_t varea);
+
 rt_err_t rt_aspace_page_get_phy(rt_aspace_t aspace, void *page_va, void *buffer);
 rt_err_t rt_aspace_page_put_phy(rt_aspace_t aspace, void *page_va, void *buffer);
 
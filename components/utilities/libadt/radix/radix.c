@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        first version
+ */
+#include <rtthread.h>
+#include <rthw.h>
+
+#include "radix.h"
+
+#define INDEX_BITS          (sizeof(unsigned long) * 8)
+#define SLOT_OF(node, idx)  (((idx) >> (node)->shift) & UTIL_RADIX_MASK)
+
+/* a lockless reader sees either RT_NULL or a complete object */
+#define RADIX_LOAD(ptr)         (*(void *volatile *)&(ptr))
+#define RADIX_PUBLISH(ptr, val) \
+    do { rt_hw_dmb(); *(void *volatile *)&(ptr) = (void *)(val); } while (0)
+
+static rt_bool_t _radix_fits(struct util_radix_node *node, unsigned long index)
+{
+    return node->shift + UTIL_RADIX_SHIFT >= INDEX_BITS ||
+           (index >> (node->shift + UTIL_RADIX_SHIFT)) == 0;
+}
+
+static struct util_radix_node *_radix_node_alloc(rt_uint16_t shift)
+{
+    struct util_radix_node *node;
+
+    node = rt_calloc(1, sizeof(struct util_radix_node));
+    if (node)
+    {
+        node->shift = shift;
+    }
+
+    return node;
+}
+
+void *util_radix_lookup(struct util_radix_root *root, unsigned long index)
+{
+    struct util_radix_node *node = RADIX_LOAD(root->rnode);
+
+    if (!node || !_radix_fits(node, index))
+    {
+        return RT_NULL;
+    }
+
+    while (node->shift)
+    {
+        node = RADIX_LOAD(node->slots[SLOT_OF(node, index)]);
+        if (!node)
+        {
+            return RT_NULL;
+        }
+    }
+
+    return RADIX_LOAD(node->slots[index & UTIL_RADIX_MASK]);
+}
+
+rt_err_t util_radix_insert(struct util_radix_root *root, unsigned long index, void *item)
+{
+    struct util_radix_node *node, *child;
+    unsigned long offset;
+
+    RT_ASSERT(item);
+
+    if (!root->rnode)
+    {
+        rt_uint16_t shift = 0;
+
+        while (shift + UTIL_RADIX_SHIFT < INDEX_BITS && (index >> (shift + UTIL_RADIX_SHIFT)))
+        {
+            shift += UTIL_RADIX_SHIFT;
+        }
+
+        node = _radix_node_alloc(shift);
+        if (!node)
+        {
+            return -RT_ENOMEM;
+        }
+        RADIX_PUBLISH(root->rnode, node);
+    }
+
+    /* grow on top until the index fits, the old tree becomes the first slot */
+    while (!_radix_fits(root->rnode, index))
+    {
+        child = root->rnode;
+        node = _radix_node_alloc(child->shift + UTIL_RADIX_SHIFT);
+        if (!node)
+        {
+            return -RT_ENOMEM;
+        }
+
+        node->slots[0] = child;
+        node->count = 1;
+        child->parent = node;
+        child->offset = 0;
+        RADIX_PUBLISH(root->rnode, node);
+    }
+
+    node = root->rnode;
+    while (node->shift)
+    {
+        offset = SLOT_OF(node, index);
+        child = node->slots[offset];
+        if (!child)
+        {
+            child = _radix_node_alloc(node->shift - UTIL_RADIX_SHIFT);
+            if (!child)
+            {
+                return -RT_ENOMEM;
+            }
+
+            child->parent = node;
+            child->offset = offset;
+            node->count ++;
+            RADIX_PUBLISH(node->slots[offset], child);
+        }
+        node = child;
+    }
+
+    offset = index & UTIL_RADIX_MASK;
+    if (node->slots[offset])
+    {
+        return -RT_EBUSY;
+    }
+
+    node->count ++;
+    RADIX_PUBLISH(node->slots[offset], item);
+
+    return RT_EOK;
+}
+
+void *util_radix_delete(struct util_radix_root *root, unsigned long index)
+{
+    void *item;
+    unsigned long offset;
+    struct util_radix_node *node = root->rnode, *parent;
+
+    if (!node || !_radix_fits(node, index))
+    {
+        return RT_NULL;
+    }
+
+    while (node->shift)
+    {
+        node = node->slots[SLOT_OF(node, index)];
+        if (!node)
+        {
+            return RT_NULL;
+        }
+    }
+
+    offset = index & UTIL_RADIX_MASK;
+    item = node->slots[offset];
+    if (!item)
+    {
+        return RT_NULL;
+    }
+
+    RADIX_PUBLISH(node->slots[offset], RT_NULL);
+    node->count --;
+
+    /* unlink the emptied nodes, readers may still be walking them */
+    while (node->count == 0 && node != root->rnode)
+    {
+        parent = node->parent;
+        RADIX_PUBLISH(parent->slots[node->offset], RT_NULL);
+        parent->count --;
+
+        node->parent = root->reclaim;
+        root->reclaim = node;
+        node = parent;
+    }
+
+    return item;
+}
+
+void util_radix_reclaim(struct util_radix_root *root)
+{
+    struct util_radix_node *node = root->reclaim, *next;
+
+    root->reclaim = RT_NULL;
+    while (node)
+    {
+        next = node->parent;
+        rt_free(node);
+        node = next;
+    }
+}
+
+static void _radix_free(struct util_radix_node *node)
+{
+    unsigned long i;
+
+    if (node->shift)
+    {
+        for (i = 0; i < UTIL_RADIX_SLOTS && node->count; i++)
+        {
+            if (node->slots[i])
+            {
+                _radix_free(node->slots[i]);
+                node->count --;
+            }
+        }
+    }
+
+    rt_free(node);
+}
+
+void util_radix_destroy(struct util_radix_root *root)
+{
+    if (root->rnode)
+    {
+        _radix_free(root->rnode);
+        root->rnode = RT_NULL;
+    }
+
+    util_radix_reclaim(root);
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        first version
+ */
+#ifndef __UTIL_TREE_RADIX_H__
+#define __UTIL_TREE_RADIX_H__
+
+#include <rtdef.h>
+
+/*
+ * A radix tree maps an unsigned long index to a pointer.
+ *
+ * Writers (insert/delete/reclaim) must be serialized by the user. Lookup is
+ * lockless and may run in parallel with writers: a published node or item is
+ * always complete, and a node emptied by delete is not freed but queued on the
+ * root until util_radix_reclaim(), which the user calls once no lockless
+ * reader can still be walking the tree.
+ */
+
+#define UTIL_RADIX_SHIFT    6
+#define UTIL_RADIX_SLOTS    (1UL << UTIL_RADIX_SHIFT)
+#define UTIL_RADIX_MASK     (UTIL_RADIX_SLOTS - 1)
+
+struct util_radix_node
+{
+    struct util_radix_node *parent;     /* next one when it's queued to reclaim */
+    rt_uint16_t shift;                  /* index bits below this level */
+    rt_uint16_t offset;                 /* slot in the parent */
+    rt_uint32_t count;                  /* used slots */
+    void *slots[UTIL_RADIX_SLOTS];
+};
+
+struct util_radix_root
+{
+    struct util_radix_node *rnode;
+    struct util_radix_node *reclaim;
+};
+
+#define UTIL_RADIX_ROOT_INIT {0, 0}
+
+rt_inline void util_radix_init(struct util_radix_root *root)
+{
+    root->rnode = RT_NULL;
+    root->reclaim = RT_NULL;
+}
+
+void *util_radix_lookup(struct util_radix_root *root, unsigned long index);
+rt_err_t util_radix_insert(struct util_radix_root *root, unsigned long index, void *item);
+void *util_radix_delete(struct util_radix_root *root, unsigned long index);
+void util_radix_reclaim(struct util_radix_root *root);
+void util_radix_destroy(struct util_radix_root *root);
+
+#endif /* __UTIL_TREE_RADIX_H__ */
@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include "utest.h"
+
+/**
+ * @brief   Block sector buffer cache testcase.
+ *
+ * @note    A RAM disk counting its reads and writes is registered with a
+ *          small cache, the repeated reads must hit, the writes must stay
+ *          in the cache until sync and reach the disk coalesced, and the
+ *          large requests must bypass the cache coherently.
+ */
+
+#define RAMDISK_SECTOR_SIZE     512
+#define RAMDISK_SECTORS         64
+#define RAMDISK_CACHE_SECTORS   8
+
+static struct rt_blk_disk ramdisk;
+static rt_uint8_t ramdisk_data[RAMDISK_SECTORS * RAMDISK_SECTOR_SIZE];
+static struct rt_dm_ida ramdisk_ida = RT_DM_IDA_INIT(CUSTOM);
+
+static rt_uint32_t read_calls, write_calls, write_sectors;
+
+static rt_ssize_t ramdisk_read(struct rt_blk_disk *disk, rt_off_t sector,
+        void *buffer, rt_size_t sector_count)
+{
+    ++read_calls;
+    rt_memcpy(buffer, &ramdisk_data[sector * RAMDISK_SECTOR_SIZE],
+            sector_count * RAMDISK_SECTOR_SIZE);
+
+    return sector_count;
+}
+
+static rt_ssize_t ramdisk_write(struct rt_blk_disk *disk, rt_off_t sector,
+        const void *buffer, rt_size_t sector_count)
+{
+    ++write_calls;
+    write_sectors += sector_count;
+    rt_memcpy(&ramdisk_data[sector * RAMDISK_SECTOR_SIZE], buffer,
+            sector_count * RAMDISK_SECTOR_SIZE);
+
+    return sector_count;
+}
+
+static rt_err_t ramdisk_getgeome(struct rt_blk_disk *disk,
+        struct rt_device_blk_geometry *geometry)
+{
+    geometry->bytes_per_sector = RAMDISK_SECTOR_SIZE;
+    geometry->block_size = RAMDISK_SECTOR_SIZE;
+    geometry->sector_count = RAMDISK_SECTORS;
+
+    return RT_EOK;
+}
+
+static rt_err_t ramdisk_sync(struct rt_blk_disk *disk)
+{
+    return RT_EOK;
+}
+
+static const struct rt_blk_disk_ops ramdisk_ops =
+{
+    .read = ramdisk_read,
+    .write = ramdisk_write,
+    .getgeome = ramdisk_getgeome,
+    .sync = ramdisk_sync,
+};
+
+static void test_blk_cache_read_hit(void)
+{
+    struct rt_blk_cache_stat stat;
+    static rt_uint8_t buffer[RAMDISK_SECTOR_SIZE];
+
+    read_calls = 0;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        uassert_int_equal(rt_device_read(&ramdisk.parent, 1, buffer, 1), 1);
+        uassert_buf_equal(&ramdisk_data[1 * RAMDISK_SECTOR_SIZE], buffer, sizeof(buffer));
+    }
+
+    uassert_int_equal(read_calls, 1);
+
+    uassert_int_equal(rt_blk_disk_get_cache_stat(&ramdisk, &stat), RT_EOK);
+    uassert_true(stat.hits >= 3);
+}
+
+static void test_blk_cache_write_back(void)
+{
+    struct rt_blk_cache_stat stat;
+    static rt_uint8_t buffer[3][RAMDISK_SECTOR_SIZE];
+    static rt_uint8_t rbuffer[RAMDISK_SECTOR_SIZE];
+
+    write_calls = write_sectors = 0;
+
+    /* Out of order, the write back is sorted */
+    for (int i = 2; i >= 0; --i)
+    {
+        rt_memset(buffer[i], 0xa0 + i, RAMDISK_SECTOR_SIZE);
+        uassert_int_equal(rt_device_write(&ramdisk.parent, 10 + i, buffer[i], 1), 1);
+    }
+
+    uassert_int_equal(write_calls, 0);
+
+    rt_device_read(&ramdisk.parent, 11, rbuffer, 1);
+    uassert_buf_equal(buffer[1], rbuffer, RAMDISK_SECTOR_SIZE);
+
+    uassert_int_equal(rt_device_control(&ramdisk.parent, RT_DEVICE_CTRL_BLK_SYNC, RT_NULL), RT_EOK);
+
+    /* Coalesced into one write */
+    uassert_int_equal(write_calls, 1);
+    uassert_int_equal(write_sectors, 3);
+    uassert_buf_equal(&ramdisk_data[10 * RAMDISK_SECTOR_SIZE], buffer, sizeof(buffer));
+
+    rt_blk_disk_get_cache_stat(&ramdisk, &stat);
+    uassert_int_equal(stat.dirty, 0);
+}
+
+static void test_blk_cache_bypass(void)
+{
+    static rt_uint8_t sector[RAMDISK_SECTOR_SIZE];
+    static rt_uint8_t large[16 * RAMDISK_SECTOR_SIZE];
+
+    /* A dirty sector is visible to the large read */
+    rt_memset(sector, 0x5a, sizeof(sector));
+    rt_device_write(&ramdisk.parent, 40, sector, 1);
+
+    uassert_int_equal(rt_device_read(&ramdisk.parent, 32, large, 16), 16);
+    uassert_buf_equal(&large[8 * RAMDISK_SECTOR_SIZE], sector, sizeof(sector));
+
+    /* The large write supersedes the dirty sector */
+    rt_memset(large, 0x3c, sizeof(large));
+    uassert_int_equal(rt_device_write(&ramdisk.parent, 32, large, 16), 16);
+
+    write_calls = 0;
+    rt_device_control(&ramdisk.parent, RT_DEVICE_CTRL_BLK_SYNC, RT_NULL);
+    uassert_int_equal(write_calls, 0);
+
+    rt_device_read(&ramdisk.parent, 40, sector, 1);
+    uassert_buf_equal(&large[8 * RAMDISK_SECTOR_SIZE], sector, sizeof(sector));
+}
+
+static void test_blk_cache_evict(void)
+{
+    struct rt_blk_cache_stat stat;
+    static rt_uint8_t buffer[RAMDISK_SECTOR_SIZE];
+
+    /* Dirty sectors are written back when nothing clean is left */
+    for (int i = 0; i < RAMDISK_CACHE_SECTORS * 2; ++i)
+    {
+        rt_memset(buffer, i, sizeof(buffer));
+        uassert_int_equal(rt_device_write(&ramdisk.parent, 48 + i, buffer, 1), 1);
+    }
+
+    rt_blk_disk_get_cache_stat(&ramdisk, &stat);
+    uassert_int_equal(stat.sectors, RAMDISK_CACHE_SECTORS);
+    uassert_true(stat.valid <= RAMDISK_CACHE_SECTORS);
+
+    rt_device_control(&ramdisk.parent, RT_DEVICE_CTRL_BLK_SYNC, RT_NULL);
+
+    for (int i = 0; i < RAMDISK_CACHE_SECTORS * 2; ++i)
+    {
+        rt_memset(buffer, i, sizeof(buffer));
+        uassert_buf_equal(&ramdisk_data[(48 + i) * RAMDISK_SECTOR_SIZE], buffer, sizeof(buffer));
+    }
+}
+
+static rt_err_t utest_tc_init(void)
+{
+    rt_err_t err;
+
+    for (int i = 0; i < sizeof(ramdisk_data); ++i)
+    {
+        ramdisk_data[i] = (rt_uint8_t)(i * 13 + 5);
+    }
+
+    rt_memset(&ramdisk, 0, sizeof(ramdisk));
+    ramdisk.ida = &ramdisk_ida;
+    rt_dm_dev_set_name(&ramdisk.parent, "cacheram");
+    ramdisk.ops = &ramdisk_ops;
+    ramdisk.parallel_io = RT_TRUE;
+    ramdisk.max_partitions = RT_BLK_PARTITION_NONE;
+    ramdisk.cache_sectors = RAMDISK_CACHE_SECTORS;
+
+    if ((err = rt_hw_blk_disk_register(&ramdisk)))
+    {
+        return err;
+    }
+
+    return rt_device_open(&ramdisk.parent, RT_DEVICE_OFLAG_RDWR);
+}
+
+static rt_err_t utest_tc_cleanup(void)
+{
+    rt_device_close(&ramdisk.parent);
+
+    return rt_hw_blk_disk_unregister(&ramdisk);
+}
+
+static void testcase(void)
+{
+    UTEST_UNIT_RUN(test_blk_cache_read_hit);
+    UTEST_UNIT_RUN(test_blk_cache_write_back);
+    UTEST_UNIT_RUN(test_blk_cache_bypass);
+    UTEST_UNIT_RUN(test_blk_cache_evict);
+}
+UTEST_TC_EXPORT(testcase, "testcases.drivers.blk_cache_tc", utest_tc_init, utest_tc_cleanup, 10);
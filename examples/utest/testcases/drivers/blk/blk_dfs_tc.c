@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+#include <rtdevice.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "utest.h"
+
+/**
+ * @brief   Block device file operations testcase.
+ *
+ * @note    A RAM disk recording its requests is registered and accessed as
+ *          /dev/fopsram. The cases cover:
+ *          1. the aligned sectors of a read go to the disk in one call;
+ *          2. a read and a write with an unaligned head and tail only touch
+ *             their bytes, a buffer not aligned for DMA never reaches the
+ *             disk;
+ *          3. O_DIRECT refuses an unaligned position, size or buffer with
+ *             EINVAL.
+ */
+
+#define RAMDISK_NAME            "fopsram"
+#define RAMDISK_PATH            "/dev/" RAMDISK_NAME
+#define RAMDISK_SECTOR_SIZE     512
+#define RAMDISK_SECTORS         64
+#define RAMDISK_SIZE            (RAMDISK_SECTORS * RAMDISK_SECTOR_SIZE)
+
+static struct rt_blk_disk ramdisk;
+static rt_uint8_t ramdisk_data[RAMDISK_SIZE];
+static struct rt_dm_ida ramdisk_ida = RT_DM_IDA_INIT(CUSTOM);
+
+static rt_uint32_t read_calls, write_calls, misaligned;
+static rt_size_t max_sectors;
+static rt_align(RT_CPU_CACHE_LINE_SZ) rt_uint8_t buffer[RAMDISK_SIZE + RT_CPU_CACHE_LINE_SZ];
+static rt_uint8_t golden[RAMDISK_SIZE];
+
+static void ramdisk_record(const void *buffer, rt_size_t sector_count)
+{
+    if ((rt_ubase_t)buffer & (RT_CPU_CACHE_LINE_SZ - 1))
+    {
+        ++misaligned;
+    }
+
+    max_sectors = rt_max_t(rt_size_t, max_sectors, sector_count);
+}
+
+static rt_ssize_t ramdisk_read(struct rt_blk_disk *disk, rt_off_t sector,
+        void *buffer, rt_size_t sector_count)
+{
+    ++read_calls;
+    ramdisk_record(buffer, sector_count);
+    rt_memcpy(buffer, &ramdisk_data[sector * RAMDISK_SECTOR_SIZE],
+            sector_count * RAMDISK_SECTOR_SIZE);
+
+    return sector_count;
+}
+
+static rt_ssize_t ramdisk_write(struct rt_blk_disk *disk, rt_off_t sector,
+        const void *buffer, rt_size_t sector_count)
+{
+    ++write_calls;
+    ramdisk_record(buffer, sector_count);
+    rt_memcpy(&ramdisk_data[sector * RAMDISK_SECTOR_SIZE], buffer,
+            sector_count * RAMDISK_SECTOR_SIZE);
+
+    return sector_count;
+}
+
+static rt_err_t ramdisk_getgeome(struct rt_blk_disk *disk,
+        struct rt_device_blk_geometry *geometry)
+{
+    geometry->bytes_per_sector = RAMDISK_SECTOR_SIZE;
+    geometry->block_size = RAMDISK_SECTOR_SIZE;
+    geometry->sector_count = RAMDISK_SECTORS;
+
+    return RT_EOK;
+}
+
+static rt_err_t ramdisk_sync(struct rt_blk_disk *disk)
+{
+    return RT_EOK;
+}
+
+static const struct rt_blk_disk_ops ramdisk_ops =
+{
+    .read = ramdisk_read,
+    .write = ramdisk_write,
+    .getgeome = ramdisk_getgeome,
+    .sync = ramdisk_sync,
+};
+
+static void ramdisk_reset_stat(void)
+{
+    read_calls = write_calls = misaligned = 0;
+    max_sectors = 0;
+}
+
+static void test_blk_fops_aligned_read(void)
+{
+    int fd;
+
+    fd = open(RAMDISK_PATH, O_RDWR, 0);
+    uassert_true(fd >= 0);
+    if (fd < 0)
+    {
+        return;
+    }
+
+    ramdisk_reset_stat();
+    lseek(fd, 4 * RAMDISK_SECTOR_SIZE, SEEK_SET);
+    uassert_int_equal(read(fd, buffer, 16 * RAMDISK_SECTOR_SIZE), 16 * RAMDISK_SECTOR_SIZE);
+    uassert_buf_equal(buffer, &golden[4 * RAMDISK_SECTOR_SIZE], 16 * RAMDISK_SECTOR_SIZE);
+    uassert_int_equal(lseek(fd, 0, SEEK_CUR), 20 * RAMDISK_SECTOR_SIZE);
+
+    /* One multi-sector call, no bounce */
+    uassert_int_equal(read_calls, 1);
+    uassert_int_equal(max_sectors, 16);
+
+    close(fd);
+}
+
+static void test_blk_fops_unaligned_rw(void)
+{
+    int fd;
+    off_t pos = 3 * RAMDISK_SECTOR_SIZE + 100;
+    size_t count = 6 * RAMDISK_SECTOR_SIZE + 50;
+
+    fd = open(RAMDISK_PATH, O_RDWR, 0);
+    uassert_true(fd >= 0);
+    if (fd < 0)
+    {
+        return;
+    }
+
+    /* The head, the tail and the middle all land at odd addresses */
+    ramdisk_reset_stat();
+    lseek(fd, pos, SEEK_SET);
+    uassert_int_equal(read(fd, buffer + 1, count), count);
+    uassert_buf_equal(buffer + 1, &golden[pos], count);
+    uassert_int_equal(lseek(fd, 0, SEEK_CUR), pos + count);
+    uassert_int_equal(misaligned, 0);
+
+    /* The bytes around the range are kept */
+    ramdisk_reset_stat();
+    rt_memset(buffer + 3, 0x5a, count);
+    lseek(fd, pos, SEEK_SET);
+    uassert_int_equal(write(fd, buffer + 3, count), count);
+    uassert_int_equal(lseek(fd, 0, SEEK_CUR), pos + count);
+    uassert_int_equal(misaligned, 0);
+
+    rt_memset(&golden[pos], 0x5a, count);
+    uassert_buf_equal(ramdisk_data, golden, RAMDISK_SIZE);
+
+    close(fd);
+}
+
+static void test_blk_fops_direct_invalid(void)
+{
+#ifdef O_DIRECT
+    int fd;
+
+    fd = open(RAMDISK_PATH, O_RDWR | O_DIRECT, 0);
+    uassert_true(fd >= 0);
+    if (fd < 0)
+    {
+        return;
+    }
+
+    ramdisk_reset_stat();
+
+    /* Unaligned position */
+    lseek(fd, 100, SEEK_SET);
+    uassert_int_equal(read(fd, buffer, RAMDISK_SECTOR_SIZE), -1);
+    uassert_int_equal(errno, EINVAL);
+
+    /* Unaligned size */
+    lseek(fd, 0, SEEK_SET);
+    uassert_int_equal(write(fd, buffer, RAMDISK_SECTOR_SIZE + 1), -1);
+    uassert_int_equal(errno, EINVAL);
+
+    /* Unaligned buffer */
+    uassert_int_equal(read(fd, buffer + 1, RAMDISK_SECTOR_SIZE), -1);
+    uassert_int_equal(errno, EINVAL);
+
+    /* None of them reached the disk or moved the position */
+    uassert_int_equal(read_calls + write_calls, 0);
+    uassert_int_equal(lseek(fd, 0, SEEK_CUR), 0);
+
+    uassert_int_equal(read(fd, buffer, 2 * RAMDISK_SECTOR_SIZE), 2 * RAMDISK_SECTOR_SIZE);
+    uassert_buf_equal(buffer, golden, 2 * RAMDISK_SECTOR_SIZE);
+
+    close(fd);
+#else
+    LOG_W("O_DIRECT is not supported by the libc");
+#endif /* O_DIRECT */
+}
+
+static rt_err_t utest_tc_init(void)
+{
+    for (int i = 0; i < sizeof(ramdisk_data); ++i)
+    {
+        ramdisk_data[i] = (rt_uint8_t)(i * 13 + 5);
+    }
+    rt_memcpy(golden, ramdisk_data, sizeof(golden));
+
+    rt_memset(&ramdisk, 0, sizeof(ramdisk));
+    ramdisk.ida = &ramdisk_ida;
+    rt_dm_dev_set_name(&ramdisk.parent, RAMDISK_NAME);
+    ramdisk.ops = &ramdisk_ops;
+    ramdisk.parallel_io = RT_TRUE;
+    ramdisk.max_partitions = RT_BLK_PARTITION_NONE;
+#ifdef RT_BLK_USING_CACHE
+    /* Counts the requests of the file operations, not of a cache */
+    ramdisk.cache_sectors = -1;
+#endif
+
+    return rt_hw_blk_disk_register(&ramdisk);
+}
+
+static rt_err_t utest_tc_cleanup(void)
+{
+    return rt_hw_blk_disk_unregister(&ramdisk);
+}
+
+static void testcase(void)
+{
+    UTEST_UNIT_RUN(test_blk_fops_aligned_read);
+    UTEST_UNIT_RUN(test_blk_fops_unaligned_rw);
+    UTEST_UNIT_RUN(test_blk_fops_direct_invalid);
+}
+UTEST_TC_EXPORT(testcase, "testcases.drivers.blk_dfs_tc", utest_tc_init, utest_tc_cleanup, 10);
@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include "utest.h"
+
+/**
+ * @brief   Block multi-queue request layer testcase.
+ *
+ * @note    A RAM disk with the batch submit op is registered, the plugged
+ *          requests of the adjacent sectors must reach the driver merged,
+ *          and every request must complete with its own sectors.
+ */
+
+#define RAMDISK_SECTOR_SIZE     512
+#define RAMDISK_SECTORS         64
+#define PLUG_REQS               8
+
+static struct rt_blk_disk ramdisk;
+static rt_uint8_t ramdisk_data[RAMDISK_SECTORS * RAMDISK_SECTOR_SIZE];
+static struct rt_dm_ida ramdisk_ida = RT_DM_IDA_INIT(CUSTOM);
+
+static rt_uint32_t submit_batches, submit_reqs, submit_segs;
+static rt_uint32_t done_count;
+static rt_ssize_t done_res[PLUG_REQS + 1];
+
+static void ramdisk_xfer(struct rt_blk_request *seg)
+{
+    void *data = &ramdisk_data[seg->sector * RAMDISK_SECTOR_SIZE];
+    rt_size_t size = seg->sector_count * RAMDISK_SECTOR_SIZE;
+
+    if (seg->op == RT_BLK_REQ_READ)
+    {
+        rt_memcpy(seg->buffer, data, size);
+    }
+    else
+    {
+        rt_memcpy(data, seg->buffer, size);
+    }
+}
+
+static rt_ssize_t ramdisk_read(struct rt_blk_disk *disk, rt_off_t sector,
+        void *buffer, rt_size_t sector_count)
+{
+    rt_memcpy(buffer, &ramdisk_data[sector * RAMDISK_SECTOR_SIZE],
+            sector_count * RAMDISK_SECTOR_SIZE);
+
+    return sector_count;
+}
+
+static rt_ssize_t ramdisk_write(struct rt_blk_disk *disk, rt_off_t sector,
+        const void *buffer, rt_size_t sector_count)
+{
+    rt_memcpy(&ramdisk_data[sector * RAMDISK_SECTOR_SIZE], buffer,
+            sector_count * RAMDISK_SECTOR_SIZE);
+
+    return sector_count;
+}
+
+static rt_err_t ramdisk_getgeome(struct rt_blk_disk *disk,
+        struct rt_device_blk_geometry *geometry)
+{
+    geometry->bytes_per_sector = RAMDISK_SECTOR_SIZE;
+    geometry->block_size = RAMDISK_SECTOR_SIZE;
+    geometry->sector_count = RAMDISK_SECTORS;
+
+    return RT_EOK;
+}
+
+static rt_err_t ramdisk_submit(struct rt_blk_disk *disk, int qid, rt_list_t *requests)
+{
+    struct rt_blk_request *req, *req_next, *seg;
+
+    ++submit_batches;
+
+    rt_list_for_each_entry_safe(req, req_next, requests, list)
+    {
+        rt_list_remove(&req->list);
+        ++submit_reqs;
+
+        rt_blk_request_for_each_segment(seg, req)
+        {
+            ramdisk_xfer(seg);
+            ++submit_segs;
+        }
+
+        rt_blk_request_complete(req, req->total_count);
+    }
+
+    return RT_EOK;
+}
+
+static const struct rt_blk_disk_ops ramdisk_ops =
+{
+    .read = ramdisk_read,
+    .write = ramdisk_write,
+    .getgeome = ramdisk_getgeome,
+    .submit = ramdisk_submit,
+};
+
+static void request_done(struct rt_blk_request *req, rt_ssize_t res)
+{
+    done_res[(rt_ubase_t)req->priv] = res;
+    ++done_count;
+}
+
+static void test_blk_mq_sync_rw(void)
+{
+    rt_ssize_t res;
+    static rt_uint8_t buffer[4 * RAMDISK_SECTOR_SIZE];
+
+    for (int i = 0; i < sizeof(buffer); ++i)
+    {
+        buffer[i] = (rt_uint8_t)(i * 7 + 1);
+    }
+
+    res = rt_device_write(&ramdisk.parent, 4, buffer, 4);
+    uassert_int_equal(res, 4);
+    uassert_buf_equal(&ramdisk_data[4 * RAMDISK_SECTOR_SIZE], buffer, sizeof(buffer));
+
+    rt_memset(buffer, 0, sizeof(buffer));
+    res = rt_device_read(&ramdisk.parent, 4, buffer, 4);
+    uassert_int_equal(res, 4);
+    uassert_buf_equal(&ramdisk_data[4 * RAMDISK_SECTOR_SIZE], buffer, sizeof(buffer));
+}
+
+static void test_blk_mq_plug_merge(void)
+{
+    rt_err_t err;
+    struct rt_blk_plug plug;
+    struct rt_blk_request reqs[PLUG_REQS + 1];
+    static rt_uint8_t buffers[PLUG_REQS + 1][RAMDISK_SECTOR_SIZE];
+
+    submit_batches = submit_reqs = submit_segs = done_count = 0;
+
+    rt_blk_start_plug(&plug);
+
+    for (int i = 0; i <= PLUG_REQS; ++i)
+    {
+        /* The last one is far away from the others */
+        rt_off_t sector = i < PLUG_REQS ? 16 + i : 48;
+
+        rt_memset(buffers[i], i + 1, RAMDISK_SECTOR_SIZE);
+        done_res[i] = 0;
+
+        rt_blk_request_init(&reqs[i], &ramdisk, RT_BLK_REQ_WRITE, sector,
+                buffers[i], 1, request_done, (void *)(rt_ubase_t)i);
+
+        err = rt_blk_submit(&reqs[i], &plug);
+        uassert_int_equal(err, RT_EOK);
+    }
+
+    /* Nothing is dispatched until the plug is finished */
+    uassert_int_equal(submit_reqs, 0);
+
+    rt_blk_finish_plug(&plug);
+
+    uassert_int_equal(done_count, PLUG_REQS + 1);
+    uassert_int_equal(submit_reqs, 2);
+    uassert_int_equal(submit_segs, PLUG_REQS + 1);
+
+    for (int i = 0; i <= PLUG_REQS; ++i)
+    {
+        rt_off_t sector = i < PLUG_REQS ? 16 + i : 48;
+
+        uassert_int_equal(done_res[i], 1);
+        uassert_buf_equal(&ramdisk_data[sector * RAMDISK_SECTOR_SIZE],
+                buffers[i], RAMDISK_SECTOR_SIZE);
+    }
+}
+
+static void test_blk_mq_read_only(void)
+{
+    struct rt_blk_request req;
+    static rt_uint8_t buffer[RAMDISK_SECTOR_SIZE];
+
+    ramdisk.read_only = RT_TRUE;
+
+    rt_blk_request_init(&req, &ramdisk, RT_BLK_REQ_WRITE, 0, buffer, 1,
+            request_done, RT_NULL);
+    uassert_int_equal(rt_blk_submit(&req, RT_NULL), -RT_ENOSYS);
+
+    ramdisk.read_only = RT_FALSE;
+}
+
+static rt_err_t utest_tc_init(void)
+{
+    rt_err_t err;
+
+    rt_memset(&ramdisk, 0, sizeof(ramdisk));
+    ramdisk.ida = &ramdisk_ida;
+    rt_dm_dev_set_name(&ramdisk.parent, "mqram");
+    ramdisk.ops = &ramdisk_ops;
+    ramdisk.parallel_io = RT_TRUE;
+    ramdisk.max_partitions = RT_BLK_PARTITION_NONE;
+#ifdef RT_BLK_USING_CACHE
+    /* The writes are checked on the disk at once */
+    ramdisk.cache_sectors = -1;
+#endif
+
+    if ((err = rt_hw_blk_disk_register(&ramdisk)))
+    {
+        return err;
+    }
+
+    return rt_device_open(&ramdisk.parent, RT_DEVICE_OFLAG_RDWR);
+}
+
+static rt_err_t utest_tc_cleanup(void)
+{
+    rt_device_close(&ramdisk.parent);
+
+    return rt_hw_blk_disk_unregister(&ramdisk);
+}
+
+static void testcase(void)
+{
+    UTEST_UNIT_RUN(test_blk_mq_sync_rw);
+    UTEST_UNIT_RUN(test_blk_mq_plug_merge);
+    UTEST_UNIT_RUN(test_blk_mq_read_only);
+}
+UTEST_TC_EXPORT(testcase, "testcases.drivers.blk_mq_tc", utest_tc_init, utest_tc_cleanup, 10);
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include "utest.h"
+
+/**
+ * @brief   NVMe synchronous commands testcase.
+ *
+ * @note    Several threads read and flush the first namespace at the same
+ *          time, their synchronous commands share the I/O queues (one queue
+ *          only if the controller has one vector). Every command must come
+ *          back with its own data, none of the waiters may be left behind.
+ *          The disk is only read, it is safe to run on a real one.
+ */
+
+#define NVME_TC_DISK            "nvme0n1"
+#define NVME_TC_THREADS         4
+#define NVME_TC_LOOPS           128
+#define NVME_TC_SECTORS         16
+
+static rt_device_t disk;
+static rt_uint32_t sector_size;
+static rt_uint8_t *golden;
+static struct rt_semaphore finished;
+static rt_atomic_t failures;
+
+static void nvme_tc_reader(void *param)
+{
+    rt_uint8_t *buffer;
+    rt_ubase_t id = (rt_ubase_t)param;
+
+    if (!(buffer = rt_malloc(sector_size)))
+    {
+        rt_atomic_add(&failures, 1);
+        rt_sem_release(&finished);
+        return;
+    }
+
+    for (int i = 0; i < NVME_TC_LOOPS; ++i)
+    {
+        rt_off_t sector = (id * 7 + i * 3) % NVME_TC_SECTORS;
+
+        if (rt_device_read(disk, sector, buffer, 1) != 1 ||
+            rt_memcmp(buffer, &golden[sector * sector_size], sector_size))
+        {
+            rt_atomic_add(&failures, 1);
+        }
+
+        if (i % 16 == id && rt_device_control(disk, RT_DEVICE_CTRL_BLK_SYNC, RT_NULL))
+        {
+            rt_atomic_add(&failures, 1);
+        }
+    }
+
+    rt_free(buffer);
+    rt_sem_release(&finished);
+}
+
+static void test_nvme_parallel_sync_cmds(void)
+{
+    rt_thread_t tid;
+    rt_uint8_t priority = RT_SCHED_PRIV(rt_thread_self()).current_priority;
+
+    rt_atomic_store(&failures, 0);
+
+    for (rt_ubase_t i = 0; i < NVME_TC_THREADS; ++i)
+    {
+        tid = rt_thread_create("nvme_tc", nvme_tc_reader, (void *)i,
+                UTEST_THR_STACK_SIZE, priority, 10);
+        uassert_not_null(tid);
+
+        if (tid)
+        {
+            rt_thread_startup(tid);
+        }
+        else
+        {
+            rt_sem_release(&finished);
+        }
+    }
+
+    for (int i = 0; i < NVME_TC_THREADS; ++i)
+    {
+        /* A lost completion leaves its reader blocked forever */
+        uassert_int_equal(rt_sem_take(&finished, rt_tick_from_millisecond(20000)), RT_EOK);
+    }
+
+    uassert_int_equal(rt_atomic_load(&failures), 0);
+}
+
+static rt_err_t utest_tc_init(void)
+{
+    rt_err_t err;
+    struct rt_device_blk_geometry geometry;
+
+    if (!(disk = rt_device_find(NVME_TC_DISK)))
+    {
+        LOG_W("%s not found", NVME_TC_DISK);
+        return -RT_ENOSYS;
+    }
+
+    if ((err = rt_device_open(disk, RT_DEVICE_OFLAG_RDONLY)))
+    {
+        return err;
+    }
+
+    rt_device_control(disk, RT_DEVICE_CTRL_BLK_GETGEOME, &geometry);
+    sector_size = geometry.bytes_per_sector;
+
+    if (!(golden = rt_malloc(sector_size * NVME_TC_SECTORS)))
+    {
+        rt_device_close(disk);
+        return -RT_ENOMEM;
+    }
+
+    if (rt_device_read(disk, 0, golden, NVME_TC_SECTORS) != NVME_TC_SECTORS)
+    {
+        rt_free(golden);
+        rt_device_close(disk);
+        return -RT_EIO;
+    }
+
+    return rt_sem_init(&finished, "nvme_tc", 0, RT_IPC_FLAG_PRIO);
+}
+
+static rt_err_t utest_tc_cleanup(void)
+{
+    rt_sem_detach(&finished);
+    rt_free(golden);
+
+    return rt_device_close(disk);
+}
+
+static void testcase(void)
+{
+    UTEST_UNIT_RUN(test_nvme_parallel_sync_cmds);
+}
+UTEST_TC_EXPORT(testcase, "testcases.drivers.nvme_tc", utest_tc_init, utest_tc_cleanup, 30);
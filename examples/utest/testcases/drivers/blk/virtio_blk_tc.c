@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include "utest.h"
+
+/**
+ * @brief   virtio-blk queued requests testcase.
+ *
+ * @note    Several threads read the first sectors of the disk at the same
+ *          time, so requests of different callers are outstanding on the
+ *          ring together. Every request must come back with its own data,
+ *          none of the callers may be left behind. One large read is split
+ *          into a batch of requests, it must match the sectors read one by
+ *          one. The disk is only read, it is safe to run on the root disk.
+ */
+
+#define VIRTIO_BLK_TC_DISK      "virtio-blk0"
+#define VIRTIO_BLK_TC_THREADS   4
+#define VIRTIO_BLK_TC_LOOPS     256
+#define VIRTIO_BLK_TC_SECTORS   256
+
+static rt_device_t disk;
+static rt_uint32_t sector_size;
+static rt_uint8_t *golden;
+static struct rt_semaphore finished;
+static rt_atomic_t failures;
+
+static void virtio_blk_tc_worker(void *param)
+{
+    rt_uint8_t *buffer;
+    rt_ubase_t id = (rt_ubase_t)param;
+
+    if (!(buffer = rt_malloc(sector_size * 4)))
+    {
+        rt_atomic_add(&failures, 1);
+        rt_sem_release(&finished);
+        return;
+    }
+
+    for (int i = 0; i < VIRTIO_BLK_TC_LOOPS; ++i)
+    {
+        rt_size_t count = (i % 4) + 1;
+        rt_off_t sector = (id * 61 + i * 7) % (VIRTIO_BLK_TC_SECTORS - count);
+
+        if (rt_device_read(disk, sector, buffer, count) != count ||
+            rt_memcmp(buffer, &golden[sector * sector_size], count * sector_size))
+        {
+            rt_atomic_add(&failures, 1);
+        }
+    }
+
+    rt_free(buffer);
+    rt_sem_release(&finished);
+}
+
+static void test_virtio_blk_parallel_requests(void)
+{
+    rt_thread_t tid;
+    rt_uint8_t priority = RT_SCHED_PRIV(rt_thread_self()).current_priority;
+
+    rt_atomic_store(&failures, 0);
+
+    for (rt_ubase_t i = 0; i < VIRTIO_BLK_TC_THREADS; ++i)
+    {
+        tid = rt_thread_create("vblk_tc", virtio_blk_tc_worker, (void *)i,
+                UTEST_THR_STACK_SIZE, priority, 10);
+        uassert_not_null(tid);
+
+        if (tid)
+        {
+            rt_thread_startup(tid);
+        }
+        else
+        {
+            rt_sem_release(&finished);
+        }
+    }
+
+    for (int i = 0; i < VIRTIO_BLK_TC_THREADS; ++i)
+    {
+        /* A lost completion leaves its caller blocked forever */
+        uassert_int_equal(rt_sem_take(&finished, rt_tick_from_millisecond(20000)), RT_EOK);
+    }
+
+    uassert_int_equal(rt_atomic_load(&failures), 0);
+}
+
+static void test_virtio_blk_batch_read(void)
+{
+    rt_uint8_t *buffer;
+    rt_size_t size = sector_size * VIRTIO_BLK_TC_SECTORS;
+
+    uassert_not_null(buffer = rt_malloc(size + 1));
+    if (!buffer)
+    {
+        return;
+    }
+
+    /* Unaligned on purpose, the segments split at every page */
+    rt_memset(buffer, 0, size + 1);
+    uassert_int_equal(rt_device_read(disk, 0, buffer + 1, VIRTIO_BLK_TC_SECTORS), VIRTIO_BLK_TC_SECTORS);
+    uassert_buf_equal(buffer + 1, golden, size);
+
+    rt_free(buffer);
+}
+
+static rt_err_t utest_tc_init(void)
+{
+    rt_err_t err;
+    rt_uint8_t *sector;
+    struct rt_device_blk_geometry geometry;
+
+    if (!(disk = rt_device_find(VIRTIO_BLK_TC_DISK)))
+    {
+        LOG_W("%s not found", VIRTIO_BLK_TC_DISK);
+        return -RT_ENOSYS;
+    }
+
+    if ((err = rt_device_open(disk, RT_DEVICE_OFLAG_RDONLY)))
+    {
+        return err;
+    }
+
+    rt_device_control(disk, RT_DEVICE_CTRL_BLK_GETGEOME, &geometry);
+    sector_size = geometry.bytes_per_sector;
+
+    if (!(golden = rt_malloc(sector_size * VIRTIO_BLK_TC_SECTORS)))
+    {
+        rt_device_close(disk);
+        return -RT_ENOMEM;
+    }
+
+    /* The golden copy is read one sector at a time */
+    for (int i = 0; i < VIRTIO_BLK_TC_SECTORS; ++i)
+    {
+        sector = &golden[i * sector_size];
+
+        if (rt_device_read(disk, i, sector, 1) != 1)
+        {
+            rt_free(golden);
+            rt_device_close(disk);
+            return -RT_EIO;
+        }
+    }
+
+    return rt_sem_init(&finished, "vblk_tc", 0, RT_IPC_FLAG_PRIO);
+}
+
+static rt_err_t utest_tc_cleanup(void)
+{
+    rt_sem_detach(&finished);
+    rt_free(golden);
+
+    return rt_device_close(disk);
+}
+
+static void testcase(void)
+{
+    UTEST_UNIT_RUN(test_virtio_blk_parallel_requests);
+    UTEST_UNIT_RUN(test_virtio_blk_batch_read);
+}
+UTEST_TC_EXPORT(testcase, "testcases.drivers.virtio_blk_tc", utest_tc_init, utest_tc_cleanup, 60);
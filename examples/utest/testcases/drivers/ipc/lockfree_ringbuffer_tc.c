@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ */
+
+/**
+ * Test Case for the lock-free ring buffers
+ *
+ * - spsc: a hard timer (ISR context) produces a counting byte stream, the
+ *   test thread consumes it by copy and in place, no byte may be lost,
+ *   duplicated or reordered.
+ * - mpsc: several threads and a hard timer put sequenced records, the
+ *   test thread checks the order per producer and the payload.
+ */
+
+#include "utest.h"
+
+#include <rtdevice.h>
+#include <rtthread.h>
+
+#define TEST_SPSC_BYTES     (64 * 1024)
+#define TEST_MPSC_THREADS   3
+#define TEST_MPSC_RECORDS   2000
+
+static struct rt_spsc_ringbuffer _spsc;
+static rt_uint8_t _spsc_pool[128];
+static rt_uint32_t _spsc_produced;
+
+static struct rt_mpsc_ringbuffer _mpsc;
+static rt_align(sizeof(rt_atomic_t)) rt_uint8_t _mpsc_pool[512];
+static struct rt_semaphore _thr_exit_sem;
+static volatile rt_bool_t _timer_stop;
+
+struct test_record
+{
+    rt_uint32_t id;
+    rt_uint32_t seq;
+    rt_uint8_t payload[16];
+};
+
+static void _spsc_timeout(void *parameter)
+{
+    rt_uint8_t *ptr;
+    rt_size_t size, i;
+
+    /* fill as much as possible in place, at most until the wrap */
+    size = rt_spsc_ringbuffer_reserve(&_spsc, &ptr, TEST_SPSC_BYTES - _spsc_produced);
+    for (i = 0; i < size; i++)
+    {
+        ptr[i] = (rt_uint8_t)(_spsc_produced + i);
+    }
+    rt_spsc_ringbuffer_commit(&_spsc, size);
+    _spsc_produced += size;
+}
+
+static void test_spsc(void)
+{
+    rt_timer_t timer;
+    rt_uint8_t buf[23], *ptr;
+    rt_uint32_t consumed = 0;
+    rt_size_t size, i;
+    rt_tick_t start = rt_tick_get();
+
+    rt_spsc_ringbuffer_init(&_spsc, _spsc_pool, sizeof(_spsc_pool));
+    _spsc_produced = 0;
+
+    timer = rt_timer_create("spsc", _spsc_timeout, RT_NULL, 1, RT_TIMER_FLAG_PERIODIC | RT_TIMER_FLAG_HARD_TIMER);
+    uassert_not_null(timer);
+    if (!timer)
+        return;
+    rt_timer_start(timer);
+
+    while (consumed < TEST_SPSC_BYTES && rt_tick_get() - start < 30 * RT_TICK_PER_SECOND)
+    {
+        if (consumed & 1)
+        {
+            size = rt_spsc_ringbuffer_get(&_spsc, buf, sizeof(buf));
+            ptr = buf;
+        }
+        else
+        {
+            size = rt_spsc_ringbuffer_peek(&_spsc, &ptr);
+        }
+
+        for (i = 0; i < size; i++)
+        {
+            if (ptr[i] != (rt_uint8_t)(consumed + i))
+                break;
+        }
+        uassert_int_equal(i, size);
+        if (i != size)
+            break;
+
+        if (ptr != buf)
+        {
+            rt_spsc_ringbuffer_consume(&_spsc, size);
+        }
+        consumed += size;
+
+        if (size == 0)
+        {
+            rt_thread_mdelay(1);
+        }
+    }
+
+    rt_timer_stop(timer);
+    rt_timer_delete(timer);
+    uassert_int_equal(consumed, TEST_SPSC_BYTES);
+}
+
+static void _mpsc_put(rt_uint32_t id, rt_uint32_t seq)
+{
+    struct test_record *rec;
+    int i;
+
+    rec = rt_mpsc_ringbuffer_reserve(&_mpsc, sizeof(*rec));
+    if (rec)
+    {
+        rec->id = id;
+        rec->seq = seq;
+        for (i = 0; i < sizeof(rec->payload); i++)
+        {
+            rec->payload[i] = (rt_uint8_t)(id + seq + i);
+        }
+        rt_mpsc_ringbuffer_commit(&_mpsc, rec);
+    }
+}
+
+static void _mpsc_producer(void *parameter)
+{
+    rt_uint32_t id = (rt_uint32_t)(rt_ubase_t)parameter;
+    struct test_record rec;
+    rt_uint32_t seq = 0;
+    int i;
+
+    rec.id = id;
+    while (seq < TEST_MPSC_RECORDS)
+    {
+        rec.seq = seq;
+        for (i = 0; i < sizeof(rec.payload); i++)
+        {
+            rec.payload[i] = (rt_uint8_t)(id + seq + i);
+        }
+
+        if (rt_mpsc_ringbuffer_put(&_mpsc, &rec, sizeof(rec)) == sizeof(rec))
+        {
+            seq++;
+        }
+        else
+        {
+            rt_thread_yield();
+        }
+    }
+
+    rt_sem_release(&_thr_exit_sem);
+}
+
+static void _mpsc_timeout(void *parameter)
+{
+    static rt_uint32_t seq;
+
+    /* the timer may lose records when it's full, only the order counts */
+    if (!_timer_stop)
+    {
+        _mpsc_put(TEST_MPSC_THREADS, seq++);
+    }
+}
+
+static void test_mpsc(void)
+{
+    rt_uint32_t next[TEST_MPSC_THREADS + 1] = {0};
+    rt_uint32_t received = 0;
+    struct test_record *rec;
+    rt_thread_t tid;
+    rt_timer_t timer;
+    rt_size_t size;
+    rt_tick_t start = rt_tick_get();
+    int i;
+
+    rt_mpsc_ringbuffer_init(&_mpsc, _mpsc_pool, sizeof(_mpsc_pool));
+    _timer_stop = RT_FALSE;
+
+    timer = rt_timer_create("mpsc", _mpsc_timeout, RT_NULL, 1, RT_TIMER_FLAG_PERIODIC | RT_TIMER_FLAG_HARD_TIMER);
+    uassert_not_null(timer);
+    if (!timer)
+        return;
+    rt_timer_start(timer);
+
+    for (i = 0; i < TEST_MPSC_THREADS; i++)
+    {
+        tid = rt_thread_create("mpsc", _mpsc_producer, (void *)(rt_ubase_t)i,
+                               UTEST_THR_STACK_SIZE, UTEST_THR_PRIORITY + 1, 2);
+        uassert_not_null(tid);
+        if (tid)
+            rt_thread_startup(tid);
+    }
+
+    while (received < TEST_MPSC_THREADS * TEST_MPSC_RECORDS && rt_tick_get() - start < 30 * RT_TICK_PER_SECOND)
+    {
+        rec = rt_mpsc_ringbuffer_peek(&_mpsc, &size);
+        if (!rec)
+        {
+            rt_thread_mdelay(1);
+            continue;
+        }
+
+        uassert_int_equal(size, sizeof(*rec));
+        uassert_true(rec->id <= TEST_MPSC_THREADS);
+        if (rec->id < TEST_MPSC_THREADS)
+        {
+            uassert_int_equal(rec->seq, next[rec->id]);
+            next[rec->id] = rec->seq + 1;
+            received++;
+        }
+        else
+        {
+            uassert_true(rec->seq >= next[rec->id]);
+            next[rec->id] = rec->seq + 1;
+        }
+        for (i = 0; i < sizeof(rec->payload); i++)
+        {
+            if (rec->payload[i] != (rt_uint8_t)(rec->id + rec->seq + i))
+                break;
+        }
+        uassert_int_equal(i, sizeof(rec->payload));
+
+        rt_mpsc_ringbuffer_consume(&_mpsc);
+    }
+
+    _timer_stop = RT_TRUE;
+    rt_timer_stop(timer);
+    rt_timer_delete(timer);
+
+    for (i = 0; i < TEST_MPSC_THREADS; i++)
+    {
+        rt_sem_take(&_thr_exit_sem, RT_WAITING_FOREVER);
+    }
+    uassert_int_equal(received, TEST_MPSC_THREADS * TEST_MPSC_RECORDS);
+}
+
+static rt_err_t utest_tc_init(void)
+{
+    rt_sem_init(&_thr_exit_sem, "test", 0, RT_IPC_FLAG_PRIO);
+    return RT_EOK;
+}
+
+static rt_err_t utest_tc_cleanup(void)
+{
+    rt_sem_detach(&_thr_exit_sem);
+    return RT_EOK;
+}
+
+static void testcase(void)
+{
+    UTEST_UNIT_RUN(test_spsc);
+    UTEST_UNIT_RUN(test_mpsc);
+}
+UTEST_TC_EXPORT(testcase, "testcases.drivers.ipc.lockfree_ringbuffer",
+                utest_tc_init, utest_tc_cleanup, 60);
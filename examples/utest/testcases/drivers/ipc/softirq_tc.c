@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ */
+
+/**
+ * Test Case for the softirq and tasklet
+ *
+ * - isr: a hard timer (ISR context) schedules a normal tasklet twice and a
+ *   high priority one, each runs once, the high priority one first.
+ * - thread: a tasklet scheduled from a thread runs on the same CPU, and it
+ *   may schedule itself again from its own callback.
+ * - kill: rt_tasklet_kill() returns only after the tasklet has run.
+ */
+
+#include "utest.h"
+
+#include <rtdevice.h>
+#include <rtthread.h>
+
+#define TEST_RESCHED_COUNT  5
+
+static struct rt_tasklet _tasklet, _tasklet_hi;
+static struct rt_timer _timer;
+static struct rt_semaphore _done_sem;
+static volatile int _order[4], _order_nr;
+static volatile int _runs, _run_cpu, _resched_left;
+
+static void _record_tasklet(struct rt_tasklet *tasklet, void *data)
+{
+    if (_order_nr < 4)
+    {
+        _order[_order_nr++] = (int)(rt_ubase_t)data;
+    }
+    rt_sem_release(&_done_sem);
+}
+
+static void _timer_isr(void *parameter)
+{
+    rt_tasklet_schedule(&_tasklet);
+    rt_tasklet_schedule(&_tasklet);
+    rt_tasklet_hi_schedule(&_tasklet_hi);
+}
+
+static void test_tasklet_isr(void)
+{
+    _order_nr = 0;
+    rt_tasklet_init(&_tasklet, _record_tasklet, (void *)1);
+    rt_tasklet_init(&_tasklet_hi, _record_tasklet, (void *)2);
+
+    rt_timer_init(&_timer, "sirq_tc", _timer_isr, RT_NULL, 1,
+            RT_TIMER_FLAG_ONE_SHOT | RT_TIMER_FLAG_HARD_TIMER);
+    rt_timer_start(&_timer);
+
+    uassert_int_equal(rt_sem_take(&_done_sem, RT_TICK_PER_SECOND), RT_EOK);
+    uassert_int_equal(rt_sem_take(&_done_sem, RT_TICK_PER_SECOND), RT_EOK);
+    /* Queued once however many times it is scheduled */
+    uassert_int_not_equal(rt_sem_take(&_done_sem, RT_TICK_PER_SECOND / 10), RT_EOK);
+
+    uassert_int_equal(_order_nr, 2);
+    uassert_int_equal(_order[0], 2);
+    uassert_int_equal(_order[1], 1);
+
+    rt_timer_detach(&_timer);
+}
+
+static void _resched_tasklet(struct rt_tasklet *tasklet, void *data)
+{
+    ++_runs;
+    _run_cpu = (int)rt_cpu_get_id();
+
+    if (--_resched_left > 0)
+    {
+        rt_tasklet_schedule(tasklet);
+    }
+    else
+    {
+        rt_sem_release(&_done_sem);
+    }
+}
+
+static void test_tasklet_thread(void)
+{
+    int cpu;
+    rt_base_t level;
+
+    _runs = 0;
+    _run_cpu = -1;
+    _resched_left = TEST_RESCHED_COUNT;
+    rt_tasklet_init(&_tasklet, _resched_tasklet, RT_NULL);
+
+    level = rt_hw_local_irq_disable();
+    cpu = (int)rt_cpu_get_id();
+    rt_tasklet_schedule(&_tasklet);
+    rt_hw_local_irq_enable(level);
+
+    uassert_int_equal(rt_sem_take(&_done_sem, RT_TICK_PER_SECOND), RT_EOK);
+    uassert_int_equal(_runs, TEST_RESCHED_COUNT);
+    uassert_int_equal(_run_cpu, cpu);
+
+    rt_tasklet_kill(&_tasklet);
+}
+
+static void test_tasklet_kill(void)
+{
+    _runs = 0;
+    _resched_left = 1;
+    rt_tasklet_init(&_tasklet, _resched_tasklet, RT_NULL);
+
+    rt_tasklet_schedule(&_tasklet);
+    rt_tasklet_kill(&_tasklet);
+
+    uassert_int_equal(_runs, 1);
+    uassert_int_equal(rt_atomic_load(&_tasklet.state), 0);
+
+    rt_sem_take(&_done_sem, RT_WAITING_NO);
+}
+
+static rt_err_t utest_tc_init(void)
+{
+    return rt_sem_init(&_done_sem, "sirq_tc", 0, RT_IPC_FLAG_FIFO);
+}
+
+static rt_err_t utest_tc_cleanup(void)
+{
+    return rt_sem_detach(&_done_sem);
+}
+
+static void testcase(void)
+{
+    UTEST_UNIT_RUN(test_tasklet_isr);
+    UTEST_UNIT_RUN(test_tasklet_thread);
+    UTEST_UNIT_RUN(test_tasklet_kill);
+}
+UTEST_TC_EXPORT(testcase, "testcases.drivers.ipc.softirq", utest_tc_init, utest_tc_cleanup, 10);
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ */
+
+/**
+ * Test Case for the concurrency managed workqueue
+ *
+ * - blocking: a work item blocks on a semaphore, the items submitted
+ *   after it still run because another worker is spawned.
+ * - max_active: the unbound pool never runs more items at the same time
+ *   than its limit.
+ * - cancel_sync: returns only after the running item is done.
+ */
+
+#include "utest.h"
+
+#include <rtdevice.h>
+#include <rtthread.h>
+
+#define TEST_MAX_ACTIVE     2
+#define TEST_WORKS          6
+
+static struct rt_semaphore _block_sem, _done_sem;
+static rt_atomic_t _active, _active_max, _done;
+
+static void _blocking_work(struct rt_work *work, void *work_data)
+{
+    rt_sem_take(&_block_sem, RT_WAITING_FOREVER);
+    rt_atomic_add(&_done, 1);
+    rt_sem_release(&_done_sem);
+}
+
+static void _counting_work(struct rt_work *work, void *work_data)
+{
+    rt_atomic_t active = rt_atomic_add(&_active, 1) + 1;
+    rt_atomic_t max = rt_atomic_load(&_active_max);
+
+    while (active > max && !rt_atomic_compare_exchange_strong(&_active_max, &max, active))
+    {
+    }
+
+    rt_thread_mdelay((rt_int32_t)(rt_ubase_t)work_data);
+
+    rt_atomic_sub(&_active, 1);
+    rt_atomic_add(&_done, 1);
+    rt_sem_release(&_done_sem);
+}
+
+static void test_pool_blocking(void)
+{
+    struct rt_workqueue *queue;
+    struct rt_work blocking, works[TEST_WORKS];
+
+    queue = rt_workqueue_create_pool("wq_tc", 2048, RT_THREAD_PRIORITY_MAX / 2,
+            RT_WORKQUEUE_FLAG_PERCPU, TEST_WORKS + 1);
+    uassert_not_null(queue);
+
+    rt_atomic_store(&_done, 0);
+
+    rt_work_init(&blocking, _blocking_work, RT_NULL);
+    uassert_int_equal(rt_workqueue_dowork(queue, &blocking), RT_EOK);
+
+    for (int i = 0; i < TEST_WORKS; ++i)
+    {
+        rt_work_init(&works[i], _counting_work, (void *)1);
+        uassert_int_equal(rt_workqueue_dowork(queue, &works[i]), RT_EOK);
+    }
+
+    /* Not stalled behind the blocking one */
+    for (int i = 0; i < TEST_WORKS; ++i)
+    {
+        uassert_int_equal(rt_sem_take(&_done_sem, RT_TICK_PER_SECOND), RT_EOK);
+    }
+    uassert_int_equal(rt_atomic_load(&_done), TEST_WORKS);
+
+    rt_sem_release(&_block_sem);
+    uassert_int_equal(rt_sem_take(&_done_sem, RT_TICK_PER_SECOND), RT_EOK);
+
+    uassert_int_equal(rt_workqueue_destroy(queue), RT_EOK);
+}
+
+static void test_pool_max_active(void)
+{
+    struct rt_workqueue *queue;
+    struct rt_work works[TEST_WORKS];
+
+    queue = rt_workqueue_create_pool("wq_tc", 2048, RT_THREAD_PRIORITY_MAX / 2,
+            RT_WORKQUEUE_FLAG_UNBOUND, TEST_MAX_ACTIVE);
+    uassert_not_null(queue);
+
+    rt_atomic_store(&_done, 0);
+    rt_atomic_store(&_active_max, 0);
+
+    for (int i = 0; i < TEST_WORKS; ++i)
+    {
+        rt_work_init(&works[i], _counting_work, (void *)20);
+        uassert_int_equal(rt_workqueue_dowork(queue, &works[i]), RT_EOK);
+    }
+
+    for (int i = 0; i < TEST_WORKS; ++i)
+    {
+        uassert_int_equal(rt_sem_take(&_done_sem, RT_TICK_PER_SECOND), RT_EOK);
+    }
+
+    uassert_true(rt_atomic_load(&_active_max) <= TEST_MAX_ACTIVE);
+    /* Sleeping items are blocked, more than one runs at a time */
+    uassert_true(rt_atomic_load(&_active_max) > 1);
+
+    uassert_int_equal(rt_workqueue_destroy(queue), RT_EOK);
+}
+
+static void test_pool_cancel_sync(void)
+{
+    struct rt_work work;
+    struct rt_workqueue *queue;
+
+    queue = rt_workqueue_create_pool("wq_tc", 2048, RT_THREAD_PRIORITY_MAX / 2,
+            RT_WORKQUEUE_FLAG_UNBOUND, 1);
+    uassert_not_null(queue);
+
+    rt_atomic_store(&_done, 0);
+
+    rt_work_init(&work, _counting_work, (void *)50);
+    uassert_int_equal(rt_workqueue_dowork(queue, &work), RT_EOK);
+    rt_thread_mdelay(10);
+
+    uassert_int_equal(rt_workqueue_cancel_work_sync(queue, &work), RT_EOK);
+    uassert_int_equal(rt_atomic_load(&_done), 1);
+    rt_sem_take(&_done_sem, RT_WAITING_NO);
+
+    uassert_int_equal(rt_workqueue_destroy(queue), RT_EOK);
+}
+
+static rt_err_t utest_tc_init(void)
+{
+    rt_sem_init(&_block_sem, "wq_blk", 0, RT_IPC_FLAG_FIFO);
+    rt_sem_init(&_done_sem, "wq_done", 0, RT_IPC_FLAG_FIFO);
+
+    return RT_EOK;
+}
+
+static rt_err_t utest_tc_cleanup(void)
+{
+    rt_sem_detach(&_block_sem);
+    rt_sem_detach(&_done_sem);
+
+    return RT_EOK;
+}
+
+static void testcase(void)
+{
+    UTEST_UNIT_RUN(test_pool_blocking);
+    UTEST_UNIT_RUN(test_pool_max_active);
+    UTEST_UNIT_RUN(test_pool_cancel_sync);
+}
+UTEST_TC_EXPORT(testcase, "testcases.drivers.ipc.workqueue_pool", utest_tc_init, utest_tc_cleanup, 30);
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ */
+
+#include <rtthread.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdev.h>
+#include "utest.h"
+
+/**
+ * @brief   virtio-net throughput benchmark.
+ *
+ * @note    Made for the virt machine of QEMU with user networking, where the
+ *          host is reachable at 10.0.2.2:
+ *          1. UDP datagrams of a full MTU are blasted to the discard port of
+ *             the server, this needs nothing on the host;
+ *          2. TCP is sent to the sink port of the server;
+ *          3. TCP is received from the source port of the server.
+ *          The TCP cases are skipped if nothing listens on the host, e.g.
+ *          start `nc -l 5001 > /dev/null` and `nc -l 5002 < /dev/zero`
+ *          before. The throughputs are printed for comparison only.
+ */
+
+#define BENCH_SERVER            UTEST_VIRTIO_NET_BENCH_SERVER
+#define BENCH_DISCARD_PORT      9
+#define BENCH_SINK_PORT         UTEST_VIRTIO_NET_BENCH_SINK_PORT
+#define BENCH_SOURCE_PORT       UTEST_VIRTIO_NET_BENCH_SOURCE_PORT
+#define BENCH_MS                3000
+#define BENCH_UDP_SIZE          1472
+#define BENCH_TCP_SIZE          (32 * 1024)
+
+static char *buffer;
+
+static void bench_report(const char *name, rt_uint64_t bytes, rt_uint32_t packets, rt_tick_t ms)
+{
+    /* bits per ms is kbit/s */
+    rt_uint32_t kbps = ms ? (rt_uint32_t)(bytes * 8 / ms) : 0;
+
+    rt_kprintf("virtio-net %s: %u bytes in %u ms, %u.%03u Mbit/s",
+            name, (rt_uint32_t)bytes, ms, kbps / 1000, kbps % 1000);
+
+    if (packets)
+    {
+        rt_kprintf(", %u pps", (rt_uint32_t)((rt_uint64_t)packets * 1000 / ms));
+    }
+
+    rt_kprintf("\n");
+}
+
+static int bench_socket(int type, int port, struct sockaddr_in *addr)
+{
+    int sock;
+    struct timeval tv = { .tv_sec = 1 };
+
+    if ((sock = socket(AF_INET, type, 0)) < 0)
+    {
+        return sock;
+    }
+
+    /* never hang the test on a stalled peer */
+    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    rt_memset(addr, 0, sizeof(*addr));
+    addr->sin_family = AF_INET;
+    addr->sin_port = htons(port);
+    addr->sin_addr.s_addr = inet_addr(BENCH_SERVER);
+
+    return sock;
+}
+
+static void test_virtio_net_udp_tx(void)
+{
+    int sock;
+    rt_tick_t start, ms;
+    rt_uint64_t bytes = 0;
+    rt_uint32_t packets = 0, drops = 0;
+    struct sockaddr_in addr;
+
+    sock = bench_socket(SOCK_DGRAM, BENCH_DISCARD_PORT, &addr);
+    uassert_true(sock >= 0);
+    if (sock < 0)
+    {
+        return;
+    }
+
+    start = rt_tick_get_millisecond();
+    while ((ms = rt_tick_get_millisecond() - start) < BENCH_MS)
+    {
+        if (sendto(sock, buffer, BENCH_UDP_SIZE, 0, (struct sockaddr *)&addr, sizeof(addr)) == BENCH_UDP_SIZE)
+        {
+            bytes += BENCH_UDP_SIZE;
+            packets++;
+        }
+        else
+        {
+            /* out of pbufs or descriptors, give the device a chance */
+            drops++;
+            rt_thread_yield();
+        }
+    }
+
+    closesocket(sock);
+
+    uassert_true(packets > 0);
+    bench_report("UDP tx", bytes, packets, ms);
+    rt_kprintf("virtio-net UDP tx: %u sends refused\n", drops);
+}
+
+static void test_virtio_net_tcp_tx(void)
+{
+    int sock, ret;
+    rt_tick_t start, ms;
+    rt_uint64_t bytes = 0;
+    struct sockaddr_in addr;
+
+    sock = bench_socket(SOCK_STREAM, BENCH_SINK_PORT, &addr);
+    uassert_true(sock >= 0);
+    if (sock < 0)
+    {
+        return;
+    }
+
+    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)))
+    {
+        LOG_W("No sink on %s:%d, skipped", BENCH_SERVER, BENCH_SINK_PORT);
+        closesocket(sock);
+        return;
+    }
+
+    start = rt_tick_get_millisecond();
+    while ((ms = rt_tick_get_millisecond() - start) < BENCH_MS)
+    {
+        if ((ret = send(sock, buffer, BENCH_TCP_SIZE, 0)) <= 0)
+        {
+            break;
+        }
+        bytes += ret;
+    }
+
+    closesocket(sock);
+
+    uassert_true(bytes > 0);
+    bench_report("TCP tx", bytes, 0, ms);
+}
+
+static void test_virtio_net_tcp_rx(void)
+{
+    int sock, ret;
+    rt_tick_t start, ms;
+    rt_uint64_t bytes = 0;
+    struct sockaddr_in addr;
+
+    sock = bench_socket(SOCK_STREAM, BENCH_SOURCE_PORT, &addr);
+    uassert_true(sock >= 0);
+    if (sock < 0)
+    {
+        return;
+    }
+
+    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)))
+    {
+        LOG_W("No source on %s:%d, skipped", BENCH_SERVER, BENCH_SOURCE_PORT);
+        closesocket(sock);
+        return;
+    }
+
+    start = rt_tick_get_millisecond();
+    while ((ms = rt_tick_get_millisecond() - start) < BENCH_MS)
+    {
+        if ((ret = recv(sock, buffer, BENCH_TCP_SIZE, 0)) <= 0)
+        {
+            break;
+        }
+        bytes += ret;
+    }
+
+    closesocket(sock);
+
+    uassert_true(bytes > 0);
+    bench_report("TCP rx", bytes, 0, ms);
+}
+
+static rt_err_t utest_tc_init(void)
+{
+    struct netdev *netdev = netdev_default;
+
+    if (!netdev || !netdev_is_up(netdev) || !netdev_is_link_up(netdev))
+    {
+        LOG_W("No network is up");
+        return -RT_ENOSYS;
+    }
+
+    if (!(buffer = rt_malloc(BENCH_TCP_SIZE)))
+    {
+        return -RT_ENOMEM;
+    }
+    rt_memset(buffer, 0xa5, BENCH_TCP_SIZE);
+
+    return RT_EOK;
+}
+
+static rt_err_t utest_tc_cleanup(void)
+{
+    rt_free(buffer);
+
+    return RT_EOK;
+}
+
+static void testcase(void)
+{
+    UTEST_UNIT_RUN(test_virtio_net_udp_tx);
+    UTEST_UNIT_RUN(test_virtio_net_tcp_tx);
+    UTEST_UNIT_RUN(test_virtio_net_tcp_rx);
+}
+UTEST_TC_EXPORT(testcase, "testcases.drivers.virtio_net_bench_tc", utest_tc_init, utest_tc_cleanup, 30);
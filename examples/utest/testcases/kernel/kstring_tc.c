@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ */
+
+#include <rtthread.h>
+#include "utest.h"
+
+#define TEST_BUF_SIZE       512
+#define TEST_ALIGN_MAX      16
+#define BENCH_BUF_SIZE      (16 * 1024)
+#define BENCH_ROUNDS        2000
+
+static rt_uint8_t *src_buf;
+static rt_uint8_t *dst_buf;
+static rt_uint8_t *ref_buf;
+
+/* the reference by bytes, which is obviously right */
+static void _ref_memcpy(void *dst, const void *src, rt_size_t count)
+{
+    rt_uint8_t *d = dst;
+    const rt_uint8_t *s = src;
+
+    while (count--)
+        *d++ = *s++;
+}
+
+static int _ref_memcmp(const void *cs, const void *ct, rt_size_t count)
+{
+    const rt_uint8_t *su1 = cs, *su2 = ct;
+
+    for (; count > 0; su1++, su2++, count--)
+        if (*su1 != *su2)
+            return *su1 - *su2;
+    return 0;
+}
+
+/* the generic copy before, with long words only if both are aligned */
+static void _generic_memcpy(void *dst, const void *src, rt_size_t count)
+{
+    char *dst_ptr = dst;
+    const char *src_ptr = src;
+
+    if (count >= sizeof(long) * 4 &&
+        (((rt_ubase_t)dst_ptr | (rt_ubase_t)src_ptr) & (sizeof(long) - 1)) == 0)
+    {
+        long *aligned_dst = (long *)dst_ptr;
+        const long *aligned_src = (const long *)src_ptr;
+
+        while (count >= sizeof(long))
+        {
+            *aligned_dst++ = *aligned_src++;
+            count -= sizeof(long);
+        }
+        dst_ptr = (char *)aligned_dst;
+        src_ptr = (const char *)aligned_src;
+    }
+
+    while (count--)
+        *dst_ptr++ = *src_ptr++;
+}
+
+static void _fill(rt_uint8_t *buf, rt_size_t size, rt_uint8_t seed)
+{
+    rt_size_t i;
+
+    for (i = 0; i < size; i++)
+        buf[i] = (rt_uint8_t)(i * 7 + seed);
+}
+
+static void test_memcpy(void)
+{
+    rt_size_t soff, doff, len;
+
+    for (soff = 0; soff < TEST_ALIGN_MAX; soff++)
+    {
+        for (doff = 0; doff < TEST_ALIGN_MAX; doff++)
+        {
+            for (len = 0; len < TEST_BUF_SIZE - TEST_ALIGN_MAX; len += (len < 80 ? 1 : 37))
+            {
+                _fill(src_buf, TEST_BUF_SIZE, (rt_uint8_t)len);
+                _fill(dst_buf, TEST_BUF_SIZE, 0x5a);
+                _fill(ref_buf, TEST_BUF_SIZE, 0x5a);
+
+                uassert_true(rt_memcpy(dst_buf + doff, src_buf + soff, len) == dst_buf + doff);
+                _ref_memcpy(ref_buf + doff, src_buf + soff, len);
+                if (rt_memcmp(dst_buf, ref_buf, TEST_BUF_SIZE) != 0 ||
+                    _ref_memcmp(dst_buf, ref_buf, TEST_BUF_SIZE) != 0)
+                {
+                    rt_kprintf("memcpy failed, src +%d dst +%d len %d\n", soff, doff, len);
+                    uassert_true(RT_FALSE);
+                    return;
+                }
+            }
+        }
+    }
+    uassert_true(RT_TRUE);
+}
+
+static void test_memset(void)
+{
+    rt_size_t off, len, i;
+
+    for (off = 0; off < TEST_ALIGN_MAX; off++)
+    {
+        for (len = 0; len < TEST_BUF_SIZE - TEST_ALIGN_MAX; len += (len < 80 ? 1 : 37))
+        {
+            _fill(dst_buf, TEST_BUF_SIZE, 0x5a);
+            _fill(ref_buf, TEST_BUF_SIZE, 0x5a);
+
+            uassert_true(rt_memset(dst_buf + off, 0x1a5, len) == dst_buf + off);
+            for (i = 0; i < len; i++)
+                ref_buf[off + i] = 0xa5;
+            if (_ref_memcmp(dst_buf, ref_buf, TEST_BUF_SIZE) != 0)
+            {
+                rt_kprintf("memset failed, dst +%d len %d\n", off, len);
+                uassert_true(RT_FALSE);
+                return;
+            }
+        }
+    }
+    uassert_true(RT_TRUE);
+}
+
+static void test_memcmp(void)
+{
+    rt_size_t soff, doff, len, diff;
+    int res, ref;
+
+    for (soff = 0; soff < TEST_ALIGN_MAX; soff++)
+    {
+        for (doff = 0; doff < TEST_ALIGN_MAX; doff++)
+        {
+            for (len = 1; len < TEST_BUF_SIZE - TEST_ALIGN_MAX; len += (len < 80 ? 1 : 37))
+            {
+                _fill(src_buf + soff, len, 0x33);
+                _fill(dst_buf + doff, len, 0x33);
+                uassert_int_equal(rt_memcmp(src_buf + soff, dst_buf + doff, len), 0);
+
+                /* make one byte different, both greater and less */
+                diff = (len * 13 + 5) % len;
+                dst_buf[doff + diff] += (len & 1) ? 1 : -1;
+                res = rt_memcmp(src_buf + soff, dst_buf + doff, len);
+                ref = _ref_memcmp(src_buf + soff, dst_buf + doff, len);
+                if ((res < 0) != (ref < 0) || (res > 0) != (ref > 0))
+                {
+                    rt_kprintf("memcmp failed, +%d +%d len %d\n", soff, doff, len);
+                    uassert_true(RT_FALSE);
+                    return;
+                }
+            }
+        }
+    }
+    uassert_true(RT_TRUE);
+}
+
+static void _bench(const char *name, void (*copy)(void *, const void *, rt_size_t),
+                   rt_size_t soff, rt_size_t doff)
+{
+    rt_tick_t start;
+    rt_uint32_t ms;
+    int i;
+
+    start = rt_tick_get_millisecond();
+    for (i = 0; i < BENCH_ROUNDS; i++)
+    {
+        copy(dst_buf + doff, src_buf + soff, BENCH_BUF_SIZE - TEST_ALIGN_MAX);
+    }
+    ms = rt_tick_get_millisecond() - start;
+
+    rt_kprintf("%-8s src +%d dst +%d: %d ms, %d KB/s\n", name, soff, doff, ms,
+          ms ? (int)((rt_uint64_t)BENCH_ROUNDS * (BENCH_BUF_SIZE / 1024) * 1000 / ms) : -1);
+}
+
+static void _rt_memcpy(void *dst, const void *src, rt_size_t count)
+{
+    rt_memcpy(dst, src, count);
+}
+
+static void test_memcpy_bench(void)
+{
+    rt_free(ref_buf);
+    rt_free(dst_buf);
+    rt_free(src_buf);
+    src_buf = rt_malloc(BENCH_BUF_SIZE);
+    dst_buf = rt_malloc(BENCH_BUF_SIZE);
+    ref_buf = RT_NULL;
+    uassert_not_null(src_buf);
+    uassert_not_null(dst_buf);
+    if (!src_buf || !dst_buf)
+        return;
+
+    _bench("generic", _generic_memcpy, 0, 0);
+    _bench("memcpy", _rt_memcpy, 0, 0);
+    _bench("generic", _generic_memcpy, 1, 0);
+    _bench("memcpy", _rt_memcpy, 1, 0);
+    _bench("generic", _generic_memcpy, 3, 5);
+    _bench("memcpy", _rt_memcpy, 3, 5);
+}
+
+static rt_err_t utest_tc_init(void)
+{
+    src_buf = rt_malloc(TEST_BUF_SIZE);
+    dst_buf = rt_malloc(TEST_BUF_SIZE);
+    ref_buf = rt_malloc(TEST_BUF_SIZE);
+    if (!src_buf || !dst_buf || !ref_buf)
+    {
+        rt_free(src_buf);
+        rt_free(dst_buf);
+        rt_free(ref_buf);
+        return -RT_ENOMEM;
+    }
+    return RT_EOK;
+}
+
+static rt_err_t utest_tc_cleanup(void)
+{
+    rt_free(src_buf);
+    rt_free(dst_buf);
+    rt_free(ref_buf);
+    return RT_EOK;
+}
+
+static void testcase(void)
+{
+    UTEST_UNIT_RUN(test_memcpy);
+    UTEST_UNIT_RUN(test_memset);
+    UTEST_UNIT_RUN(test_memcmp);
+    UTEST_UNIT_RUN(test_memcpy_bench);
+}
+UTEST_TC_EXPORT(testcase, "testcases.kernel.kstring_tc", utest_tc_init, utest_tc_cleanup, 60);
@@ -8,6 +8,7 @@
  * 2021-08-28     Sherman      the first version
  * 2023-09-15     xqyjlj       change stack size in cpu64
  *                             fix in smp
+ * 2026-10-17     agent        add zero-copy reserve/commit and borrow/release test
  */
 
 #include <rtthread.h>
@@ -181,6 +182,73 @@ static void test_mq_testcase(void)
     rt_event_recv(&finish_e, MQSEND_FINISH | MQRECV_FINIHS, RT_EVENT_FLAG_AND, RT_WAITING_FOREVER, RT_NULL);
 }
 
+#ifdef RT_USING_MESSAGEQUEUE_ZEROCOPY
+static void test_mq_zerocopy(void)
+{
+    void *slot[MAX_MSGS + 1];
+    void *buf;
+    rt_int32_t prio;
+    rt_ssize_t len;
+    rt_err_t ret;
+
+    /* fill the queue in place */
+    for (int var = 0; var < MAX_MSGS; ++var)
+    {
+        ret = rt_mq_reserve(&static_mq, &slot[var], RT_WAITING_NO, RT_UNINTERRUPTIBLE);
+        uassert_true(ret == RT_EOK);
+        *(rt_uint32_t *)slot[var] = var + 1;
+    }
+    ret = rt_mq_reserve(&static_mq, &slot[MAX_MSGS], RT_WAITING_NO, RT_UNINTERRUPTIBLE);
+    uassert_true(ret == -RT_EFULL);
+    ret = rt_mq_reserve(&static_mq, &slot[MAX_MSGS], 10, RT_UNINTERRUPTIBLE);
+    uassert_true(ret == -RT_ETIMEOUT);
+
+    /* a cancelled slot is never seen by the receiver */
+    ret = rt_mq_cancel(&static_mq, slot[MAX_MSGS - 1]);
+    uassert_true(ret == RT_EOK);
+    for (int var = 0; var < MAX_MSGS - 1; ++var)
+    {
+        ret = rt_mq_commit(&static_mq, slot[var], sizeof(rt_uint32_t));
+        uassert_true(ret == RT_EOK);
+    }
+    uassert_true(static_mq.entry == MAX_MSGS - 1);
+
+    /* messages are borrowed in order, at the address they were built */
+    for (int var = 0; var < MAX_MSGS - 1; ++var)
+    {
+        len = rt_mq_borrow_prio(&static_mq, &buf, &prio, RT_WAITING_NO, RT_UNINTERRUPTIBLE);
+        uassert_true(len == sizeof(rt_uint32_t));
+        uassert_true(buf == slot[var]);
+        uassert_true(*(rt_uint32_t *)buf == var + 1);
+        uassert_true(prio == 0);
+        ret = rt_mq_release(&static_mq, buf);
+        uassert_true(ret == RT_EOK);
+    }
+    len = rt_mq_borrow(&static_mq, &buf, RT_WAITING_NO, RT_UNINTERRUPTIBLE);
+    uassert_true(len == -RT_ETIMEOUT);
+
+#ifdef RT_USING_MESSAGEQUEUE_PRIORITY
+    ret = rt_mq_reserve(&static_mq, &slot[0], RT_WAITING_NO, RT_UNINTERRUPTIBLE);
+    uassert_true(ret == RT_EOK);
+    ret = rt_mq_reserve(&static_mq, &slot[1], RT_WAITING_NO, RT_UNINTERRUPTIBLE);
+    uassert_true(ret == RT_EOK);
+    ret = rt_mq_commit_prio(&static_mq, slot[0], sizeof(rt_uint32_t), 1);
+    uassert_true(ret == RT_EOK);
+    ret = rt_mq_commit_prio(&static_mq, slot[1], sizeof(rt_uint32_t), 2);
+    uassert_true(ret == RT_EOK);
+
+    len = rt_mq_borrow_prio(&static_mq, &buf, &prio, RT_WAITING_NO, RT_UNINTERRUPTIBLE);
+    uassert_true(len == sizeof(rt_uint32_t) && buf == slot[1] && prio == 2);
+    rt_mq_release(&static_mq, buf);
+    len = rt_mq_borrow_prio(&static_mq, &buf, &prio, RT_WAITING_NO, RT_UNINTERRUPTIBLE);
+    uassert_true(len == sizeof(rt_uint32_t) && buf == slot[0] && prio == 1);
+    rt_mq_release(&static_mq, buf);
+#endif /* RT_USING_MESSAGEQUEUE_PRIORITY */
+
+    uassert_true(static_mq.entry == 0);
+}
+#endif /* RT_USING_MESSAGEQUEUE_ZEROCOPY */
+
 static void test_mq_detach(void)
 {
     rt_err_t ret = rt_mq_detach(&static_mq);
@@ -228,6 +296,9 @@ static void testcase(void)
     UTEST_UNIT_RUN(test_mq_init);
     UTEST_UNIT_RUN(test_mq_create);
     UTEST_UNIT_RUN(test_mq_testcase);
+#ifdef RT_USING_MESSAGEQUEUE_ZEROCOPY
+    UTEST_UNIT_RUN(test_mq_zerocopy);
+#endif
     UTEST_UNIT_RUN(test_mq_detach);
     UTEST_UNIT_RUN(test_mq_delete);
 }
@@ -6,6 +6,7 @@
  * Change Logs:
  * Date           Author       Notes
  * 2021-10-14     tyx          the first version
+ * 2026-10-17     agent        check the magazine counters of this cpu
  */
 
 #include <rtthread.h>
@@ -305,6 +306,77 @@ static void slab_realloc_test(void)
     rt_free(buf);
 }
 
+#ifdef RT_USING_SLAB_MAGAZINE
+#define SLAB_MAGAZINE_TEST_CNT (RT_SLAB_MAGAZINE_SIZE * 4)
+
+static void slab_magazine_test(void)
+{
+    rt_uint8_t *buf;
+    rt_slab_t heap;
+    struct rt_slab_magazine_stat stat;
+    void *ptr[SLAB_MAGAZINE_TEST_CNT];
+    void *last;
+    int i, cpu;
+
+    buf = rt_malloc(TEST_SLAB_SIZE);
+    uassert_not_null(buf);
+    heap = rt_slab_init("slab_tc", buf, TEST_SLAB_SIZE);
+    uassert_not_null(heap);
+
+    /* the magazines are per cpu, stay on this cpu */
+    rt_enter_critical();
+    cpu = rt_cpu_get_id();
+
+    /* the empty magazine misses, the refill caches a batch */
+    uassert_null(rt_slab_magazine_alloc(heap, 32));
+    for (i = 0; i < SLAB_MAGAZINE_TEST_CNT; i++)
+    {
+        ptr[i] = rt_slab_magazine_alloc(heap, 32);
+        if (ptr[i] == RT_NULL)
+        {
+            ptr[i] = rt_slab_magazine_refill(heap, 32);
+        }
+        uassert_not_null(ptr[i]);
+        rt_memset(ptr[i], i, 32);
+    }
+    uassert_int_equal(rt_slab_magazine_get_stat(heap, cpu, 32, &stat), RT_EOK);
+    uassert_true(stat.alloc_miss > 0);
+    uassert_int_equal(stat.alloc_hit + stat.alloc_miss, SLAB_MAGAZINE_TEST_CNT);
+    uassert_true(stat.count < RT_SLAB_MAGAZINE_SIZE / 2);
+
+    /* the full magazine is flushed to zones */
+    for (i = 0; i < SLAB_MAGAZINE_TEST_CNT; i++)
+    {
+        if (!rt_slab_magazine_free(heap, ptr[i]))
+        {
+            rt_slab_magazine_flush(heap, ptr[i]);
+        }
+    }
+    uassert_int_equal(rt_slab_magazine_get_stat(heap, cpu, 32, &stat), RT_EOK);
+    uassert_true(stat.free_miss > 0);
+    uassert_int_equal(stat.free_hit + stat.free_miss, SLAB_MAGAZINE_TEST_CNT);
+    uassert_true(stat.count > 0 && stat.count <= RT_SLAB_MAGAZINE_SIZE);
+
+    /* the last freed chunk is the first one to reuse */
+    last = rt_slab_magazine_alloc(heap, 32);
+    uassert_true(last == ptr[SLAB_MAGAZINE_TEST_CNT - 1]);
+    uassert_int_equal(rt_slab_magazine_get_stat(heap, cpu, 32, &stat), RT_EOK);
+    uassert_int_equal(stat.alloc_hit + stat.alloc_miss, SLAB_MAGAZINE_TEST_CNT + 1);
+    rt_exit_critical();
+    rt_slab_free(heap, last);
+
+    /* large allocation never goes to magazine */
+    uassert_int_equal(rt_slab_magazine_get_stat(heap, cpu, TEST_SLAB_SIZE / 8, &stat), -RT_EINVAL);
+    last = rt_slab_magazine_refill(heap, TEST_SLAB_SIZE / 8);
+    uassert_not_null(last);
+    uassert_false(rt_slab_magazine_free(heap, last));
+    rt_slab_magazine_flush(heap, last);
+
+    rt_slab_detach(heap);
+    rt_free(buf);
+}
+#endif /* RT_USING_SLAB_MAGAZINE */
+
 static rt_err_t utest_tc_init(void)
 {
     return RT_EOK;
@@ -319,5 +391,8 @@ static void testcase(void)
 {
     UTEST_UNIT_RUN(slab_alloc_test);
     UTEST_UNIT_RUN(slab_realloc_test);
+#ifdef RT_USING_SLAB_MAGAZINE
+    UTEST_UNIT_RUN(slab_magazine_test);
+#endif /* RT_USING_SLAB_MAGAZINE */
 }
 UTEST_TC_EXPORT(testcase, "testcases.kernel.slab_tc", utest_tc_init, utest_tc_cleanup, 20);
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ */
+
+#include <rtthread.h>
+#include "utest.h"
+
+/**
+ * @brief   Mutex adaptive spinning testcase.
+ *
+ * @note    Threads bound to different cores contend on a mutex that is only
+ *          held for a short while, so the waiters mostly spin on the running
+ *          owner instead of being suspended. The shared counters must stay
+ *          consistent and the mutex must end up free.
+ */
+
+#define THREAD_PRIORITY   20
+#define THREAD_TIMESLICE  20
+#define THREAD_STACK_SIZE UTEST_THR_STACK_SIZE
+#define LOOP_COUNT        10000
+
+static rt_thread_t        threads[RT_CPUS_NR];
+static struct rt_mutex    mutex;
+static struct rt_event    finish_e;
+static volatile rt_uint32_t number1, number2;
+
+static void mutex_spin_entry(void *parameter)
+{
+    rt_uint32_t i;
+    rt_err_t ret;
+
+    for (i = 0; i < LOOP_COUNT; i++)
+    {
+        ret = rt_mutex_take(&mutex, RT_WAITING_FOREVER);
+        if (ret != RT_EOK)
+        {
+            uassert_true(ret == RT_EOK);
+            break;
+        }
+
+        uassert_int_equal(number1, number2);
+        number1++;
+        number2++;
+
+        rt_mutex_release(&mutex);
+    }
+
+    rt_event_send(&finish_e, 1u << (rt_ubase_t)parameter);
+}
+
+static void smp_mutex_spin_tc(void)
+{
+    rt_uint32_t set = 0;
+    rt_ubase_t cpu;
+    char name[RT_NAME_MAX];
+
+    for (cpu = 0; cpu < RT_CPUS_NR; cpu++)
+    {
+        rt_snprintf(name, sizeof(name), "mspin%d", (int)cpu);
+        threads[cpu] = rt_thread_create(name, mutex_spin_entry, (void *)cpu,
+                                        THREAD_STACK_SIZE, THREAD_PRIORITY, THREAD_TIMESLICE);
+        uassert_not_null(threads[cpu]);
+        rt_thread_control(threads[cpu], RT_THREAD_CTRL_BIND_CPU, (void *)cpu);
+        set |= 1u << cpu;
+    }
+
+    for (cpu = 0; cpu < RT_CPUS_NR; cpu++)
+    {
+        rt_thread_startup(threads[cpu]);
+    }
+
+    rt_event_recv(&finish_e, set, RT_EVENT_FLAG_AND | RT_EVENT_FLAG_CLEAR,
+                  RT_WAITING_FOREVER, RT_NULL);
+
+    uassert_int_equal(number1, LOOP_COUNT * RT_CPUS_NR);
+    uassert_int_equal(number2, LOOP_COUNT * RT_CPUS_NR);
+    uassert_null(mutex.owner);
+}
+
+static rt_err_t utest_tc_init(void)
+{
+    number1 = number2 = 0;
+    rt_mutex_init(&mutex, "mspin", RT_IPC_FLAG_PRIO);
+    rt_event_init(&finish_e, "mspin", RT_IPC_FLAG_FIFO);
+    return RT_EOK;
+}
+
+static rt_err_t utest_tc_cleanup(void)
+{
+    rt_mutex_detach(&mutex);
+    rt_event_detach(&finish_e);
+    return RT_EOK;
+}
+
+static void testcase(void)
+{
+    UTEST_UNIT_RUN(smp_mutex_spin_tc);
+}
+UTEST_TC_EXPORT(testcase, "testcases.smp.mutex_spin_tc", utest_tc_init, utest_tc_cleanup, 10);
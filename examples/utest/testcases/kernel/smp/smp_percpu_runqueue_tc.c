@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2006-2024, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ * 2026-10-17     agent        assert migrations, add wakeup ping-pong test
+ */
+
+#include <rtthread.h>
+#include <rthw.h>
+#include "utest.h"
+
+/**
+ * @brief   Per-CPU ready queue with work stealing.
+ *
+ * @note    Create 2 * RT_CPUS_NR busy threads bound to core 0, so all of them
+ *          are queued on the ready queue of core 0. Each of them unbinds itself
+ *          once it runs, then it can only reach a peer core by being stolen or
+ *          by being queued on a peer when it gives out the core. Every core is
+ *          expected to have run some of them, so threads must migrate.
+ *
+ *          The second case wakes threads across cores with semaphores in a
+ *          ping-pong way. Woken threads are queued after the waker releases
+ *          the scheduler lock, none of the wakeups may be lost.
+ */
+
+#define THREAD_STACK_SIZE UTEST_THR_STACK_SIZE
+#define THREAD_PRIORITY   20
+#define THREAD_NUM        (RT_CPUS_NR * 2)
+#define LOOP_NUM          100
+#define PINGPONG_NUM      1000
+
+static struct rt_semaphore done_sem;
+static rt_atomic_t cpu_mask;
+static rt_atomic_t migrations;
+
+static void thread_entry(void *parameter)
+{
+    int i, cpu, last_cpu;
+    rt_tick_t start;
+
+    RT_UNUSED(parameter);
+
+    /* queued on core 0 only, let it go from now on */
+    last_cpu = rt_hw_cpu_id();
+    rt_thread_control(rt_thread_self(), RT_THREAD_CTRL_BIND_CPU, (void *)RT_CPUS_NR);
+
+    for (i = 0; i < LOOP_NUM; i++)
+    {
+        cpu = rt_hw_cpu_id();
+        rt_atomic_or(&cpu_mask, 1 << cpu);
+
+        if (cpu != last_cpu)
+        {
+            rt_atomic_add(&migrations, 1);
+            last_cpu = cpu;
+        }
+
+        /* busy for a tick so peers have to steal */
+        start = rt_tick_get();
+        while (rt_tick_get() == start);
+    }
+
+    rt_sem_release(&done_sem);
+}
+
+static void percpu_runqueue_steal_tc(void)
+{
+    int i, started = 0;
+    char thread_name[RT_NAME_MAX];
+    rt_thread_t thread;
+
+    rt_atomic_store(&cpu_mask, 0);
+    rt_atomic_store(&migrations, 0);
+
+    for (i = 0; i < THREAD_NUM; i++)
+    {
+        rt_snprintf(thread_name, sizeof(thread_name), "rq%d", i);
+        thread = rt_thread_create(thread_name, thread_entry, RT_NULL,
+                                  THREAD_STACK_SIZE, THREAD_PRIORITY, 5);
+        uassert_not_null(thread);
+
+        if (thread)
+        {
+            rt_thread_control(thread, RT_THREAD_CTRL_BIND_CPU, (void *)0);
+            rt_thread_startup(thread);
+            started++;
+        }
+    }
+
+    for (i = 0; i < started; i++)
+    {
+        uassert_int_equal(rt_sem_take(&done_sem, rt_tick_from_millisecond(20000)), RT_EOK);
+    }
+
+    /* all of them started on core 0, so the peers ran migrated threads only */
+    uassert_int_equal(rt_atomic_load(&cpu_mask), RT_CPU_MASK);
+    uassert_true(rt_atomic_load(&migrations) >= RT_CPUS_NR - 1);
+}
+
+static struct rt_semaphore ping_sem[RT_CPUS_NR];
+static struct rt_semaphore pong_sem[RT_CPUS_NR];
+
+static void ping_entry(void *parameter)
+{
+    rt_ubase_t id = (rt_ubase_t)parameter;
+
+    for (int i = 0; i < PINGPONG_NUM; i++)
+    {
+        rt_sem_release(&ping_sem[id]);
+        if (rt_sem_take(&pong_sem[id], rt_tick_from_millisecond(1000)) != RT_EOK)
+        {
+            /* a lost wakeup */
+            break;
+        }
+    }
+
+    rt_sem_release(&done_sem);
+}
+
+static void pong_entry(void *parameter)
+{
+    rt_ubase_t id = (rt_ubase_t)parameter;
+
+    for (int i = 0; i < PINGPONG_NUM; i++)
+    {
+        if (rt_sem_take(&ping_sem[id], rt_tick_from_millisecond(1000)) != RT_EOK)
+        {
+            break;
+        }
+        rt_sem_release(&pong_sem[id]);
+    }
+
+    rt_sem_release(&done_sem);
+}
+
+static void percpu_runqueue_wakeup_tc(void)
+{
+    int i, started = 0;
+    rt_thread_t ping, pong;
+
+    for (i = 0; i < RT_CPUS_NR; i++)
+    {
+        rt_sem_init(&ping_sem[i], "ping", 0, RT_IPC_FLAG_PRIO);
+        rt_sem_init(&pong_sem[i], "pong", 0, RT_IPC_FLAG_PRIO);
+    }
+
+    for (i = 0; i < RT_CPUS_NR; i++)
+    {
+        ping = rt_thread_create("ping", ping_entry, (void *)(rt_ubase_t)i,
+                                THREAD_STACK_SIZE, THREAD_PRIORITY, 5);
+        pong = rt_thread_create("pong", pong_entry, (void *)(rt_ubase_t)i,
+                                THREAD_STACK_SIZE, THREAD_PRIORITY, 5);
+        uassert_not_null(ping);
+        uassert_not_null(pong);
+
+        /* a pair runs on different cores, so every wakeup crosses cores */
+        if (ping && pong)
+        {
+            rt_thread_control(ping, RT_THREAD_CTRL_BIND_CPU, (void *)(rt_ubase_t)i);
+            rt_thread_control(pong, RT_THREAD_CTRL_BIND_CPU, (void *)(rt_ubase_t)((i + 1) % RT_CPUS_NR));
+            rt_thread_startup(ping);
+            rt_thread_startup(pong);
+            started += 2;
+        }
+        else
+        {
+            if (ping)
+            {
+                rt_thread_delete(ping);
+            }
+            if (pong)
+            {
+                rt_thread_delete(pong);
+            }
+        }
+    }
+
+    for (i = 0; i < started; i++)
+    {
+        uassert_int_equal(rt_sem_take(&done_sem, rt_tick_from_millisecond(20000)), RT_EOK);
+    }
+
+    for (i = 0; i < RT_CPUS_NR; i++)
+    {
+        /* a side gave up on a timeout if anything is left */
+        uassert_int_equal(ping_sem[i].value, 0);
+        uassert_int_equal(pong_sem[i].value, 0);
+
+        rt_sem_detach(&ping_sem[i]);
+        rt_sem_detach(&pong_sem[i]);
+    }
+}
+
+static rt_err_t utest_tc_init(void)
+{
+    return rt_sem_init(&done_sem, "rq_done", 0, RT_IPC_FLAG_PRIO);
+}
+
+static rt_err_t utest_tc_cleanup(void)
+{
+    return rt_sem_detach(&done_sem);
+}
+
+static void testcase(void)
+{
+    UTEST_UNIT_RUN(percpu_runqueue_steal_tc);
+    UTEST_UNIT_RUN(percpu_runqueue_wakeup_tc);
+}
+UTEST_TC_EXPORT(testcase, "testcases.smp.percpu_runqueue_tc", utest_tc_init, utest_tc_cleanup, 60);
@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ */
+
+#include <rtthread.h>
+#include <rthw.h>
+#include "utest.h"
+
+/**
+ * @brief   timing wheel of rt_timer testcase.
+ *
+ * @note    The wheel has 32 slots per level, so a timeout of 32 ticks or
+ *          more is hashed to an upper level and cascaded down later. Hard
+ *          timers must fire exactly on their timeout tick wherever they were
+ *          hashed, timers of the same timeout tick fire in the order they
+ *          were started, and a timer re-armed by rt_timer_control() must
+ *          leave its old slot.
+ */
+
+#define WHEEL_SLOTS         32
+#define WHEEL_TIMER_NR      6
+
+struct wheel_timer
+{
+    struct rt_timer timer;
+    rt_tick_t expect;           /* tick it should fire on */
+    rt_tick_t fired;            /* tick it fired on */
+    rt_uint32_t hits;           /* times it fired */
+    rt_uint32_t late;           /* times it missed the expected tick */
+    rt_uint32_t order;          /* sequence it fired in */
+};
+
+static struct wheel_timer wtimers[WHEEL_TIMER_NR];
+static rt_uint32_t fire_seq;
+
+static void _wheel_oneshot(void *param)
+{
+    struct wheel_timer *wt = param;
+
+    wt->fired = rt_tick_get();
+    wt->order = fire_seq++;
+    wt->hits++;
+}
+
+static void _wheel_periodic(void *param)
+{
+    struct wheel_timer *wt = param;
+
+    if (rt_tick_get() != wt->expect)
+    {
+        wt->late++;
+    }
+    wt->expect = rt_tick_get() + wt->timer.init_tick;
+    wt->hits++;
+}
+
+static void _wheel_init(struct wheel_timer *wt, void (*timeout)(void *parameter),
+                        rt_tick_t ticks, rt_uint8_t flag)
+{
+    rt_memset(wt, 0, sizeof(*wt));
+    rt_timer_init(&wt->timer, "wheel", timeout, wt, ticks, flag | RT_TIMER_FLAG_HARD_TIMER);
+}
+
+static void _wheel_start(struct wheel_timer *wt)
+{
+    uassert_int_equal(rt_timer_start(&wt->timer), RT_EOK);
+    rt_timer_control(&wt->timer, RT_TIMER_CTRL_GET_REMAIN_TIME, &wt->expect);
+}
+
+static rt_uint32_t _wheel_state(struct wheel_timer *wt)
+{
+    rt_uint32_t state;
+
+    rt_timer_control(&wt->timer, RT_TIMER_CTRL_GET_STATE, &state);
+    return state;
+}
+
+static void test_wheel_cascade(void)
+{
+    /* across the boundaries of level 0, 1 and 2 */
+    const rt_tick_t ticks[WHEEL_TIMER_NR] = {
+        3, WHEEL_SLOTS - 1, WHEEL_SLOTS, WHEEL_SLOTS + 1,
+        WHEEL_SLOTS * 3 + 5, WHEEL_SLOTS * WHEEL_SLOTS + 5,
+    };
+    int i;
+
+    for (i = 0; i < WHEEL_TIMER_NR; i++)
+    {
+        _wheel_init(&wtimers[i], _wheel_oneshot, ticks[i], RT_TIMER_FLAG_ONE_SHOT);
+        _wheel_start(&wtimers[i]);
+    }
+
+    rt_thread_delay(ticks[WHEEL_TIMER_NR - 1] + 2);
+
+    for (i = 0; i < WHEEL_TIMER_NR; i++)
+    {
+        uassert_int_equal(wtimers[i].hits, 1);
+        uassert_int_equal(wtimers[i].fired, wtimers[i].expect);
+        rt_timer_detach(&wtimers[i].timer);
+    }
+}
+
+static void test_wheel_same_tick_order(void)
+{
+    struct wheel_timer *upper = &wtimers[0], *lower = &wtimers[1];
+    rt_base_t level;
+    rt_tick_t ticks;
+
+    /* the upper one is cascaded down to the slot the lower one is hashed to */
+    _wheel_init(upper, _wheel_oneshot, WHEEL_SLOTS * 2, RT_TIMER_FLAG_ONE_SHOT);
+    _wheel_init(lower, _wheel_oneshot, 1, RT_TIMER_FLAG_ONE_SHOT);
+    _wheel_start(upper);
+
+    rt_thread_delay(WHEEL_SLOTS + 8);
+
+    /* the tick may step on other cores, retry until they share the tick */
+    do
+    {
+        rt_timer_stop(&lower->timer);
+
+        level = rt_hw_interrupt_disable();
+        ticks = upper->expect - rt_tick_get();
+        rt_timer_control(&lower->timer, RT_TIMER_CTRL_SET_TIME, &ticks);
+        _wheel_start(lower);
+        rt_hw_interrupt_enable(level);
+    } while (lower->expect != upper->expect);
+
+    rt_thread_delay(upper->expect - rt_tick_get() + 2);
+
+    uassert_int_equal(upper->hits, 1);
+    uassert_int_equal(lower->hits, 1);
+    uassert_int_equal(upper->fired, upper->expect);
+    uassert_int_equal(lower->fired, lower->expect);
+    uassert_true(upper->order < lower->order);
+
+    rt_timer_detach(&upper->timer);
+    rt_timer_detach(&lower->timer);
+}
+
+static void test_wheel_long_timeout(void)
+{
+    /* the longest timeout lands on the top level */
+    const rt_tick_t ticks[3] = { RT_TICK_MAX / 2 - 1, (rt_tick_t)1 << 26, WHEEL_SLOTS + 17 };
+    struct wheel_timer *shortest = &wtimers[2];
+    rt_tick_t before, after;
+    int i;
+
+    for (i = 0; i < 3; i++)
+    {
+        _wheel_init(&wtimers[i], _wheel_oneshot, ticks[i], RT_TIMER_FLAG_ONE_SHOT);
+
+        before = rt_tick_get();
+        _wheel_start(&wtimers[i]);
+        after = rt_tick_get();
+
+        uassert_true(wtimers[i].expect - before >= ticks[i]);
+        uassert_true(wtimers[i].expect - after <= ticks[i]);
+    }
+
+    /* the ones far away do not disturb the near one, nor fire early */
+    rt_thread_delay(ticks[2] + 2);
+
+    uassert_int_equal(shortest->hits, 1);
+    uassert_int_equal(shortest->fired, shortest->expect);
+    for (i = 0; i < 2; i++)
+    {
+        uassert_int_equal(wtimers[i].hits, 0);
+        uassert_int_equal(_wheel_state(&wtimers[i]), RT_TIMER_FLAG_ACTIVATED);
+        uassert_int_equal(rt_timer_stop(&wtimers[i].timer), RT_EOK);
+        uassert_int_equal(_wheel_state(&wtimers[i]), RT_TIMER_FLAG_DEACTIVATED);
+    }
+
+    for (i = 0; i < 3; i++)
+    {
+        rt_timer_detach(&wtimers[i].timer);
+    }
+}
+
+static void test_wheel_control_rearm(void)
+{
+    struct wheel_timer *wt = &wtimers[0];
+    rt_tick_t ticks;
+
+    /* from level 2 down to level 0 */
+    _wheel_init(wt, _wheel_oneshot, WHEEL_SLOTS * WHEEL_SLOTS + 76, RT_TIMER_FLAG_ONE_SHOT);
+    _wheel_start(wt);
+    rt_thread_delay(10);
+
+    ticks = 20;
+    rt_timer_control(&wt->timer, RT_TIMER_CTRL_SET_TIME, &ticks);
+    uassert_int_equal(_wheel_state(wt), RT_TIMER_FLAG_DEACTIVATED);
+    _wheel_start(wt);
+    rt_thread_delay(ticks + 2);
+
+    uassert_int_equal(wt->hits, 1);
+    uassert_int_equal(wt->fired, wt->expect);
+
+    /* from level 0 up to level 1, it must not fire on the old slot */
+    wt->hits = 0;
+    ticks = 5;
+    rt_timer_control(&wt->timer, RT_TIMER_CTRL_SET_TIME, &ticks);
+    _wheel_start(wt);
+
+    ticks = WHEEL_SLOTS * 2 + 6;
+    rt_timer_control(&wt->timer, RT_TIMER_CTRL_SET_TIME, &ticks);
+    _wheel_start(wt);
+    rt_thread_delay(10);
+    uassert_int_equal(wt->hits, 0);
+
+    rt_thread_delay(ticks);
+    uassert_int_equal(wt->hits, 1);
+    uassert_int_equal(wt->fired, wt->expect);
+    rt_timer_detach(&wt->timer);
+
+    /* a periodic one re-armed from level 1 keeps the new period */
+    _wheel_init(wt, _wheel_periodic, WHEEL_SLOTS + 8, RT_TIMER_FLAG_PERIODIC);
+    _wheel_start(wt);
+    rt_thread_delay(WHEEL_SLOTS + 10);
+    uassert_int_equal(wt->hits, 1);
+
+    ticks = 7;
+    rt_timer_control(&wt->timer, RT_TIMER_CTRL_SET_TIME, &ticks);
+    wt->hits = 0;
+    wt->late = 0;
+    _wheel_start(wt);
+    rt_thread_delay(ticks * 5 + 3);
+
+    uassert_int_equal(rt_timer_stop(&wt->timer), RT_EOK);
+    uassert_true(wt->hits >= 5);
+    uassert_int_equal(wt->late, 0);
+    rt_timer_detach(&wt->timer);
+}
+
+static rt_err_t utest_tc_init(void)
+{
+    fire_seq = 0;
+
+    return RT_EOK;
+}
+
+static rt_err_t utest_tc_cleanup(void)
+{
+    return RT_EOK;
+}
+
+static void testcase(void)
+{
+    UTEST_UNIT_RUN(test_wheel_cascade);
+    UTEST_UNIT_RUN(test_wheel_same_tick_order);
+    UTEST_UNIT_RUN(test_wheel_long_timeout);
+    UTEST_UNIT_RUN(test_wheel_control_rearm);
+}
+UTEST_TC_EXPORT(testcase, "testcases.kernel.timer_wheel_tc", utest_tc_init, utest_tc_cleanup, 60);
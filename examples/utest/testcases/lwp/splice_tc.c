@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ */
+
+#include <rtthread.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dfs_file.h>
+#include <lwp_syscall.h>
+#ifdef RT_USING_SAL
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#endif
+#include "utest.h"
+
+/**
+ * @brief   sendfile, splice and copy_file_range testcase.
+ *
+ * @note    The syscalls run on the fds of the kernel with the file positions,
+ *          an explicit offset is given to dfs_file_splice_read() behind them.
+ *          The cases cover:
+ *          1. sendfile() advances the position of the source by the bytes
+ *             sent, an explicit offset leaves it alone;
+ *          2. copy_file_range() refuses overlapping ranges of one file;
+ *          3. sendfile() to a non-blocking socket that fills up returns the
+ *             bytes sent so far, then -EAGAIN, the source position follows
+ *             exactly what was sent.
+ */
+
+#define SPLICE_TC_SRC           "/splice_tc_src"
+#define SPLICE_TC_DST           "/splice_tc_dst"
+#define SPLICE_TC_SIZE          (64 * 1024 + 100)
+#define SPLICE_TC_PORT          5050
+
+static char *pattern;
+static char *data;
+static int src = -1;
+
+struct splice_tc_sink
+{
+    char *buf;
+    size_t len;
+};
+
+static ssize_t _splice_tc_actor(void *priv, const void *buf, size_t len)
+{
+    struct splice_tc_sink *sink = priv;
+
+    rt_memcpy(sink->buf + sink->len, buf, len);
+    sink->len += len;
+
+    return len;
+}
+
+static off_t _pos(int fd)
+{
+    return lseek(fd, 0, SEEK_CUR);
+}
+
+static void test_sendfile_fpos(void)
+{
+    int dst;
+    off_t off;
+    struct splice_tc_sink sink = { .buf = data };
+
+    dst = open(SPLICE_TC_DST, O_RDWR | O_CREAT | O_TRUNC, 0);
+    uassert_true(dst >= 0);
+    if (dst < 0)
+    {
+        return;
+    }
+
+    /* the file positions of both sides advance */
+    lseek(src, 10, SEEK_SET);
+    uassert_int_equal(sys_sendfile(dst, src, RT_NULL, 5000), 5000);
+    uassert_int_equal(_pos(src), 5010);
+    uassert_int_equal(_pos(dst), 5000);
+
+    lseek(dst, 0, SEEK_SET);
+    uassert_int_equal(read(dst, data, 5000), 5000);
+    uassert_buf_equal(data, pattern + 10, 5000);
+
+    /* an offset advances instead of the file position */
+    off = 200;
+    uassert_int_equal(dfs_file_splice_read(fd_get(src), 1000, &off, _splice_tc_actor, &sink), 1000);
+    uassert_int_equal(off, 1200);
+    uassert_int_equal(_pos(src), 5010);
+    uassert_int_equal(sink.len, 1000);
+    uassert_buf_equal(data, pattern + 200, 1000);
+
+    /* stops at the end of file */
+    lseek(src, SPLICE_TC_SIZE - 50, SEEK_SET);
+    lseek(dst, 0, SEEK_SET);
+    uassert_int_equal(sys_sendfile(dst, src, RT_NULL, 1000), 50);
+    uassert_int_equal(_pos(src), SPLICE_TC_SIZE);
+
+    close(dst);
+    unlink(SPLICE_TC_DST);
+}
+
+static void test_copy_file_range_overlap(void)
+{
+    int out;
+
+    out = open(SPLICE_TC_SRC, O_RDWR, 0);
+    uassert_true(out >= 0);
+    if (out < 0)
+    {
+        return;
+    }
+
+    /* the output would be read back as input */
+    lseek(src, 0, SEEK_SET);
+    lseek(out, 100, SEEK_SET);
+    uassert_int_equal(sys_copy_file_range(src, RT_NULL, out, RT_NULL, 200, 0), -EINVAL);
+    uassert_int_equal(_pos(src), 0);
+    uassert_int_equal(_pos(out), 100);
+
+    lseek(src, 300, SEEK_SET);
+    lseek(out, 100, SEEK_SET);
+    uassert_int_equal(sys_copy_file_range(src, RT_NULL, out, RT_NULL, 300, 0), -EINVAL);
+
+    /* apart from each other */
+    lseek(src, 0, SEEK_SET);
+    lseek(out, 8192, SEEK_SET);
+    uassert_int_equal(sys_copy_file_range(src, RT_NULL, out, RT_NULL, 200, 0), 200);
+    uassert_int_equal(_pos(src), 200);
+    uassert_int_equal(_pos(out), 8392);
+
+    lseek(out, 8192, SEEK_SET);
+    uassert_int_equal(read(out, data, 200), 200);
+    uassert_buf_equal(data, pattern, 200);
+
+    /* restore the source for the other cases */
+    lseek(out, 8192, SEEK_SET);
+    uassert_int_equal(write(out, pattern + 8192, 200), 200);
+
+    close(out);
+}
+
+#ifdef RT_USING_SAL
+static void test_sendfile_socket_eagain(void)
+{
+    int server, client, peer = -1;
+    int on = 1;
+    ssize_t ret;
+    off_t sent = 0;
+    struct sockaddr_in addr;
+    socklen_t addrlen = sizeof(addr);
+
+    server = socket(AF_INET, SOCK_STREAM, 0);
+    client = socket(AF_INET, SOCK_STREAM, 0);
+    uassert_true(server >= 0 && client >= 0);
+
+    rt_memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(SPLICE_TC_PORT);
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+
+    if (server < 0 || client < 0 ||
+        bind(server, (struct sockaddr *)&addr, sizeof(addr)) ||
+        listen(server, 1) ||
+        connect(client, (struct sockaddr *)&addr, sizeof(addr)) ||
+        (peer = accept(server, (struct sockaddr *)&addr, &addrlen)) < 0)
+    {
+        LOG_W("No loopback network, skipped");
+        goto _exit;
+    }
+
+    /* nobody reads from the peer, the send buffer fills up */
+    ioctlsocket(client, FIONBIO, &on);
+    lseek(src, 0, SEEK_SET);
+
+    while ((ret = sys_sendfile(client, src, RT_NULL, SPLICE_TC_SIZE - sent)) > 0)
+    {
+        sent += ret;
+        uassert_int_equal(_pos(src), sent);
+
+        if (sent == SPLICE_TC_SIZE)
+        {
+            break;
+        }
+    }
+
+    /* the send buffer of lwIP is far less than the file */
+    uassert_true(sent > 0 && sent < SPLICE_TC_SIZE);
+    uassert_int_equal(ret, -EAGAIN);
+    uassert_int_equal(_pos(src), sent);
+
+_exit:
+    if (peer >= 0)
+    {
+        closesocket(peer);
+    }
+    if (client >= 0)
+    {
+        closesocket(client);
+    }
+    if (server >= 0)
+    {
+        closesocket(server);
+    }
+}
+#endif /* RT_USING_SAL */
+
+static rt_err_t utest_tc_init(void)
+{
+    if (!(pattern = rt_malloc(SPLICE_TC_SIZE)))
+    {
+        return -RT_ENOMEM;
+    }
+
+    if (!(data = rt_malloc(SPLICE_TC_SIZE)))
+    {
+        rt_free(pattern);
+        return -RT_ENOMEM;
+    }
+
+    for (int i = 0; i < SPLICE_TC_SIZE; i++)
+    {
+        pattern[i] = (char)(i * 31 + 3);
+    }
+
+    src = open(SPLICE_TC_SRC, O_RDWR | O_CREAT | O_TRUNC, 0);
+    if (src < 0 || write(src, pattern, SPLICE_TC_SIZE) != SPLICE_TC_SIZE)
+    {
+        if (src >= 0)
+        {
+            close(src);
+        }
+        rt_free(data);
+        rt_free(pattern);
+        return -RT_ERROR;
+    }
+
+    return RT_EOK;
+}
+
+static rt_err_t utest_tc_cleanup(void)
+{
+    close(src);
+    unlink(SPLICE_TC_SRC);
+    rt_free(data);
+    rt_free(pattern);
+
+    return RT_EOK;
+}
+
+static void testcase(void)
+{
+    UTEST_UNIT_RUN(test_sendfile_fpos);
+    UTEST_UNIT_RUN(test_copy_file_range_overlap);
+#ifdef RT_USING_SAL
+    UTEST_UNIT_RUN(test_sendfile_socket_eagain);
+#endif
+}
+UTEST_TC_EXPORT(testcase, "testcases.lwp.splice_tc", utest_tc_init, utest_tc_cleanup, 10);
@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ */
+
+#include <rtthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <lwp.h>
+#include <lwp_user_mm.h>
+#include <mm_aspace.h>
+#include <mm_page.h>
+#include "utest.h"
+
+/**
+ * @brief   lwp user buffer iterator testcase.
+ *
+ * @note    The iterator behind sys_readv()/sys_writev() is driven over the
+ *          iovecs of a new lwp, the way they do it for a file copying with
+ *          CPU. The cases cover:
+ *          1. a readv fills segments crossing pages through pinned chunks;
+ *          2. a writev drains the same segments to a file;
+ *          3. a pinned frame outlives the unmap of its user range;
+ *          4. a chunk of memory other than anonymous one is not pinned.
+ */
+
+#define UITER_TC_FILE           "/uiter_tc"
+#define UITER_TC_PAGES          3
+#define UITER_TC_SIZE           (UITER_TC_PAGES * ARCH_PAGE_SIZE)
+
+static struct rt_lwp *lwp;
+static char *ubuf;
+static char *pattern;
+static char *data;
+static struct iovec iov[3];
+static size_t iov_total;
+
+static char *_frame_of(void *kaddr)
+{
+    return (char *)((rt_ubase_t)kaddr & ~ARCH_PAGE_MASK);
+}
+
+static void _iov_setup(void)
+{
+    /* the second segment crosses a page */
+    iov[0].iov_base = ubuf + 100;
+    iov[0].iov_len = 50;
+    iov[1].iov_base = ubuf + ARCH_PAGE_SIZE - 10;
+    iov[1].iov_len = 30;
+    iov[2].iov_base = ubuf + 2 * ARCH_PAGE_SIZE + 5;
+    iov[2].iov_len = 200;
+
+    iov_total = iov[0].iov_len + iov[1].iov_len + iov[2].iov_len;
+}
+
+static ssize_t _uiter_rw(int fd, int dir)
+{
+    ssize_t chunk, ret, done = 0;
+    struct lwp_uiter iter;
+    void *uaddr, *kaddr;
+
+    uassert_int_equal(lwp_uiter_init(&iter, lwp, dir, iov, 3), 0);
+
+    while ((chunk = lwp_uiter_chunk(&iter, ARCH_PAGE_SIZE, &uaddr, &kaddr)) > 0)
+    {
+        /* anonymous memory is pinned, the frame holds one more reference */
+        uassert_not_null(kaddr);
+        if (!kaddr)
+        {
+            break;
+        }
+        uassert_int_equal(rt_page_ref_get(_frame_of(kaddr), 0), 2);
+
+        ret = dir == LWP_UITER_TO_USER ? read(fd, kaddr, chunk) : write(fd, kaddr, chunk);
+        if (ret <= 0)
+        {
+            break;
+        }
+
+        lwp_uiter_advance(&iter, ret);
+        uassert_int_equal(rt_page_ref_get(_frame_of(kaddr), 0), 1);
+        done += ret;
+    }
+
+    lwp_uiter_fini(&iter);
+
+    return done;
+}
+
+static void test_uiter_readv(void)
+{
+    int fd;
+    size_t off = 0;
+
+    fd = open(UITER_TC_FILE, O_RDWR | O_CREAT | O_TRUNC, 0);
+    uassert_true(fd >= 0);
+    if (fd < 0)
+    {
+        return;
+    }
+    uassert_int_equal(write(fd, pattern, iov_total), iov_total);
+    lseek(fd, 0, SEEK_SET);
+
+    uassert_int_equal(_uiter_rw(fd, LWP_UITER_TO_USER), iov_total);
+
+    for (int i = 0; i < 3; i++)
+    {
+        uassert_int_equal(lwp_data_get(lwp, data, iov[i].iov_base, iov[i].iov_len), iov[i].iov_len);
+        uassert_buf_equal(data, pattern + off, iov[i].iov_len);
+        off += iov[i].iov_len;
+    }
+
+    close(fd);
+}
+
+static void test_uiter_writev(void)
+{
+    int fd;
+    size_t off = 0;
+
+    for (int i = 0; i < 3; i++)
+    {
+        lwp_data_put(lwp, iov[i].iov_base, pattern + UITER_TC_SIZE - iov_total + off, iov[i].iov_len);
+        off += iov[i].iov_len;
+    }
+
+    fd = open(UITER_TC_FILE, O_RDWR | O_CREAT | O_TRUNC, 0);
+    uassert_true(fd >= 0);
+    if (fd < 0)
+    {
+        return;
+    }
+
+    uassert_int_equal(_uiter_rw(fd, LWP_UITER_FROM_USER), iov_total);
+
+    lseek(fd, 0, SEEK_SET);
+    uassert_int_equal(read(fd, data, iov_total), iov_total);
+    uassert_buf_equal(data, pattern + UITER_TC_SIZE - iov_total, iov_total);
+
+    close(fd);
+    unlink(UITER_TC_FILE);
+}
+
+static void test_uiter_unmap_pinned(void)
+{
+    char *buf, *frame;
+    ssize_t chunk;
+    struct lwp_uiter iter;
+    struct iovec one;
+    void *uaddr, *kaddr;
+
+    buf = lwp_map_user(lwp, RT_NULL, ARCH_PAGE_SIZE, RT_FALSE);
+    uassert_not_null(buf);
+    if (!buf)
+    {
+        return;
+    }
+
+    one.iov_base = buf;
+    one.iov_len = ARCH_PAGE_SIZE;
+    uassert_int_equal(lwp_uiter_init(&iter, lwp, LWP_UITER_TO_USER, &one, 1), 0);
+
+    chunk = lwp_uiter_chunk(&iter, ARCH_PAGE_SIZE, &uaddr, &kaddr);
+    uassert_int_equal(chunk, ARCH_PAGE_SIZE);
+    uassert_not_null(kaddr);
+    if (chunk != ARCH_PAGE_SIZE || !kaddr)
+    {
+        lwp_uiter_fini(&iter);
+        lwp_unmap_user(lwp, buf);
+        return;
+    }
+
+    /* another thread unmaps it during the transfer */
+    frame = _frame_of(kaddr);
+    uassert_int_equal(lwp_unmap_user(lwp, buf), 0);
+    uassert_int_equal(rt_page_ref_get(frame, 0), 1);
+
+    /* still the pinned frame, nobody else is using it */
+    rt_memset(kaddr, 0x5a, chunk);
+    lwp_uiter_advance(&iter, chunk);
+    lwp_uiter_fini(&iter);
+}
+
+static void test_uiter_phy_not_pinned(void)
+{
+    char *page, *buf;
+    ssize_t chunk;
+    struct lwp_uiter iter;
+    struct iovec one;
+    void *uaddr, *kaddr;
+
+    page = rt_pages_alloc_ext(0, PAGE_ANY_AVAILABLE);
+    uassert_not_null(page);
+    if (!page)
+    {
+        return;
+    }
+
+    buf = lwp_map_user_phy(lwp, RT_NULL, page + PV_OFFSET, ARCH_PAGE_SIZE, RT_TRUE);
+    uassert_not_null(buf);
+    if (buf)
+    {
+        one.iov_base = buf;
+        one.iov_len = ARCH_PAGE_SIZE;
+        uassert_int_equal(lwp_uiter_init(&iter, lwp, LWP_UITER_FROM_USER, &one, 1), 0);
+
+        /* handed out for a copy by the fault tolerant helpers */
+        chunk = lwp_uiter_chunk(&iter, ARCH_PAGE_SIZE, &uaddr, &kaddr);
+        uassert_int_equal(chunk, ARCH_PAGE_SIZE);
+        uassert_null(kaddr);
+        uassert_int_equal(rt_page_ref_get(page, 0), 1);
+        lwp_uiter_fini(&iter);
+
+        lwp_unmap_user(lwp, buf);
+    }
+
+    rt_pages_free(page, 0);
+}
+
+static rt_err_t utest_tc_init(void)
+{
+    if (!(pattern = rt_malloc(UITER_TC_SIZE)))
+    {
+        return -RT_ENOMEM;
+    }
+
+    if (!(data = rt_malloc(UITER_TC_SIZE)))
+    {
+        rt_free(pattern);
+        return -RT_ENOMEM;
+    }
+
+    for (int i = 0; i < UITER_TC_SIZE; i++)
+    {
+        pattern[i] = (char)(i * 13 + 7);
+    }
+
+    if (!(lwp = lwp_create(LWP_CREATE_FLAG_NONE)))
+    {
+        rt_free(data);
+        rt_free(pattern);
+        return -RT_ENOMEM;
+    }
+
+    if (lwp_user_space_init(lwp, 1) ||
+        !(ubuf = lwp_map_user(lwp, RT_NULL, UITER_TC_SIZE, RT_FALSE)))
+    {
+        lwp_ref_dec(lwp);
+        rt_free(data);
+        rt_free(pattern);
+        return -RT_ENOMEM;
+    }
+
+    _iov_setup();
+
+    return RT_EOK;
+}
+
+static rt_err_t utest_tc_cleanup(void)
+{
+    lwp_unmap_user(lwp, ubuf);
+    lwp_ref_dec(lwp);
+    rt_free(data);
+    rt_free(pattern);
+
+    return RT_EOK;
+}
+
+static void testcase(void)
+{
+    UTEST_UNIT_RUN(test_uiter_readv);
+    UTEST_UNIT_RUN(test_uiter_writev);
+    UTEST_UNIT_RUN(test_uiter_unmap_pinned);
+    UTEST_UNIT_RUN(test_uiter_phy_not_pinned);
+}
+UTEST_TC_EXPORT(testcase, "testcases.lwp.uiter_tc", utest_tc_init, utest_tc_cleanup, 10);
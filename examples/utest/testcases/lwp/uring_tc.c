@@ -0,0 +1,296 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ */
+
+#include <rtthread.h>
+#include <dfs_file.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <lwp.h>
+#include <lwp_user_mm.h>
+#include <lwp_uring.h>
+#include <lwp_syscall.h>
+#include <mm_aspace.h>
+#include "utest.h"
+
+/**
+ * @brief   lwp io_uring testcase.
+ *
+ * @note    The ring is set up for a new lwp, its SQ and CQ are driven from
+ *          here through the kernel mapping of the same pages, the buffers are
+ *          mapped in the lwp. The cases cover:
+ *          1. a NOP and a READ complete with their results and data;
+ *          2. a POLL_ADD on an empty pipe completes once the pipe is written;
+ *          3. closing the ring cancels an armed request and drops its file
+ *             reference;
+ *          4. CQEs posted while the CQ is full are kept, new SQEs are refused
+ *             with -EBUSY until they are reaped, then they come in order.
+ */
+
+#define URING_TC_ENTRIES        8
+#define URING_TC_FILE           "/uring_tc"
+#define URING_TC_SIZE           64
+#define URING_TC_TIMEOUT        1000
+
+static struct rt_lwp *lwp;
+static int ring_fd = -1;
+static struct lwp_uring_params params;
+static struct lwp_uring_rings *rings;
+static struct lwp_uring_sqe *sqes;
+static struct lwp_uring_cqe *cqes;
+static void *ubuf;
+
+static void _uring_tc_push(rt_uint8_t opcode, int fd, void *addr, rt_uint32_t len,
+        rt_uint32_t op_flags, rt_uint64_t user_data)
+{
+    struct lwp_uring_sqe *sqe = &sqes[rings->sq_tail & rings->sq_mask];
+
+    rt_memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->addr = (rt_uint64_t)(rt_ubase_t)addr;
+    sqe->len = len;
+    sqe->op_flags = op_flags;
+    sqe->user_data = user_data;
+
+    /* the SQE must be visible before the tail */
+    rt_hw_dmb();
+    rings->sq_tail++;
+}
+
+static rt_bool_t _uring_tc_pop(struct lwp_uring_cqe *cqe)
+{
+    if (rings->cq_head == rings->cq_tail)
+    {
+        return RT_FALSE;
+    }
+
+    rt_hw_dmb();
+    rt_memcpy(cqe, &cqes[rings->cq_head & rings->cq_mask], sizeof(*cqe));
+    rings->cq_head++;
+
+    return RT_TRUE;
+}
+
+static void test_uring_submit_complete(void)
+{
+    int fd;
+    char pattern[URING_TC_SIZE], data[URING_TC_SIZE];
+    struct lwp_uring_cqe cqe;
+
+    for (int i = 0; i < URING_TC_SIZE; ++i)
+    {
+        pattern[i] = (char)(i * 7 + 1);
+    }
+
+    fd = open(URING_TC_FILE, O_RDWR | O_CREAT | O_TRUNC, 0);
+    uassert_true(fd >= 0);
+    if (fd < 0)
+    {
+        return;
+    }
+    uassert_int_equal(write(fd, pattern, URING_TC_SIZE), URING_TC_SIZE);
+
+    _uring_tc_push(LWP_URING_OP_NOP, -1, RT_NULL, 0, 0, 1);
+    _uring_tc_push(LWP_URING_OP_READ, fd, ubuf, URING_TC_SIZE, 0, 2);
+
+    uassert_int_equal(sys_io_uring_enter(ring_fd, 2, 2, LWP_URING_ENTER_GETEVENTS), 2);
+
+    for (int i = 0; i < 2; ++i)
+    {
+        uassert_true(_uring_tc_pop(&cqe));
+
+        if (cqe.user_data == 1)
+        {
+            uassert_int_equal(cqe.res, 0);
+        }
+        else
+        {
+            uassert_int_equal(cqe.user_data, 2);
+            uassert_int_equal(cqe.res, URING_TC_SIZE);
+        }
+    }
+
+    uassert_int_equal(lwp_data_get(lwp, data, ubuf, URING_TC_SIZE), URING_TC_SIZE);
+    uassert_buf_equal(data, pattern, URING_TC_SIZE);
+
+    close(fd);
+    unlink(URING_TC_FILE);
+}
+
+static void test_uring_poll_pipe(void)
+{
+    int fds[2];
+    char byte = 'u';
+    struct lwp_uring_cqe cqe;
+
+    uassert_int_equal(pipe(fds), 0);
+
+    _uring_tc_push(LWP_URING_OP_POLL_ADD, fds[0], RT_NULL, 0, POLLIN, 3);
+    uassert_int_equal(sys_io_uring_enter(ring_fd, 1, 0, 0), 1);
+
+    /* nothing to read yet */
+    rt_thread_mdelay(10);
+    uassert_false(_uring_tc_pop(&cqe));
+
+    uassert_int_equal(write(fds[1], &byte, 1), 1);
+    uassert_int_equal(sys_io_uring_enter(ring_fd, 0, 1, LWP_URING_ENTER_GETEVENTS), 0);
+
+    uassert_true(_uring_tc_pop(&cqe));
+    uassert_int_equal(cqe.user_data, 3);
+    uassert_true(cqe.res & POLLIN);
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+static void test_uring_close_cancel(void)
+{
+    int fds[2];
+    rt_tick_t start;
+    struct dfs_file *file;
+
+    uassert_int_equal(pipe(fds), 0);
+    file = fd_get(fds[0]);
+
+    _uring_tc_push(LWP_URING_OP_POLL_ADD, fds[0], RT_NULL, 0, POLLIN, 4);
+    uassert_int_equal(sys_io_uring_enter(ring_fd, 1, 0, 0), 1);
+
+    /* the armed request holds the file */
+    uassert_int_equal(file->ref_count, 2);
+
+    close(ring_fd);
+    ring_fd = -1;
+
+    start = rt_tick_get();
+    while (file->ref_count != 1 &&
+           rt_tick_get() - start < rt_tick_from_millisecond(URING_TC_TIMEOUT))
+    {
+        rt_thread_mdelay(1);
+    }
+    uassert_int_equal(file->ref_count, 1);
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+static void test_uring_cq_overflow(void)
+{
+    rt_uint64_t user_data = 0, expected = 0;
+    struct lwp_uring_cqe cqe;
+
+    /* fill the CQ, then keep as many again on the overflow list */
+    while (user_data < params.cq_entries + params.sq_entries)
+    {
+        for (int i = 0; i < params.sq_entries; ++i)
+        {
+            _uring_tc_push(LWP_URING_OP_NOP, -1, RT_NULL, 0, 0, user_data++);
+        }
+        uassert_int_equal(sys_io_uring_enter(ring_fd, params.sq_entries, 0, 0), params.sq_entries);
+    }
+    uassert_int_equal(rings->cq_tail - rings->cq_head, params.cq_entries);
+
+    _uring_tc_push(LWP_URING_OP_NOP, -1, RT_NULL, 0, 0, user_data);
+    uassert_int_equal(sys_io_uring_enter(ring_fd, 1, 0, 0), -EBUSY);
+
+    /* reap the CQ, the backlog is moved in on the next enter */
+    for (int i = 0; i < params.cq_entries; ++i)
+    {
+        uassert_true(_uring_tc_pop(&cqe));
+        uassert_int_equal(cqe.user_data, expected++);
+    }
+    uassert_int_equal(sys_io_uring_enter(ring_fd, 1, 0, 0), 1);
+
+    while (_uring_tc_pop(&cqe))
+    {
+        uassert_int_equal(cqe.user_data, expected++);
+        uassert_int_equal(cqe.res, 0);
+    }
+    uassert_int_equal(expected, user_data + 1);
+    uassert_int_equal(rings->cq_overflow, 0);
+}
+
+static rt_err_t _uring_tc_setup(void)
+{
+    char *kaddr;
+
+    rt_memset(&params, 0, sizeof(params));
+    ring_fd = lwp_uring_setup(lwp, URING_TC_ENTRIES, &params);
+    if (ring_fd < 0)
+    {
+        return -RT_ERROR;
+    }
+
+    /* the kernel address of the pages mapped in the lwp */
+    kaddr = (char *)lwp_v2p(lwp, (void *)(rt_ubase_t)params.rings) - PV_OFFSET;
+    rings = (struct lwp_uring_rings *)kaddr;
+    sqes = (struct lwp_uring_sqe *)(kaddr + params.sq_off);
+    cqes = (struct lwp_uring_cqe *)(kaddr + params.cq_off);
+
+    return RT_EOK;
+}
+
+static rt_err_t utest_tc_init(void)
+{
+    if (!(lwp = lwp_create(LWP_CREATE_FLAG_NONE)))
+    {
+        return -RT_ENOMEM;
+    }
+
+    if (lwp_user_space_init(lwp, 1) ||
+        !(ubuf = lwp_map_user(lwp, RT_NULL, ARCH_PAGE_SIZE, RT_FALSE)))
+    {
+        lwp_ref_dec(lwp);
+        return -RT_ENOMEM;
+    }
+
+    return RT_EOK;
+}
+
+static rt_err_t utest_tc_cleanup(void)
+{
+    if (ring_fd >= 0)
+    {
+        close(ring_fd);
+        ring_fd = -1;
+    }
+
+    lwp_unmap_user(lwp, ubuf);
+    lwp_ref_dec(lwp);
+
+    return RT_EOK;
+}
+
+static void testcase(void)
+{
+    uassert_int_equal(_uring_tc_setup(), RT_EOK);
+    if (ring_fd < 0)
+    {
+        return;
+    }
+
+    UTEST_UNIT_RUN(test_uring_submit_complete);
+    UTEST_UNIT_RUN(test_uring_poll_pipe);
+    UTEST_UNIT_RUN(test_uring_close_cancel);
+
+    /* a fresh ring with an empty CQ */
+    if (ring_fd >= 0)
+    {
+        close(ring_fd);
+    }
+    uassert_int_equal(_uring_tc_setup(), RT_EOK);
+    if (ring_fd < 0)
+    {
+        return;
+    }
+
+    UTEST_UNIT_RUN(test_uring_cq_overflow);
+}
+UTEST_TC_EXPORT(testcase, "testcases.lwp.uring_tc", utest_tc_init, utest_tc_cleanup, 10);
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ */
+
+#include "common.h"
+#include "lwp_user_mm.h"
+#include <dfs_file.h>
+#include <mm_fault.h>
+
+/**
+ * @brief   file mapping fault-around testcase.
+ *
+ * @note    The file is read through once, so all of its pages are in the
+ *          page cache. A read fault on a private mapping must map its whole
+ *          aligned window with the content of the file, a read fault on a
+ *          shared writable mapping must map the faulting page only, and
+ *          MAP_POPULATE must map every page of the mapping up front.
+ */
+
+#ifndef RT_PAGECACHE_FAULT_AROUND
+#define RT_PAGECACHE_FAULT_AROUND   16
+#endif
+
+#define WINDOW_PAGES    RT_PAGECACHE_FAULT_AROUND
+#define FILE_PAGES      (WINDOW_PAGES * 2)
+#define FILE_PATH       "/test_fault_around"
+#define FILE_SZ         (FILE_PAGES * ARCH_PAGE_SIZE)
+
+static struct rt_lwp *lwp;
+static void *vaddr = (void *)0x100000000;
+static char page_sz_buf[ARCH_PAGE_SIZE];
+
+static char _page_char(size_t index)
+{
+    return 'a' + index % ('z' - 'a' + 1);
+}
+
+static size_t _count_mapped(char *start, size_t pages)
+{
+    size_t count = 0;
+
+    for (size_t i = 0; i < pages; i++)
+    {
+        if (rt_hw_mmu_v2p(lwp->aspace, start + i * ARCH_PAGE_SIZE) != ARCH_MAP_FAILED)
+            count++;
+    }
+    return count;
+}
+
+static int _read_fault(char *va)
+{
+    struct rt_aspace_fault_msg msg;
+
+    msg.fault_op = MM_FAULT_OP_READ;
+    msg.fault_type = MM_FAULT_TYPE_PAGE_FAULT;
+    msg.fault_vaddr = va;
+    msg.off = (long)va >> MM_PAGE_SHIFT;
+
+    return rt_aspace_fault_try_fix(lwp->aspace, &msg);
+}
+
+static void *_mmap_file(int oflags, int prot, int flags)
+{
+    void *addr;
+    long fd;
+
+    fd = open(FILE_PATH, oflags);
+    uassert_true(fd >= 0);
+    if (fd < 0)
+        return RT_NULL;
+
+    addr = lwp_mmap2(lwp, vaddr, FILE_SZ, prot, flags, fd, 0);
+    close(fd);
+
+    utest_int_equal(addr, vaddr);
+    if (addr != vaddr)
+        return RT_NULL;
+
+    return addr;
+}
+
+static void test_fault_around_private(void)
+{
+    char *addr, *pa;
+
+    addr = _mmap_file(O_RDONLY, PROT_READ, MAP_PRIVATE);
+    if (!addr)
+        return;
+    utest_int_equal(_count_mapped(addr, FILE_PAGES), 0);
+
+    /* one fault maps the cached window around it */
+    uassert_true(_read_fault(addr + 3 * ARCH_PAGE_SIZE));
+    utest_int_equal(_count_mapped(addr, WINDOW_PAGES), WINDOW_PAGES);
+    utest_int_equal(_count_mapped(addr + WINDOW_PAGES * ARCH_PAGE_SIZE, WINDOW_PAGES), 0);
+
+    /* and nothing but the file content */
+    for (size_t i = 0; i < WINDOW_PAGES; i++)
+    {
+        pa = rt_hw_mmu_v2p(lwp->aspace, addr + i * ARCH_PAGE_SIZE);
+        utest_int_equal(RT_EOK, memtest(rt_kmem_p2v(pa), _page_char(i), ARCH_PAGE_SIZE));
+    }
+
+    /* the next window */
+    uassert_true(_read_fault(addr + (FILE_PAGES - 1) * ARCH_PAGE_SIZE));
+    utest_int_equal(_count_mapped(addr, FILE_PAGES), FILE_PAGES);
+
+    utest_int_equal(RT_EOK, rt_aspace_unmap_range(lwp->aspace, addr, FILE_SZ));
+}
+
+static void test_fault_around_shared_writable(void)
+{
+    char *addr;
+
+    addr = _mmap_file(O_RDWR, PROT_READ | PROT_WRITE, MAP_SHARED);
+    if (!addr)
+        return;
+
+    /* no page is mapped ahead, it would be written back on unmap */
+    uassert_true(_read_fault(addr + 3 * ARCH_PAGE_SIZE));
+    utest_int_equal(_count_mapped(addr, FILE_PAGES), 1);
+
+    utest_int_equal(RT_EOK, rt_aspace_unmap_range(lwp->aspace, addr, FILE_SZ));
+}
+
+static void test_map_populate(void)
+{
+    char *addr;
+
+    addr = _mmap_file(O_RDONLY, PROT_READ, MAP_PRIVATE | MAP_POPULATE);
+    if (!addr)
+        return;
+
+    utest_int_equal(_count_mapped(addr, FILE_PAGES), FILE_PAGES);
+
+    utest_int_equal(RT_EOK, rt_aspace_unmap_range(lwp->aspace, addr, FILE_SZ));
+}
+
+static rt_err_t utest_tc_init(void)
+{
+    long fd;
+    rt_bool_t cached;
+
+    fd = open(FILE_PATH, O_RDWR | O_CREAT | O_TRUNC, 0777);
+    if (fd < 0)
+        return -RT_ERROR;
+
+    for (size_t i = 0; i < FILE_PAGES; i++)
+    {
+        memset(page_sz_buf, _page_char(i), ARCH_PAGE_SIZE);
+        write(fd, page_sz_buf, ARCH_PAGE_SIZE);
+    }
+
+    /* bring every page into the page cache */
+    lseek(fd, 0, SEEK_SET);
+    while (read(fd, page_sz_buf, ARCH_PAGE_SIZE) > 0)
+        ;
+
+    cached = fd_get(fd)->vnode->aspace != RT_NULL;
+    close(fd);
+
+    if (!cached)
+    {
+        LOG_W("%s is not in the page cache", FILE_PATH);
+        unlink(FILE_PATH);
+        return -RT_ENOSYS;
+    }
+
+    lwp = lwp_create(0);
+    if (lwp)
+        lwp_user_space_init(lwp, 1);
+    else
+        return -RT_ENOMEM;
+    return RT_EOK;
+}
+
+static rt_err_t utest_tc_cleanup(void)
+{
+    lwp_ref_dec(lwp);
+    unlink(FILE_PATH);
+    return RT_EOK;
+}
+
+static void testcase(void)
+{
+    UTEST_UNIT_RUN(test_fault_around_private);
+    UTEST_UNIT_RUN(test_fault_around_shared_writable);
+    UTEST_UNIT_RUN(test_map_populate);
+}
+UTEST_TC_EXPORT(testcase, "testcases.mm.fault_around", utest_tc_init, utest_tc_cleanup, 10);
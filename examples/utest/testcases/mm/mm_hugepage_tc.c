@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ */
+
+#include "common.h"
+#include "lwp_user_mm.h"
+
+/**
+ * @brief   transparent huge page testcase.
+ *
+ * @note    A split huge page frame must be freed page by page, a fault in a
+ *          large private mapping must populate the whole aligned block with
+ *          contiguous frames, and a partial unmap must only remove the pages
+ *          in range.
+ */
+
+static void *vaddr = (void *)0x100000000;
+static size_t map_size = RT_HUGE_PAGE_SIZE * 2;
+static struct rt_lwp *lwp;
+
+static void test_page_split(void)
+{
+    rt_size_t total, free_before, free_after;
+    char *block;
+
+    rt_page_get_info(&total, &free_before);
+
+    block = rt_pages_alloc(RT_HUGE_PAGE_ORDER);
+    uassert_not_null(block);
+    if (!block)
+        return;
+
+    rt_page_split(block, RT_HUGE_PAGE_ORDER);
+    for (size_t off = 0; off < RT_HUGE_PAGE_SIZE; off += ARCH_PAGE_SIZE)
+    {
+        utest_int_equal(rt_page_ref_get(block + off, 0), 1);
+    }
+    for (size_t off = 0; off < RT_HUGE_PAGE_SIZE; off += ARCH_PAGE_SIZE)
+    {
+        utest_int_equal(rt_pages_free(block + off, 0), 1);
+    }
+
+    rt_page_get_info(&total, &free_after);
+    utest_int_equal(free_before, free_after);
+}
+
+static void test_anon_huge_fault(void)
+{
+    char *block = (char *)vaddr + RT_HUGE_PAGE_SIZE;
+    char *hole = block + 0x3000;
+    char *page_pa;
+    void *buffer;
+
+    buffer = rt_pages_alloc(0);
+    uassert_not_null(buffer);
+    if (!buffer)
+        return;
+    rt_memset(buffer, 0xa5, ARCH_PAGE_SIZE);
+
+    uassert_true(!rt_aspace_map_private(lwp->aspace, &vaddr, map_size, MMU_MAP_U_RWCB, MMF_MAP_FIXED));
+
+    /* a single write populates the whole block */
+    utest_int_equal(RT_EOK, rt_aspace_page_put(lwp->aspace, block + 0x1000, buffer));
+    page_pa = rt_hw_mmu_v2p(lwp->aspace, block);
+    uassert_true(page_pa != ARCH_MAP_FAILED);
+    uassert_true(!((rt_ubase_t)page_pa & (RT_HUGE_PAGE_SIZE - 1)));
+    for (size_t off = 0; off < RT_HUGE_PAGE_SIZE; off += ARCH_PAGE_SIZE)
+    {
+        uassert_true(rt_hw_mmu_v2p(lwp->aspace, block + off) == page_pa + off);
+    }
+    uassert_true(!memtest(rt_kmem_p2v(page_pa + 0x1000), 0xa5, ARCH_PAGE_SIZE));
+
+    /* unmap a page in the middle of the block */
+    utest_int_equal(RT_EOK, rt_aspace_unmap_range(lwp->aspace, hole, ARCH_PAGE_SIZE));
+    uassert_true(rt_hw_mmu_v2p(lwp->aspace, hole) == ARCH_MAP_FAILED);
+    uassert_true(rt_hw_mmu_v2p(lwp->aspace, hole - ARCH_PAGE_SIZE) == page_pa + 0x2000);
+    uassert_true(rt_hw_mmu_v2p(lwp->aspace, hole + ARCH_PAGE_SIZE) == page_pa + 0x4000);
+    uassert_true(!memtest(rt_kmem_p2v(rt_hw_mmu_v2p(lwp->aspace, block + 0x1000)), 0xa5, ARCH_PAGE_SIZE));
+
+    utest_int_equal(RT_EOK, rt_aspace_unmap_range(lwp->aspace, vaddr, map_size));
+    uassert_true(rt_hw_mmu_v2p(lwp->aspace, block) == ARCH_MAP_FAILED);
+
+    rt_pages_free(buffer, 0);
+}
+
+static rt_err_t utest_tc_init(void)
+{
+    lwp = lwp_create(0);
+    if (lwp)
+        lwp_user_space_init(lwp, 1);
+    else
+        return -RT_ENOMEM;
+    return RT_EOK;
+}
+
+static rt_err_t utest_tc_cleanup(void)
+{
+    lwp_ref_dec(lwp);
+    return RT_EOK;
+}
+
+static void testcase(void)
+{
+    UTEST_UNIT_RUN(test_page_split);
+    UTEST_UNIT_RUN(test_anon_huge_fault);
+}
+UTEST_TC_EXPORT(testcase, "testcases.mm.hugepage", utest_tc_init, utest_tc_cleanup, 10);
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ * 2026-10-17     agent        check the cache of the running CPU only
+ */
+
+#include "common.h"
+
+/**
+ * @brief   per-CPU page frame cache testcase.
+ *
+ * @note    Single page frames go through the cache of the CPU, a frame
+ *          must only enter the cache when its last reference is dropped,
+ *          and a drain must empty the caches of every CPU.
+ */
+
+#define TEST_PAGES_NR   (RT_PAGE_PCP_BATCH * 4)
+
+static void *pages[TEST_PAGES_NR];
+
+/* keep the test thread on one CPU, so only its cache is touched by us */
+static int _pcp_pin_cpu(void)
+{
+    int cpu = rt_cpu_get_id();
+
+#ifdef RT_USING_SMP
+    rt_thread_control(rt_thread_self(), RT_THREAD_CTRL_BIND_CPU, (void *)(rt_ubase_t)cpu);
+
+    /* we may be migrated before being bound, wait until we are there */
+    while (rt_cpu_get_id() != cpu)
+    {
+        rt_thread_mdelay(1);
+    }
+#endif /* RT_USING_SMP */
+    return cpu;
+}
+
+static void _pcp_unpin_cpu(void)
+{
+#ifdef RT_USING_SMP
+    rt_thread_control(rt_thread_self(), RT_THREAD_CTRL_BIND_CPU, (void *)RT_CPUS_NR);
+#endif /* RT_USING_SMP */
+}
+
+static void test_pcp_alloc_free(void)
+{
+    struct rt_page_pcp_stat before, after;
+    int cpu;
+
+    cpu = _pcp_pin_cpu();
+
+    /* start from an empty cache so the allocation must refill it */
+    rt_page_pcp_drain();
+    uassert_int_equal(rt_page_pcp_get_stat(cpu, &before), RT_EOK);
+
+    for (int i = 0; i < TEST_PAGES_NR; i++)
+    {
+        pages[i] = rt_pages_alloc(0);
+        uassert_not_null(pages[i]);
+        rt_memset(pages[i], i, ARCH_PAGE_SIZE);
+    }
+    for (int i = 0; i < TEST_PAGES_NR; i++)
+    {
+        uassert_int_equal(rt_pages_free(pages[i], 0), 1);
+    }
+
+    /* the other CPUs are running, only the cache of this CPU is stable */
+    uassert_int_equal(rt_page_pcp_get_stat(cpu, &after), RT_EOK);
+    uassert_true(after.alloc - before.alloc >= TEST_PAGES_NR);
+    uassert_true(after.free - before.free >= TEST_PAGES_NR);
+    uassert_true(after.refill > before.refill);
+    uassert_true(after.count <= RT_PAGE_PCP_HIGH * 2);
+
+    _pcp_unpin_cpu();
+}
+
+static void test_pcp_ref(void)
+{
+    void *page = rt_pages_alloc(0);
+
+    uassert_not_null(page);
+
+    rt_page_ref_inc(page, 0);
+    uassert_int_equal(rt_page_ref_get(page, 0), 2);
+
+    uassert_int_equal(rt_pages_free(page, 0), 0);
+    uassert_int_equal(rt_page_ref_get(page, 0), 1);
+    uassert_int_equal(rt_pages_free(page, 0), 1);
+}
+
+static void test_pcp_drain(void)
+{
+    struct rt_page_pcp_stat stat;
+    rt_base_t level;
+    void *block;
+    int cpu;
+
+    level = rt_hw_local_irq_disable();
+    cpu = rt_cpu_get_id();
+    rt_page_pcp_drain();
+    uassert_int_equal(rt_page_pcp_get_stat(cpu, &stat), RT_EOK);
+    uassert_int_equal(stat.count, 0);
+    rt_hw_local_irq_enable(level);
+
+    /* the drained frames merge back into blocks */
+    block = rt_pages_alloc(2);
+    uassert_not_null(block);
+    uassert_int_equal(rt_pages_free(block, 2), 1);
+}
+
+static rt_err_t utest_tc_init(void)
+{
+    return RT_EOK;
+}
+
+static rt_err_t utest_tc_cleanup(void)
+{
+    return RT_EOK;
+}
+
+static void testcase(void)
+{
+    UTEST_UNIT_RUN(test_pcp_alloc_free);
+    UTEST_UNIT_RUN(test_pcp_ref);
+    UTEST_UNIT_RUN(test_pcp_drain);
+}
+UTEST_TC_EXPORT(testcase, "testcases.mm.page_pcp_tc", utest_tc_init, utest_tc_cleanup, 20);
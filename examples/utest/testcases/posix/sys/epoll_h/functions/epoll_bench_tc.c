@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ */
+
+#include <rtthread.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include "utest.h"
+
+/**
+ * @brief   epoll_wait scalability benchmark.
+ *
+ * @note    One eventfd is signaled and harvested per round while the others
+ *          of the interest set stay idle. The harvest only visits the ready
+ *          list, so the cost per round must not follow the size of the
+ *          interest set. The interest set is up to 10000 fds, bounded by
+ *          DFS_FD_MAX, the timings are printed for comparison only.
+ */
+
+#define BENCH_MAX_FDS       10000
+#define BENCH_RESERVED_FDS  8
+#define BENCH_ROUNDS        10000
+
+#if DFS_FD_MAX - BENCH_RESERVED_FDS < BENCH_MAX_FDS
+#define BENCH_FDS           (DFS_FD_MAX - BENCH_RESERVED_FDS)
+#else
+#define BENCH_FDS           BENCH_MAX_FDS
+#endif
+
+static int epfd = -1;
+static int efds[BENCH_FDS];
+static int efds_nr;
+
+static rt_tick_t bench_rounds(int efd)
+{
+    uint64_t value = 1;
+    struct epoll_event ev;
+    rt_tick_t start = rt_tick_get_millisecond();
+
+    for (int i = 0; i < BENCH_ROUNDS; ++i)
+    {
+        write(efd, &value, sizeof(value));
+
+        if (epoll_wait(epfd, &ev, 1, 0) != 1 || ev.data.fd != efd)
+        {
+            return (rt_tick_t)-1;
+        }
+
+        read(efd, &value, sizeof(value));
+    }
+
+    return rt_tick_get_millisecond() - start;
+}
+
+static rt_tick_t bench_monitor(int count, int op)
+{
+    struct epoll_event ev;
+    rt_tick_t start = rt_tick_get_millisecond();
+
+    for (int i = 0; i < count; ++i)
+    {
+        ev.events = EPOLLIN | EPOLLET;
+        ev.data.fd = efds[i];
+
+        if (epoll_ctl(epfd, op, efds[i], &ev))
+        {
+            return (rt_tick_t)-1;
+        }
+    }
+
+    return rt_tick_get_millisecond() - start;
+}
+
+static void test_epoll_bench_ready_one(void)
+{
+    rt_tick_t ms_one, ms_all, ms_add, ms_del;
+
+    uassert_true(efds_nr > 1);
+
+    /* Only the signaled fd is monitored */
+    ms_add = bench_monitor(1, EPOLL_CTL_ADD);
+    uassert_int_not_equal(ms_add, (rt_tick_t)-1);
+    ms_one = bench_rounds(efds[0]);
+    uassert_int_not_equal(ms_one, (rt_tick_t)-1);
+    bench_monitor(1, EPOLL_CTL_DEL);
+
+    /* Every fd is monitored, only one of them is signaled */
+    ms_add = bench_monitor(efds_nr, EPOLL_CTL_ADD);
+    uassert_int_not_equal(ms_add, (rt_tick_t)-1);
+    ms_all = bench_rounds(efds[efds_nr / 2]);
+    uassert_int_not_equal(ms_all, (rt_tick_t)-1);
+    ms_del = bench_monitor(efds_nr, EPOLL_CTL_DEL);
+    uassert_int_not_equal(ms_del, (rt_tick_t)-1);
+
+    rt_kprintf("epoll %d rounds: 1 fd %u ms, %d fds %u ms\n",
+            BENCH_ROUNDS, ms_one, efds_nr, ms_all);
+    rt_kprintf("epoll ctl %d fds: add %u ms, del %u ms\n", efds_nr, ms_add, ms_del);
+}
+
+static rt_err_t utest_tc_init(void)
+{
+    epfd = epoll_create(1);
+
+    if (epfd < 0)
+    {
+        return -RT_ERROR;
+    }
+
+    for (efds_nr = 0; efds_nr < BENCH_FDS; ++efds_nr)
+    {
+        if ((efds[efds_nr] = eventfd(0, EFD_NONBLOCK)) < 0)
+        {
+            break;
+        }
+    }
+
+    return RT_EOK;
+}
+
+static rt_err_t utest_tc_cleanup(void)
+{
+    while (efds_nr > 0)
+    {
+        close(efds[--efds_nr]);
+    }
+
+    if (epfd >= 0)
+    {
+        close(epfd);
+    }
+
+    return RT_EOK;
+}
+
+static void testcase(void)
+{
+    UTEST_UNIT_RUN(test_epoll_bench_ready_one);
+}
+UTEST_TC_EXPORT(testcase, "testcases.posix.epoll_bench_tc", utest_tc_init, utest_tc_cleanup, 60);
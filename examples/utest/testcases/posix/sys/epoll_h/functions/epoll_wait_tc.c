@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ */
+
+#include <rtthread.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include "utest.h"
+
+/**
+ * @brief   epoll_wait testcase.
+ *
+ * @note    The eventfds are monitored in the level-triggered, edge-triggered
+ *          and one-shot modes, a ready fd must be reported again only as
+ *          its mode allows, and a removed fd must never be reported.
+ */
+
+#define TEST_MAX_EVENTS 4
+
+static int epfd = -1;
+static int efd = -1;
+
+static void efd_signal(void)
+{
+    uint64_t value = 1;
+
+    uassert_int_equal(write(efd, &value, sizeof(value)), sizeof(value));
+}
+
+static void efd_drain(void)
+{
+    uint64_t value;
+
+    uassert_int_equal(read(efd, &value, sizeof(value)), sizeof(value));
+}
+
+static int efd_wait(int timeout)
+{
+    struct epoll_event events[TEST_MAX_EVENTS];
+    int count;
+
+    count = epoll_wait(epfd, events, TEST_MAX_EVENTS, timeout);
+
+    for (int i = 0; i < count; ++i)
+    {
+        uassert_int_equal(events[i].data.fd, efd);
+        uassert_true(events[i].events & EPOLLIN);
+    }
+
+    return count;
+}
+
+static void efd_monitor(int op, rt_uint32_t events)
+{
+    struct epoll_event ev;
+
+    ev.events = events;
+    ev.data.fd = efd;
+    uassert_int_equal(epoll_ctl(epfd, op, efd, &ev), 0);
+}
+
+static void test_epoll_level_triggered(void)
+{
+    efd_monitor(EPOLL_CTL_ADD, EPOLLIN);
+
+    uassert_int_equal(efd_wait(0), 0);
+
+    efd_signal();
+    uassert_int_equal(efd_wait(0), 1);
+    /* Still ready, reported again */
+    uassert_int_equal(efd_wait(0), 1);
+
+    efd_drain();
+    uassert_int_equal(efd_wait(0), 0);
+
+    uassert_int_equal(epoll_ctl(epfd, EPOLL_CTL_DEL, efd, RT_NULL), 0);
+}
+
+static void test_epoll_edge_triggered(void)
+{
+    efd_monitor(EPOLL_CTL_ADD, EPOLLIN | EPOLLET);
+
+    efd_signal();
+    uassert_int_equal(efd_wait(0), 1);
+    /* No new edge */
+    uassert_int_equal(efd_wait(0), 0);
+
+    efd_signal();
+    uassert_int_equal(efd_wait(0), 1);
+    uassert_int_equal(efd_wait(0), 0);
+
+    efd_drain();
+    uassert_int_equal(epoll_ctl(epfd, EPOLL_CTL_DEL, efd, RT_NULL), 0);
+}
+
+static void test_epoll_oneshot(void)
+{
+    efd_monitor(EPOLL_CTL_ADD, EPOLLIN | EPOLLONESHOT);
+
+    efd_signal();
+    uassert_int_equal(efd_wait(0), 1);
+
+    /* Disabled until rearmed */
+    efd_signal();
+    uassert_int_equal(efd_wait(0), 0);
+
+    efd_monitor(EPOLL_CTL_MOD, EPOLLIN | EPOLLONESHOT);
+    uassert_int_equal(efd_wait(0), 1);
+    uassert_int_equal(efd_wait(0), 0);
+
+    efd_drain();
+    uassert_int_equal(epoll_ctl(epfd, EPOLL_CTL_DEL, efd, RT_NULL), 0);
+}
+
+static void test_epoll_del(void)
+{
+    efd_monitor(EPOLL_CTL_ADD, EPOLLIN);
+
+    efd_signal();
+    uassert_int_equal(epoll_ctl(epfd, EPOLL_CTL_DEL, efd, RT_NULL), 0);
+    uassert_int_equal(efd_wait(0), 0);
+
+    efd_drain();
+}
+
+static void efd_signal_entry(void *param)
+{
+    uint64_t value = 1;
+
+    rt_thread_mdelay(50);
+    write(efd, &value, sizeof(value));
+}
+
+static void test_epoll_blocking(void)
+{
+    rt_thread_t thread;
+
+    efd_monitor(EPOLL_CTL_ADD, EPOLLIN | EPOLLET);
+
+    thread = rt_thread_create("epollsig", efd_signal_entry, RT_NULL,
+            UTEST_THR_STACK_SIZE, RT_THREAD_PRIORITY_MAX / 2, 10);
+    uassert_not_null(thread);
+    rt_thread_startup(thread);
+
+    /* Woken up by the wakeup callback of the eventfd */
+    uassert_int_equal(efd_wait(1000), 1);
+
+    efd_drain();
+    uassert_int_equal(epoll_ctl(epfd, EPOLL_CTL_DEL, efd, RT_NULL), 0);
+}
+
+static rt_err_t utest_tc_init(void)
+{
+    epfd = epoll_create(1);
+    efd = eventfd(0, EFD_NONBLOCK);
+
+    return (epfd < 0 || efd < 0) ? -RT_ERROR : RT_EOK;
+}
+
+static rt_err_t utest_tc_cleanup(void)
+{
+    if (efd >= 0)
+    {
+        close(efd);
+    }
+    if (epfd >= 0)
+    {
+        close(epfd);
+    }
+
+    return RT_EOK;
+}
+
+static void testcase(void)
+{
+    UTEST_UNIT_RUN(test_epoll_level_triggered);
+    UTEST_UNIT_RUN(test_epoll_edge_triggered);
+    UTEST_UNIT_RUN(test_epoll_oneshot);
+    UTEST_UNIT_RUN(test_epoll_del);
+    UTEST_UNIT_RUN(test_epoll_blocking);
+}
+UTEST_TC_EXPORT(testcase, "testcases.posix.epoll_wait_tc", utest_tc_init, utest_tc_cleanup, 10);
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ */
+#include <rtthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <mmu.h>
+#include "utest.h"
+
+#define RA_FILE         "/tmp/pcache_ra"
+#define RA_FILE_PAGES   96
+#define RA_CHUNK        1000
+
+static rt_uint8_t *buf;
+
+static rt_uint8_t _pattern(off_t pos)
+{
+    return (rt_uint8_t)((pos >> 12) * 31 + pos);
+}
+
+static int _check(const rt_uint8_t *data, off_t pos, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++)
+    {
+        if (data[i] != _pattern(pos + i))
+            return -1;
+    }
+    return 0;
+}
+
+static void test_make_file(void)
+{
+    int fd;
+    off_t pos;
+
+    fd = open(RA_FILE, O_CREAT | O_TRUNC | O_RDWR, 0644);
+    uassert_true(fd >= 0);
+    if (fd < 0)
+        return;
+
+    for (pos = 0; pos < RA_FILE_PAGES * ARCH_PAGE_SIZE; pos += ARCH_PAGE_SIZE)
+    {
+        off_t i;
+
+        for (i = 0; i < ARCH_PAGE_SIZE; i++)
+            buf[i] = _pattern(pos + i);
+        uassert_int_equal(write(fd, buf, ARCH_PAGE_SIZE), ARCH_PAGE_SIZE);
+    }
+    close(fd);
+}
+
+/* small chunks not aligned to pages, walking the readahead windows */
+static void test_sequential_read(void)
+{
+    int fd;
+    ssize_t len;
+    off_t pos = 0;
+
+    fd = open(RA_FILE, O_RDONLY);
+    uassert_true(fd >= 0);
+    if (fd < 0)
+        return;
+
+    while ((len = read(fd, buf, RA_CHUNK)) > 0)
+    {
+        if (_check(buf, pos, len))
+        {
+            rt_kprintf("sequential read mismatch at %d\n", (int)pos);
+            break;
+        }
+        pos += len;
+    }
+    uassert_int_equal(pos, RA_FILE_PAGES * ARCH_PAGE_SIZE);
+    close(fd);
+}
+
+/* jump around the file, which collapses the window */
+static void test_random_read(void)
+{
+    int fd, i;
+    off_t pos;
+
+    fd = open(RA_FILE, O_RDONLY);
+    uassert_true(fd >= 0);
+    if (fd < 0)
+        return;
+
+    for (i = 0; i < 64; i++)
+    {
+        pos = ((i * 37) % RA_FILE_PAGES) * ARCH_PAGE_SIZE + i * 13;
+        uassert_int_equal(lseek(fd, pos, SEEK_SET), pos);
+        uassert_int_equal(read(fd, buf, RA_CHUNK), RA_CHUNK);
+        uassert_int_equal(_check(buf, pos, RA_CHUNK), 0);
+    }
+    close(fd);
+}
+
+/* close right after a read which issued an async window */
+static void test_close_in_flight(void)
+{
+    int fd, i;
+
+    for (i = 0; i < 16; i++)
+    {
+        fd = open(RA_FILE, O_RDONLY);
+        uassert_true(fd >= 0);
+        if (fd < 0)
+            return;
+        uassert_int_equal(read(fd, buf, ARCH_PAGE_SIZE), ARCH_PAGE_SIZE);
+        uassert_int_equal(_check(buf, 0, ARCH_PAGE_SIZE), 0);
+        close(fd);
+    }
+}
+
+static rt_err_t utest_tc_init(void)
+{
+    buf = rt_malloc(ARCH_PAGE_SIZE);
+    return buf ? RT_EOK : -RT_ENOMEM;
+}
+
+static rt_err_t utest_tc_cleanup(void)
+{
+    unlink(RA_FILE);
+    rt_free(buf);
+    return RT_EOK;
+}
+
+static void testcase(void)
+{
+    UTEST_UNIT_RUN(test_make_file);
+    UTEST_UNIT_RUN(test_sequential_read);
+    UTEST_UNIT_RUN(test_random_read);
+    UTEST_UNIT_RUN(test_close_in_flight);
+}
+UTEST_TC_EXPORT(testcase, "testcase.tfs.pcache_ra", utest_tc_init, utest_tc_cleanup, 30);
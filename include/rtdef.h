@@ -705,10 +705,18 @@ struct rt_cpu
     #else
         rt_uint32_t             priority_group;
     #endif /* RT_THREAD_PRIORITY_MAX > 32 */
+    #ifdef RT_SCHED_USING_PERCPU_RUNQUEUE
+        rt_uint32_t             ready_unbound;  /**< unbound threads queued, candidates of stealing */
+    #endif /* RT_SCHED_USING_PERCPU_RUNQUEUE */
 
         rt_atomic_t             tick;   /**< Passing tickes on this core */
     );
 
+#ifdef RT_SCHED_USING_PERCPU_RUNQUEUE
+    struct rt_spinlock          rq_lock;    /**< protect the ready queue of this core */
+    rt_list_t                   wake_pending; /**< threads woken by this core, not queued yet */
+#endif /* RT_SCHED_USING_PERCPU_RUNQUEUE */
+
     struct rt_thread            *idle_thread;
     rt_atomic_t                 irq_nest;
 
@@ -1164,6 +1172,20 @@ typedef rt_mem_t rt_smem_t;
 
 #ifdef RT_USING_SLAB
 typedef rt_mem_t rt_slab_t;
+
+#ifdef RT_USING_SLAB_MAGAZINE
+/**
+ * statistics of the magazine of a cpu for a size class
+ */
+struct rt_slab_magazine_stat
+{
+    rt_uint32_t count;                                  /**< chunks cached now */
+    rt_uint32_t alloc_hit;                              /**< alloc served by magazine */
+    rt_uint32_t alloc_miss;                             /**< alloc refilled from zones */
+    rt_uint32_t free_hit;                               /**< free cached by magazine */
+    rt_uint32_t free_miss;                              /**< free flushed to zones */
+};
+#endif /* RT_USING_SLAB_MAGAZINE */
 #endif /* RT_USING_SLAB */
 
 #ifdef RT_USING_MEMHEAP
@@ -194,6 +194,17 @@ void rt_hw_exception_install(rt_err_t (*exception_handle)(void *context));
  */
 void rt_hw_us_delay(rt_uint32_t us);
 
+#ifdef RT_USING_TICKLESS_IDLE
+/*
+ * tickless idle interface: stop the periodic tick of the current cpu and
+ * wait for an interrupt, or `tick` periods since the last announced tick,
+ * then resume the periodic tick. It's invoked with local irq disabled and
+ * returns the periods passed since the last announced tick, which will be
+ * announced by the next tick interrupt.
+ */
+rt_tick_t rt_hw_tick_idle(rt_tick_t tick);
+#endif /* RT_USING_TICKLESS_IDLE */
+
 int rt_hw_cpu_id(void);
 
 #if defined(RT_USING_SMP) || defined(RT_USING_AMP)
@@ -7,6 +7,7 @@
  * Date           Author       Notes
  * 2024-01-19     Shell        Separate scheduling statements from rt_thread_t
  *                             to rt_sched_thread_ctx. Add definitions of scheduler.
+ * 2026-10-17     agent        add wake_cpu for deferred queuing of woken threads
  */
 #ifndef __RT_SCHED_H__
 #define __RT_SCHED_H__
@@ -61,6 +62,10 @@ struct rt_sched_thread_ctx
 #ifdef RT_USING_SMP
     rt_uint8_t                  bind_cpu;               /**< thread is bind to cpu */
     rt_uint8_t                  oncpu;                  /**< process on cpu */
+#ifdef RT_SCHED_USING_PERCPU_RUNQUEUE
+    rt_uint8_t                  rq_cpu;                 /**< ready queue of the cpu it queued on or last ran on */
+    rt_uint8_t                  wake_cpu;               /**< cpu deferring the queuing of the woken thread */
+#endif /* RT_SCHED_USING_PERCPU_RUNQUEUE */
 
     rt_base_t                   critical_lock_nest;     /**< critical lock count */
 #endif
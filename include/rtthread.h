@@ -23,6 +23,7 @@
  * 2023-12-10     xqyjlj       fix spinlock in up
  * 2024-01-25     Shell        Add rt_susp_list for IPC primitives
  * 2024-03-10     Meco Man     move std libc related functions to rtklibc
+ * 2026-10-17     agent        add rt_softirq_irq_exit
  */
 
 #ifndef __RT_THREAD_H__
@@ -208,6 +209,9 @@ rt_err_t rt_thread_idle_sethook(void (*hook)(void));
 rt_err_t rt_thread_idle_delhook(void (*hook)(void));
 #endif /* defined(RT_USING_HOOK) || defined(RT_USING_IDLE_HOOK) */
 rt_thread_t rt_thread_idle_gethandler(void);
+#ifdef RT_USING_TICKLESS_IDLE
+void rt_thread_idle_tickless_kick(void);
+#endif /* RT_USING_TICKLESS_IDLE */
 
 /*
  * schedule service
@@ -381,6 +385,14 @@ void rt_slab_page_free(rt_slab_t m, void *addr, rt_size_t npages);
 void *rt_slab_alloc(rt_slab_t m, rt_size_t size);
 void *rt_slab_realloc(rt_slab_t m, void *ptr, rt_size_t size);
 void rt_slab_free(rt_slab_t m, void *ptr);
+#ifdef RT_USING_SLAB_MAGAZINE
+void *rt_slab_magazine_alloc(rt_slab_t m, rt_size_t size);
+void *rt_slab_magazine_refill(rt_slab_t m, rt_size_t size);
+rt_bool_t rt_slab_magazine_free(rt_slab_t m, void *ptr);
+void rt_slab_magazine_flush(rt_slab_t m, void *ptr);
+rt_err_t rt_slab_magazine_get_stat(rt_slab_t m, int cpu, rt_size_t size,
+                                   struct rt_slab_magazine_stat *stat);
+#endif /* RT_USING_SLAB_MAGAZINE */
 #endif /* RT_USING_SLAB */
 
 /**@}*/
@@ -636,6 +648,20 @@ rt_ssize_t rt_mq_recv_prio(rt_mq_t mq,
                            rt_int32_t timeout,
                            int suspend_flag);
 #endif /* RT_USING_MESSAGEQUEUE_PRIORITY */
+
+#ifdef RT_USING_MESSAGEQUEUE_ZEROCOPY
+rt_err_t rt_mq_reserve(rt_mq_t mq, void **buffer, rt_int32_t timeout, int suspend_flag);
+rt_err_t rt_mq_commit(rt_mq_t mq, void *buffer, rt_size_t size);
+rt_err_t rt_mq_commit_prio(rt_mq_t mq, void *buffer, rt_size_t size, rt_int32_t prio);
+rt_err_t rt_mq_cancel(rt_mq_t mq, void *buffer);
+rt_ssize_t rt_mq_borrow(rt_mq_t mq, void **buffer, rt_int32_t timeout, int suspend_flag);
+rt_ssize_t rt_mq_borrow_prio(rt_mq_t mq,
+                             void **buffer,
+                             rt_int32_t *prio,
+                             rt_int32_t timeout,
+                             int suspend_flag);
+rt_err_t rt_mq_release(rt_mq_t mq, void *buffer);
+#endif /* RT_USING_MESSAGEQUEUE_ZEROCOPY */
 #endif /* RT_USING_MESSAGEQUEUE */
 
 /**@}*/
@@ -754,6 +780,10 @@ void rt_interrupt_enter_sethook(void (*hook)(void));
 void rt_interrupt_leave_sethook(void (*hook)(void));
 #endif /* RT_USING_HOOK */
 
+#ifdef RT_SOFTIRQ_ON_IRQ_EXIT
+void rt_softirq_irq_exit(void);
+#endif /* RT_SOFTIRQ_ON_IRQ_EXIT */
+
 #ifdef RT_USING_COMPONENTS_INIT
 void rt_components_init(void);
 void rt_components_board_init(void);
@@ -6,6 +6,7 @@
  * Change Logs:
  * Date           Author       Notes
  * 2011-12-20     GuEe-GUI     first version
+ * 2026-10-17     agent        support tickless idle
  */
 
 #include <rtthread.h>
@@ -21,11 +22,51 @@
 
 static volatile rt_uint64_t timer_step;
 
+#ifdef RT_USING_TICKLESS_IDLE
+/* the counter of the last announced tick on each cpu */
+static rt_uint64_t timer_last[RT_CPUS_NR];
+
+static void rt_hw_timer_isr(int vector, void *parameter)
+{
+    rt_uint64_t *last = &timer_last[rt_hw_cpu_id()];
+    rt_tick_t passed;
+
+    /* announce all the ticks passed, the tick may be stopped in idle */
+    passed = (rt_hw_get_cntpct_val() - *last) / timer_step;
+    *last += (rt_uint64_t)passed * timer_step;
+    rt_hw_sysreg_write(CNTP_CVAL_EL0, *last + timer_step);
+
+    if (passed > 0)
+    {
+        rt_tick_increase_tick(passed);
+    }
+}
+
+rt_tick_t rt_hw_tick_idle(rt_tick_t tick)
+{
+    rt_uint64_t *last = &timer_last[rt_hw_cpu_id()];
+    rt_uint64_t now;
+
+    rt_hw_sysreg_write(CNTP_CVAL_EL0, *last + (rt_uint64_t)tick * timer_step);
+    rt_hw_isb();
+
+    /* wake up on pending interrupts even if they are masked */
+    rt_hw_wfi();
+
+    /* resume the periodic tick, it fires at once if any tick is missed */
+    now = rt_hw_get_cntpct_val();
+    rt_hw_sysreg_write(CNTP_CVAL_EL0, *last + timer_step);
+    rt_hw_isb();
+
+    return (now - *last) / timer_step;
+}
+#else
 static void rt_hw_timer_isr(int vector, void *parameter)
 {
     rt_hw_set_gtimer_val(timer_step);
     rt_tick_increase();
 }
+#endif /* RT_USING_TICKLESS_IDLE */
 
 void rt_hw_gtimer_init(void)
 {
@@ -40,7 +81,12 @@ void rt_hw_gtimer_init(void)
 void rt_hw_gtimer_local_enable(void)
 {
     rt_hw_gtimer_disable();
+#ifdef RT_USING_TICKLESS_IDLE
+    timer_last[rt_hw_cpu_id()] = rt_hw_get_cntpct_val();
+    rt_hw_sysreg_write(CNTP_CVAL_EL0, timer_last[rt_hw_cpu_id()] + timer_step);
+#else
     rt_hw_set_gtimer_val(timer_step);
+#endif /* RT_USING_TICKLESS_IDLE */
     rt_hw_interrupt_umask(EL1_PHY_TIMER_IRQ_NUM);
 #ifdef RT_USING_KTIME
     rt_ktime_cputimer_init();
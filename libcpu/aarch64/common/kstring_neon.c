@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ */
+
+#include <rtthread.h>
+
+#ifdef RT_KLIBC_USING_ARCH_MEMOPS
+
+#include <arm_neon.h>
+
+/*
+ * The FPU/SIMD registers are saved on both context switch and interrupt,
+ * so NEON is free to use in any context of kernel. The loads and stores
+ * of NEON have no alignment limitation on normal memory.
+ */
+
+void *rt_memset(void *s, int c, rt_ubase_t count)
+{
+    rt_uint8_t *xs = (rt_uint8_t *)s;
+    uint8x16_t v = vdupq_n_u8((rt_uint8_t)c);
+
+    while (count >= 64)
+    {
+        vst1q_u8(xs, v);
+        vst1q_u8(xs + 16, v);
+        vst1q_u8(xs + 32, v);
+        vst1q_u8(xs + 48, v);
+        xs += 64;
+        count -= 64;
+    }
+
+    while (count >= 16)
+    {
+        vst1q_u8(xs, v);
+        xs += 16;
+        count -= 16;
+    }
+
+    while (count--)
+        *xs++ = (rt_uint8_t)c;
+
+    return s;
+}
+
+void *rt_memcpy(void *dst, const void *src, rt_ubase_t count)
+{
+    rt_uint8_t *d = (rt_uint8_t *)dst;
+    const rt_uint8_t *s = (const rt_uint8_t *)src;
+    uint8x16_t v0, v1, v2, v3;
+
+    while (count >= 64)
+    {
+        v0 = vld1q_u8(s);
+        v1 = vld1q_u8(s + 16);
+        v2 = vld1q_u8(s + 32);
+        v3 = vld1q_u8(s + 48);
+        vst1q_u8(d, v0);
+        vst1q_u8(d + 16, v1);
+        vst1q_u8(d + 32, v2);
+        vst1q_u8(d + 48, v3);
+        s += 64;
+        d += 64;
+        count -= 64;
+    }
+
+    while (count >= 16)
+    {
+        vst1q_u8(d, vld1q_u8(s));
+        s += 16;
+        d += 16;
+        count -= 16;
+    }
+
+    while (count--)
+        *d++ = *s++;
+
+    return dst;
+}
+
+rt_int32_t rt_memcmp(const void *cs, const void *ct, rt_size_t count)
+{
+    const rt_uint8_t *su1 = (const rt_uint8_t *)cs;
+    const rt_uint8_t *su2 = (const rt_uint8_t *)ct;
+    int res = 0;
+
+    /* skip the equal blocks, the different byte is found below */
+    while (count >= 16)
+    {
+        if (vminvq_u8(vceqq_u8(vld1q_u8(su1), vld1q_u8(su2))) != 0xff)
+            break;
+        su1 += 16;
+        su2 += 16;
+        count -= 16;
+    }
+
+    for (; count > 0; ++su1, ++su2, count--)
+        if ((res = *su1 - *su2) != 0)
+            break;
+
+    return res;
+}
+
+#endif /* RT_KLIBC_USING_ARCH_MEMOPS */
@@ -8,6 +8,7 @@
  * 2021-01-30     lizhirui     first version
  * 2022-12-13     WangXiaoyao  Port to new mm
  * 2023-10-12     Shell        Add permission control API
+ * 2026-10-17     agent        Map and split 2MB huge pages
  */
 
 #include <rtthread.h>
@@ -142,36 +143,142 @@ static int _map_one_page(struct rt_aspace *aspace, void *va, void *pa,
     return 0;
 }
 
+#ifdef RT_USING_HUGEPAGE
+/**
+ * map a 2MB leaf in the level 2 table. Return 1 if the entry is occupied by
+ * a level 3 table, the caller should fallback to normal pages then.
+ */
+static int _map_huge_page(struct rt_aspace *aspace, void *va, void *pa,
+                          size_t attr)
+{
+    rt_ubase_t l1_off, l2_off;
+    rt_ubase_t *mmu_l1, *mmu_l2;
+
+    l1_off = GET_L1((size_t)va);
+    l2_off = GET_L2((size_t)va);
+
+    mmu_l1 = ((rt_ubase_t *)aspace->page_table) + l1_off;
+
+    if (PTE_USED(*mmu_l1))
+    {
+        mmu_l2 = (rt_ubase_t *)PPN_TO_VPN(GET_PADDR(*mmu_l1), PV_OFFSET);
+    }
+    else
+    {
+        mmu_l2 = (rt_ubase_t *)rt_pages_alloc(0);
+
+        if (mmu_l2)
+        {
+            rt_memset(mmu_l2, 0, PAGE_SIZE);
+            rt_hw_cpu_dcache_clean(mmu_l2, PAGE_SIZE);
+            *mmu_l1 = COMBINEPTE((rt_ubase_t)VPN_TO_PPN(mmu_l2, PV_OFFSET),
+                                 PAGE_DEFAULT_ATTR_NEXT);
+            rt_hw_cpu_dcache_clean(mmu_l1, sizeof(*mmu_l1));
+        }
+        else
+        {
+            return -1;
+        }
+    }
+
+    if (PTE_USED(*(mmu_l2 + l2_off)))
+    {
+        RT_ASSERT(!PAGE_IS_LEAF(*(mmu_l2 + l2_off)));
+        return 1;
+    }
+
+    // declares a reference to parent page table
+    rt_page_ref_inc((void *)mmu_l2, 0);
+    *(mmu_l2 + l2_off) = COMBINEPTE((rt_ubase_t)pa, attr);
+    rt_hw_cpu_dcache_clean(mmu_l2 + l2_off, sizeof(*(mmu_l2 + l2_off)));
+    return 0;
+}
+
+/**
+ * split a 2MB leaf into a level 3 table with the same attributes, so a part
+ * of it can be unmapped or changed. The TLB is still coherent as the
+ * translation is unchanged.
+ */
+static int _split_huge_page(rt_ubase_t *pentry)
+{
+    rt_ubase_t *mmu_l3;
+    rt_ubase_t pa, attr;
+
+    mmu_l3 = (rt_ubase_t *)rt_pages_alloc(0);
+    if (!mmu_l3)
+    {
+        return -1;
+    }
+
+    pa = GET_PADDR(*pentry);
+    attr = *pentry ^ COMBINEPTE(pa, 0);
+    for (size_t i = 0; i < __SIZE(VPN0_BIT); i++)
+    {
+        mmu_l3[i] = COMBINEPTE(pa, attr);
+        pa += ARCH_PAGE_SIZE;
+        // declares a reference to parent page table
+        rt_page_ref_inc((void *)mmu_l3, 0);
+    }
+    rt_hw_cpu_dcache_clean(mmu_l3, PAGE_SIZE);
+
+    *pentry = COMBINEPTE((rt_ubase_t)VPN_TO_PPN(mmu_l3, PV_OFFSET),
+                         PAGE_DEFAULT_ATTR_NEXT);
+    rt_hw_cpu_dcache_clean(pentry, sizeof(*pentry));
+    return 0;
+}
+
+rt_inline rt_bool_t _can_map_huge(void *v_addr, void *p_addr, size_t size)
+{
+    return !(((rt_ubase_t)v_addr | (rt_ubase_t)p_addr) & (L2_PAGE_SIZE - 1)) &&
+           size >= L2_PAGE_SIZE;
+}
+#endif /* RT_USING_HUGEPAGE */
+
 /** rt_hw_mmu_map will never override existed page table entry */
 void *rt_hw_mmu_map(struct rt_aspace *aspace, void *v_addr, void *p_addr,
                     size_t size, size_t attr)
 {
     int ret = -1;
     void *unmap_va = v_addr;
-    size_t npages = size >> ARCH_PAGE_SHIFT;
+    size_t mapped;
 
     if ((rt_ubase_t)p_addr >= IO_SPACE_BASE_ADDR)
         attr |= PTE_SO;
-    // TODO trying with HUGEPAGE here
-    while (npages--)
+
+    size &= ~ARCH_PAGE_MASK;
+    while (size)
     {
+        mapped = ARCH_PAGE_SIZE;
         MM_PGTBL_LOCK(aspace);
-        ret = _map_one_page(aspace, v_addr, p_addr, attr);
+#ifdef RT_USING_HUGEPAGE
+        if (_can_map_huge(v_addr, p_addr, size))
+        {
+            ret = _map_huge_page(aspace, v_addr, p_addr, attr);
+            if (ret == 0)
+                mapped = L2_PAGE_SIZE;
+            else if (ret > 0)
+                ret = _map_one_page(aspace, v_addr, p_addr, attr);
+        }
+        else
+#endif /* RT_USING_HUGEPAGE */
+        {
+            ret = _map_one_page(aspace, v_addr, p_addr, attr);
+        }
         MM_PGTBL_UNLOCK(aspace);
         if (ret != 0)
         {
             /* error, undo map */
-            while (unmap_va != v_addr)
+            while (unmap_va < v_addr)
             {
                 MM_PGTBL_LOCK(aspace);
-                _unmap_area(aspace, unmap_va, ARCH_PAGE_SIZE);
+                unmap_va += _unmap_area(aspace, unmap_va, v_addr - unmap_va);
                 MM_PGTBL_UNLOCK(aspace);
-                unmap_va += ARCH_PAGE_SIZE;
             }
             break;
         }
-        v_addr += ARCH_PAGE_SIZE;
-        p_addr += ARCH_PAGE_SIZE;
+        v_addr += mapped;
+        p_addr += mapped;
+        size -= mapped;
     }
 
     if (ret == 0)
@@ -237,13 +344,32 @@ static size_t _unmap_area(struct rt_aspace *aspace, void *v_addr, size_t size)
         unmapped >>= ARCH_INDEX_WIDTH;
     }
 
+#ifdef RT_USING_HUGEPAGE
+    // a huge page partially covered by the region is split before unmapping
+    if (PTE_USED(*pentry) && i == 1 &&
+        ((loop_va & (L2_PAGE_SIZE - 1)) || size < L2_PAGE_SIZE))
+    {
+        if (_split_huge_page(pentry) != 0)
+        {
+            LOG_E("%s: no memory to split huge page at %p", __func__, v_addr);
+            return 0;
+        }
+        i += 1;
+        lvl_entry[i] = ((rt_ubase_t *)PPN_TO_VPN(GET_PADDR(*pentry), PV_OFFSET) +
+                        lvl_off[i]);
+        pentry = lvl_entry[i];
+        unmapped >>= ARCH_INDEX_WIDTH;
+    }
+#endif /* RT_USING_HUGEPAGE */
+
     // clear PTE & setup its
     if (PTE_USED(*pentry))
     {
         _unmap_pte(pentry, lvl_entry, i);
     }
 
-    return unmapped;
+    // step to the start of next entry in the same level
+    return unmapped - (loop_va & (unmapped - 1));
 }
 
 /** unmap is different from map that it can handle multiple pages */
@@ -397,6 +523,33 @@ static rt_ubase_t *_query(struct rt_aspace *aspace, void *vaddr, int *level)
     return RT_NULL;
 }
 
+#ifdef RT_USING_HUGEPAGE
+/**
+ * Check whether nothing is mapped in the 2MB block of vaddr. A page table is
+ * freed with its last entry, so an unused level 2 entry tells it at once.
+ */
+rt_bool_t rt_hw_mmu_huge_unused(struct rt_aspace *aspace, void *vaddr)
+{
+    rt_ubase_t *mmu_l1, *mmu_l2;
+
+    mmu_l1 = ((rt_ubase_t *)aspace->page_table) + GET_L1((rt_uintptr_t)vaddr);
+
+    if (!PTE_USED(*mmu_l1))
+    {
+        return RT_TRUE;
+    }
+
+    if (*mmu_l1 & PTE_XWR_MASK)
+    {
+        return RT_FALSE;
+    }
+
+    mmu_l2 = (rt_ubase_t *)PPN_TO_VPN(GET_PADDR(*mmu_l1), PV_OFFSET);
+
+    return !PTE_USED(*(mmu_l2 + GET_L2((rt_uintptr_t)vaddr)));
+}
+#endif /* RT_USING_HUGEPAGE */
+
 void *rt_hw_mmu_v2p(struct rt_aspace *aspace, void *vaddr)
 {
     int level;
@@ -447,6 +600,21 @@ int rt_hw_mmu_control(struct rt_aspace *aspace, void *vaddr, size_t size,
         {
             rt_base_t *pte = _query(aspace, vaddr, &level);
             void *range_end = vaddr + _get_level_size(level);
+#ifdef RT_USING_HUGEPAGE
+            if (pte && level == 2 &&
+                (((rt_ubase_t)vaddr & (L2_PAGE_SIZE - 1)) || range_end > vend))
+            {
+                MM_PGTBL_LOCK(aspace);
+                if (_split_huge_page((rt_ubase_t *)pte) != 0)
+                {
+                    MM_PGTBL_UNLOCK(aspace);
+                    err = -RT_ENOMEM;
+                    break;
+                }
+                MM_PGTBL_UNLOCK(aspace);
+                continue;
+            }
+#endif /* RT_USING_HUGEPAGE */
             RT_ASSERT(range_end <= vend);
 
             if (pte)
@@ -67,6 +67,9 @@ void *rt_hw_mmu_map(rt_aspace_t aspace, void *v_addr, void *p_addr, size_t size,
 void rt_hw_mmu_unmap(rt_aspace_t aspace, void *v_addr, size_t size);
 void rt_hw_aspace_switch(rt_aspace_t aspace);
 void *rt_hw_mmu_v2p(rt_aspace_t aspace, void *vaddr);
+#ifdef RT_USING_HUGEPAGE
+rt_bool_t rt_hw_mmu_huge_unused(rt_aspace_t aspace, void *vaddr);
+#endif
 
 int rt_hw_mmu_control(struct rt_aspace *aspace, void *vaddr, size_t size,
                       enum rt_mmu_cntl cmd);
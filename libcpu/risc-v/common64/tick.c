@@ -7,6 +7,7 @@
  * Date           Author       Notes
  * 2018/10/28     Bernard      The unify RISC-V porting code.
  * 2024/07/08     Shell        Using CPUTIME as tick
+ * 2026/10/17     agent        Support tickless idle
  */
 
 #include <rthw.h>
@@ -22,12 +23,51 @@
 
 static volatile unsigned long tick_cycles = 0;
 
+#ifdef RT_USING_TICKLESS_IDLE
+/* the cycle of the last announced tick on each hart */
+static rt_uint64_t tick_last[RT_CPUS_NR];
+
+int tick_isr(void)
+{
+    rt_uint64_t *last = &tick_last[rt_hw_cpu_id()];
+    rt_tick_t passed;
+
+    /* announce all the ticks passed, the tick may be stopped in idle */
+    passed = (clock_cpu_gettime() - *last) / tick_cycles;
+    *last += (rt_uint64_t)passed * tick_cycles;
+    sbi_set_timer(*last + tick_cycles);
+
+    if (passed > 0)
+    {
+        rt_tick_increase_tick(passed);
+    }
+    return 0;
+}
+
+rt_tick_t rt_hw_tick_idle(rt_tick_t tick)
+{
+    rt_uint64_t *last = &tick_last[rt_hw_cpu_id()];
+    rt_uint64_t now;
+
+    sbi_set_timer(*last + (rt_uint64_t)tick * tick_cycles);
+
+    /* wake up on pending interrupts even if they are disabled */
+    __asm__ volatile ("wfi" ::: "memory");
+
+    /* resume the periodic tick, it fires at once if any tick is missed */
+    now = clock_cpu_gettime();
+    sbi_set_timer(*last + tick_cycles);
+
+    return (now - *last) / tick_cycles;
+}
+#else
 int tick_isr(void)
 {
     rt_tick_increase();
     sbi_set_timer(clock_cpu_gettime() + tick_cycles);
     return 0;
 }
+#endif /* RT_USING_TICKLESS_IDLE */
 
 /* BSP should config clockbase frequency */
 RT_STATIC_ASSERT(defined_clockbase_freq, CPUTIME_TIMER_FREQ != 0);
@@ -45,7 +85,12 @@ int rt_hw_tick_init(void)
     riscv_cputime_init();
 
     /* Set timer */
+#ifdef RT_USING_TICKLESS_IDLE
+    tick_last[rt_hw_cpu_id()] = clock_cpu_gettime();
+    sbi_set_timer(tick_last[rt_hw_cpu_id()] + tick_cycles);
+#else
     sbi_set_timer(clock_cpu_gettime() + tick_cycles);
+#endif /* RT_USING_TICKLESS_IDLE */
 
 #ifdef RT_USING_KTIME
     rt_ktime_cputimer_init();
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2006-2026, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-17     agent        the first version
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+#include <encoding.h>
+
+/* shorter blocks are not worth to switch on the vector unit */
+#define RVV_MEMOPS_THRESHOLD    32
+
+#define RVV_CLOBBER_V8_V15  "v8", "v9", "v10", "v11", "v12", "v13", "v14", "v15"
+#define RVV_CLOBBER_V16_V23 "v16", "v17", "v18", "v19", "v20", "v21", "v22", "v23"
+
+/*
+ * The vector unit of kernel is enabled on demand. If it's off, no vector
+ * context is living in this frame, so turn it on for the copy and off again
+ * to keep the trap frame small. This works in interrupt context as well,
+ * the vector registers are saved by trap entry only if it's on.
+ */
+rt_inline rt_ubase_t _rvv_enter(void)
+{
+    rt_ubase_t vs = read_csr(sstatus) & SSTATUS_VS;
+
+    if (vs == 0)
+    {
+        set_csr(sstatus, SSTATUS_VS_INITIAL);
+    }
+    return vs;
+}
+
+rt_inline void _rvv_leave(rt_ubase_t vs)
+{
+    if (vs == 0)
+    {
+        clear_csr(sstatus, SSTATUS_VS);
+    }
+}
+
+void *rt_memset(void *s, int c, rt_ubase_t count)
+{
+    rt_uint8_t *xs = (rt_uint8_t *)s;
+    rt_ubase_t vl, vs;
+
+    if (count < RVV_MEMOPS_THRESHOLD)
+    {
+        while (count--)
+            *xs++ = (rt_uint8_t)c;
+        return s;
+    }
+
+    vs = _rvv_enter();
+    while (count > 0)
+    {
+        __asm__ volatile (
+            "vsetvli    %0, %1, e8, m8, ta, ma\n"
+            "vmv.v.x    v8, %2\n"
+            "vse8.v     v8, (%3)\n"
+            : "=&r"(vl)
+            : "r"(count), "r"(c), "r"(xs)
+            : "memory", "vl", "vtype", RVV_CLOBBER_V8_V15);
+        xs += vl;
+        count -= vl;
+    }
+    _rvv_leave(vs);
+
+    return s;
+}
+
+void *rt_memcpy(void *dst, const void *src, rt_ubase_t count)
+{
+    rt_uint8_t *d = (rt_uint8_t *)dst;
+    const rt_uint8_t *s = (const rt_uint8_t *)src;
+    rt_ubase_t vl, vs;
+
+    if (count < RVV_MEMOPS_THRESHOLD)
+    {
+        while (count--)
+            *d++ = *s++;
+        return dst;
+    }
+
+    vs = _rvv_enter();
+    while (count > 0)
+    {
+        __asm__ volatile (
+            "vsetvli    %0, %1, e8, m8, ta, ma\n"
+            "vle8.v     v8, (%2)\n"
+            "vse8.v     v8, (%3)\n"
+            : "=&r"(vl)
+            : "r"(count), "r"(s), "r"(d)
+            : "memory", "vl", "vtype", RVV_CLOBBER_V8_V15);
+        s += vl;
+        d += vl;
+        count -= vl;
+    }
+    _rvv_leave(vs);
+
+    return dst;
+}
+
+rt_int32_t rt_memcmp(const void *cs, const void *ct, rt_size_t count)
+{
+    const rt_uint8_t *su1 = (const rt_uint8_t *)cs;
+    const rt_uint8_t *su2 = (const rt_uint8_t *)ct;
+    rt_ubase_t vl, vs;
+    long idx;
+    int res = 0;
+
+    if (count >= RVV_MEMOPS_THRESHOLD)
+    {
+        vs = _rvv_enter();
+        while (count > 0)
+        {
+            /* find the first different byte of this block */
+            __asm__ volatile (
+                "vsetvli    %0, %2, e8, m8, ta, ma\n"
+                "vle8.v     v8, (%3)\n"
+                "vle8.v     v16, (%4)\n"
+                "vmsne.vv   v0, v8, v16\n"
+                "vfirst.m   %1, v0\n"
+                : "=&r"(vl), "=&r"(idx)
+                : "r"(count), "r"(su1), "r"(su2)
+                : "memory", "vl", "vtype", "v0",
+                  RVV_CLOBBER_V8_V15, RVV_CLOBBER_V16_V23);
+            if (idx >= 0)
+            {
+                res = su1[idx] - su2[idx];
+                break;
+            }
+            su1 += vl;
+            su2 += vl;
+            count -= vl;
+        }
+        _rvv_leave(vs);
+
+        return res;
+    }
+
+    for (; count > 0; ++su1, ++su2, count--)
+        if ((res = *su1 - *su2) != 0)
+            break;
+
+    return res;
+}
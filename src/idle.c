@@ -19,6 +19,7 @@
  * 2023-09-15     xqyjlj       perf rt_hw_interrupt_disable/enable
  * 2023-11-07     xqyjlj       fix thread exit
  * 2023-12-10     xqyjlj       add _hook_spinlock
+ * 2026-10-17     agent        add tickless idle
  */
 
 #include <rthw.h>
@@ -123,6 +124,136 @@ rt_err_t rt_thread_idle_delhook(void (*hook)(void))
 
 #endif /* RT_USING_IDLE_HOOK */
 
+#ifdef RT_USING_TICKLESS_IDLE
+#ifndef RT_TICKLESS_IDLE_MIN_TICKS
+#define RT_TICKLESS_IDLE_MIN_TICKS  2
+#endif /* RT_TICKLESS_IDLE_MIN_TICKS */
+
+struct _tickless_stat
+{
+    rt_ubase_t  stop_count;     /* times of the tick stopped */
+    rt_ubase_t  sleep_ticks;    /* ticks passed with the tick stopped */
+    rt_tick_t   max_ticks;      /* the longest sleep */
+};
+
+static struct _tickless_stat _tickless_stat[_CPUS_NR];
+/* core 0 is sleeping with the tick stopped */
+static rt_atomic_t _tickless_sleeping;
+
+/**
+ * @brief This function wakes up the core 0 from tickless sleep, so the tick
+ *        timer can be re-armed for a timer started by other cores.
+ *
+ * @note  Timers are only checked by core 0, which stops its tick until the
+ *        nearest timer expires. It must be invoked after the timer is added.
+ */
+void rt_thread_idle_tickless_kick(void)
+{
+#ifdef RT_USING_SMP
+    /* pairs with the barrier in _idle_tickless() */
+    rt_hw_dmb();
+    if (rt_atomic_load(&_tickless_sleeping))
+    {
+        rt_hw_ipi_send(RT_SCHEDULE_IPI, 1 << 0);
+    }
+#endif /* RT_USING_SMP */
+}
+
+/**
+ * @brief Stop the periodic tick of the current cpu and sleep until the nearest
+ *        timer expires or any interrupt arrives.
+ *
+ * @return RT_TRUE if the tick has been stopped, otherwise RT_FALSE.
+ */
+static rt_bool_t _idle_tickless(void)
+{
+    rt_base_t level;
+    rt_tick_t sleep, slept;
+    rt_tick_t timeout_tick = RT_TICK_MAX;
+    struct _tickless_stat *stat;
+    int cpu_id;
+
+    level = rt_hw_local_irq_disable();
+    cpu_id = rt_cpu_get_id();
+    stat = &_tickless_stat[cpu_id];
+
+    if (cpu_id == 0)
+    {
+        /*
+         * publish the state before looking up the timers, so a timer added
+         * by others is either found here or followed by a kick.
+         */
+        rt_atomic_store(&_tickless_sleeping, 1);
+        rt_hw_dmb();
+        timeout_tick = rt_timer_next_timeout_tick();
+    }
+
+    sleep = RT_TICK_MAX / 2;
+    if (timeout_tick != RT_TICK_MAX)
+    {
+        sleep = timeout_tick - rt_tick_get();
+        if (sleep > RT_TICK_MAX / 2)
+        {
+            /* already expired and waiting for the next tick */
+            sleep = 0;
+        }
+    }
+
+    if (sleep >= RT_TICKLESS_IDLE_MIN_TICKS)
+    {
+        slept = rt_hw_tick_idle(sleep);
+
+        stat->stop_count++;
+        stat->sleep_ticks += slept;
+        if (slept > stat->max_ticks)
+        {
+            stat->max_ticks = slept;
+        }
+    }
+
+    if (cpu_id == 0)
+    {
+        rt_atomic_store(&_tickless_sleeping, 0);
+    }
+    rt_hw_local_irq_enable(level);
+
+    return sleep >= RT_TICKLESS_IDLE_MIN_TICKS;
+}
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+
+static int list_tickless(void)
+{
+    rt_ubase_t i;
+    rt_uint64_t total, permille;
+    struct _tickless_stat *stat;
+
+    rt_kprintf("cpu  stopped   sleep ticks  max ticks  residency\n");
+    rt_kprintf("--- ---------- ----------- ---------- ---------\n");
+    for (i = 0; i < _CPUS_NR; i++)
+    {
+        stat = &_tickless_stat[i];
+#ifdef RT_USING_SMP
+        total = (rt_tick_t)rt_atomic_load(&(rt_cpu_index(i)->tick));
+#else
+        total = rt_tick_get();
+#endif /* RT_USING_SMP */
+        permille = total ? (rt_uint64_t)stat->sleep_ticks * 1000 / total : 0;
+
+        rt_kprintf("%3d %10lu %11lu %10lu %5d.%d%%\n", (int)i,
+                   (unsigned long)stat->stop_count,
+                   (unsigned long)stat->sleep_ticks,
+                   (unsigned long)stat->max_ticks,
+                   (int)(permille / 10), (int)(permille % 10));
+    }
+
+    return 0;
+}
+MSH_CMD_EXPORT(list_tickless, list tickless idle statistics);
+#endif /* RT_USING_FINSH */
+#endif /* RT_USING_TICKLESS_IDLE */
+
 static void idle_thread_entry(void *parameter)
 {
     RT_UNUSED(parameter);
@@ -131,6 +262,12 @@ static void idle_thread_entry(void *parameter)
     {
         while (1)
         {
+#ifdef RT_USING_TICKLESS_IDLE
+            if (_idle_tickless())
+            {
+                continue;
+            }
+#endif /* RT_USING_TICKLESS_IDLE */
             rt_hw_secondary_cpu_idle_exec();
         }
     }
@@ -156,6 +293,10 @@ static void idle_thread_entry(void *parameter)
     rt_defunct_execute();
 #endif
 
+#ifdef RT_USING_TICKLESS_IDLE
+        _idle_tickless();
+#endif /* RT_USING_TICKLESS_IDLE */
+
 #ifdef RT_USING_PM
         void rt_system_power_manager(void);
         rt_system_power_manager();
@@ -46,6 +46,8 @@
  * 2022-10-16     Bernard      add prioceiling feature in mutex
  * 2023-04-16     Xin-zheqi    redesigen queue recv and send function return real message size
  * 2023-09-15     xqyjlj       perf rt_hw_interrupt_disable/enable
+ * 2026-10-17     agent        add zero-copy reserve/commit and borrow/release to message queue
+ * 2026-10-17     agent        add adaptive spinning to mutex take on SMP
  */
 
 #include <rtthread.h>
@@ -942,6 +944,58 @@ static rt_bool_t _check_and_update_prio(rt_thread_t thread, rt_mutex_t mutex)
     return do_sched;
 }
 
+#ifdef RT_USING_MUTEX_ADAPTIVE_SPIN
+#ifndef rt_hw_cpu_relax
+#define rt_hw_cpu_relax()   rt_hw_dmb()
+#endif
+
+/* whether the owner thread is running on another core right now */
+rt_inline rt_bool_t _mutex_owner_on_cpu(struct rt_thread *owner)
+{
+    rt_uint8_t oncpu;
+
+    /**
+     * sampled without the scheduler lock, it is only a hint. The thread
+     * object is not reclaimed before the defunct thread is cleaned up, so
+     * a stale owner reads harmless data.
+     */
+    oncpu = *(volatile rt_uint8_t *)&RT_SCHED_CTX(owner).oncpu;
+
+    return oncpu != RT_CPU_DETACHED && oncpu != rt_hw_cpu_id();
+}
+
+/**
+ * spin while the mutex owner keeps running on another core, since it is
+ * likely to release the mutex sooner than the caller can be suspended and
+ * resumed. The caller takes the mutex through the normal path afterwards,
+ * so priority inheritance applies as soon as it has to block.
+ */
+static void _mutex_spin_on_owner(rt_mutex_t mutex, struct rt_thread *thread)
+{
+    struct rt_thread *owner;
+    rt_list_t *waiters;
+    rt_uint32_t budget;
+
+    waiters = &(mutex->parent.suspend_thread);
+    for (budget = RT_MUTEX_SPIN_BUDGET; budget > 0; budget --)
+    {
+        owner = *(struct rt_thread *volatile *)&mutex->owner;
+        if (owner == RT_NULL || owner == thread)
+            break;
+
+        /* the mutex is handed over to the first waiter on release */
+        if (*(rt_list_t *volatile *)&waiters->next != waiters)
+            break;
+
+        /* owner is preempted or blocked, spinning is useless */
+        if (!_mutex_owner_on_cpu(owner))
+            break;
+
+        rt_hw_cpu_relax();
+    }
+}
+#endif /* RT_USING_MUTEX_ADAPTIVE_SPIN */
+
 static void _mutex_before_delete_detach(rt_mutex_t mutex)
 {
     rt_sched_lock_level_t slvl;
@@ -1339,6 +1393,12 @@ static rt_err_t _rt_mutex_take(rt_mutex_t mutex, rt_int32_t timeout, int suspend
     /* get current thread */
     thread = rt_thread_self();
 
+#ifdef RT_USING_MUTEX_ADAPTIVE_SPIN
+    /* wait for a running owner for a while before going to suspend */
+    if (timeout != 0)
+        _mutex_spin_on_owner(mutex, thread);
+#endif /* RT_USING_MUTEX_ADAPTIVE_SPIN */
+
     rt_spin_lock(&(mutex->spinlock));
 
     RT_OBJECT_HOOK_CALL(rt_object_trytake_hook, (&(mutex->parent.parent)));
@@ -3340,43 +3400,9 @@ rt_err_t rt_mq_delete(rt_mq_t mq)
 RTM_EXPORT(rt_mq_delete);
 #endif /* RT_USING_HEAP */
 
-/**
- * @brief    This function will send a message to the messagequeue object. If
- *           there is a thread suspended on the messagequeue, the thread will be
- *           resumed.
- *
- * @note     When using this function to send a message, if the messagequeue is
- *           fully used, the current thread will wait for a timeout. If reaching
- *           the timeout and there is still no space available, the sending
- *           thread will be resumed and an error code will be returned. By
- *           contrast, the _rt_mq_send_wait() function will return an error code
- *           immediately without waiting when the messagequeue if fully used.
- *
- * @see      _rt_mq_send_wait()
- *
- * @param    mq is a pointer to the messagequeue object to be sent.
- *
- * @param    buffer is the content of the message.
- *
- * @param    size is the length of the message(Unit: Byte).
- *
- * @param    prio is message priority, A larger value indicates a higher priority
- *
- * @param    timeout is a timeout period (unit: an OS tick).
- *
- * @param    suspend_flag status flag of the thread to be suspended.
- *
- * @return   Return the operation status. When the return value is RT_EOK, the
- *           operation is successful. If the return value is any other values,
- *           it means that the messagequeue detach failed.
- *
- * @warning  This function can be called in interrupt context and thread
- * context.
- */
-static rt_err_t _rt_mq_send_wait(rt_mq_t mq,
-                                 const void *buffer,
-                                 rt_size_t size,
-                                 rt_int32_t prio,
+/* take a free message from the pool, the sender is suspended while the queue is full */
+static rt_err_t _rt_mq_alloc_msg(rt_mq_t mq,
+                                 struct rt_mq_message **pmsg,
                                  rt_int32_t timeout,
                                  int suspend_flag)
 {
@@ -3386,28 +3412,11 @@ static rt_err_t _rt_mq_send_wait(rt_mq_t mq,
     struct rt_thread *thread;
     rt_err_t ret;
 
-    RT_UNUSED(prio);
-
-    /* parameter check */
-    RT_ASSERT(mq != RT_NULL);
-    RT_ASSERT(rt_object_get_type(&mq->parent.parent) == RT_Object_Class_MessageQueue);
-    RT_ASSERT(buffer != RT_NULL);
-    RT_ASSERT(size != 0);
-
-    /* current context checking */
-    RT_DEBUG_SCHEDULER_AVAILABLE(timeout != 0);
-
-    /* greater than one message size */
-    if (size > mq->msg_size)
-        return -RT_ERROR;
-
     /* initialize delta tick */
     tick_delta = 0;
     /* get current thread */
     thread = rt_thread_self();
 
-    RT_OBJECT_HOOK_CALL(rt_object_put_hook, (&(mq->parent.parent)));
-
     level = rt_spin_lock_irqsave(&(mq->spinlock));
 
     /* get a free list, there must be an empty item */
@@ -3489,11 +3498,23 @@ static rt_err_t _rt_mq_send_wait(rt_mq_t mq,
 
     /* the msg is the new tailer of list, the next shall be NULL */
     msg->next = RT_NULL;
+    *pmsg = msg;
+
+    return RT_EOK;
+}
+
+/* link a filled message to the queue and wake up a receiver */
+static rt_err_t _rt_mq_queue_msg(rt_mq_t mq,
+                                 struct rt_mq_message *msg,
+                                 rt_size_t size,
+                                 rt_int32_t prio)
+{
+    rt_base_t level;
+
+    RT_UNUSED(prio);
 
     /* add the length */
     ((struct rt_mq_message *)msg)->length = size;
-    /* copy buffer */
-    rt_memcpy(GET_MESSAGEBYTE_ADDR(msg), buffer, size);
 
     /* disable interrupt */
     level = rt_spin_lock_irqsave(&(mq->spinlock));
@@ -3565,6 +3586,74 @@ static rt_err_t _rt_mq_send_wait(rt_mq_t mq,
     return RT_EOK;
 }
 
+/**
+ * @brief    This function will send a message to the messagequeue object. If
+ *           there is a thread suspended on the messagequeue, the thread will be
+ *           resumed.
+ *
+ * @note     When using this function to send a message, if the messagequeue is
+ *           fully used, the current thread will wait for a timeout. If reaching
+ *           the timeout and there is still no space available, the sending
+ *           thread will be resumed and an error code will be returned. By
+ *           contrast, the _rt_mq_send_wait() function will return an error code
+ *           immediately without waiting when the messagequeue if fully used.
+ *
+ * @see      _rt_mq_send_wait()
+ *
+ * @param    mq is a pointer to the messagequeue object to be sent.
+ *
+ * @param    buffer is the content of the message.
+ *
+ * @param    size is the length of the message(Unit: Byte).
+ *
+ * @param    prio is message priority, A larger value indicates a higher priority
+ *
+ * @param    timeout is a timeout period (unit: an OS tick).
+ *
+ * @param    suspend_flag status flag of the thread to be suspended.
+ *
+ * @return   Return the operation status. When the return value is RT_EOK, the
+ *           operation is successful. If the return value is any other values,
+ *           it means that the messagequeue detach failed.
+ *
+ * @warning  This function can be called in interrupt context and thread
+ * context.
+ */
+static rt_err_t _rt_mq_send_wait(rt_mq_t mq,
+                                 const void *buffer,
+                                 rt_size_t size,
+                                 rt_int32_t prio,
+                                 rt_int32_t timeout,
+                                 int suspend_flag)
+{
+    struct rt_mq_message *msg;
+    rt_err_t ret;
+
+    /* parameter check */
+    RT_ASSERT(mq != RT_NULL);
+    RT_ASSERT(rt_object_get_type(&mq->parent.parent) == RT_Object_Class_MessageQueue);
+    RT_ASSERT(buffer != RT_NULL);
+    RT_ASSERT(size != 0);
+
+    /* current context checking */
+    RT_DEBUG_SCHEDULER_AVAILABLE(timeout != 0);
+
+    /* greater than one message size */
+    if (size > mq->msg_size)
+        return -RT_ERROR;
+
+    RT_OBJECT_HOOK_CALL(rt_object_put_hook, (&(mq->parent.parent)));
+
+    ret = _rt_mq_alloc_msg(mq, &msg, timeout, suspend_flag);
+    if (ret != RT_EOK)
+        return ret;
+
+    /* copy buffer */
+    rt_memcpy(GET_MESSAGEBYTE_ADDR(msg), buffer, size);
+
+    return _rt_mq_queue_msg(mq, msg, size, prio);
+}
+
 rt_err_t rt_mq_send_wait(rt_mq_t     mq,
                          const void *buffer,
                          rt_size_t   size,
@@ -3725,66 +3814,22 @@ rt_err_t rt_mq_urgent(rt_mq_t mq, const void *buffer, rt_size_t size)
 }
 RTM_EXPORT(rt_mq_urgent);
 
-/**
- * @brief    This function will receive a message from message queue object,
- *           if there is no message in messagequeue object, the thread shall wait for a specified time.
- *
- * @note     Only when there is mail in the mailbox, the receiving thread can get the mail immediately and return RT_EOK,
- *           otherwise the receiving thread will be suspended until timeout.
- *           If the mail is not received within the specified time, it will return -RT_ETIMEOUT.
- *
- * @param    mq is a pointer to the messagequeue object to be received.
- *
- * @param    buffer is the content of the message.
- *
- * @param    prio is message priority, A larger value indicates a higher priority
- *
- * @param    size is the length of the message(Unit: Byte).
- *
- * @param    timeout is a timeout period (unit: an OS tick). If the message is unavailable, the thread will wait for
- *           the message in the queue up to the amount of time specified by this parameter.
- *
- * @param    suspend_flag status flag of the thread to be suspended.
- *
- *           NOTE:
- *           If use Macro RT_WAITING_FOREVER to set this parameter, which means that when the
- *           message is unavailable in the queue, the thread will be waiting forever.
- *           If use macro RT_WAITING_NO to set this parameter, which means that this
- *           function is non-blocking and will return immediately.
- *
- * @return   Return the real length of the message. When the return value is larger than zero, the operation is successful.
- *           If the return value is any other values, it means that the mailbox release failed.
- */
-static rt_ssize_t _rt_mq_recv(rt_mq_t mq,
-                              void *buffer,
-                              rt_size_t size,
-                              rt_int32_t *prio,
-                              rt_int32_t timeout,
-                              int suspend_flag)
+/* take the first message from the queue, the receiver is suspended while the queue is empty */
+static rt_err_t _rt_mq_dequeue_msg(rt_mq_t mq,
+                                   struct rt_mq_message **pmsg,
+                                   rt_int32_t timeout,
+                                   int suspend_flag)
 {
     struct rt_thread *thread;
     rt_base_t level;
     struct rt_mq_message *msg;
     rt_uint32_t tick_delta;
     rt_err_t ret;
-    rt_size_t len;
-
-    RT_UNUSED(prio);
-
-    /* parameter check */
-    RT_ASSERT(mq != RT_NULL);
-    RT_ASSERT(rt_object_get_type(&mq->parent.parent) == RT_Object_Class_MessageQueue);
-    RT_ASSERT(buffer != RT_NULL);
-    RT_ASSERT(size != 0);
-
-    /* current context checking */
-    RT_DEBUG_SCHEDULER_AVAILABLE(timeout != 0);
 
     /* initialize delta tick */
     tick_delta = 0;
     /* get current thread */
     thread = rt_thread_self();
-    RT_OBJECT_HOOK_CALL(rt_object_trytake_hook, (&(mq->parent.parent)));
 
     level = rt_spin_lock_irqsave(&(mq->spinlock));
 
@@ -3879,18 +3924,16 @@ static rt_ssize_t _rt_mq_recv(rt_mq_t mq,
 
     rt_spin_unlock_irqrestore(&(mq->spinlock), level);
 
-    /* get real message length */
-    len = ((struct rt_mq_message *)msg)->length;
+    *pmsg = msg;
 
-    if (len > size)
-        len = size;
-    /* copy message */
-    rt_memcpy(buffer, GET_MESSAGEBYTE_ADDR(msg), len);
+    return RT_EOK;
+}
+
+/* put a message back to the free list and wake up a sender */
+static void _rt_mq_free_msg(rt_mq_t mq, struct rt_mq_message *msg)
+{
+    rt_base_t level;
 
-#ifdef RT_USING_MESSAGEQUEUE_PRIORITY
-    if (prio != RT_NULL)
-        *prio = msg->prio;
-#endif
     level = rt_spin_lock_irqsave(&(mq->spinlock));
     /* put message to free list */
     msg->next = (struct rt_mq_message *)mq->msg_queue_free;
@@ -3907,12 +3950,85 @@ static rt_ssize_t _rt_mq_recv(rt_mq_t mq,
 
         rt_schedule();
 
-        return len;
+        return;
     }
 
     rt_spin_unlock_irqrestore(&(mq->spinlock), level);
 
     RT_OBJECT_HOOK_CALL(rt_object_take_hook, (&(mq->parent.parent)));
+}
+
+/**
+ * @brief    This function will receive a message from message queue object,
+ *           if there is no message in messagequeue object, the thread shall wait for a specified time.
+ *
+ * @note     Only when there is mail in the mailbox, the receiving thread can get the mail immediately and return RT_EOK,
+ *           otherwise the receiving thread will be suspended until timeout.
+ *           If the mail is not received within the specified time, it will return -RT_ETIMEOUT.
+ *
+ * @param    mq is a pointer to the messagequeue object to be received.
+ *
+ * @param    buffer is the content of the message.
+ *
+ * @param    prio is message priority, A larger value indicates a higher priority
+ *
+ * @param    size is the length of the message(Unit: Byte).
+ *
+ * @param    timeout is a timeout period (unit: an OS tick). If the message is unavailable, the thread will wait for
+ *           the message in the queue up to the amount of time specified by this parameter.
+ *
+ * @param    suspend_flag status flag of the thread to be suspended.
+ *
+ *           NOTE:
+ *           If use Macro RT_WAITING_FOREVER to set this parameter, which means that when the
+ *           message is unavailable in the queue, the thread will be waiting forever.
+ *           If use macro RT_WAITING_NO to set this parameter, which means that this
+ *           function is non-blocking and will return immediately.
+ *
+ * @return   Return the real length of the message. When the return value is larger than zero, the operation is successful.
+ *           If the return value is any other values, it means that the mailbox release failed.
+ */
+static rt_ssize_t _rt_mq_recv(rt_mq_t mq,
+                              void *buffer,
+                              rt_size_t size,
+                              rt_int32_t *prio,
+                              rt_int32_t timeout,
+                              int suspend_flag)
+{
+    struct rt_mq_message *msg;
+    rt_err_t ret;
+    rt_size_t len;
+
+    RT_UNUSED(prio);
+
+    /* parameter check */
+    RT_ASSERT(mq != RT_NULL);
+    RT_ASSERT(rt_object_get_type(&mq->parent.parent) == RT_Object_Class_MessageQueue);
+    RT_ASSERT(buffer != RT_NULL);
+    RT_ASSERT(size != 0);
+
+    /* current context checking */
+    RT_DEBUG_SCHEDULER_AVAILABLE(timeout != 0);
+
+    RT_OBJECT_HOOK_CALL(rt_object_trytake_hook, (&(mq->parent.parent)));
+
+    ret = _rt_mq_dequeue_msg(mq, &msg, timeout, suspend_flag);
+    if (ret != RT_EOK)
+        return ret;
+
+    /* get real message length */
+    len = ((struct rt_mq_message *)msg)->length;
+
+    if (len > size)
+        len = size;
+    /* copy message */
+    rt_memcpy(buffer, GET_MESSAGEBYTE_ADDR(msg), len);
+
+#ifdef RT_USING_MESSAGEQUEUE_PRIORITY
+    if (prio != RT_NULL)
+        *prio = msg->prio;
+#endif
+    _rt_mq_free_msg(mq, msg);
 
     return len;
 }
@@ -3963,6 +4079,248 @@ rt_ssize_t rt_mq_recv_prio(rt_mq_t mq,
 }
 #endif
 RTM_EXPORT(rt_mq_recv_killable);
+
+#ifdef RT_USING_MESSAGEQUEUE_ZEROCOPY
+/* get the message header of a slot handed out by rt_mq_reserve() or rt_mq_borrow() */
+static struct rt_mq_message *_rt_mq_buffer_to_msg(rt_mq_t mq, void *buffer)
+{
+    struct rt_mq_message *msg;
+    rt_ubase_t offset, stride;
+
+    RT_UNUSED(offset);
+    RT_UNUSED(stride);
+
+    msg = (struct rt_mq_message *)buffer - 1;
+    offset = (rt_ubase_t)msg - (rt_ubase_t)mq->msg_pool;
+    stride = RT_ALIGN(mq->msg_size, RT_ALIGN_SIZE) + sizeof(struct rt_mq_message);
+
+    /* the slot must come from the message pool of this queue */
+    RT_ASSERT((rt_ubase_t)msg >= (rt_ubase_t)mq->msg_pool);
+    RT_ASSERT(offset % stride == 0);
+    RT_ASSERT(offset / stride < mq->max_msgs);
+
+    return msg;
+}
+
+/**
+ * @brief    This function will reserve a free message slot of the messagequeue
+ *           object, so the sender can build the message in place.
+ *
+ * @note     The slot is owned by the caller until it is handed back by
+ *           rt_mq_commit() or rt_mq_cancel(). When the messagequeue is full,
+ *           the caller waits for a slot the same way rt_mq_send_wait() does.
+ *
+ * @param    mq is a pointer to the messagequeue object.
+ *
+ * @param    buffer is used to return the address of the slot, which can hold
+ *           up to msg_size bytes.
+ *
+ * @param    timeout is a timeout period (unit: an OS tick).
+ *
+ * @param    suspend_flag status flag of the thread to be suspended.
+ *
+ * @return   Return the operation status. When the return value is RT_EOK, the
+ *           operation is successful. -RT_EFULL is returned when no slot is
+ *           available and the call is non-blocking.
+ */
+rt_err_t rt_mq_reserve(rt_mq_t mq, void **buffer, rt_int32_t timeout, int suspend_flag)
+{
+    struct rt_mq_message *msg;
+    rt_err_t ret;
+
+    /* parameter check */
+    RT_ASSERT(mq != RT_NULL);
+    RT_ASSERT(rt_object_get_type(&mq->parent.parent) == RT_Object_Class_MessageQueue);
+    RT_ASSERT(buffer != RT_NULL);
+
+    /* current context checking */
+    RT_DEBUG_SCHEDULER_AVAILABLE(timeout != 0);
+
+    RT_OBJECT_HOOK_CALL(rt_object_put_hook, (&(mq->parent.parent)));
+
+    ret = _rt_mq_alloc_msg(mq, &msg, timeout, suspend_flag);
+    if (ret != RT_EOK)
+        return ret;
+
+    *buffer = GET_MESSAGEBYTE_ADDR(msg);
+
+    return RT_EOK;
+}
+RTM_EXPORT(rt_mq_reserve);
+
+/**
+ * @brief    This function will send a slot reserved by rt_mq_reserve() to the
+ *           messagequeue object. If there is a thread suspended on the
+ *           messagequeue, the thread will be resumed.
+ *
+ * @param    mq is a pointer to the messagequeue object.
+ *
+ * @param    buffer is the slot returned by rt_mq_reserve().
+ *
+ * @param    size is the length of the message(Unit: Byte).
+ *
+ * @return   Return the operation status. When the return value is RT_EOK, the
+ *           operation is successful.
+ *
+ * @warning  This function can be called in interrupt context and thread
+ *           context.
+ */
+rt_err_t rt_mq_commit(rt_mq_t mq, void *buffer, rt_size_t size)
+{
+    return rt_mq_commit_prio(mq, buffer, size, 0);
+}
+RTM_EXPORT(rt_mq_commit);
+
+/**
+ * @brief    This function is the same as rt_mq_commit(), except that the
+ *           message is queued with the given priority.
+ *
+ * @param    mq is a pointer to the messagequeue object.
+ *
+ * @param    buffer is the slot returned by rt_mq_reserve().
+ *
+ * @param    size is the length of the message(Unit: Byte).
+ *
+ * @param    prio is message priority, A larger value indicates a higher
+ *           priority. It is ignored without RT_USING_MESSAGEQUEUE_PRIORITY.
+ *
+ * @return   Return the operation status. When the return value is RT_EOK, the
+ *           operation is successful.
+ */
+rt_err_t rt_mq_commit_prio(rt_mq_t mq, void *buffer, rt_size_t size, rt_int32_t prio)
+{
+    /* parameter check */
+    RT_ASSERT(mq != RT_NULL);
+    RT_ASSERT(rt_object_get_type(&mq->parent.parent) == RT_Object_Class_MessageQueue);
+    RT_ASSERT(buffer != RT_NULL);
+    RT_ASSERT(size != 0);
+    RT_ASSERT(size <= mq->msg_size);
+
+    return _rt_mq_queue_msg(mq, _rt_mq_buffer_to_msg(mq, buffer), size, prio);
+}
+RTM_EXPORT(rt_mq_commit_prio);
+
+/**
+ * @brief    This function will give a slot reserved by rt_mq_reserve() back to
+ *           the messagequeue object without sending it.
+ *
+ * @param    mq is a pointer to the messagequeue object.
+ *
+ * @param    buffer is the slot returned by rt_mq_reserve().
+ *
+ * @return   Return the operation status. When the return value is RT_EOK, the
+ *           operation is successful.
+ */
+rt_err_t rt_mq_cancel(rt_mq_t mq, void *buffer)
+{
+    /* parameter check */
+    RT_ASSERT(mq != RT_NULL);
+    RT_ASSERT(rt_object_get_type(&mq->parent.parent) == RT_Object_Class_MessageQueue);
+    RT_ASSERT(buffer != RT_NULL);
+
+    _rt_mq_free_msg(mq, _rt_mq_buffer_to_msg(mq, buffer));
+
+    return RT_EOK;
+}
+RTM_EXPORT(rt_mq_cancel);
+
+/**
+ * @brief    This function will take a message from the messagequeue object
+ *           without copying it. If there is no message in the messagequeue,
+ *           the thread shall wait for a specified time.
+ *
+ * @note     The message stays valid until it is handed back by rt_mq_release().
+ *           A borrowed slot is not counted as a free message, so senders may
+ *           be blocked until it is released.
+ *
+ * @param    mq is a pointer to the messagequeue object.
+ *
+ * @param    buffer is used to return the address of the message.
+ *
+ * @param    prio is used to return the message priority, it can be RT_NULL.
+ *
+ * @param    timeout is a timeout period (unit: an OS tick).
+ *
+ * @param    suspend_flag status flag of the thread to be suspended.
+ *
+ * @return   Return the real length of the message. When the return value is
+ *           larger than zero, the operation is successful.
+ */
+rt_ssize_t rt_mq_borrow_prio(rt_mq_t mq,
+                             void **buffer,
+                             rt_int32_t *prio,
+                             rt_int32_t timeout,
+                             int suspend_flag)
+{
+    struct rt_mq_message *msg;
+    rt_err_t ret;
+
+    /* parameter check */
+    RT_ASSERT(mq != RT_NULL);
+    RT_ASSERT(rt_object_get_type(&mq->parent.parent) == RT_Object_Class_MessageQueue);
+    RT_ASSERT(buffer != RT_NULL);
+
+    /* current context checking */
+    RT_DEBUG_SCHEDULER_AVAILABLE(timeout != 0);
+
+    RT_OBJECT_HOOK_CALL(rt_object_trytake_hook, (&(mq->parent.parent)));
+
+    ret = _rt_mq_dequeue_msg(mq, &msg, timeout, suspend_flag);
+    if (ret != RT_EOK)
+        return ret;
+
+    *buffer = GET_MESSAGEBYTE_ADDR(msg);
+    if (prio != RT_NULL)
+    {
+#ifdef RT_USING_MESSAGEQUEUE_PRIORITY
+        *prio = msg->prio;
+#else
+        *prio = 0;
+#endif
+    }
+
+    return msg->length;
+}
+RTM_EXPORT(rt_mq_borrow_prio);
+
+/**
+ * @brief    This function is the same as rt_mq_borrow_prio() without
+ *           returning the message priority.
+ *
+ * @see      rt_mq_borrow_prio()
+ */
+rt_ssize_t rt_mq_borrow(rt_mq_t mq, void **buffer, rt_int32_t timeout, int suspend_flag)
+{
+    return rt_mq_borrow_prio(mq, buffer, RT_NULL, timeout, suspend_flag);
+}
+RTM_EXPORT(rt_mq_borrow);
+
+/**
+ * @brief    This function will give a message taken by rt_mq_borrow() back to
+ *           the messagequeue object. If there is a sender suspended on the
+ *           full messagequeue, the thread will be resumed.
+ *
+ * @param    mq is a pointer to the messagequeue object.
+ *
+ * @param    buffer is the message returned by rt_mq_borrow().
+ *
+ * @return   Return the operation status. When the return value is RT_EOK, the
+ *           operation is successful.
+ */
+rt_err_t rt_mq_release(rt_mq_t mq, void *buffer)
+{
+    /* parameter check */
+    RT_ASSERT(mq != RT_NULL);
+    RT_ASSERT(rt_object_get_type(&mq->parent.parent) == RT_Object_Class_MessageQueue);
+    RT_ASSERT(buffer != RT_NULL);
+
+    _rt_mq_free_msg(mq, _rt_mq_buffer_to_msg(mq, buffer));
+
+    return RT_EOK;
+}
+RTM_EXPORT(rt_mq_release);
+#endif /* RT_USING_MESSAGEQUEUE_ZEROCOPY */
+
 /**
  * @brief    This function will set some extra attributions of a messagequeue object.
  *
@@ -15,6 +15,7 @@
  * 2023-09-15     xqyjlj       perf rt_hw_interrupt_disable/enable
  * 2024-01-05     Shell        Fixup of data racing in rt_interrupt_get_nest
  * 2024-01-03     Shell        Support for interrupt context
+ * 2026-10-17     agent        run the softirqs on the outermost interrupt leave
  */
 
 #include <rthw.h>
@@ -119,6 +120,13 @@ rt_weak void rt_interrupt_leave(void)
     LOG_D("irq is going to leave, irq current nest:%d",
                  (rt_int32_t)rt_atomic_load(&(rt_interrupt_nest)));
     RT_OBJECT_HOOK_CALL(rt_interrupt_leave_hook,());
+#ifdef RT_SOFTIRQ_ON_IRQ_EXIT
+    if (rt_atomic_load(&(rt_interrupt_nest)) == 1)
+    {
+        /* the outermost interrupt, hand the deferred work to its thread */
+        rt_softirq_irq_exit();
+    }
+#endif /* RT_SOFTIRQ_ON_IRQ_EXIT */
     rt_atomic_sub(&(rt_interrupt_nest), 1);
 
 }
@@ -6,6 +6,7 @@
  * Change Logs:
  * Date           Author       Notes
  * 2024-03-10     Meco Man     the first version
+ * 2026-10-17     agent        copy mutually unaligned blocks by shifting words
  */
 
 #include <rtthread.h>
@@ -155,8 +156,48 @@ void *rt_memcpy(void *dst, const void *src, rt_ubase_t count)
     long *aligned_src = RT_NULL;
     rt_ubase_t len = count;
 
-    /* If the size is small, or either SRC or DST is unaligned,
-    then punt into the byte copy loop.  This should be rare. */
+    /* If the size is small, punt into the byte copy loop. */
+    if (!TOO_SMALL(len) && UNALIGNED(src_ptr, dst_ptr))
+    {
+        unsigned long w0, w1;
+        unsigned int lshift, rshift;
+
+        /* Align the DST, then SRC must be unaligned if they still differ. */
+        while (((long)dst_ptr & (sizeof (long) - 1)) != 0)
+        {
+            *dst_ptr++ = *src_ptr++;
+            len--;
+        }
+
+        if (UNALIGNED(src_ptr, dst_ptr))
+        {
+            /*
+             * Read the aligned words covering SRC, and merge two of them
+             * by shifting into each word of DST. Only the words holding
+             * the bytes of SRC are read, so it never crosses a page.
+             */
+            rshift = ((long)src_ptr & (sizeof (long) - 1)) * 8;
+            lshift = sizeof (long) * 8 - rshift;
+            aligned_dst = (long *)dst_ptr;
+            aligned_src = (long *)(src_ptr - (rshift / 8));
+
+            w0 = *aligned_src++;
+            while (len >= LITTLEBLOCKSIZE)
+            {
+                w1 = *aligned_src++;
+#ifdef ARCH_CPU_BIG_ENDIAN
+                *aligned_dst++ = (long)((w0 << rshift) | (w1 >> lshift));
+#else
+                *aligned_dst++ = (long)((w0 >> rshift) | (w1 << lshift));
+#endif /* ARCH_CPU_BIG_ENDIAN */
+                w0 = w1;
+                len -= LITTLEBLOCKSIZE;
+                src_ptr += LITTLEBLOCKSIZE;
+            }
+            dst_ptr = (char *)aligned_dst;
+        }
+    }
+
     if (!TOO_SMALL(len) && !UNALIGNED(src_ptr, dst_ptr))
     {
         aligned_dst = (long *)dst_ptr;
@@ -261,7 +302,31 @@ rt_int32_t rt_memcmp(const void *cs, const void *ct, rt_size_t count)
     const unsigned char *su1 = RT_NULL, *su2 = RT_NULL;
     int res = 0;
 
-    for (su1 = (const unsigned char *)cs, su2 = (const unsigned char *)ct; 0 < count; ++su1, ++su2, count--)
+    su1 = (const unsigned char *)cs;
+    su2 = (const unsigned char *)ct;
+
+    /* Compare a long word at a time if both are aligned in the same way. */
+    if (count >= sizeof(long) * 2 &&
+        (((rt_ubase_t)su1 ^ (rt_ubase_t)su2) & (sizeof(long) - 1)) == 0)
+    {
+        while (((rt_ubase_t)su1 & (sizeof(long) - 1)) != 0)
+        {
+            if ((res = *su1 - *su2) != 0)
+                return res;
+            ++su1, ++su2, count--;
+        }
+
+        /* Stop at the different word and find the byte below. */
+        while (count >= sizeof(long) &&
+               *(const unsigned long *)su1 == *(const unsigned long *)su2)
+        {
+            su1 += sizeof(long);
+            su2 += sizeof(long);
+            count -= sizeof(long);
+        }
+    }
+
+    for (; 0 < count; ++su1, ++su2, count--)
         if ((res = *su1 - *su2) != 0)
             break;
 
@@ -754,12 +754,23 @@ rt_inline void _slab_info(rt_size_t *total,
 }
 #define _MEM_INIT(_name, _start, _size) \
     system_heap = rt_slab_init(_name, _start, _size)
+#ifdef RT_USING_SLAB_MAGAZINE
+#define _MEM_MALLOC_NOLOCK(_size)   \
+    rt_slab_magazine_alloc(system_heap, _size)
+#define _MEM_MALLOC(_size)  \
+    rt_slab_magazine_refill(system_heap, _size)
+#define _MEM_FREE_NOLOCK(_ptr)  \
+    rt_slab_magazine_free(system_heap, _ptr)
+#define _MEM_FREE(_ptr) \
+    rt_slab_magazine_flush(system_heap, _ptr)
+#else
 #define _MEM_MALLOC(_size)  \
     rt_slab_alloc(system_heap, _size)
-#define _MEM_REALLOC(_ptr, _newsize)    \
-    rt_slab_realloc(system_heap, _ptr, _newsize)
 #define _MEM_FREE(_ptr) \
     rt_slab_free(system_heap, _ptr)
+#endif /* RT_USING_SLAB_MAGAZINE */
+#define _MEM_REALLOC(_ptr, _newsize)    \
+    rt_slab_realloc(system_heap, _ptr, _newsize)
 #define _MEM_INFO       _slab_info
 #else
 #define _MEM_INIT(...)
@@ -769,6 +780,14 @@ rt_inline void _slab_info(rt_size_t *total,
 #define _MEM_INFO(...)
 #endif
 
+/* the allocator may serve some requests without the heap lock */
+#ifndef _MEM_MALLOC_NOLOCK
+#define _MEM_MALLOC_NOLOCK(...)     RT_NULL
+#endif
+#ifndef _MEM_FREE_NOLOCK
+#define _MEM_FREE_NOLOCK(...)       RT_FALSE
+#endif
+
 /**
  * @brief This function will do the generic system heap initialization.
  *
@@ -814,12 +833,17 @@ rt_weak void *rt_malloc(rt_size_t size)
     rt_base_t level;
     void *ptr;
 
-    /* Enter critical zone */
-    level = _heap_lock();
-    /* allocate memory block from system heap */
-    ptr = _MEM_MALLOC(size);
-    /* Exit critical zone */
-    _heap_unlock(level);
+    /* try the lockless path of allocator first */
+    ptr = _MEM_MALLOC_NOLOCK(size);
+    if (ptr == RT_NULL)
+    {
+        /* Enter critical zone */
+        level = _heap_lock();
+        /* allocate memory block from system heap */
+        ptr = _MEM_MALLOC(size);
+        /* Exit critical zone */
+        _heap_unlock(level);
+    }
     /* call 'rt_malloc' hook */
     RT_OBJECT_HOOK_CALL(rt_malloc_hook, (&ptr, size));
     return ptr;
@@ -896,6 +920,8 @@ rt_weak void rt_free(void *ptr)
     RT_OBJECT_HOOK_CALL(rt_free_hook, (&ptr));
     /* NULL check */
     if (ptr == RT_NULL) return;
+    /* try the lockless path of allocator first */
+    if (_MEM_FREE_NOLOCK(ptr)) return;
     /* Enter critical zone */
     level = _heap_lock();
     _MEM_FREE(ptr);
@@ -25,6 +25,10 @@ void rt_sched_thread_init_ctx(struct rt_thread *thread, rt_uint32_t tick, rt_uin
     /* not bind on any cpu */
     RT_SCHED_CTX(thread).bind_cpu = RT_CPUS_NR;
     RT_SCHED_CTX(thread).oncpu = RT_CPU_DETACHED;
+#ifdef RT_SCHED_USING_PERCPU_RUNQUEUE
+    RT_SCHED_CTX(thread).rq_cpu = RT_CPU_DETACHED;
+    RT_SCHED_CTX(thread).wake_cpu = RT_CPU_DETACHED;
+#endif /* RT_SCHED_USING_PERCPU_RUNQUEUE */
 #endif /* RT_USING_SMP */
 
     rt_sched_thread_init_priv(thread, tick, priority);
@@ -219,6 +223,14 @@ rt_err_t rt_sched_thread_change_priority(struct rt_thread *thread, rt_uint8_t pr
 #else
         RT_SCHED_PRIV(thread).number_mask = 1 << RT_SCHED_PRIV(thread).current_priority;
 #endif /* RT_THREAD_PRIORITY_MAX > 32 */
+
+#ifdef RT_SCHED_USING_PERCPU_RUNQUEUE
+        /* preemption check of per-cpu ready queue relies on priority of running core */
+        if (RT_SCHED_CTX(thread).oncpu != RT_CPU_DETACHED)
+        {
+            rt_cpu_index(RT_SCHED_CTX(thread).oncpu)->current_priority = priority;
+        }
+#endif /* RT_SCHED_USING_PERCPU_RUNQUEUE */
     }
 
     return RT_EOK;
@@ -268,6 +280,14 @@ rt_err_t rt_sched_thread_set_priority(struct rt_thread *thread, rt_uint8_t prior
 #else
         RT_SCHED_PRIV(thread).number_mask = 1 << RT_SCHED_PRIV(thread).current_priority;
 #endif /* RT_THREAD_PRIORITY_MAX > 32 */
+
+#ifdef RT_SCHED_USING_PERCPU_RUNQUEUE
+        /* preemption check of per-cpu ready queue relies on priority of running core */
+        if (RT_SCHED_CTX(thread).oncpu != RT_CPU_DETACHED)
+        {
+            rt_cpu_index(RT_SCHED_CTX(thread).oncpu)->current_priority = priority;
+        }
+#endif /* RT_SCHED_USING_PERCPU_RUNQUEUE */
     }
 
     return RT_EOK;
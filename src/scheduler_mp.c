@@ -34,6 +34,8 @@
  * 2024-01-05     Shell        Fixup of data racing in rt_critical_level
  * 2024-01-18     Shell        support rt_sched_thread of scheduling status for better mt protection
  * 2024-01-18     Shell        support rt_hw_thread_self to improve overall performance
+ * 2026-10-17     agent        protect percpu ready queue by its own lock, steal only if idle or imbalanced
+ * 2026-10-17     agent        queue woken threads with the ready queue lock of target only
  */
 
 #include <rtthread.h>
@@ -74,6 +76,7 @@ static struct rt_spinlock _mp_scheduler_lock;
         RT_ASSERT(SCHEDULER_LOCK_FLAG(percpu) == 1); \
         SCHEDULER_LOCK_FLAG(percpu) = 0;             \
         _fast_spin_unlock(&_mp_scheduler_lock);      \
+        SCHED_FLUSH_WAKEUPS(percpu);                 \
     } while (0)
 
 #define SCHEDULER_LOCK(level)              \
@@ -225,6 +228,452 @@ rt_inline rt_base_t _get_local_highest_ready_prio(struct rt_cpu* pcpu)
 
 #endif /* RT_THREAD_PRIORITY_MAX > 32 */
 
+#ifdef RT_SCHED_USING_PERCPU_RUNQUEUE
+
+/* a peer queuing this many more unbound threads than us is worth stealing from */
+#define RQ_STEAL_IMBALANCE  2
+
+#ifndef rt_hw_cpu_relax
+#define rt_hw_cpu_relax()   rt_hw_dmb()
+#endif
+
+/**
+ * @brief   insert thread to the ready queue of core `cpu`
+ *
+ * @note    caller must holding the ready queue lock of core `cpu`
+ */
+static void _rq_enqueue(int cpu, struct rt_thread *thread)
+{
+    struct rt_cpu *pcpu = rt_cpu_index(cpu);
+
+#if RT_THREAD_PRIORITY_MAX > 32
+    pcpu->ready_table[RT_SCHED_PRIV(thread).number] |= RT_SCHED_PRIV(thread).high_mask;
+#endif /* RT_THREAD_PRIORITY_MAX > 32 */
+    pcpu->priority_group |= RT_SCHED_PRIV(thread).number_mask;
+
+    /* there is no time slices left(YIELD), inserting thread before ready list*/
+    if ((RT_SCHED_CTX(thread).stat & RT_THREAD_STAT_YIELD_MASK) != 0)
+    {
+        rt_list_insert_before(&(pcpu->priority_table[RT_SCHED_PRIV(thread).current_priority]),
+                              &RT_THREAD_LIST_NODE(thread));
+    }
+    /* there are some time slices left, inserting thread after ready list to schedule it firstly at next time*/
+    else
+    {
+        rt_list_insert_after(&(pcpu->priority_table[RT_SCHED_PRIV(thread).current_priority]),
+                             &RT_THREAD_LIST_NODE(thread));
+    }
+
+    RT_SCHED_CTX(thread).rq_cpu = cpu;
+    if (RT_SCHED_CTX(thread).bind_cpu == RT_CPUS_NR)
+    {
+        pcpu->ready_unbound++;
+    }
+
+    /* it's visible to the ready queue now, release the waiters of it */
+    *(volatile rt_uint8_t *)&RT_SCHED_CTX(thread).wake_cpu = RT_CPU_DETACHED;
+}
+
+/**
+ * @brief   remove a READY thread from the ready queue it's queued on
+ *
+ * @note    caller must holding the ready queue lock of the core it's queued on
+ */
+static void _rq_dequeue(struct rt_thread *thread)
+{
+    struct rt_cpu *pcpu;
+
+    RT_ASSERT(RT_SCHED_CTX(thread).rq_cpu < RT_CPUS_NR);
+    pcpu = rt_cpu_index(RT_SCHED_CTX(thread).rq_cpu);
+
+    rt_list_remove(&RT_THREAD_LIST_NODE(thread));
+
+    if (rt_list_isempty(&(pcpu->priority_table[RT_SCHED_PRIV(thread).current_priority])))
+    {
+#if RT_THREAD_PRIORITY_MAX > 32
+        pcpu->ready_table[RT_SCHED_PRIV(thread).number] &= ~RT_SCHED_PRIV(thread).high_mask;
+        if (pcpu->ready_table[RT_SCHED_PRIV(thread).number] == 0)
+        {
+            pcpu->priority_group &= ~RT_SCHED_PRIV(thread).number_mask;
+        }
+#else
+        pcpu->priority_group &= ~RT_SCHED_PRIV(thread).number_mask;
+#endif /* RT_THREAD_PRIORITY_MAX > 32 */
+    }
+
+    if (RT_SCHED_CTX(thread).bind_cpu == RT_CPUS_NR)
+    {
+        RT_ASSERT(pcpu->ready_unbound > 0);
+        pcpu->ready_unbound--;
+    }
+}
+
+/**
+ * @brief   remove a READY thread from the ready queue it's queued on
+ *
+ * @note    caller must holding the `_mp_scheduler_lock` lock, so the thread is
+ *          not moved to another queue meanwhile. The ready queue lock of the
+ *          core it's queued on is taken here.
+ */
+static void _rq_dequeue_locked(struct rt_thread *thread)
+{
+    struct rt_cpu *pcpu;
+
+    RT_ASSERT(RT_SCHED_CTX(thread).rq_cpu < RT_CPUS_NR);
+    pcpu = rt_cpu_index(RT_SCHED_CTX(thread).rq_cpu);
+
+    _fast_spin_lock(&pcpu->rq_lock);
+    _rq_dequeue(thread);
+    _fast_spin_unlock(&pcpu->rq_lock);
+}
+
+/**
+ * Priority a newly ready thread must beat so that it can run on the core
+ * immediately. Noted that an empty ready queue gives (rt_ubase_t)-1.
+ */
+rt_inline rt_ubase_t _rq_busy_prio(struct rt_cpu *pcpu)
+{
+    rt_ubase_t prio = _get_local_highest_ready_prio(pcpu);
+
+    return prio < pcpu->current_priority ? prio : pcpu->current_priority;
+}
+
+/**
+ * @brief   select a ready queue for an unbound thread. The core it last ran
+ *          on is preferred for cache affinity if the thread can run there
+ *          immediately. Otherwise the core running the lowest priority work
+ *          is selected.
+ *
+ * @note    the thread is owned by caller, no one else is queuing it. Queues of
+ *          peers are read without lock, it's only a hint.
+ */
+static int _rq_select_cpu(struct rt_thread *thread, int cpu_id)
+{
+    int cpu, target;
+    rt_ubase_t prio, lowest, busy;
+
+    prio = RT_SCHED_PRIV(thread).current_priority;
+    target = RT_SCHED_CTX(thread).rq_cpu;
+    if (target >= RT_CPUS_NR)
+    {
+        target = cpu_id;
+    }
+
+    lowest = _rq_busy_prio(rt_cpu_index(target));
+    if (prio < lowest)
+    {
+        return target;
+    }
+
+    for (cpu = 0; cpu < RT_CPUS_NR; cpu++)
+    {
+        busy = _rq_busy_prio(rt_cpu_index(cpu));
+        if (busy > lowest)
+        {
+            lowest = busy;
+            target = cpu;
+        }
+    }
+
+    return target;
+}
+
+/**
+ * @brief   queue a READY thread on its bound core, or the core selected for
+ *          it, and notify that core only if the thread should preempt it.
+ *
+ * @note    local irq must be disabled. The ready queue lock of target is taken
+ *          here, unless the target is this core and `local_locked` is set.
+ */
+static void _rq_activate(int cpu_id, struct rt_thread *thread, rt_bool_t local_locked)
+{
+    int target;
+    rt_bool_t preempt;
+    struct rt_cpu *pcpu;
+
+    target = RT_SCHED_CTX(thread).bind_cpu;
+    if (target == RT_CPUS_NR)
+    {
+        target = _rq_select_cpu(thread, cpu_id);
+    }
+    pcpu = rt_cpu_index(target);
+    local_locked = local_locked && target == cpu_id;
+
+    if (!local_locked)
+    {
+        _fast_spin_lock(&pcpu->rq_lock);
+    }
+
+    _rq_enqueue(target, thread);
+    /* current priority of target is updated under its ready queue lock */
+    preempt = RT_SCHED_PRIV(thread).current_priority < pcpu->current_priority;
+
+    if (!local_locked)
+    {
+        _fast_spin_unlock(&pcpu->rq_lock);
+    }
+
+    if (target != cpu_id && preempt)
+    {
+        rt_hw_ipi_send(RT_SCHEDULE_IPI, 1U << target);
+    }
+}
+
+/**
+ * @brief   queue threads woken by this core. It's done after the
+ *          `_mp_scheduler_lock` lock is released, so a wakeup contends only on
+ *          the ready queue lock of the core it's queued on.
+ *
+ * @note    local irq must be disabled
+ */
+static void _rq_flush_wakeups(struct rt_cpu *pcpu)
+{
+    struct rt_thread *thread;
+
+    while (!rt_list_isempty(&pcpu->wake_pending))
+    {
+        thread = RT_THREAD_LIST_NODE_ENTRY(pcpu->wake_pending.next);
+        rt_list_remove(&RT_THREAD_LIST_NODE(thread));
+
+        _rq_activate(rt_hw_cpu_id(), thread, RT_FALSE);
+    }
+}
+
+#define SCHED_FLUSH_WAKEUPS(pcpu) _rq_flush_wakeups(pcpu)
+
+/**
+ * @brief   wait until a woken thread is visible on the ready queue, before
+ *          anyone dequeues it. Threads woken by this core are queued at once.
+ *
+ * @note    caller must holding the `_mp_scheduler_lock` lock. The core
+ *          queuing the thread never waits for that lock, it can't deadlock.
+ */
+static void _rq_wait_queued(struct rt_thread *thread)
+{
+    struct rt_cpu *pcpu = rt_cpu_self();
+
+    if (RT_SCHED_CTX(thread).wake_cpu == rt_hw_cpu_id())
+    {
+        _rq_flush_wakeups(pcpu);
+    }
+
+    while (*(volatile rt_uint8_t *)&RT_SCHED_CTX(thread).wake_cpu != RT_CPU_DETACHED)
+    {
+        rt_hw_cpu_relax();
+    }
+}
+
+/* find the first unbound thread queued on priority `prio` of core `pcpu` */
+static struct rt_thread *_rq_find_unbound(struct rt_cpu *pcpu, rt_ubase_t prio)
+{
+    rt_list_t *node;
+    struct rt_thread *thread;
+
+    rt_list_for_each(node, &pcpu->priority_table[prio])
+    {
+        thread = RT_THREAD_LIST_NODE_ENTRY(node);
+        if (RT_SCHED_CTX(thread).bind_cpu == RT_CPUS_NR)
+        {
+            return thread;
+        }
+    }
+
+    return RT_NULL;
+}
+
+/**
+ * Priority a thread stolen should beat, i.e. the most urgent work runnable on
+ * this core. The idle priority means that nothing but idle is runnable here.
+ *
+ * @note    caller must holding the `_mp_scheduler_lock` lock or the ready
+ *          queue lock of this core
+ */
+static rt_ubase_t _rq_steal_bar(int cpu_id, struct rt_cpu *pcpu, struct rt_thread *current_thread)
+{
+    rt_ubase_t bar;
+
+    bar = _get_local_highest_ready_prio(pcpu);
+    if ((RT_SCHED_CTX(current_thread).stat & RT_THREAD_STAT_MASK) == RT_THREAD_RUNNING &&
+        (RT_SCHED_CTX(current_thread).bind_cpu == RT_CPUS_NR ||
+         RT_SCHED_CTX(current_thread).bind_cpu == cpu_id) &&
+        RT_SCHED_PRIV(current_thread).current_priority < bar)
+    {
+        bar = RT_SCHED_PRIV(current_thread).current_priority;
+    }
+
+    return bar;
+}
+
+/* whether the peer queues more unbound threads than this core can balance */
+rt_inline rt_bool_t _rq_imbalanced(struct rt_cpu *pcpu, struct rt_cpu *peer)
+{
+    return peer->ready_unbound >= pcpu->ready_unbound + RQ_STEAL_IMBALANCE;
+}
+
+/**
+ * @brief   check if work stealing is worthy. Only a core going idle, or a
+ *          core far less loaded than a peer, scans the queues of peers. Peer
+ *          counters are read without lock, it's only a hint.
+ */
+static rt_bool_t _rq_should_steal(int cpu_id, struct rt_cpu *pcpu, struct rt_thread *current_thread)
+{
+    int cpu;
+    rt_bool_t idle;
+    struct rt_cpu *peer;
+
+    idle = _rq_steal_bar(cpu_id, pcpu, current_thread) >= RT_THREAD_PRIORITY_MAX - 1;
+    for (cpu = 0; cpu < RT_CPUS_NR; cpu++)
+    {
+        peer = rt_cpu_index(cpu);
+        if (cpu != cpu_id && peer->ready_unbound != 0 && (idle || _rq_imbalanced(pcpu, peer)))
+        {
+            return RT_TRUE;
+        }
+    }
+
+    return RT_FALSE;
+}
+
+/**
+ * @brief   work stealing. Pull the most urgent unbound thread from peer cores
+ *          to local ready queue if it beats every thread runnable on this
+ *          core, or ties with them on a peer that is imbalanced. Among
+ *          candidates of the same priority, the one on the busiest peer is
+ *          chosen.
+ *
+ * @note    caller must holding the `_mp_scheduler_lock` lock. A candidate is
+ *          still queued after the peer lock is dropped, since threads are only
+ *          dequeued under the `_mp_scheduler_lock` lock.
+ */
+static void _rq_steal_locked(int cpu_id, struct rt_cpu *pcpu, struct rt_thread *current_thread)
+{
+    int cpu;
+    rt_ubase_t bar, limit, prio;
+    rt_uint32_t busiest = 0;
+    struct rt_cpu *peer;
+    struct rt_thread *thread, *victim = RT_NULL;
+
+    /* thread stolen should be more urgent than anyone can run on this core */
+    bar = _rq_steal_bar(cpu_id, pcpu, current_thread);
+
+    for (cpu = 0; cpu < RT_CPUS_NR; cpu++)
+    {
+        peer = rt_cpu_index(cpu);
+        if (cpu == cpu_id || peer->ready_unbound == 0)
+        {
+            continue;
+        }
+
+        limit = bar;
+        if (_rq_imbalanced(pcpu, peer) && limit < RT_THREAD_PRIORITY_MAX)
+        {
+            limit++;
+        }
+
+        /* peer is queued by woken threads without `_mp_scheduler_lock` */
+        _fast_spin_lock(&peer->rq_lock);
+        thread = RT_NULL;
+        for (prio = _get_local_highest_ready_prio(peer);
+             prio < limit && prio < RT_THREAD_PRIORITY_MAX; prio++)
+        {
+            thread = _rq_find_unbound(peer, prio);
+            if (thread)
+            {
+                break;
+            }
+        }
+        _fast_spin_unlock(&peer->rq_lock);
+
+        if (!thread)
+        {
+            continue;
+        }
+
+        /* a peer of the same priority is only taken if it's busier */
+        if (!victim || prio < RT_SCHED_PRIV(victim).current_priority ||
+            (prio == RT_SCHED_PRIV(victim).current_priority && peer->ready_unbound > busiest))
+        {
+            victim = thread;
+            busiest = peer->ready_unbound;
+            bar = prio + 1;
+        }
+    }
+
+    if (victim)
+    {
+        LOG_D("[cpu#%d] steal thread[%.*s] from cpu#%d", cpu_id,
+              RT_NAME_MAX, victim->parent.name, RT_SCHED_CTX(victim).rq_cpu);
+
+        _rq_dequeue_locked(victim);
+
+        _fast_spin_lock(&pcpu->rq_lock);
+        _rq_enqueue(cpu_id, victim);
+        _fast_spin_unlock(&pcpu->rq_lock);
+    }
+}
+
+/**
+ * @brief   check with only the ready queue lock of this core whether current
+ *          thread keeps the core, so a reschedule changing nothing doesn't
+ *          contend on the `_mp_scheduler_lock` lock.
+ *
+ * @note    local irq must be disabled. Only the RUNNING thread of this core
+ *          without yield or signal flags is qualified, since the flags are
+ *          updated under `_mp_scheduler_lock`. Peers enqueuing a thread that
+ *          preempts us will send a schedule IPI after we return.
+ */
+static rt_bool_t _rq_keep_current(int cpu_id, struct rt_cpu *pcpu, struct rt_thread *current_thread)
+{
+    rt_bool_t keep = RT_FALSE;
+    rt_uint8_t stat = RT_SCHED_CTX(current_thread).stat;
+
+    if ((stat & RT_THREAD_STAT_MASK) != RT_THREAD_RUNNING ||
+        (stat & (RT_THREAD_STAT_YIELD_MASK | RT_THREAD_STAT_SIGNAL_MASK)) != 0)
+    {
+        return RT_FALSE;
+    }
+
+    _fast_spin_lock(&pcpu->rq_lock);
+    if ((RT_SCHED_CTX(current_thread).bind_cpu == RT_CPUS_NR ||
+         RT_SCHED_CTX(current_thread).bind_cpu == cpu_id) &&
+        RT_SCHED_PRIV(current_thread).current_priority <= (rt_ubase_t)_get_local_highest_ready_prio(pcpu) &&
+        !_rq_should_steal(cpu_id, pcpu, current_thread))
+    {
+        keep = RT_TRUE;
+    }
+    _fast_spin_unlock(&pcpu->rq_lock);
+
+    return keep;
+}
+
+#define SCHED_KEEP_CURRENT(cpu_id, pcpu, curthr) _rq_keep_current(cpu_id, pcpu, curthr)
+
+/**
+ * @brief   put current thread giving out the core back to ready queue
+ *
+ * @note    caller must holding the `_mp_scheduler_lock` lock and the ready
+ *          queue lock of this core. The current thread is RUNNING, so it's
+ *          queued at once rather than deferred like a woken thread.
+ */
+static void _rq_requeue_current(int cpu_id, struct rt_thread *current_thread)
+{
+    RT_SCHED_CTX(current_thread).stat = RT_THREAD_READY | (RT_SCHED_CTX(current_thread).stat & ~RT_THREAD_STAT_MASK);
+
+    _rq_activate(cpu_id, current_thread, RT_TRUE);
+}
+
+#define SCHED_REQUEUE_CURRENT(cpu_id, curthr)   _rq_requeue_current(cpu_id, curthr)
+#define SCHED_DEQUEUE_PICKED(thread)            _rq_dequeue(thread)
+
+#else /* !RT_SCHED_USING_PERCPU_RUNQUEUE */
+
+#define SCHED_KEEP_CURRENT(cpu_id, pcpu, curthr) RT_FALSE
+#define SCHED_FLUSH_WAKEUPS(pcpu)
+#define SCHED_REQUEUE_CURRENT(cpu_id, curthr)   _sched_insert_thread_locked(curthr)
+#define SCHED_DEQUEUE_PICKED(thread)            _sched_remove_thread_locked(thread)
+
+#endif /* RT_SCHED_USING_PERCPU_RUNQUEUE */
+
 /*
  * get the highest priority thread in ready queue
  */
@@ -234,7 +683,12 @@ static struct rt_thread* _scheduler_get_highest_priority_thread(rt_ubase_t *high
     rt_ubase_t highest_ready_priority, local_highest_ready_priority;
     struct rt_cpu* pcpu = rt_cpu_self();
 
+#ifdef RT_SCHED_USING_PERCPU_RUNQUEUE
+    /* unbound threads are queued on percpu ready queue as well */
+    highest_ready_priority = (rt_ubase_t)-1;
+#else
     highest_ready_priority = _get_global_highest_ready_prio();
+#endif /* RT_SCHED_USING_PERCPU_RUNQUEUE */
     local_highest_ready_priority = _get_local_highest_ready_prio(pcpu);
 
     /* get highest ready priority thread */
@@ -274,6 +728,7 @@ static void _sched_insert_thread_locked(struct rt_thread *thread)
     int cpu_id;
     int bind_cpu;
     rt_uint32_t cpu_mask;
+    rt_bool_t waking;
 
     if ((RT_SCHED_CTX(thread).stat & RT_THREAD_STAT_MASK) == RT_THREAD_READY)
     {
@@ -290,12 +745,36 @@ static void _sched_insert_thread_locked(struct rt_thread *thread)
         return ;
     }
 
+    waking = rt_sched_thread_is_suspended(thread);
+
     /* READY thread, insert to ready queue */
     RT_SCHED_CTX(thread).stat = RT_THREAD_READY | (RT_SCHED_CTX(thread).stat & ~RT_THREAD_STAT_MASK);
 
     cpu_id   = rt_hw_cpu_id();
     bind_cpu = RT_SCHED_CTX(thread).bind_cpu;
 
+#ifdef RT_SCHED_USING_PERCPU_RUNQUEUE
+    RT_UNUSED(bind_cpu);
+    RT_UNUSED(cpu_mask);
+
+    if (waking)
+    {
+        /**
+         * a woken thread is READY from now on, but it's queued on the core
+         * selected, and that core is notified, only after this core releases
+         * the `_mp_scheduler_lock` lock.
+         */
+        RT_SCHED_CTX(thread).wake_cpu = cpu_id;
+        rt_list_insert_before(&rt_cpu_index(cpu_id)->wake_pending, &RT_THREAD_LIST_NODE(thread));
+    }
+    else
+    {
+        _rq_activate(cpu_id, thread, RT_FALSE);
+    }
+
+#else /* !RT_SCHED_USING_PERCPU_RUNQUEUE */
+    RT_UNUSED(waking);
+
     /* insert thread to ready list */
     if (bind_cpu == RT_CPUS_NR)
     {
@@ -348,6 +827,7 @@ static void _sched_insert_thread_locked(struct rt_thread *thread)
             rt_hw_ipi_send(RT_SCHEDULE_IPI, cpu_mask);
         }
     }
+#endif /* RT_SCHED_USING_PERCPU_RUNQUEUE */
 
     LOG_D("insert thread[%.*s], the priority: %d",
           RT_NAME_MAX, thread->parent.name, RT_SCHED_PRIV(thread).current_priority);
@@ -360,6 +840,18 @@ static void _sched_remove_thread_locked(struct rt_thread *thread)
           RT_NAME_MAX, thread->parent.name,
           RT_SCHED_PRIV(thread).current_priority);
 
+#ifdef RT_SCHED_USING_PERCPU_RUNQUEUE
+    if ((RT_SCHED_CTX(thread).stat & RT_THREAD_STAT_MASK) == RT_THREAD_READY)
+    {
+        _rq_wait_queued(thread);
+        _rq_dequeue_locked(thread);
+    }
+    else
+    {
+        /* not queued on any ready queue */
+        rt_list_remove(&RT_THREAD_LIST_NODE(thread));
+    }
+#else /* !RT_SCHED_USING_PERCPU_RUNQUEUE */
     /* remove thread from ready list */
     rt_list_remove(&RT_THREAD_LIST_NODE(thread));
 
@@ -395,6 +887,7 @@ static void _sched_remove_thread_locked(struct rt_thread *thread)
 #endif /* RT_THREAD_PRIORITY_MAX > 32 */
         }
     }
+#endif /* RT_SCHED_USING_PERCPU_RUNQUEUE */
 }
 
 /**
@@ -427,6 +920,11 @@ void rt_system_scheduler_init(void)
         pcpu->current_priority = RT_THREAD_PRIORITY_MAX - 1;
         pcpu->current_thread = RT_NULL;
         pcpu->priority_group = 0;
+#ifdef RT_SCHED_USING_PERCPU_RUNQUEUE
+        pcpu->ready_unbound = 0;
+        rt_spin_lock_init(&pcpu->rq_lock);
+        rt_list_init(&pcpu->wake_pending);
+#endif /* RT_SCHED_USING_PERCPU_RUNQUEUE */
 
 #if RT_THREAD_PRIORITY_MAX > 32
         rt_memset(pcpu->ready_table, 0, sizeof(pcpu->ready_table));
@@ -471,16 +969,30 @@ void rt_system_scheduler_start(void)
      */
     _fast_spin_lock(&_mp_scheduler_lock);
 
+#ifdef RT_SCHED_USING_PERCPU_RUNQUEUE
+    /* peers may queue woken threads here meanwhile */
+    _fast_spin_lock(&rt_cpu_self()->rq_lock);
+#endif /* RT_SCHED_USING_PERCPU_RUNQUEUE */
+
     /* get the thread scheduling to */
     to_thread = _scheduler_get_highest_priority_thread(&highest_ready_priority);
     RT_ASSERT(to_thread);
 
     /* to_thread is picked to running on current core, so remove it from ready queue */
+#ifdef RT_SCHED_USING_PERCPU_RUNQUEUE
+    _rq_dequeue(to_thread);
+#else
     _sched_remove_thread_locked(to_thread);
+#endif /* RT_SCHED_USING_PERCPU_RUNQUEUE */
 
     /* dedigate current core to `to_thread` */
     RT_SCHED_CTX(to_thread).oncpu = rt_hw_cpu_id();
     RT_SCHED_CTX(to_thread).stat = RT_THREAD_RUNNING;
+    rt_cpu_self()->current_priority = (rt_uint8_t)highest_ready_priority;
+
+#ifdef RT_SCHED_USING_PERCPU_RUNQUEUE
+    _fast_spin_unlock(&rt_cpu_self()->rq_lock);
+#endif /* RT_SCHED_USING_PERCPU_RUNQUEUE */
 
     LOG_D("[cpu#%d] switch to priority#%d thread:%.*s(sp:0x%08x)",
           rt_hw_cpu_id(), RT_SCHED_PRIV(to_thread).current_priority,
@@ -578,6 +1090,20 @@ static rt_thread_t _prepare_context_switch_locked(int cpu_id,
     rt_thread_t to_thread = RT_NULL;
     rt_ubase_t highest_ready_priority;
 
+#ifdef RT_SCHED_USING_PERCPU_RUNQUEUE
+    /* threads woken by this core are seen by this pick */
+    _rq_flush_wakeups(pcpu);
+
+    /* pull urgent threads queuing on peer cores if we are idle or imbalanced */
+    if (_rq_should_steal(cpu_id, pcpu, current_thread))
+    {
+        _rq_steal_locked(cpu_id, pcpu, current_thread);
+    }
+
+    /* peers queue woken threads here without the `_mp_scheduler_lock` lock */
+    _fast_spin_lock(&pcpu->rq_lock);
+#endif /* RT_SCHED_USING_PERCPU_RUNQUEUE */
+
     /* quickly check if any other ready threads queuing */
     if (rt_thread_ready_priority_group != 0 || pcpu->priority_group != 0)
     {
@@ -608,13 +1134,13 @@ static rt_thread_t _prepare_context_switch_locked(int cpu_id,
                 /* otherwise give out the core */
                 else
                 {
-                    _sched_insert_thread_locked(current_thread);
+                    SCHED_REQUEUE_CURRENT(cpu_id, current_thread);
                 }
             }
             else
             {
                 /* put current_thread to ready queue of another core */
-                _sched_insert_thread_locked(current_thread);
+                SCHED_REQUEUE_CURRENT(cpu_id, current_thread);
             }
 
             /* consume the yield flags after scheduling */
@@ -639,7 +1165,7 @@ static rt_thread_t _prepare_context_switch_locked(int cpu_id,
             RT_OBJECT_HOOK_CALL(rt_scheduler_hook, (current_thread, to_thread));
 
             /* remove to_thread from ready queue and update its status to RUNNING */
-            _sched_remove_thread_locked(to_thread);
+            SCHED_DEQUEUE_PICKED(to_thread);
             RT_SCHED_CTX(to_thread).stat = RT_THREAD_RUNNING | (RT_SCHED_CTX(to_thread).stat & ~RT_THREAD_STAT_MASK);
 
             RT_SCHEDULER_STACK_CHECK(to_thread);
@@ -658,6 +1184,10 @@ static rt_thread_t _prepare_context_switch_locked(int cpu_id,
         to_thread = RT_NULL;
     }
 
+#ifdef RT_SCHED_USING_PERCPU_RUNQUEUE
+    _fast_spin_unlock(&pcpu->rq_lock);
+#endif /* RT_SCHED_USING_PERCPU_RUNQUEUE */
+
     return to_thread;
 }
 
@@ -835,6 +1365,17 @@ void rt_schedule(void)
     /* forbid any recursive entries of schedule() */
     SCHEDULER_ENTER_CRITICAL(current_thread);
 
+    /* current thread keeps the core, no need to touch the scheduler lock */
+    if (RT_SCHED_CTX(current_thread).critical_lock_nest == 1 &&
+        SCHED_KEEP_CURRENT(cpu_id, pcpu, current_thread))
+    {
+        CLR_CRITICAL_SWITCH_FLAG(pcpu, current_thread);
+        pcpu->irq_switch_flag = 0;
+        SCHEDULER_EXIT_CRITICAL(current_thread);
+        rt_hw_local_irq_enable(level);
+        return ;
+    }
+
     /* prepare current_thread for processing if signals existed */
     SCHED_THREAD_PREPROCESS_SIGNAL(pcpu, current_thread);
 
@@ -934,6 +1475,14 @@ void rt_scheduler_do_irq_switch(void *context)
         CLR_CRITICAL_SWITCH_FLAG(pcpu, current_thread);
         pcpu->irq_switch_flag = 0;
 
+        if (SCHED_KEEP_CURRENT(cpu_id, pcpu, current_thread))
+        {
+            /* current thread keeps the core, no need to touch the scheduler lock */
+            SCHEDULER_EXIT_CRITICAL(current_thread);
+            rt_hw_local_irq_enable(level);
+            return;
+        }
+
         SCHEDULER_CONTEXT_LOCK(pcpu);
 
         /* pick the highest runnable thread, and pass the control to it */
@@ -13,6 +13,8 @@
  * 2010-07-13     Bernard      fix RT_ALIGN issue found by kuronca
  * 2010-10-23     yi.qiu       add module memory allocator
  * 2010-12-18     yi.qiu       fix zone release bug
+ * 2026-10-17     agent        add per-cpu magazine caches
+ * 2026-10-17     agent        add rt_slab_magazine_get_stat
  */
 
 /*
@@ -188,6 +190,29 @@ struct rt_slab_page
 
 #define RT_SLAB_NZONES                  72              /* number of zones */
 
+#ifdef RT_USING_SLAB_MAGAZINE
+#ifndef RT_SLAB_MAGAZINE_SIZE
+#define RT_SLAB_MAGAZINE_SIZE           16
+#endif /* RT_SLAB_MAGAZINE_SIZE */
+#ifndef RT_SLAB_MAGAZINE_ZONES
+#define RT_SLAB_MAGAZINE_ZONES          24
+#endif /* RT_SLAB_MAGAZINE_ZONES */
+
+/*
+ * Per-cpu stack of free chunks of one zone index. It's only accessed by
+ * the owner cpu with local irq disabled.
+ */
+struct rt_slab_magazine
+{
+    rt_uint32_t  count;                      /**< chunks cached */
+    rt_uint32_t  alloc_hit;                  /**< alloc served by magazine */
+    rt_uint32_t  alloc_miss;                 /**< alloc refilled from zones */
+    rt_uint32_t  free_hit;                   /**< free cached by magazine */
+    rt_uint32_t  free_miss;                  /**< free flushed to zones */
+    void        *chunks[RT_SLAB_MAGAZINE_SIZE];
+};
+#endif /* RT_USING_SLAB_MAGAZINE */
+
 /*
  * slab object
  */
@@ -204,6 +229,9 @@ struct rt_slab
     rt_uint32_t                 zone_limit;
     rt_uint32_t                 zone_page_cnt;
     struct rt_slab_page        *page_list;
+#ifdef RT_USING_SLAB_MAGAZINE
+    struct rt_slab_magazine     magazine[RT_CPUS_NR][RT_SLAB_MAGAZINE_ZONES];
+#endif /* RT_USING_SLAB_MAGAZINE */
 };
 
 /**
@@ -853,4 +881,329 @@ void rt_slab_free(rt_slab_t m, void *ptr)
 }
 RTM_EXPORT(rt_slab_free);
 
+#ifdef RT_USING_SLAB_MAGAZINE
+/*
+ * Get the magazine of current cpu for the zone index of a small chunk,
+ * RT_NULL if the size class is not cached. Local irq must be disabled.
+ */
+rt_inline struct rt_slab_magazine *_magazine_of(struct rt_slab *slab, rt_int32_t zi)
+{
+    if (zi >= RT_SLAB_MAGAZINE_ZONES)
+        return RT_NULL;
+
+    return &slab->magazine[rt_cpu_get_id()][zi];
+}
+
+/*
+ * Get the zone index of a chunk, -1 for a large allocation.
+ */
+rt_inline rt_int32_t _chunk_zoneindex(struct rt_slab *slab, void *ptr)
+{
+    struct rt_slab_zone *z;
+    struct rt_slab_memusage *kup;
+
+    kup = btokup((rt_uintptr_t)ptr & ~RT_MM_PAGE_MASK);
+    if (kup->type != PAGE_TYPE_SMALL)
+        return -1;
+
+    z = (struct rt_slab_zone *)(((rt_uintptr_t)ptr & ~RT_MM_PAGE_MASK) -
+                      kup->size * RT_MM_PAGE_SIZE);
+    RT_ASSERT(z->z_magic == ZALLOC_SLAB_MAGIC);
+
+    return z->z_zoneindex;
+}
+
+/**
+ * @brief This function will allocate a block from the magazine of current cpu
+ *        without touching the zones, so it needs no lock of slab object.
+ *
+ * @param m the slab memory management object.
+ *
+ * @param size is the size of memory to be allocated.
+ *
+ * @return the allocated memory, RT_NULL if the size is not cached or the
+ *         magazine is empty, then rt_slab_magazine_refill() should be used.
+ */
+void *rt_slab_magazine_alloc(rt_slab_t m, rt_size_t size)
+{
+    rt_base_t level;
+    void *chunk = RT_NULL;
+    struct rt_slab_magazine *mag;
+    struct rt_slab *slab = (struct rt_slab *)m;
+
+    if (size == 0 || size >= slab->zone_limit)
+        return RT_NULL;
+
+    level = rt_hw_local_irq_disable();
+    mag = _magazine_of(slab, zoneindex(&size));
+    if (mag != RT_NULL && mag->count > 0)
+    {
+        chunk = mag->chunks[--mag->count];
+        mag->alloc_hit++;
+    }
+    rt_hw_local_irq_enable(level);
+
+    return chunk;
+}
+RTM_EXPORT(rt_slab_magazine_alloc);
+
+/**
+ * @brief This function will allocate a block from slab object, and refill the
+ *        magazine of current cpu to half full in batch from the zones.
+ *
+ * @note It works as rt_slab_alloc(), and must be protected by the lock of slab
+ *       object as well.
+ *
+ * @param m the slab memory management object.
+ *
+ * @param size is the size of memory to be allocated.
+ *
+ * @return the allocated memory.
+ */
+void *rt_slab_magazine_refill(rt_slab_t m, rt_size_t size)
+{
+    rt_base_t level;
+    rt_int32_t zi;
+    void *chunk = RT_NULL;
+    struct rt_slab_magazine *mag;
+    struct rt_slab *slab = (struct rt_slab *)m;
+
+    if (size == 0 || size >= slab->zone_limit)
+        return rt_slab_alloc(m, size);
+
+    zi = zoneindex(&size);
+    if (zi >= RT_SLAB_MAGAZINE_ZONES)
+        return rt_slab_alloc(m, size);
+
+    level = rt_hw_local_irq_disable();
+    mag = _magazine_of(slab, zi);
+    mag->alloc_miss++;
+    while (mag->count < RT_SLAB_MAGAZINE_SIZE / 2)
+    {
+        chunk = rt_slab_alloc(m, size);
+        if (chunk == RT_NULL)
+            break;
+        mag->chunks[mag->count++] = chunk;
+    }
+
+    chunk = RT_NULL;
+    if (mag->count > 0)
+        chunk = mag->chunks[--mag->count];
+    rt_hw_local_irq_enable(level);
+
+    return chunk;
+}
+RTM_EXPORT(rt_slab_magazine_refill);
+
+/**
+ * @brief This function will cache a block in the magazine of current cpu
+ *        without touching the zones, so it needs no lock of slab object.
+ *
+ * @param m the slab memory management object.
+ *
+ * @param ptr is the address of memory which will be released.
+ *
+ * @return RT_TRUE if the block is cached, otherwise rt_slab_magazine_flush()
+ *         should be used to release it.
+ */
+rt_bool_t rt_slab_magazine_free(rt_slab_t m, void *ptr)
+{
+    rt_base_t level;
+    rt_bool_t cached = RT_FALSE;
+    rt_int32_t zi;
+    struct rt_slab_magazine *mag;
+    struct rt_slab *slab = (struct rt_slab *)m;
+
+    if (ptr == RT_NULL)
+        return RT_FALSE;
+
+    zi = _chunk_zoneindex(slab, ptr);
+    if (zi < 0)
+        return RT_FALSE;
+
+    level = rt_hw_local_irq_disable();
+    mag = _magazine_of(slab, zi);
+    if (mag != RT_NULL && mag->count < RT_SLAB_MAGAZINE_SIZE)
+    {
+        mag->chunks[mag->count++] = ptr;
+        mag->free_hit++;
+        cached = RT_TRUE;
+    }
+    rt_hw_local_irq_enable(level);
+
+    return cached;
+}
+RTM_EXPORT(rt_slab_magazine_free);
+
+/**
+ * @brief This function will release a block, and flush the older half of the
+ *        full magazine of current cpu in batch to the zones.
+ *
+ * @note It works as rt_slab_free(), and must be protected by the lock of slab
+ *       object as well.
+ *
+ * @param m the slab memory management object.
+ *
+ * @param ptr is the address of memory which will be released.
+ */
+void rt_slab_magazine_flush(rt_slab_t m, void *ptr)
+{
+    rt_base_t level;
+    rt_int32_t zi;
+    rt_uint32_t i, half;
+    struct rt_slab_magazine *mag;
+    struct rt_slab *slab = (struct rt_slab *)m;
+
+    if (ptr == RT_NULL)
+        return;
+
+    zi = _chunk_zoneindex(slab, ptr);
+    if (zi < 0 || zi >= RT_SLAB_MAGAZINE_ZONES)
+    {
+        rt_slab_free(m, ptr);
+        return;
+    }
+
+    level = rt_hw_local_irq_disable();
+    mag = _magazine_of(slab, zi);
+    mag->free_miss++;
+    if (mag->count == RT_SLAB_MAGAZINE_SIZE)
+    {
+        /* the bottom of stack is the coldest */
+        half = RT_SLAB_MAGAZINE_SIZE / 2;
+        for (i = 0; i < half; i++)
+            rt_slab_free(m, mag->chunks[i]);
+        for (i = half; i < mag->count; i++)
+            mag->chunks[i - half] = mag->chunks[i];
+        mag->count -= half;
+    }
+    mag->chunks[mag->count++] = ptr;
+    rt_hw_local_irq_enable(level);
+}
+RTM_EXPORT(rt_slab_magazine_flush);
+
+/**
+ * @brief This function will get the statistics of the magazine of a cpu.
+ *
+ * @note The magazine of another cpu is read without lock, the statistics are
+ *       only exact for the current cpu.
+ *
+ * @param m the slab memory management object.
+ *
+ * @param cpu is the cpu id.
+ *
+ * @param size is a size of the size class.
+ *
+ * @param stat is the statistics returned.
+ *
+ * @return RT_EOK on success, -RT_EINVAL if the size is not cached.
+ */
+rt_err_t rt_slab_magazine_get_stat(rt_slab_t m, int cpu, rt_size_t size,
+                                   struct rt_slab_magazine_stat *stat)
+{
+    rt_base_t level;
+    rt_int32_t zi;
+    struct rt_slab_magazine *mag;
+    struct rt_slab *slab = (struct rt_slab *)m;
+
+    if (cpu < 0 || cpu >= RT_CPUS_NR || stat == RT_NULL ||
+        size == 0 || size >= slab->zone_limit)
+        return -RT_EINVAL;
+
+    zi = zoneindex(&size);
+    if (zi >= RT_SLAB_MAGAZINE_ZONES)
+        return -RT_EINVAL;
+
+    level = rt_hw_local_irq_disable();
+    mag = &slab->magazine[cpu][zi];
+    stat->count = mag->count;
+    stat->alloc_hit = mag->alloc_hit;
+    stat->alloc_miss = mag->alloc_miss;
+    stat->free_hit = mag->free_hit;
+    stat->free_miss = mag->free_miss;
+    rt_hw_local_irq_enable(level);
+
+    return RT_EOK;
+}
+RTM_EXPORT(rt_slab_magazine_get_stat);
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+
+/*
+ * Get the chunk size of a zone index, the reverse of zoneindex().
+ */
+static rt_size_t _zone_chunksize(rt_int32_t zi)
+{
+    if (zi < 16)
+        return (zi + 1) * 8;
+    if (zi < 24)
+        return (zi - 7) * 16;
+    if (zi < 32)
+        return (zi - 15) * 32;
+    if (zi < 40)
+        return (zi - 23) * 64;
+    if (zi < 48)
+        return (zi - 31) * 128;
+    if (zi < 56)
+        return (zi - 39) * 256;
+    if (zi < 64)
+        return (zi - 47) * 512;
+
+    return (zi - 55) * 1024;
+}
+
+static int list_slab_magazine(void)
+{
+    int cpu;
+    rt_int32_t zi;
+    rt_uint64_t alloc_hit, alloc_miss, free_hit, free_miss, cached;
+    struct rt_object_information *information;
+    struct rt_list_node *node;
+    struct rt_slab_magazine *mag;
+    struct rt_slab *slab;
+
+    information = rt_object_get_information(RT_Object_Class_Memory);
+    for (node = information->object_list.next;
+         node != &(information->object_list);
+         node  = node->next)
+    {
+        slab = (struct rt_slab *)rt_list_entry(node, struct rt_object, list);
+        if (rt_strncmp(slab->parent.algorithm, "slab", RT_NAME_MAX) != 0)
+            continue;
+
+        rt_kprintf("slab %-*.*s\n", RT_NAME_MAX, RT_NAME_MAX, slab->parent.parent.name);
+        rt_kprintf("chunk  alloc hit  alloc miss   free hit  free miss cached  hit rate\n");
+        rt_kprintf("----- ---------- ---------- ---------- ---------- ------ --------\n");
+        for (zi = 0; zi < RT_SLAB_MAGAZINE_ZONES; zi++)
+        {
+            alloc_hit = alloc_miss = free_hit = free_miss = cached = 0;
+            for (cpu = 0; cpu < RT_CPUS_NR; cpu++)
+            {
+                mag = &slab->magazine[cpu][zi];
+                alloc_hit  += mag->alloc_hit;
+                alloc_miss += mag->alloc_miss;
+                free_hit   += mag->free_hit;
+                free_miss  += mag->free_miss;
+                cached     += mag->count;
+            }
+            if (alloc_hit + alloc_miss + free_hit + free_miss == 0)
+                continue;
+
+            rt_kprintf("%5d %10lu %10lu %10lu %10lu %6d %7d%%\n",
+                       (int)_zone_chunksize(zi),
+                       (unsigned long)alloc_hit, (unsigned long)alloc_miss,
+                       (unsigned long)free_hit, (unsigned long)free_miss,
+                       (int)cached,
+                       (int)((alloc_hit + free_hit) * 100 /
+                             (alloc_hit + alloc_miss + free_hit + free_miss)));
+        }
+    }
+
+    return 0;
+}
+MSH_CMD_EXPORT(list_slab_magazine, list the hit rate of slab magazines);
+#endif /* RT_USING_FINSH */
+#endif /* RT_USING_SLAB_MAGAZINE */
+
 #endif /* RT_USING_SLAB */
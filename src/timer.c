@@ -31,9 +31,40 @@
 #define DBG_LVL           DBG_INFO
 #include <rtdbg.h>
 
+#ifdef RT_TIMER_USING_WHEEL
+/**
+ * Hierarchical timing wheel. Each level has _WHEEL_SIZE slots, and a slot of
+ * level `n` covers (_WHEEL_SIZE ^ n) ticks. Timers are hashed into the slot by
+ * their timeout tick, and timers on upper levels are cascaded down when the
+ * clock of wheel steps into their slot.
+ */
+#define _WHEEL_BITS     5
+#define _WHEEL_SIZE     (1u << _WHEEL_BITS)
+#define _WHEEL_MASK     (_WHEEL_SIZE - 1)
+#define _WHEEL_LEVEL    ((sizeof(rt_tick_t) * 8 + _WHEEL_BITS - 1) / _WHEEL_BITS)
+
+struct _timer_wheel
+{
+    rt_tick_t   clock;                              /**< next tick to process */
+    rt_uint32_t pending[_WHEEL_LEVEL];              /**< bitmap of non-empty slots */
+    rt_list_t   slot[_WHEEL_LEVEL][_WHEEL_SIZE];
+};
+
+typedef struct _timer_wheel *_timer_list_t;
+#define _TIMER_LIST(list)   (&(list))
+
+#else
+typedef rt_list_t *_timer_list_t;
+#define _TIMER_LIST(list)   (list)
+#endif /* RT_TIMER_USING_WHEEL */
+
 #ifndef RT_USING_TIMER_ALL_SOFT
 /* hard timer list */
+#ifdef RT_TIMER_USING_WHEEL
+static struct _timer_wheel _timer_list;
+#else
 static rt_list_t _timer_list[RT_TIMER_SKIP_LIST_LEVEL];
+#endif /* RT_TIMER_USING_WHEEL */
 static struct rt_spinlock _htimer_lock;
 #endif
 
@@ -48,7 +79,11 @@ static struct rt_spinlock _htimer_lock;
 #endif /* RT_TIMER_THREAD_PRIO */
 
 /* soft timer list */
+#ifdef RT_TIMER_USING_WHEEL
+static struct _timer_wheel _soft_timer_list;
+#else
 static rt_list_t _soft_timer_list[RT_TIMER_SKIP_LIST_LEVEL];
+#endif /* RT_TIMER_USING_WHEEL */
 static struct rt_spinlock _stimer_lock;
 static struct rt_thread _timer_thread;
 static struct rt_semaphore _soft_timer_sem;
@@ -159,6 +194,290 @@ static void _timer_init(rt_timer_t timer,
     }
 }
 
+#ifdef RT_TIMER_USING_WHEEL
+
+/**
+ * @brief Initialize the timing wheel
+ *
+ * @param wheel the timing wheel
+ */
+static void _wheel_init(struct _timer_wheel *wheel)
+{
+    int lvl, idx;
+
+    wheel->clock = rt_tick_get();
+    for (lvl = 0; lvl < _WHEEL_LEVEL; lvl++)
+    {
+        wheel->pending[lvl] = 0;
+        for (idx = 0; idx < _WHEEL_SIZE; idx++)
+        {
+            rt_list_init(&wheel->slot[lvl][idx]);
+        }
+    }
+}
+
+/**
+ * @brief Hash the timer into the slot by its timeout tick
+ *
+ * @param wheel the timing wheel
+ *
+ * @param timer the timer to insert
+ *
+ * @param to_head insert to the head of slot. Timers cascaded down from upper
+ *        level are inserted earlier than any timer of the slot, so they are
+ *        placed in front to keep the FIFO order of the same timeout tick.
+ */
+static void _wheel_insert(struct _timer_wheel *wheel, rt_timer_t timer, rt_bool_t to_head)
+{
+    int lvl;
+    rt_uint32_t idx;
+    rt_tick_t delta;
+    rt_list_t *head;
+
+    delta = timer->timeout_tick - wheel->clock;
+
+    if (delta >= RT_TICK_MAX / 2)
+    {
+        /* already expired, put it on the slot to be processed next */
+        lvl = 0;
+        idx = wheel->clock & _WHEEL_MASK;
+    }
+    else
+    {
+        for (lvl = 0; lvl < _WHEEL_LEVEL - 1; lvl++)
+        {
+            if (delta < ((rt_tick_t)1 << ((lvl + 1) * _WHEEL_BITS)))
+            {
+                break;
+            }
+        }
+        idx = (timer->timeout_tick >> (lvl * _WHEEL_BITS)) & _WHEEL_MASK;
+    }
+
+    head = &wheel->slot[lvl][idx];
+    if (to_head)
+    {
+        rt_list_insert_after(head, &timer->row[0]);
+    }
+    else
+    {
+        rt_list_insert_before(head, &timer->row[0]);
+    }
+    wheel->pending[lvl] |= 1u << idx;
+}
+
+/**
+ * @brief Check whether there is no timer on the wheel
+ */
+rt_inline rt_bool_t _wheel_is_empty(struct _timer_wheel *wheel)
+{
+    int lvl;
+
+    for (lvl = 0; lvl < _WHEEL_LEVEL; lvl++)
+    {
+        if (wheel->pending[lvl])
+        {
+            return RT_FALSE;
+        }
+    }
+
+    return RT_TRUE;
+}
+
+/**
+ * @brief Clear the pending bit of a drained slot
+ *
+ * @param wheel the timing wheel
+ *
+ * @param head the list head which is left empty
+ *
+ * @return RT_TRUE if the head is a slot of the wheel
+ */
+rt_inline rt_bool_t _wheel_slot_drained(struct _timer_wheel *wheel, rt_list_t *head)
+{
+    rt_ubase_t offset;
+
+    if (head < &wheel->slot[0][0] || head >= &wheel->slot[0][0] + _WHEEL_LEVEL * _WHEEL_SIZE)
+    {
+        return RT_FALSE;
+    }
+
+    offset = head - &wheel->slot[0][0];
+    wheel->pending[offset / _WHEEL_SIZE] &= ~(1u << (offset % _WHEEL_SIZE));
+
+    return RT_TRUE;
+}
+
+/**
+ * @brief Find the next pending slot from `from`, wrapping around the level
+ *
+ * @return index of the slot, or -1 if none
+ */
+rt_inline int _wheel_next_slot(rt_uint32_t pending, rt_uint32_t from)
+{
+    from &= _WHEEL_MASK;
+    if (from)
+    {
+        pending = (pending >> from) | (pending << (_WHEEL_SIZE - from));
+    }
+
+    if (!pending)
+    {
+        return -1;
+    }
+
+    return (from + __rt_ffs((int)pending) - 1) & _WHEEL_MASK;
+}
+
+/**
+ * @brief Move the timers of upper levels down when the clock steps into their
+ *        slots. It's called when the clock is stepping on slot 0 of level 0.
+ *
+ * @param wheel the timing wheel
+ */
+static void _wheel_cascade(struct _timer_wheel *wheel)
+{
+    int lvl;
+    rt_uint32_t idx;
+    rt_list_t *head;
+    struct rt_timer *t;
+
+    for (lvl = 1; lvl < _WHEEL_LEVEL; lvl++)
+    {
+        idx = (wheel->clock >> (lvl * _WHEEL_BITS)) & _WHEEL_MASK;
+        head = &wheel->slot[lvl][idx];
+
+        /* from tail to head, so the order of slot is kept after inserting to head */
+        while (!rt_list_isempty(head))
+        {
+            t = rt_list_entry(head->prev, struct rt_timer, row[0]);
+            rt_list_remove(&t->row[0]);
+            _wheel_insert(wheel, t, RT_TRUE);
+        }
+        wheel->pending[lvl] &= ~(1u << idx);
+
+        if (idx != 0)
+        {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Count the ticks from the clock of wheel that have nothing to do, so
+ *        the wheel can skip them at once.
+ *
+ * @param wheel the timing wheel
+ *
+ * @param current_tick the tick the wheel is going to catch up with
+ *
+ * @return ticks to skip, no more than the ticks to reach current_tick
+ */
+static rt_tick_t _wheel_idle_ticks(struct _timer_wheel *wheel, rt_tick_t current_tick)
+{
+    int lvl;
+    rt_tick_t limit, step;
+    rt_uint32_t idx, pending;
+
+    limit = current_tick - wheel->clock + 1;
+
+    for (lvl = 1; lvl < _WHEEL_LEVEL; lvl++)
+    {
+        if (wheel->pending[lvl])
+        {
+            break;
+        }
+    }
+
+    idx = wheel->clock & _WHEEL_MASK;
+    if (lvl == _WHEEL_LEVEL)
+    {
+        if (!wheel->pending[0])
+        {
+            /* the wheel is empty */
+            return limit;
+        }
+    }
+    else if (idx == 0)
+    {
+        /* cascading is required */
+        return 0;
+    }
+
+    if (wheel->pending[0] & (1u << idx))
+    {
+        return 0;
+    }
+
+    /* step to the next pending slot, or the next point of cascading */
+    pending = (wheel->pending[0] >> idx) >> 1;
+    if (pending)
+    {
+        step = __rt_ffs((int)pending);
+    }
+    else
+    {
+        step = _WHEEL_SIZE - idx;
+    }
+
+    return step < limit ? step : limit;
+}
+
+/**
+ * @brief  Find the next timeout tick of the wheel
+ *
+ * @param wheel the timing wheel
+ *
+ * @param timeout_tick is the next timer's ticks
+ *
+ * @return  Return the operation status. If the return value is RT_EOK, the function is successfully executed.
+ *          If the return value is any other values, it means this operation failed.
+ */
+static rt_err_t _timer_list_next_timeout(struct _timer_wheel *wheel, rt_tick_t *timeout_tick)
+{
+    int lvl, idx;
+    rt_uint32_t from;
+    rt_tick_t delta, nearest = RT_TICK_MAX;
+    struct rt_timer *t;
+    rt_list_t *node;
+
+    for (lvl = 0; lvl < _WHEEL_LEVEL; lvl++)
+    {
+        /**
+         * slot of level 0 is exact tick. On upper levels, the slot under the
+         * clock had been cascaded, anything there is a full round later.
+         */
+        from = (wheel->clock >> (lvl * _WHEEL_BITS)) + (lvl ? 1 : 0);
+        idx = _wheel_next_slot(wheel->pending[lvl], from);
+        if (idx < 0)
+        {
+            continue;
+        }
+
+        /* slots are in order of time, only the first one is interested */
+        rt_list_for_each(node, &wheel->slot[lvl][idx])
+        {
+            t = rt_list_entry(node, struct rt_timer, row[0]);
+            delta = t->timeout_tick - wheel->clock;
+            if (delta >= RT_TICK_MAX / 2)
+            {
+                /* expired one */
+                delta = 0;
+            }
+
+            if (delta < nearest)
+            {
+                nearest = delta;
+                *timeout_tick = t->timeout_tick;
+            }
+        }
+    }
+
+    return nearest == RT_TICK_MAX ? -RT_ERROR : RT_EOK;
+}
+
+#else /* !RT_TIMER_USING_WHEEL */
+
 /**
  * @brief  Find the next emtpy timer ticks
  *
@@ -183,6 +502,8 @@ static rt_err_t _timer_list_next_timeout(rt_list_t timer_list[], rt_tick_t *time
     return -RT_ERROR;
 }
 
+#endif /* RT_TIMER_USING_WHEEL */
+
 /**
  * @brief Remove the timer
  *
@@ -191,14 +512,33 @@ static rt_err_t _timer_list_next_timeout(rt_list_t timer_list[], rt_tick_t *time
 rt_inline void _timer_remove(rt_timer_t timer)
 {
     int i;
+#ifdef RT_TIMER_USING_WHEEL
+    rt_list_t *prev = timer->row[0].prev;
+#endif /* RT_TIMER_USING_WHEEL */
 
     for (i = 0; i < RT_TIMER_SKIP_LIST_LEVEL; i++)
     {
         rt_list_remove(&timer->row[i]);
     }
+
+#ifdef RT_TIMER_USING_WHEEL
+    /* only the list head of slot is left, keep the pending bitmap exact */
+    if (prev != &timer->row[0] && prev->next == prev)
+    {
+#ifndef RT_USING_TIMER_ALL_SOFT
+        if (_wheel_slot_drained(&_timer_list, prev))
+        {
+            return;
+        }
+#endif /* RT_USING_TIMER_ALL_SOFT */
+#ifdef RT_USING_TIMER_SOFT
+        _wheel_slot_drained(&_soft_timer_list, prev);
+#endif /* RT_USING_TIMER_SOFT */
+    }
+#endif /* RT_TIMER_USING_WHEEL */
 }
 
-#if (DBG_LVL == DBG_LOG)
+#if (DBG_LVL == DBG_LOG) && !defined(RT_TIMER_USING_WHEEL)
 /**
  * @brief The number of timer
  *
@@ -237,7 +577,7 @@ void rt_timer_dump(rt_list_t timer_heads[])
     }
     rt_kprintf("\n");
 }
-#endif /* (DBG_LVL == DBG_LOG) */
+#endif /* (DBG_LVL == DBG_LOG) && !defined(RT_TIMER_USING_WHEEL) */
 
 /**
  * @addtogroup Clock
@@ -399,6 +739,134 @@ rt_err_t rt_timer_delete(rt_timer_t timer)
 RTM_EXPORT(rt_timer_delete);
 #endif /* RT_USING_HEAP */
 
+#ifdef RT_TIMER_USING_WHEEL
+/**
+ * @brief This function will start the timer
+ *
+ * @param wheel the timing wheel the timer is hashed into
+ *
+ * @param timer the timer to be started
+ *
+ * @return the operation status, RT_EOK on OK, -RT_ERROR on error
+ */
+static rt_err_t _timer_start(struct _timer_wheel *wheel, rt_timer_t timer)
+{
+    rt_tick_t current_tick;
+
+    /* remove timer from list */
+    _timer_remove(timer);
+    /* change status of timer */
+    timer->parent.flag &= ~RT_TIMER_FLAG_ACTIVATED;
+
+    RT_OBJECT_HOOK_CALL(rt_object_take_hook, (&(timer->parent)));
+
+    current_tick = rt_tick_get();
+    timer->timeout_tick = current_tick + timer->init_tick;
+
+    /* an empty wheel is not stepped, catch up with the tick before hashing */
+    if (_wheel_is_empty(wheel) && (current_tick - wheel->clock) < RT_TICK_MAX / 2)
+    {
+        wheel->clock = current_tick;
+    }
+
+    _wheel_insert(wheel, timer, RT_FALSE);
+
+    timer->parent.flag |= RT_TIMER_FLAG_ACTIVATED;
+
+    return RT_EOK;
+}
+
+/**
+ * @brief This function will check timer list, if a timeout event happens,
+ *        the corresponding timeout function will be invoked.
+ *
+ * @param wheel The timing wheel to check.
+ * @param lock The lock for the timing wheel.
+ */
+static void _timer_check(struct _timer_wheel *wheel, struct rt_spinlock *lock)
+{
+    struct rt_timer *t;
+    rt_tick_t current_tick, step, clock;
+    rt_base_t level;
+    rt_list_t list, *head;
+
+    level = rt_spin_lock_irqsave(lock);
+
+    current_tick = rt_tick_get();
+
+    rt_list_init(&list);
+
+    /* catch up with current tick */
+    while ((current_tick - wheel->clock) < RT_TICK_MAX / 2)
+    {
+        step = _wheel_idle_ticks(wheel, current_tick);
+        if (step)
+        {
+            wheel->clock += step;
+            continue;
+        }
+
+        clock = wheel->clock;
+        if ((clock & _WHEEL_MASK) == 0)
+        {
+            _wheel_cascade(wheel);
+        }
+
+        head = &wheel->slot[0][clock & _WHEEL_MASK];
+        while (!rt_list_isempty(head))
+        {
+            t = rt_list_entry(head->next, struct rt_timer, row[0]);
+
+            RT_OBJECT_HOOK_CALL(rt_timer_enter_hook, (t));
+
+            /* remove timer from timer list firstly */
+            _timer_remove(t);
+            if (!(t->parent.flag & RT_TIMER_FLAG_PERIODIC))
+            {
+                t->parent.flag &= ~RT_TIMER_FLAG_ACTIVATED;
+            }
+
+            /* add timer to temporary list  */
+            rt_list_insert_after(&list, &(t->row[0]));
+
+            rt_spin_unlock_irqrestore(lock, level);
+
+            /* call timeout function */
+            t->timeout_func(t->parameter);
+
+            RT_OBJECT_HOOK_CALL(rt_timer_exit_hook, (t));
+
+            level = rt_spin_lock_irqsave(lock);
+
+            /* Check whether the timer object is detached or started again */
+            if (rt_list_isempty(&list))
+            {
+                continue;
+            }
+            rt_list_remove(&(t->row[0]));
+            if ((t->parent.flag & RT_TIMER_FLAG_PERIODIC) &&
+                (t->parent.flag & RT_TIMER_FLAG_ACTIVATED))
+            {
+                /* start it */
+                t->parent.flag &= ~RT_TIMER_FLAG_ACTIVATED;
+                _timer_start(wheel, t);
+            }
+        }
+
+        /* clock is moved forward if the wheel was drained and restarted meanwhile */
+        if (wheel->clock == clock)
+        {
+            wheel->clock++;
+        }
+
+        /* re-get tick */
+        current_tick = rt_tick_get();
+    }
+    rt_spin_unlock_irqrestore(lock, level);
+}
+
+#else /* !RT_TIMER_USING_WHEEL */
+
 /**
  * @brief This function will start the timer
  *
@@ -552,6 +1020,8 @@ static void _timer_check(rt_list_t *timer_list, struct rt_spinlock *lock)
     rt_spin_unlock_irqrestore(lock, level);
 }
 
+#endif /* RT_TIMER_USING_WHEEL */
+
 /**
  * @brief This function will start the timer
  *
@@ -564,7 +1034,7 @@ rt_err_t rt_timer_start(rt_timer_t timer)
     rt_sched_lock_level_t slvl;
     int is_thread_timer = 0;
     struct rt_spinlock *spinlock;
-    rt_list_t *timer_list;
+    _timer_list_t timer_list;
     rt_base_t level;
     rt_err_t err;
 
@@ -573,19 +1043,19 @@ rt_err_t rt_timer_start(rt_timer_t timer)
     RT_ASSERT(rt_object_get_type(&timer->parent) == RT_Object_Class_Timer);
 
 #ifdef RT_USING_TIMER_ALL_SOFT
-    timer_list = _soft_timer_list;
+    timer_list = _TIMER_LIST(_soft_timer_list);
     spinlock = &_stimer_lock;
 #else
 #ifdef RT_USING_TIMER_SOFT
     if (timer->parent.flag & RT_TIMER_FLAG_SOFT_TIMER)
     {
-        timer_list = _soft_timer_list;
+        timer_list = _TIMER_LIST(_soft_timer_list);
         spinlock = &_stimer_lock;
     }
     else
 #endif /* RT_USING_TIMER_SOFT */
     {
-        timer_list = _timer_list;
+        timer_list = _TIMER_LIST(_timer_list);
         spinlock = &_htimer_lock;
     }
 #endif
@@ -612,6 +1082,11 @@ rt_err_t rt_timer_start(rt_timer_t timer)
         rt_sched_unlock(slvl);
     }
 
+#if defined(RT_USING_TICKLESS_IDLE) && defined(RT_USING_SMP)
+    /* core 0 may sleep beyond the new timer */
+    rt_thread_idle_tickless_kick();
+#endif /* RT_USING_TICKLESS_IDLE && RT_USING_SMP */
+
     return err;
 }
 RTM_EXPORT(rt_timer_start);
@@ -758,6 +1233,16 @@ void rt_timer_check(void)
 #endif
 
 #ifdef RT_USING_TIMER_SOFT
+#ifdef RT_TIMER_USING_WHEEL
+    rt_tick_t current_tick = rt_tick_get();
+
+    /* wake up timer thread if the soft wheel has anything to do */
+    if ((current_tick - _soft_timer_list.clock) < RT_TICK_MAX / 2 &&
+        _wheel_idle_ticks(&_soft_timer_list, current_tick) != current_tick - _soft_timer_list.clock + 1)
+    {
+        rt_sem_release(&_soft_timer_sem);
+    }
+#else
     rt_err_t ret = RT_ERROR;
     rt_tick_t next_timeout;
 
@@ -766,9 +1251,10 @@ void rt_timer_check(void)
     {
         rt_sem_release(&_soft_timer_sem);
     }
+#endif /* RT_TIMER_USING_WHEEL */
 #endif
 #ifndef RT_USING_TIMER_ALL_SOFT
-    _timer_check(_timer_list, &_htimer_lock);
+    _timer_check(_TIMER_LIST(_timer_list), &_htimer_lock);
 #endif
 }
 
@@ -784,13 +1270,13 @@ rt_tick_t rt_timer_next_timeout_tick(void)
 
 #ifndef RT_USING_TIMER_ALL_SOFT
     level = rt_spin_lock_irqsave(&_htimer_lock);
-    _timer_list_next_timeout(_timer_list, &htimer_next_timeout);
+    _timer_list_next_timeout(_TIMER_LIST(_timer_list), &htimer_next_timeout);
     rt_spin_unlock_irqrestore(&_htimer_lock, level);
 #endif
 
 #ifdef RT_USING_TIMER_SOFT
     level = rt_spin_lock_irqsave(&_stimer_lock);
-    _timer_list_next_timeout(_soft_timer_list, &stimer_next_timeout);
+    _timer_list_next_timeout(_TIMER_LIST(_soft_timer_list), &stimer_next_timeout);
     rt_spin_unlock_irqrestore(&_stimer_lock, level);
 #endif
 
@@ -809,7 +1295,7 @@ static void _timer_thread_entry(void *parameter)
 
     while (1)
     {
-        _timer_check(_soft_timer_list, &_stimer_lock); /* check software timer */
+        _timer_check(_TIMER_LIST(_soft_timer_list), &_stimer_lock); /* check software timer */
         rt_sem_take(&_soft_timer_sem, RT_WAITING_FOREVER);
     }
 }
@@ -823,12 +1309,16 @@ static void _timer_thread_entry(void *parameter)
 void rt_system_timer_init(void)
 {
 #ifndef RT_USING_TIMER_ALL_SOFT
+#ifdef RT_TIMER_USING_WHEEL
+    _wheel_init(&_timer_list);
+#else
     rt_size_t i;
 
     for (i = 0; i < sizeof(_timer_list) / sizeof(_timer_list[0]); i++)
     {
         rt_list_init(_timer_list + i);
     }
+#endif /* RT_TIMER_USING_WHEEL */
 
     rt_spin_lock_init(&_htimer_lock);
 #endif
@@ -842,6 +1332,9 @@ void rt_system_timer_init(void)
 void rt_system_timer_thread_init(void)
 {
 #ifdef RT_USING_TIMER_SOFT
+#ifdef RT_TIMER_USING_WHEEL
+    _wheel_init(&_soft_timer_list);
+#else
     int i;
 
     for (i = 0;
@@ -850,6 +1343,7 @@ void rt_system_timer_thread_init(void)
     {
         rt_list_init(_soft_timer_list + i);
     }
+#endif /* RT_TIMER_USING_WHEEL */
     rt_spin_lock_init(&_stimer_lock);
     rt_sem_init(&_soft_timer_sem, "stimer", 0, RT_IPC_FLAG_PRIO);
     rt_sem_control(&_soft_timer_sem, RT_IPC_CMD_SET_VLIMIT, (void*)1);